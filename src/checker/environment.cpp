@@ -23,15 +23,15 @@ std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::add_struct(D
         // The GlobalChecker never enters local scope and the LocalChecker never calls this function.
         return {nullptr, E_STRUCT_IN_LOCAL_SCOPE};
     } else {
-        auto iter = current_scope->children.find(decl->name.lexeme);
+        auto iter = current_scope->children.find(decl->name.symbol);
         if (iter != current_scope->children.end()) {
             auto locatable = std::dynamic_pointer_cast<Node::Locatable>(iter->second);
             return {locatable, E_STRUCT_ALREADY_DECLARED};
         } else {
-            auto new_scope = std::make_shared<Node::StructScope>(decl->location, current_scope, decl->name.lexeme);
+            auto new_scope = std::make_shared<Node::StructScope>(decl->location, current_scope, decl->name.lexeme, *llvm_context);
             auto new_type = std::make_shared<Type::Struct>(new_scope);
             decl->struct_type = new_type;
-            current_scope->children[decl->name.lexeme] = new_scope;
+            current_scope->children[decl->name.symbol] = new_scope;
             current_scope = new_scope;
             struct_scopes.push_back(new_scope);
             return {new_scope, (ErrorCode)0};
@@ -39,11 +39,64 @@ std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::add_struct(D
     }
 }
 
+std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::add_enum(Decl::Enum* decl) {
+    if (IS_TYPE(current_scope, Node::LocalScope)) {
+        return {nullptr, E_STRUCT_IN_LOCAL_SCOPE};
+    }
+    auto iter = current_scope->children.find(decl->name.symbol);
+    if (iter != current_scope->children.end()) {
+        auto locatable = std::dynamic_pointer_cast<Node::Locatable>(iter->second);
+        return {locatable, E_STRUCT_ALREADY_DECLARED};
+    }
+    // An enum whose values are integers needs no struct type
+    llvm::Type* llvm_type = nullptr;
+    if (decl->layout != Decl::Enum::Layout::TAGGED_UNION) {
+        llvm_type = llvm::IntegerType::get(*llvm_context, decl->tag_bits());
+    }
+    auto new_scope = std::make_shared<Node::StructScope>(decl->location, current_scope, decl->name.lexeme, *llvm_context, llvm_type);
+    new_scope->enum_decl = decl;
+    if (llvm_type != nullptr) {
+        decl->enum_type = std::make_shared<Type::Named>(new_scope);
+    } else {
+        decl->enum_type = std::make_shared<Type::Struct>(new_scope);
+    }
+    current_scope->children[decl->name.symbol] = new_scope;
+    struct_scopes.push_back(new_scope);
+    return {new_scope, (ErrorCode)0};
+}
+
+std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::add_generic(Decl* decl, const Token& name) {
+    auto iter = current_scope->children.find(name.symbol);
+    if (iter != current_scope->children.end()) {
+        auto locatable = std::dynamic_pointer_cast<Node::Locatable>(iter->second);
+        return {locatable, E_SYMBOL_ALREADY_DECLARED};
+    }
+    auto new_generic = std::make_shared<Node::Generic>(current_scope, decl, name);
+    current_scope->children[name.symbol] = new_generic;
+    return {new_generic, (ErrorCode)0};
+}
+
+std::string Environment::instance_name(const std::string& name, const std::vector<std::shared_ptr<Type>>& type_args) {
+    std::string result = name + "<";
+    for (size_t i = 0; i < type_args.size(); i++) {
+        result += type_args[i]->to_string();
+        result += i < type_args.size() - 1 ? ", " : "";
+    }
+    return result + ">";
+}
+
 void Environment::install_primitive_types() {
 
     std::vector<std::pair<std::string, llvm::Type*>> primitive_types = {
+        {"i8", llvm::Type::getInt8Ty(*llvm_context)},
+        {"i16", llvm::Type::getInt16Ty(*llvm_context)},
         {"i32", llvm::Type::getInt32Ty(*llvm_context)},
         {"i64", llvm::Type::getInt64Ty(*llvm_context)},
+        {"u8", llvm::Type::getInt8Ty(*llvm_context)},
+        {"u16", llvm::Type::getInt16Ty(*llvm_context)},
+        {"u32", llvm::Type::getInt32Ty(*llvm_context)},
+        {"u64", llvm::Type::getInt64Ty(*llvm_context)},
+        {"f32", llvm::Type::getFloatTy(*llvm_context)},
         {"f64", llvm::Type::getDoubleTy(*llvm_context)},
         {"bool", llvm::Type::getInt1Ty(*llvm_context)},
         {"char", llvm::Type::getInt8Ty(*llvm_context)},
@@ -51,14 +104,14 @@ void Environment::install_primitive_types() {
     };
 
     for (auto& type : primitive_types) {
-        auto new_struct = std::make_shared<Node::StructScope>(Location(), global_tree, type.first, type.second);
+        auto new_struct = std::make_shared<Node::StructScope>(Location(), global_tree, type.first, *llvm_context, type.second);
         new_struct->is_primitive = true;
         global_tree->children[type.first] = new_struct;
     }
 }
 
 void Environment::increase_local_scope() {
-    auto local_scope = std::make_shared<Node::LocalScope>(current_scope);
+    auto local_scope = std::make_shared<Node::LocalScope>(current_scope, local_scope_count++);
     current_scope = local_scope;
     local_scopes.push_back(local_scope);
 }
@@ -90,7 +143,7 @@ ErrorCode Environment::exit_scope() {
 }
 
 void Environment::exit_all_local_scopes() {
-    while (!IS_TYPE(current_scope, Node::LocalScope)) {
+    while (IS_TYPE(current_scope, Node::LocalScope)) {
         exit_scope();
     }
     local_scopes.clear();
@@ -104,7 +157,7 @@ std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::declare_vari
     Decl::VarDeclarable* decl,
     bool allow_deferral
 ) {
-    auto iter = current_scope->children.find(decl->name.lexeme);
+    auto iter = current_scope->children.find(decl->name.symbol);
     if (iter != current_scope->children.end()) {
         // The symbol has already been declared.
         auto locatable = std::dynamic_pointer_cast<Node::Locatable>(iter->second);
@@ -132,8 +185,14 @@ std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::declare_vari
                 // This is to prevent users from mutating the object that the pointer points to.
                 ptr_type->declarer = decl->declarer;
             }
+            // The same goes for the elements a slice refers to.
+            auto slice_type = std::dynamic_pointer_cast<Type::Slice>(type);
+            if (slice_type != nullptr) {
+                slice_type->declarer = decl->declarer;
+            }
 
             auto new_variable = std::make_shared<Node::Variable>(current_scope, decl);
+            decl->variable = new_variable;
             if (decl->is_instance_member) {
                 auto struct_scope = std::dynamic_pointer_cast<Node::StructScope>(current_scope);
                 if (struct_scope == nullptr) {
@@ -141,7 +200,7 @@ std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::declare_vari
                 }
                 struct_scope->instance_members[decl->name.lexeme] = decl;
             } else {
-                current_scope->children[decl->name.lexeme] = new_variable;
+                current_scope->children[decl->name.symbol] = new_variable;
             }
 
             // If the type is a function, add it to the function list.
@@ -155,28 +214,76 @@ std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> Environment::declare_vari
 }
 
 std::shared_ptr<Node::Variable> Environment::get_variable(const std::vector<Token>& ident_tokens) {
-    std::vector<std::string> ident_strings;
+    std::vector<Symbol> ident_symbols;
+    ident_symbols.reserve(ident_tokens.size());
     for (auto& token : ident_tokens) {
-        ident_strings.push_back(token.lexeme);
+        ident_symbols.push_back(token.symbol);
     }
-    return get_variable(ident_strings);
+    return get_variable(ident_symbols);
 }
 
 std::shared_ptr<Node::Variable> Environment::get_variable(const std::vector<std::string>& ident_strings) {
+    std::vector<Symbol> ident_symbols;
+    ident_symbols.reserve(ident_strings.size());
+    for (auto& name : ident_strings) {
+        ident_symbols.push_back(Symbol::find(name));
+    }
+    return get_variable(ident_symbols);
+}
+
+std::shared_ptr<Node::Variable> Environment::get_variable(const std::vector<Symbol>& ident_symbols) {
+    // A name that was never interned cannot have been declared.
+    for (auto& symbol : ident_symbols) {
+        if (symbol.empty()) {
+            return nullptr;
+        }
+    }
+
     std::shared_ptr<Node> found_node = nullptr;
     // If the identifier is a single token, we can look up the variable in the global scope.
-    if (ident_strings.size() == 1) {
-        found_node = current_scope->upward_lookup(ident_strings[0]);
+    if (ident_symbols.size() == 1) {
+        found_node = current_scope->upward_lookup(ident_symbols[0]);
     }
     // If the first lookup failed or was not attempted, we perform a downward lookup.
     if (found_node == nullptr) {
         // TODO: Check later to see if this works. If it doesn't, this function will return nullptr and it'll appear as if the symbol was not found.
-        found_node = current_scope->downward_lookup(ident_strings);
+        found_node = current_scope->downward_lookup(ident_symbols);
     }
 
     return std::dynamic_pointer_cast<Node::Variable>(found_node);
 }
 
+std::vector<std::string> Environment::get_path(const Expr::Identifier* identifier) {
+    std::vector<std::string> path;
+    for (size_t i = 0; i < identifier->tokens.size(); i++) {
+        if (i >= identifier->type_args.size() || identifier->type_args[i].empty()) {
+            path.push_back(identifier->tokens[i].lexeme);
+            continue;
+        }
+        std::vector<std::shared_ptr<Type>> type_args;
+        for (auto& type_arg : identifier->type_args[i]) {
+            auto type = get_type(type_arg);
+            if (type == nullptr) {
+                return {};
+            }
+            type_args.push_back(type);
+        }
+        path.push_back(instance_name(identifier->tokens[i].lexeme, type_args));
+    }
+    return path;
+}
+
+std::shared_ptr<Node::Generic> Environment::get_generic(const std::vector<std::string>& ident_strings) {
+    std::shared_ptr<Node> found_node = nullptr;
+    if (ident_strings.size() == 1) {
+        found_node = current_scope->upward_lookup(ident_strings[0]);
+    }
+    if (found_node == nullptr) {
+        found_node = current_scope->downward_lookup(ident_strings);
+    }
+    return std::dynamic_pointer_cast<Node::Generic>(found_node);
+}
+
 Decl::VarDeclarable* Environment::get_instance_variable(std::shared_ptr<Type::Named> instance_type, const std::string& member_name) {
     auto struct_node = instance_type->struct_scope;
     auto found_node_iter = struct_node->instance_members.find(member_name);
@@ -202,15 +309,21 @@ std::shared_ptr<Type> Environment::get_type(const std::shared_ptr<Annotation>& a
         // Start building the path to the type.
         std::vector<std::string> path;
         for (auto& class_ : segmented_annotation->classes) {
-            path.push_back(class_->name);
-            // Also verify each type argument in the segmented type.
+            if (class_->type_args.empty()) {
+                path.push_back(class_->name);
+                continue;
+            }
+            // A class with type arguments names an instance of a generic struct.
+            std::vector<std::shared_ptr<Type>> type_args;
             for (auto& type_arg : class_->type_args) {
                 auto ret = get_type(type_arg, from_scope);
                 // If any of the type arguments are invalid, return nullptr.
                 if (ret == nullptr) {
                     return nullptr;
                 }
+                type_args.push_back(ret);
             }
+            path.push_back(instance_name(class_->name, type_args));
         }
         // Lookup the type in the global tree.
         // Note: only downward lookup is performed here. We may change this later.
@@ -221,6 +334,9 @@ std::shared_ptr<Type> Environment::get_type(const std::shared_ptr<Annotation>& a
             return nullptr;
         } else if (found_struct->is_primitive) {
             return std::make_shared<Type::Named>(found_struct);
+        } else if (found_struct->enum_decl != nullptr && found_struct->enum_decl->layout != Decl::Enum::Layout::TAGGED_UNION) {
+            // Enums whose values are integers are passed around like them
+            return std::make_shared<Type::Named>(found_struct);
         } else {
             return std::make_shared<Type::Struct>(found_struct);
         }
@@ -235,7 +351,7 @@ std::shared_ptr<Type> Environment::get_type(const std::shared_ptr<Annotation>& a
             if (param_type == nullptr) {
                 return nullptr;
             }
-            params.push_back({param.first ? KW_VAR : KW_CONST, param_type});
+            params.push_back({param.first == KW_VAR ? KW_VAR : KW_CONST, param_type});
         }
         // Verify the return type of the function.
         auto ret_type = get_type(fun_annotation->return_annotation, from_scope);
@@ -267,7 +383,26 @@ std::shared_ptr<Type> Environment::get_type(const std::shared_ptr<Annotation>& a
         if (ret == nullptr) {
             return nullptr;
         }
+        if (array_annotation->size == -1) {
+            // Arrays of unknown size are slices
+            return std::make_shared<Type::Slice>(ret);
+        }
         return std::make_shared<Type::Array>(ret, array_annotation->size);
+    } else if (IS_TYPE(annotation, Annotation::Vector)) {
+        // Annotations of the form `vec<t, n>`; the lanes must be numbers or bools
+        auto vector_annotation = std::dynamic_pointer_cast<Annotation::Vector>(annotation);
+        auto ret = get_type(vector_annotation->inner, from_scope);
+        if (ret == nullptr || vector_annotation->size <= 0) {
+            return nullptr;
+        }
+        if (!ret->is_numeric() && ret->to_string() != "::bool") {
+            return nullptr;
+        }
+        return std::make_shared<Type::Vector>(ret, vector_annotation->size);
+    } else if (IS_TYPE(annotation, Annotation::Scoped)) {
+        // Type arguments substituted into generic instances mean what they meant where the generic was used.
+        auto scoped_annotation = std::dynamic_pointer_cast<Annotation::Scoped>(annotation);
+        return get_type(scoped_annotation->inner, scoped_annotation->scope);
     } else if (IS_TYPE(annotation, Annotation::Pointer)) {
         // Annotations of the form `t*`
         auto ptr_annotation = std::dynamic_pointer_cast<Annotation::Pointer>(annotation);
@@ -286,24 +421,57 @@ std::shared_ptr<Type> Environment::get_type(const std::string& name) {
     return get_type(annotation);
 }
 
+std::pair<Decl::Enum*, int> Environment::get_variant(const std::vector<Token>& ident_tokens) {
+    if (ident_tokens.size() < 2) {
+        return {nullptr, -1};
+    }
+    // The path without its last token must lead to an enum
+    std::vector<std::string> path;
+    for (size_t i = 0; i < ident_tokens.size() - 1; i++) {
+        path.push_back(ident_tokens[i].lexeme);
+    }
+    auto found_struct = std::dynamic_pointer_cast<Node::StructScope>(current_scope->downward_lookup(path));
+    if (found_struct == nullptr || found_struct->enum_decl == nullptr) {
+        return {nullptr, -1};
+    }
+    int variant = found_struct->enum_decl->find_variant(ident_tokens.back().lexeme);
+    if (variant < 0) {
+        return {nullptr, -1};
+    }
+    return {found_struct->enum_decl, variant};
+}
+
 bool Environment::verify_deferred_types() {
     // Save the current scope to restore it later.
     auto previous_scope = current_scope;
 
+    bool all_valid = true;
     for (auto& deferred_declaration : deferred_declarations) {
         // Set the current scope to the scope of the deferred declaration.
         current_scope = deferred_declaration.second;
         // This is like jumping to a different part of the tree and declaring the variable there.
         auto [variable, error] = declare_variable(deferred_declaration.first, false);
         if (error != 0) {
-            return false;
+            all_valid = false;
         }
     }
+    deferred_declarations.clear();
 
     // Restore the previous scope (not that we need it anymore since this function is called at the end of the global checker).
     current_scope = previous_scope;
 
-    return true;
+    return all_valid;
+}
+
+Environment::Environment(const Environment& parent, std::shared_ptr<Node::Scope> scope)
+    : global_tree(parent.global_tree),
+      current_scope(scope),
+      struct_scopes(parent.struct_scopes),
+      llvm_context(parent.llvm_context) {}
+
+void Environment::merge(Environment& fork) {
+    global_functions.insert(global_functions.end(), fork.global_functions.begin(), fork.global_functions.end());
+    fork.global_functions.clear();
 }
 
 void Environment::reset() {
@@ -312,6 +480,8 @@ void Environment::reset() {
     struct_scopes.clear();
     local_scopes.clear();
     global_functions.clear();
+    deferred_declarations.clear();
+    local_scope_count = 0;
     current_scope = global_tree;
     install_primitive_types();
 }
@@ -17,8 +17,9 @@
 #include <vector>
 
 /**
- * @brief A singleton class to store environment information for the type checkers.
+ * @brief A class to store environment information for the type checkers.
  * Uses a namespace tree to store scopes.
+ * Each compilation owns its own environment through its CompilationContext.
  *
  */
 class Environment {
@@ -45,24 +46,47 @@ class Environment {
     std::vector<std::pair<Decl::VarDeclarable*, std::shared_ptr<Node::Scope>>>
         deferred_declarations;
 
+    // The LLVM context used for type checking.
+    std::shared_ptr<llvm::LLVMContext> llvm_context;
+
+    // The number of local scopes created. Used for generating unique names.
+    int local_scope_count = 0;
+
+public:
     Environment() {
         reset();
     }
 
-    // The LLVM context used for type checking.
-    std::shared_ptr<llvm::LLVMContext> llvm_context;
+    /**
+     * @brief Creates a fork of another environment, positioned at the given scope.
+     * The fork shares the namespace tree and LLVM context of the parent, but has its own current scope and local scopes.
+     * This lets a worker thread check a function body while other workers check other bodies.
+     * The shared tree must not be modified while forks are in use; local declarations only modify the fork's local scopes.
+     * Functions declared through the fork are collected separately; see merge.
+     *
+     * @param parent The environment to fork.
+     * @param scope The scope to start in. Must belong to the parent's tree.
+     */
+    Environment(const Environment& parent, std::shared_ptr<Node::Scope> scope);
+
+    Environment(const Environment&) = delete;
+    Environment& operator=(const Environment&) = delete;
 
-public:
     /**
-     * @brief Get the singleton instance of the Environment. Will create the instance if it does not exist.
+     * @brief Merges the results of a fork back into this environment.
+     * Functions declared through the fork are appended to the list of global functions.
      *
-     * @return Environment& A reference to the Environment singleton instance.
+     * @param fork The fork to merge. Should have been created from this environment.
      */
-    static Environment&
-    inst() {
-        static Environment instance;
-        return instance;
-    }
+    void merge(Environment& fork);
+
+    /**
+     * @brief Get the Environment of the compilation bound to the calling thread.
+     * See CompilationContext for how contexts are bound.
+     *
+     * @return Environment& A reference to the current Environment.
+     */
+    static Environment& inst();
 
     std::shared_ptr<llvm::LLVMContext> get_llvm_context() {
         return llvm_context;
@@ -98,6 +122,39 @@ public:
      */
     std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> add_struct(Decl::Struct* decl);
 
+    /**
+     * @brief Adds an enum to the current scope, without entering it.
+     * The layout of the enum must already be decided; an enum whose values are integers is a type like the primitives.
+     *
+     * @param decl The enum declaration to add.
+     * @return std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> A pair containing a pointer to the enum node and an error code.
+     * If the enum was added successfully, the pair will contain the enum node and 0.
+     * If a struct or enum is already declared with the name, the pair will contain the existing node and E_STRUCT_ALREADY_DECLARED.
+     * If the enum was added in a local scope, the pair will contain nullptr and E_STRUCT_IN_LOCAL_SCOPE.
+     */
+    std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> add_enum(Decl::Enum* decl);
+
+    /**
+     * @brief Adds a generic struct or function to the current scope, without entering it.
+     * The generic itself is not a type or a variable; its instances are added next to it as they are created.
+     *
+     * @param decl The generic declaration to add.
+     * @param name The name of the generic declaration.
+     * @return std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> A pair containing a pointer to the generic node and an error code.
+     * If the generic was added successfully, the pair will contain the generic node and 0.
+     * If the name is already declared, the pair will contain the existing node and E_SYMBOL_ALREADY_DECLARED.
+     */
+    std::pair<std::shared_ptr<Node::Locatable>, ErrorCode> add_generic(Decl* decl, const Token& name);
+
+    /**
+     * @brief Gets the name an instance of a generic is declared under, e.g. `Box<::i32>` for `Box` and `i32`.
+     *
+     * @param name The name of the generic.
+     * @param type_args The type arguments of the instance.
+     * @return std::string The name of the instance.
+     */
+    static std::string instance_name(const std::string& name, const std::vector<std::shared_ptr<Type>>& type_args);
+
     /**
      * @brief Adds the primitive types to the global scope.
      *
@@ -122,6 +179,25 @@ public:
      */
     bool enter_scope(const std::string& name);
 
+    /**
+     * @brief Enters the given scope, wherever it is in the tree.
+     * Unlike exiting a local scope, leaving a local scope this way does not remove it.
+     *
+     * @param scope The scope to enter.
+     */
+    void enter_scope(std::shared_ptr<Node::Scope> scope) {
+        current_scope = scope;
+    }
+
+    /**
+     * @brief Gets the current scope.
+     *
+     * @return std::shared_ptr<Node::Scope> The current scope.
+     */
+    std::shared_ptr<Node::Scope> get_current_scope() {
+        return current_scope;
+    }
+
     /**
      * @brief Exits the current scope.
      * If the current scope is the root, it will not exit.
@@ -134,7 +210,7 @@ public:
     ErrorCode exit_scope();
 
     /**
-     * @brief Exits all local scopes.
+     * @brief Exits all local scopes, returning to the innermost enclosing global scope.
      * Useful when an error occurs and the local scopes need to be removed.
      *
      */
@@ -191,6 +267,32 @@ public:
      */
     std::shared_ptr<Node::Variable> get_variable(const std::vector<std::string>& ident_strings);
 
+    /**
+     * @brief Retrieves the variable node from the current scope.
+     * Same as the other overloads, but with the identifier already interned.
+     *
+     * @param ident_symbols The list of symbols that make up the identifier.
+     * @return std::shared_ptr<Node::Variable> A pointer to the variable node. nullptr if the variable is not found.
+     */
+    std::shared_ptr<Node::Variable> get_variable(const std::vector<Symbol>& ident_symbols);
+
+    /**
+     * @brief Gets the path of names an identifier refers to.
+     * A token given type arguments refers to an instance of a generic, e.g. `max::<i32>` refers to `max<::i32>`.
+     *
+     * @param identifier The identifier.
+     * @return std::vector<std::string> The path. Empty if a type argument cannot be resolved.
+     */
+    std::vector<std::string> get_path(const Expr::Identifier* identifier);
+
+    /**
+     * @brief Retrieves a generic struct or function from the current scope, the same way as get_variable.
+     *
+     * @param ident_strings The list of strings that make up the name of the generic.
+     * @return std::shared_ptr<Node::Generic> A pointer to the generic node. nullptr if the generic is not found.
+     */
+    std::shared_ptr<Node::Generic> get_generic(const std::vector<std::string>& ident_strings);
+
     /**
      * @brief Get the declaration for a given instance type and member name.
      *
@@ -219,6 +321,15 @@ public:
      */
     std::shared_ptr<Type> get_type(const std::string& name);
 
+    /**
+     * @brief Finds the enum variant an identifier names, e.g. `Shape::Circle`.
+     * Variants are not nodes of the namespace tree, so they are found through the enum their path leads to.
+     *
+     * @param ident_tokens The tokens of the identifier.
+     * @return std::pair<Decl::Enum*, int> The enum and the index of the variant, or nullptr and -1 if the identifier names no variant.
+     */
+    std::pair<Decl::Enum*, int> get_variant(const std::vector<Token>& ident_tokens);
+
     /**
      * @brief Get the global functions object.
      * The list of global functions is used to create function prototypes.
@@ -244,6 +355,7 @@ public:
     /**
      * @brief Iterates through the list of deferred types and verifies them.
      * Should be called by the global checker after all statements have been visited.
+     * Every declaration whose type can now be resolved is declared; the others are left undeclared, and the list is cleared.
      *
      * @return true If the list is empty or all deferred types are valid.
      * @return false If any deferred type is found to be invalid.
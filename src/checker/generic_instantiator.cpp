@@ -0,0 +1,355 @@
+#include "generic_instantiator.h"
+
+#include "../logger/error_code.h"
+#include "../logger/logger.h"
+#include "../parser/parser.h"
+#include "../utility/utils.h"
+#include <unordered_map>
+
+void GenericInstantiator::instantiate_uses(const std::shared_ptr<Annotation>& annotation, const Location& location) {
+    this->location = location;
+    instantiate_annotation(annotation);
+}
+
+void GenericInstantiator::instantiate_uses(const std::vector<std::shared_ptr<Stmt>>& stmts) {
+    auto previous_scope = environment.get_current_scope();
+    for (auto& stmt : stmts) {
+        stmt->accept(this);
+    }
+    // Searching an instance may create more instances.
+    while (!pending.empty()) {
+        auto next = pending.back();
+        pending.pop_back();
+        environment.enter_scope(next.scope);
+        depth = next.depth;
+        next.instance->accept(this);
+    }
+    depth = 0;
+    environment.enter_scope(previous_scope);
+}
+
+void GenericInstantiator::instantiate_annotation(const std::shared_ptr<Annotation>& annotation) {
+    if (auto segmented = std::dynamic_pointer_cast<Annotation::Segmented>(annotation)) {
+        std::vector<std::string> path;
+        for (auto& class_ : segmented->classes) {
+            path.push_back(class_->name);
+            if (class_->type_args.empty()) {
+                continue;
+            }
+            for (auto& type_arg : class_->type_args) {
+                instantiate_annotation(type_arg);
+            }
+            auto generic = environment.get_generic(path);
+            if (generic == nullptr) {
+                // Not a generic; the local checker reports what it is instead.
+                return;
+            }
+            path.back() = instantiate(generic.get(), class_->type_args);
+            if (path.back().empty()) {
+                return;
+            }
+        }
+    } else if (auto function = std::dynamic_pointer_cast<Annotation::Function>(annotation)) {
+        for (auto& param : function->params) {
+            instantiate_annotation(param.second);
+        }
+        instantiate_annotation(function->return_annotation);
+    } else if (auto array = std::dynamic_pointer_cast<Annotation::Array>(annotation)) {
+        instantiate_annotation(array->inner);
+    } else if (auto pointer = std::dynamic_pointer_cast<Annotation::Pointer>(annotation)) {
+        instantiate_annotation(pointer->inner);
+    } else if (auto tuple = std::dynamic_pointer_cast<Annotation::Tuple>(annotation)) {
+        for (auto& element : tuple->elements) {
+            instantiate_annotation(element);
+        }
+    } else if (auto scoped = std::dynamic_pointer_cast<Annotation::Scoped>(annotation)) {
+        auto previous_scope = environment.get_current_scope();
+        environment.enter_scope(scoped->scope);
+        instantiate_annotation(scoped->inner);
+        environment.enter_scope(previous_scope);
+    }
+}
+
+std::string GenericInstantiator::instantiate(Node::Generic* generic, const std::vector<std::shared_ptr<Annotation>>& type_args) {
+    std::vector<std::shared_ptr<Type>> types;
+    for (auto& type_arg : type_args) {
+        auto type = environment.get_type(type_arg);
+        if (type == nullptr) {
+            return "";
+        }
+        types.push_back(type);
+    }
+
+    auto generic_struct = dynamic_cast<Decl::Struct*>(generic->decl);
+    auto generic_fun = dynamic_cast<Decl::Fun*>(generic->decl);
+    const Token& generic_name = generic_struct != nullptr ? generic_struct->name : generic_fun->name;
+    const auto& type_params = generic_struct != nullptr ? generic_struct->type_params : generic_fun->type_params;
+    const auto& tokens = generic_struct != nullptr ? generic_struct->tokens : generic_fun->tokens;
+
+    auto name = Environment::instance_name(generic_name.lexeme, types);
+    auto cached = generic->instances.find(name);
+    if (cached != generic->instances.end()) {
+        return cached->second != nullptr ? name : "";
+    }
+    // Failures are cached too, so that they are reported once.
+    generic->instances[name] = nullptr;
+
+    if (types.size() != type_params.size()) {
+        logger.log_error(location, E_WRONG_TYPE_ARG_COUNT, "`" + generic_name.lexeme + "` takes " + std::to_string(type_params.size()) + " type arguments, but " + std::to_string(types.size()) + " were given.");
+        logger.log_note(generic->location, "`" + generic_name.lexeme + "` was declared here.");
+        return "";
+    }
+    if (depth >= MAX_DEPTH) {
+        logger.log_error(location, E_INSTANTIATION_TOO_DEEP, "Instantiating `" + name + "` requires instances nested more than " + std::to_string(MAX_DEPTH) + " deep.");
+        logger.log_note(generic->location, "`" + generic_name.lexeme + "` was declared here.");
+        return "";
+    }
+
+    // The type arguments keep the meaning they have here, whatever the instance's own scope can see.
+    std::unordered_map<std::string, std::shared_ptr<Annotation>> substitutions;
+    for (size_t i = 0; i < type_params.size(); i++) {
+        substitutions[type_params[i].lexeme] = std::make_shared<Annotation::Scoped>(type_args[i], environment.get_current_scope());
+    }
+    auto instance = Parser().parse_instance(tokens, substitutions, name);
+    if (instance == nullptr) {
+        return "";
+    }
+    if (generic_struct != nullptr) {
+        generic_struct->instances.push_back(std::static_pointer_cast<Decl::Struct>(instance));
+    } else {
+        generic_fun->instances.push_back(std::static_pointer_cast<Decl::Fun>(instance));
+    }
+    // Cached before it is declared, so that an instance can refer to itself, e.g. `Node<T>` to `Node<T>*`.
+    generic->instances[name] = instance;
+
+    // The instance is declared next to the generic.
+    auto previous_scope = environment.get_current_scope();
+    auto previous_location = location;
+    auto scope = generic->parent.lock();
+    environment.enter_scope(scope);
+    depth++;
+    declare(instance.get());
+    depth--;
+    environment.enter_scope(previous_scope);
+    location = previous_location;
+
+    pending.push_back({instance, scope, depth + 1});
+    return name;
+}
+
+void GenericInstantiator::visit_declaration_stmt(Stmt::Declaration* stmt) {
+    stmt->declaration->accept(this);
+}
+
+void GenericInstantiator::visit_expression_stmt(Stmt::Expression* stmt) {
+    stmt->expression->accept(this);
+}
+
+void GenericInstantiator::visit_conditional_stmt(Stmt::Conditional* stmt) {
+    stmt->condition->accept(this);
+    for (auto& then_stmt : stmt->then_branch) {
+        then_stmt->accept(this);
+    }
+    for (auto& else_stmt : stmt->else_branch) {
+        else_stmt->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_loop_stmt(Stmt::Loop* stmt) {
+    stmt->condition->accept(this);
+    for (auto& body_stmt : stmt->body) {
+        body_stmt->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_for_stmt(Stmt::For* stmt) {
+    stmt->variable->accept(this);
+    stmt->start->accept(this);
+    if (stmt->end != nullptr) {
+        stmt->end->accept(this);
+    }
+    for (auto& body_stmt : stmt->body) {
+        body_stmt->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_match_stmt(Stmt::Match* stmt) {
+    stmt->value->accept(this);
+    for (auto& arm : stmt->arms) {
+        for (auto& body_stmt : arm.body) {
+            body_stmt->accept(this);
+        }
+    }
+}
+
+void GenericInstantiator::visit_return_stmt(Stmt::Return* stmt) {
+    if (stmt->value != nullptr) {
+        stmt->value->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_var_decl(Decl::Var* decl) {
+    location = decl->location;
+    instantiate_annotation(decl->type_annotation);
+    if (decl->initializer != nullptr) {
+        decl->initializer->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_fun_decl(Decl::Fun* decl) {
+    // A generic function is searched through its instances.
+    if (!decl->type_params.empty()) {
+        return;
+    }
+    location = decl->location;
+    instantiate_annotation(decl->type_annotation);
+    for (auto& stmt : decl->body) {
+        stmt->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_extern_fun_decl(Decl::ExternFun* decl) {
+    location = decl->location;
+    instantiate_annotation(decl->type_annotation);
+}
+
+void GenericInstantiator::visit_struct_decl(Decl::Struct* decl) {
+    // A generic struct is searched through its instances.
+    // A struct that failed to be declared cannot be entered, and its errors have been reported.
+    if (!decl->type_params.empty() || !environment.enter_scope(decl->name.lexeme)) {
+        return;
+    }
+    for (auto& declaration : decl->declarations) {
+        declaration->accept(this);
+    }
+    environment.exit_scope();
+}
+
+void GenericInstantiator::visit_enum_decl(Decl::Enum* decl) {
+    for (auto& variant : decl->variants) {
+        location = variant.name.location;
+        for (auto& annotation : variant.payload_annotations) {
+            instantiate_annotation(annotation);
+        }
+    }
+}
+
+void GenericInstantiator::visit_assign_expr(Expr::Assign* expr) {
+    expr->left->accept(this);
+    expr->right->accept(this);
+}
+
+void GenericInstantiator::visit_logical_expr(Expr::Logical* expr) {
+    expr->left->accept(this);
+    expr->right->accept(this);
+}
+
+void GenericInstantiator::visit_binary_expr(Expr::Binary* expr) {
+    expr->left->accept(this);
+    expr->right->accept(this);
+}
+
+void GenericInstantiator::visit_unary_expr(Expr::Unary* expr) {
+    expr->inner->accept(this);
+}
+
+void GenericInstantiator::visit_dereference_expr(Expr::Dereference* expr) {
+    expr->inner->accept(this);
+}
+
+void GenericInstantiator::visit_access_expr(Expr::Access* expr) {
+    expr->left->accept(this);
+}
+
+void GenericInstantiator::visit_index_expr(Expr::Index* expr) {
+    expr->left->accept(this);
+    expr->right->accept(this);
+}
+
+void GenericInstantiator::visit_slice_expr(Expr::Slice* expr) {
+    expr->left->accept(this);
+    if (expr->start != nullptr) {
+        expr->start->accept(this);
+    }
+    if (expr->end != nullptr) {
+        expr->end->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_call_expr(Expr::Call* expr) {
+    expr->callee->accept(this);
+    for (auto& argument : expr->arguments) {
+        argument->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_cast_expr(Expr::Cast* expr) {
+    expr->expression->accept(this);
+    location = expr->location;
+    instantiate_annotation(expr->annotation);
+}
+
+void GenericInstantiator::visit_grouping_expr(Expr::Grouping* expr) {
+    expr->expression->accept(this);
+}
+
+void GenericInstantiator::visit_identifier_expr(Expr::Identifier* expr) {
+    if (expr->type_args.empty()) {
+        return;
+    }
+    location = expr->location;
+    std::vector<std::string> path;
+    for (size_t i = 0; i < expr->tokens.size(); i++) {
+        path.push_back(expr->tokens[i].lexeme);
+        if (expr->type_args[i].empty()) {
+            continue;
+        }
+        for (auto& type_arg : expr->type_args[i]) {
+            instantiate_annotation(type_arg);
+        }
+        auto generic = environment.get_generic(path);
+        if (generic == nullptr) {
+            return;
+        }
+        path.back() = instantiate(generic.get(), expr->type_args[i]);
+        if (path.back().empty()) {
+            return;
+        }
+    }
+}
+
+void GenericInstantiator::visit_array_expr(Expr::Array* expr) {
+    for (auto& element : expr->elements) {
+        element->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_array_gen_expr(Expr::ArrayGen* expr) {
+    expr->generator->accept(this);
+}
+
+void GenericInstantiator::visit_tuple_expr(Expr::Tuple* expr) {
+    for (auto& element : expr->elements) {
+        element->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_object_expr(Expr::Object* expr) {
+    location = expr->location;
+    instantiate_annotation(expr->struct_annotation);
+    for (auto& [name, field] : expr->fields) {
+        field->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_alloc_expr(Expr::Alloc* expr) {
+    location = expr->location;
+    instantiate_annotation(expr->annotation);
+    if (expr->count != nullptr) {
+        expr->count->accept(this);
+    }
+}
+
+void GenericInstantiator::visit_dealloc_expr(Expr::Dealloc* expr) {
+    expr->expression->accept(this);
+}
@@ -0,0 +1,136 @@
+#ifndef GENERIC_INSTANTIATOR_H
+#define GENERIC_INSTANTIATOR_H
+
+#include "../compiler/compilation_context.h"
+#include "../utility/decl.h"
+#include "../utility/expr.h"
+#include "../utility/stmt.h"
+#include "environment.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Instantiates generic structs and functions for the type arguments they are used with.
+ * An instance is parsed again from the tokens of the generic declaration, with its type arguments substituted for the type parameters,
+ * and declared next to the generic under its instance name, e.g. `Box<::i32>` next to `Box`.
+ * Instances are cached on the generic node, so each one is declared, checked and generated once, however often it is used.
+ * Every instance is created during global checking, since the namespace tree must not change while function bodies are checked in parallel.
+ *
+ */
+class GenericInstantiator : public Stmt::Visitor<void>, public Decl::Visitor<void>, public Expr::Visitor<void> {
+    // The environment of the compilation.
+    Environment& environment;
+    // The logger of the compilation.
+    ErrorLogger& logger;
+    // Declares a new instance in the current scope, like any other global declaration.
+    std::function<void(Decl*)> declare;
+
+    /**
+     * @brief An instance whose declarations have not been searched for uses of generics yet.
+     *
+     */
+    struct PendingInstance {
+        // The instance.
+        std::shared_ptr<Decl> instance;
+        // The scope the instance is declared in.
+        std::shared_ptr<Node::Scope> scope;
+        // How many instances the instance was created in, itself included.
+        unsigned depth;
+    };
+    // The instances to search, in no particular order.
+    std::vector<PendingInstance> pending;
+
+    // How many instances the declarations being searched were created in.
+    unsigned depth = 0;
+    // The location of the declaration or expression being searched, for error messages.
+    Location location;
+
+    // How deeply instances may be created inside each other, e.g. `A<T>` using `A<[T; 1]>` would never stop.
+    static constexpr unsigned MAX_DEPTH = 64;
+
+    /**
+     * @brief Instantiates the generics used in an annotation, type arguments first.
+     *
+     * @param annotation The annotation.
+     */
+    void instantiate_annotation(const std::shared_ptr<Annotation>& annotation);
+
+    /**
+     * @brief Gets the instance of a generic for a list of type arguments, creating and declaring it if needed.
+     * Type arguments that cannot be resolved are left for the local checker to report where they are used.
+     *
+     * @param generic The generic node.
+     * @param type_args The annotations of the type arguments, as written where the generic is used.
+     * @return std::string The name of the instance. Empty if it could not be created.
+     */
+    std::string instantiate(Node::Generic* generic, const std::vector<std::shared_ptr<Annotation>>& type_args);
+
+    void visit_declaration_stmt(Stmt::Declaration* stmt) override;
+    void visit_expression_stmt(Stmt::Expression* stmt) override;
+    void visit_block_stmt(Stmt::Block* /*stmt*/) override {}
+    void visit_conditional_stmt(Stmt::Conditional* stmt) override;
+    void visit_loop_stmt(Stmt::Loop* stmt) override;
+    void visit_for_stmt(Stmt::For* stmt) override;
+    void visit_match_stmt(Stmt::Match* stmt) override;
+    void visit_return_stmt(Stmt::Return* stmt) override;
+    void visit_break_stmt(Stmt::Break* /*stmt*/) override {}
+    void visit_continue_stmt(Stmt::Continue* /*stmt*/) override {}
+    void visit_eof_stmt(Stmt::EndOfFile* /*stmt*/) override {}
+
+    void visit_var_decl(Decl::Var* decl) override;
+    void visit_fun_decl(Decl::Fun* decl) override;
+    void visit_extern_fun_decl(Decl::ExternFun* decl) override;
+    void visit_struct_decl(Decl::Struct* decl) override;
+    void visit_enum_decl(Decl::Enum* decl) override;
+
+    void visit_assign_expr(Expr::Assign* expr) override;
+    void visit_logical_expr(Expr::Logical* expr) override;
+    void visit_binary_expr(Expr::Binary* expr) override;
+    void visit_unary_expr(Expr::Unary* expr) override;
+    void visit_dereference_expr(Expr::Dereference* expr) override;
+    void visit_access_expr(Expr::Access* expr) override;
+    void visit_index_expr(Expr::Index* expr) override;
+    void visit_slice_expr(Expr::Slice* expr) override;
+    void visit_call_expr(Expr::Call* expr) override;
+    void visit_cast_expr(Expr::Cast* expr) override;
+    void visit_grouping_expr(Expr::Grouping* expr) override;
+    void visit_identifier_expr(Expr::Identifier* expr) override;
+    void visit_literal_expr(Expr::Literal* /*expr*/) override {}
+    void visit_array_expr(Expr::Array* expr) override;
+    void visit_array_gen_expr(Expr::ArrayGen* expr) override;
+    void visit_tuple_expr(Expr::Tuple* expr) override;
+    void visit_object_expr(Expr::Object* expr) override;
+    void visit_alloc_expr(Expr::Alloc* expr) override;
+    void visit_dealloc_expr(Expr::Dealloc* expr) override;
+
+public:
+    /**
+     * @brief Creates an instantiator for the given compilation.
+     *
+     * @param compilation The compilation being checked.
+     * @param declare Declares a new instance in the current scope; the global checker visits it like any other declaration.
+     */
+    GenericInstantiator(CompilationContext& compilation, std::function<void(Decl*)> declare)
+        : environment(compilation.get_environment()), logger(compilation.get_logger()), declare(declare) {}
+
+    /**
+     * @brief Instantiates the generics used in the annotation of a global declaration, so that the declaration can be resolved.
+     * The instances are searched for further uses later, by instantiate_uses.
+     *
+     * @param annotation The annotation.
+     * @param location The location of the declaration.
+     */
+    void instantiate_uses(const std::shared_ptr<Annotation>& annotation, const Location& location);
+
+    /**
+     * @brief Instantiates every generic used in the program, including the uses inside instances.
+     * Generic declarations themselves are not searched; their instances are.
+     *
+     * @param stmts The statements of the program.
+     */
+    void instantiate_uses(const std::vector<std::shared_ptr<Stmt>>& stmts);
+};
+
+#endif // GENERIC_INSTANTIATOR_H
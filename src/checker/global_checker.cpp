@@ -5,81 +5,116 @@
 #include "../utility/utils.h"
 #include <iostream>
 
-std::any GlobalChecker::visit_declaration_stmt(Stmt::Declaration* stmt) {
+void GlobalChecker::visit_declaration_stmt(Stmt::Declaration* stmt) {
     // Visit the declaration
     return stmt->declaration->accept(this);
 }
 
-std::any GlobalChecker::visit_expression_stmt(Stmt::Expression* stmt) {
+void GlobalChecker::visit_expression_stmt(Stmt::Expression* stmt) {
     // Global expression statements are not allowed
-    ErrorLogger::inst().log_error(stmt->location, E_GLOBAL_EXPRESSION, "Global expression statements are not allowed.");
+    logger.log_error(stmt->location, E_GLOBAL_EXPRESSION, "Global expression statements are not allowed.");
     throw GlobalTypeException();
 }
 
-std::any GlobalChecker::visit_conditional_stmt(Stmt::Conditional* /* stmt */) {
+void GlobalChecker::visit_conditional_stmt(Stmt::Conditional* /* stmt */) {
     // Global conditional statements are not allowed
-    // ErrorLogger::inst().log_error(stmt->location, E_GLOBAL_EXPRESSION, "Global conditional statements are not allowed.");
+    // logger.log_error(stmt->location, E_GLOBAL_EXPRESSION, "Global conditional statements are not allowed.");
     throw GlobalTypeException();
 }
 
-std::any GlobalChecker::visit_loop_stmt(Stmt::Loop* /* stmt */) {
+void GlobalChecker::visit_loop_stmt(Stmt::Loop* /* stmt */) {
     // Global loop statements are not allowed
-    // ErrorLogger::inst().log_error(stmt->location, E_GLOBAL_EXPRESSION, "Global loop statements are not allowed.");
+    // logger.log_error(stmt->location, E_GLOBAL_EXPRESSION, "Global loop statements are not allowed.");
     throw GlobalTypeException();
 }
 
-std::any GlobalChecker::visit_return_stmt(Stmt::Return* stmt) {
+void GlobalChecker::visit_for_stmt(Stmt::For* /* stmt */) {
+    // Global for statements are not allowed
+    throw GlobalTypeException();
+}
+
+void GlobalChecker::visit_match_stmt(Stmt::Match* /* stmt */) {
+    // Global match statements are not allowed
+    throw GlobalTypeException();
+}
+
+void GlobalChecker::visit_return_stmt(Stmt::Return* stmt) {
     // Global return statements are not allowed
-    ErrorLogger::inst().log_error(stmt->location, E_GLOBAL_RETURN, "Global return statements are not allowed.");
+    logger.log_error(stmt->location, E_GLOBAL_RETURN, "Global return statements are not allowed.");
     throw GlobalTypeException();
 }
 
-std::any GlobalChecker::visit_break_stmt(Stmt::Break* /* stmt */) {
+void GlobalChecker::visit_break_stmt(Stmt::Break* /* stmt */) {
     // Global break statements are not allowed
-    // ErrorLogger::inst().log_error(stmt->location, E_GLOBAL_BREAK, "Global break statements are not allowed.");
+    // logger.log_error(stmt->location, E_GLOBAL_BREAK, "Global break statements are not allowed.");
     throw GlobalTypeException();
 }
 
-std::any GlobalChecker::visit_continue_stmt(Stmt::Continue* /* stmt */) {
+void GlobalChecker::visit_continue_stmt(Stmt::Continue* /* stmt */) {
     // Global continue statements are not allowed
-    // ErrorLogger::inst().log_error(stmt->location, E_GLOBAL_CONTINUE, "Global continue statements are not allowed.");
+    // logger.log_error(stmt->location, E_GLOBAL_CONTINUE, "Global continue statements are not allowed.");
     throw GlobalTypeException();
 }
 
-std::any GlobalChecker::visit_eof_stmt(Stmt::EndOfFile* /* stmt */) {
+void GlobalChecker::visit_eof_stmt(Stmt::EndOfFile* /* stmt */) {
     // TODO: This doesn't really do anything right now. This becomes more useful when `using` is implemented.
-    return std::any();
+    return;
+}
+
+void GlobalChecker::declare_instance(Decl* decl) {
+    try {
+        decl->accept(this);
+    } catch (const GlobalTypeException&) {
+        // The error has been logged; the instance is left as far as it was declared
+    }
+}
+
+void GlobalChecker::add_generic(Decl* decl, const Token& name) {
+    auto [node, result] = environment.add_generic(decl, name);
+    if (result == E_SYMBOL_ALREADY_DECLARED) {
+        logger.log_error(name.location, result, "A symbol with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
+        throw GlobalTypeException();
+    }
 }
 
-std::any GlobalChecker::visit_var_decl(Decl::Var* decl) {
+void GlobalChecker::visit_var_decl(Decl::Var* decl) {
+    // The type may name instances of generics that do not exist yet
+    instantiator.instantiate_uses(decl->type_annotation, decl->location);
 
     // Declare the variable, defer if necessary
-    auto [node, result] = Environment::inst().declare_variable(decl, true);
+    auto [node, result] = environment.declare_variable(decl, true);
 
     if (result == E_SYMBOL_ALREADY_DECLARED) {
-        ErrorLogger::inst().log_error(decl->name.location, result, "A symbol with the same name has already been declared in this scope.");
-        ErrorLogger::inst().log_note(node->location, "Previous declaration was here.");
+        logger.log_error(decl->name.location, result, "A symbol with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
         throw GlobalTypeException();
     } else if (result != 0) {
-        ErrorLogger::inst().log_error(decl->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(result) + " in global type checking.");
+        logger.log_error(decl->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(result) + " in global type checking.");
         throw GlobalTypeException();
     }
     // E_UNKNOWN_TYPE is not handled here since variables with unknown types are deferred here.
 
-    return std::any();
+    return;
 }
 
-std::any GlobalChecker::visit_fun_decl(Decl::Fun* decl) {
+void GlobalChecker::visit_fun_decl(Decl::Fun* decl) {
+    // A generic function is instantiated where it is used
+    if (!decl->type_params.empty()) {
+        add_generic(decl, decl->name);
+        return;
+    }
+    instantiator.instantiate_uses(decl->type_annotation, decl->location);
 
     // Declare the function, defer if necessary
-    auto [node, result] = Environment::inst().declare_variable(decl, true);
+    auto [node, result] = environment.declare_variable(decl, true);
 
     if (result == E_SYMBOL_ALREADY_DECLARED) {
-        ErrorLogger::inst().log_error(decl->name.location, result, "A symbol with the same name has already been declared in this scope.");
-        ErrorLogger::inst().log_note(node->location, "Previous declaration was here.");
+        logger.log_error(decl->name.location, result, "A symbol with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
         throw GlobalTypeException();
     } else if (result != 0) {
-        ErrorLogger::inst().log_error(decl->name.location, result, "An error occurred while declaring the function.");
+        logger.log_error(decl->name.location, result, "An error occurred while declaring the function.");
         throw GlobalTypeException();
     }
 
@@ -88,7 +123,7 @@ std::any GlobalChecker::visit_fun_decl(Decl::Fun* decl) {
     if (decl->name.lexeme == "main") {
         // The function declarer must be "fun"
         if (decl->declarer != KW_FUN) {
-            ErrorLogger::inst().log_error(decl->name.location, E_INVALID_MAIN_SIGNATURE, "The main function must be declared with the 'fun' keyword.");
+            logger.log_error(decl->name.location, E_INVALID_MAIN_SIGNATURE, "The main function must be declared with the 'fun' keyword.");
         }
 
         // The function type must be either fun() => i32 or fun(int, char**) => i32
@@ -96,42 +131,49 @@ std::any GlobalChecker::visit_fun_decl(Decl::Fun* decl) {
         auto type_string = variable != nullptr ? variable->decl->type->to_string() : "";
 
         if (type_string != "fun() => ::i32" && type_string != "fun(::int, ::char**) => ::i32") {
-            ErrorLogger::inst().log_error(decl->name.location, E_INVALID_MAIN_SIGNATURE, "The main function must have the signature 'fun() => i32' or 'fun(int, char**) => i32'. Found type: " + type_string);
+            logger.log_error(decl->name.location, E_INVALID_MAIN_SIGNATURE, "The main function must have the signature 'fun() => i32' or 'fun(int, char**) => i32'. Found type: " + type_string);
         }
     }
 
-    return std::any();
+    return;
 }
 
-std::any GlobalChecker::visit_extern_fun_decl(Decl::ExternFun* decl) {
+void GlobalChecker::visit_extern_fun_decl(Decl::ExternFun* decl) {
+    instantiator.instantiate_uses(decl->type_annotation, decl->location);
+
     // Declare the function, defer if necessary
-    auto [node, result] = Environment::inst().declare_variable(decl, true);
+    auto [node, result] = environment.declare_variable(decl, true);
 
     if (result == E_SYMBOL_ALREADY_DECLARED) {
-        ErrorLogger::inst().log_error(decl->name.location, result, "A symbol with the same name has already been declared in this scope.");
-        ErrorLogger::inst().log_note(node->location, "Previous declaration was here.");
+        logger.log_error(decl->name.location, result, "A symbol with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
         throw GlobalTypeException();
     } else if (result != 0) {
-        ErrorLogger::inst().log_error(decl->name.location, result, "An error occurred while declaring the function.");
+        logger.log_error(decl->name.location, result, "An error occurred while declaring the function.");
         throw GlobalTypeException();
     }
 
     // The function is not allowed to be named `main`
     if (decl->name.lexeme == "main") {
-        ErrorLogger::inst().log_error(decl->name.location, E_INVALID_MAIN_SIGNATURE, "The main function cannot be declared as an external function.");
+        logger.log_error(decl->name.location, E_INVALID_MAIN_SIGNATURE, "The main function cannot be declared as an external function.");
     }
 
-    return std::any();
+    return;
 }
 
-std::any GlobalChecker::visit_struct_decl(Decl::Struct* decl) {
-    auto [node, ec] = Environment::inst().add_struct(decl);
+void GlobalChecker::visit_struct_decl(Decl::Struct* decl) {
+    // A generic struct is instantiated where it is used
+    if (!decl->type_params.empty()) {
+        add_generic(decl, decl->name);
+        return;
+    }
+    auto [node, ec] = environment.add_struct(decl);
     if (ec == E_STRUCT_ALREADY_DECLARED) {
-        ErrorLogger::inst().log_error(decl->name.location, ec, "A struct with the same name has already been declared in this scope.");
-        ErrorLogger::inst().log_note(node->location, "Previous declaration was here.");
+        logger.log_error(decl->name.location, ec, "A struct with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
         throw GlobalTypeException();
     } else if (ec != 0) {
-        ErrorLogger::inst().log_error(decl->name.location, E_IMPOSSIBLE, "Function `add_struct` issued error " + std::to_string(ec) + " in global type checking.");
+        logger.log_error(decl->name.location, E_IMPOSSIBLE, "Function `add_struct` issued error " + std::to_string(ec) + " in global type checking.");
         throw GlobalTypeException();
     }
     auto struct_node = std::dynamic_pointer_cast<Node::StructScope>(node);
@@ -152,28 +194,122 @@ std::any GlobalChecker::visit_struct_decl(Decl::Struct* decl) {
 
     for (auto& declaration : decl->declarations) {
         if (IS_TYPE(declaration, Decl::ExternFun)) {
-            ErrorLogger::inst().log_error(declaration->location, E_EXTERN_FUN_IN_STRUCT, "Extern functions are not allowed in structs.");
+            logger.log_error(declaration->location, E_EXTERN_FUN_IN_STRUCT, "Extern functions are not allowed in structs.");
             throw GlobalTypeException();
         }
         declaration->accept(this);
     }
 
-    Environment::inst().exit_scope();
-    return std::any();
+    environment.exit_scope();
+    return;
+}
+
+void GlobalChecker::choose_enum_layout(Decl::Enum* decl) {
+    Decl::Enum::Variant* payload_variant = nullptr;
+    for (auto& variant : decl->variants) {
+        if (variant.payload_annotations.empty()) {
+            continue;
+        }
+        if (payload_variant != nullptr) {
+            // Two variants with payloads need a tag to tell them apart
+            decl->layout = Decl::Enum::Layout::TAGGED_UNION;
+            return;
+        }
+        payload_variant = &variant;
+    }
+    if (payload_variant == nullptr) {
+        decl->layout = Decl::Enum::Layout::TAG;
+        return;
+    }
+
+    // A single field that is a bool or a tag-only enum never takes most of the values of its integer,
+    // so the other variants can be those values, like `Option<bool>` in one byte
+    decl->layout = Decl::Enum::Layout::TAGGED_UNION;
+    if (payload_variant->payload_annotations.size() != 1) {
+        return;
+    }
+    auto type = environment.get_type(payload_variant->payload_annotations[0]);
+    auto named = std::dynamic_pointer_cast<Type::Named>(type);
+    if (named == nullptr || IS_TYPE(type, Type::Aggregate)) {
+        return;
+    }
+    if (type->to_string() == "::bool") {
+        decl->niche_start = 2;
+    } else if (named->struct_scope->enum_decl != nullptr) {
+        decl->niche_start = named->struct_scope->enum_decl->value_count();
+    } else {
+        return;
+    }
+    decl->layout = Decl::Enum::Layout::NICHE;
+    payload_variant->payload = {type};
+}
+
+void GlobalChecker::visit_enum_decl(Decl::Enum* decl) {
+    for (size_t i = 0; i < decl->variants.size(); i++) {
+        auto& name = decl->variants[i].name;
+        int first = decl->find_variant(name.lexeme);
+        if (first != static_cast<int>(i)) {
+            logger.log_error(name.location, E_DUPLICATE_VARIANT, "A variant named `" + name.lexeme + "` has already been declared in this enum.");
+            logger.log_note(decl->variants[first].name.location, "Previous declaration was here.");
+            throw GlobalTypeException();
+        }
+    }
+
+    choose_enum_layout(decl);
+    auto [node, ec] = environment.add_enum(decl);
+    if (ec == E_STRUCT_ALREADY_DECLARED) {
+        logger.log_error(decl->name.location, ec, "A struct or enum with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
+        throw GlobalTypeException();
+    } else if (ec != 0) {
+        logger.log_error(decl->name.location, E_IMPOSSIBLE, "Function `add_enum` issued error " + std::to_string(ec) + " in global type checking.");
+        throw GlobalTypeException();
+    }
+    enums.push_back({decl, environment.get_current_scope()});
+}
+
+void GlobalChecker::resolve_enum_payloads() {
+    for (auto& [decl, scope] : enums) {
+        for (auto& variant : decl->variants) {
+            if (!variant.payload.empty()) {
+                // Resolved when the layout was chosen
+                continue;
+            }
+            for (auto& annotation : variant.payload_annotations) {
+                auto type = environment.get_type(annotation, scope);
+                if (type == nullptr || IS_TYPE(type, Type::Blank)) {
+                    logger.log_error(variant.name.location, E_UNKNOWN_TYPE, "The payload type `" + annotation->to_string() + "` could not be resolved.");
+                    break;
+                }
+                variant.payload.push_back(type);
+            }
+        }
+    }
+    enums.clear();
 }
 
 void GlobalChecker::type_check(std::vector<std::shared_ptr<Stmt>> stmts) {
+    // Code outside the checker finds the compilation through the thread's binding.
+    CompilationContext::Binding binding(compilation);
     for (auto& stmt : stmts) {
         try {
             stmt->accept(this);
         } catch (const GlobalTypeException&) {
             // Do nothing
         } catch (const std::bad_any_cast& e) {
-            ErrorLogger::inst().log_error(stmt->location, E_ANY_CAST, "Any cast failed in global type checking.");
+            logger.log_error(stmt->location, E_ANY_CAST, "Any cast failed in global type checking.");
             std::cerr << e.what() << std::endl;
         } catch (const std::exception& e) {
-            ErrorLogger::inst().log_error(stmt->location, E_UNKNOWN, "An error occurred while type checking the statement.");
+            logger.log_error(stmt->location, E_UNKNOWN, "An error occurred while type checking the statement.");
             std::cerr << e.what() << std::endl;
         }
     }
+
+    // Every instance must exist before function bodies are checked, since they are checked in parallel
+    instantiator.instantiate_uses(stmts);
+    // Declarations deferred for types declared after them, including instances, can be declared now
+    // Those whose types still do not resolve are reported where they are used
+    environment.verify_deferred_types();
+    // Payloads may name any type, including instances and the enum itself
+    resolve_enum_payloads();
 }
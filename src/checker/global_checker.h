@@ -1,10 +1,11 @@
 #ifndef GLOBAL_CHECKER_H
 #define GLOBAL_CHECKER_H
 
+#include "../compiler/compilation_context.h"
 #include "../utility/decl.h"
 #include "../utility/stmt.h"
 #include "environment.h"
-#include <any>
+#include "generic_instantiator.h"
 #include <exception>
 #include <memory>
 #include <vector>
@@ -22,17 +23,56 @@ class GlobalTypeException : public std::exception {};
  * Note: global space includes anything declared outside of a function body, so anything declared within a namespace may also be checked.
  *
  */
-class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
-    std::shared_ptr<Environment> environment;
+class GlobalChecker : public Stmt::Visitor<void>, public Decl::Visitor<void> {
+    // The compilation being checked.
+    CompilationContext& compilation;
+    // The environment of the compilation.
+    Environment& environment;
+    // The logger of the compilation.
+    ErrorLogger& logger;
+    // Instantiates the generics used by the declarations.
+    GenericInstantiator instantiator;
+    // The enums declared so far, with the scopes they were declared in; their payloads are resolved after every type is declared.
+    std::vector<std::pair<Decl::Enum*, std::shared_ptr<Node::Scope>>> enums;
+
+    /**
+     * @brief Declares an instance of a generic struct or function in the current scope.
+     *
+     * @param decl The instance to declare.
+     */
+    void declare_instance(Decl* decl);
+
+    /**
+     * @brief Adds a generic struct or function to the current scope, to be instantiated where it is used.
+     *
+     * @param decl The generic declaration.
+     * @param name The name of the generic declaration.
+     * @throw GlobalTypeException If the name is already declared; will be caught by the type_check function.
+     */
+    void add_generic(Decl* decl, const Token& name);
+
+    /**
+     * @brief Decides how the values of an enum are represented, before it is added to the scope.
+     * A payload can only leave room for the other variants if its type is already declared.
+     *
+     * @param decl The enum declaration.
+     */
+    void choose_enum_layout(Decl::Enum* decl);
+
+    /**
+     * @brief Resolves the payload types of every enum declared so far.
+     * Reports the payload types that are not declared anywhere.
+     *
+     */
+    void resolve_enum_payloads();
 
     /**
      * @brief Checks a declaration statement in global space.
      *
      * @param stmt The statement to check
-     * @return std::any The empty any object always.
      * @throw GlobalTypeException If an error occurs; will be caught by the type_check function.
      */
-    std::any visit_declaration_stmt(Stmt::Declaration* stmt) override;
+    void visit_declaration_stmt(Stmt::Declaration* stmt) override;
 
     /**
      * @brief Throws an exception for global expression statements.
@@ -42,16 +82,15 @@ class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
      * @return This function never returns.
      * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
      */
-    std::any visit_expression_stmt(Stmt::Expression* stmt) override;
+    void visit_expression_stmt(Stmt::Expression* stmt) override;
 
     /**
      * @brief Returns the empty any object always.
      * This type checker does not concern itself with block statements.
      *
      * @param stmt The statement to check
-     * @return std::any The empty any object always.
      */
-    std::any visit_block_stmt(Stmt::Block* /*stmt*/) override { return std::any(); }
+    void visit_block_stmt(Stmt::Block* /*stmt*/) override {}
 
     /**
      * @brief Throws an exception for global conditional statements.
@@ -61,7 +100,7 @@ class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
      * @return This function never returns.
      * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
      */
-    std::any visit_conditional_stmt(Stmt::Conditional* stmt) override;
+    void visit_conditional_stmt(Stmt::Conditional* stmt) override;
 
     /**
      * @brief Throws an exception for global loop statements.
@@ -71,7 +110,27 @@ class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
      * @return This function never returns.
      * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
      */
-    std::any visit_loop_stmt(Stmt::Loop* stmt) override;
+    void visit_loop_stmt(Stmt::Loop* stmt) override;
+
+    /**
+     * @brief Throws an exception for global for statements.
+     * No global for statements are allowed.
+     *
+     * @param stmt The statement to check
+     * @return This function never returns.
+     * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
+     */
+    void visit_for_stmt(Stmt::For* stmt) override;
+
+    /**
+     * @brief Throws an exception for global match statements.
+     * No global match statements are allowed.
+     *
+     * @param stmt The statement to check
+     * @return This function never returns.
+     * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
+     */
+    void visit_match_stmt(Stmt::Match* stmt) override;
 
     /**
      * @brief Throws an exception for global return statements.
@@ -81,7 +140,7 @@ class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
      * @return This function never returns.
      * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
      */
-    std::any visit_return_stmt(Stmt::Return* stmt) override;
+    void visit_return_stmt(Stmt::Return* stmt) override;
 
     /**
      * @brief Throws an exception for global break statements.
@@ -91,7 +150,7 @@ class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
      * @return This function never returns.
      * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
      */
-    std::any visit_break_stmt(Stmt::Break* stmt) override;
+    void visit_break_stmt(Stmt::Break* stmt) override;
 
     /**
      * @brief Throws an exception for global continue statements.
@@ -101,55 +160,75 @@ class GlobalChecker : public Stmt::Visitor, public Decl::Visitor {
      * @return This function never returns.
      * @throw GlobalTypeException Always thrown. Will be caught by the type_check function.
      */
-    std::any visit_continue_stmt(Stmt::Continue* stmt) override;
+    void visit_continue_stmt(Stmt::Continue* stmt) override;
 
     /**
      * @brief Checks the end of file statement. May alter the environment accordingly.
      *
      * @param stmt The statement to check (ignored)
-     * @return std::any The empty any object always.
      */
-    std::any visit_eof_stmt(Stmt::EndOfFile* stmt) override;
+    void visit_eof_stmt(Stmt::EndOfFile* stmt) override;
 
     /**
      * @brief Checks a variable declaration in global space. This function is never called on local variable declarations (declarations inside a function body).
      *
      * @param decl The variable declaration to check
-     * @return std::any The empty any object always.
      */
-    std::any visit_var_decl(Decl::Var* decl) override;
+    void visit_var_decl(Decl::Var* decl) override;
 
     /**
      * @brief Checks a function declaration in global space.
      * If the function is named `main`, this function will also check if the function has the correct signature.
      * This function should not call visit on the function body, as the function body is checked by the LocalChecker.
+     * A generic function is only added to the scope; its instances are checked instead.
      *
      * @param decl The function declaration to check
-     * @return std::any The empty any object always.
      */
-    std::any visit_fun_decl(Decl::Fun* decl) override;
+    void visit_fun_decl(Decl::Fun* decl) override;
 
     /**
      * @brief Checks an external function declaration in global space.
      *
      * @param decl The external function declaration to check
-     * @return std::any The empty any object always.
      */
-    std::any visit_extern_fun_decl(Decl::ExternFun* decl) override;
+    void visit_extern_fun_decl(Decl::ExternFun* decl) override;
 
     /**
      * @brief Checks a struct declaration in global space.
+     * A generic struct is only added to the scope; its instances are checked instead.
      *
      * @param decl The struct declaration to check
-     * @return std::any The empty any object always.
      */
-    std::any visit_struct_decl(Decl::Struct* decl) override;
+    void visit_struct_decl(Decl::Struct* decl) override;
+
+    /**
+     * @brief Checks an enum declaration in global space and adds it to the scope.
+     * Its payload types are resolved at the end of type checking, so that they may name types declared after it.
+     *
+     * @param decl The enum declaration to check
+     * @throw GlobalTypeException If the enum or one of its variants is already declared; will be caught by the type_check function.
+     */
+    void visit_enum_decl(Decl::Enum* decl) override;
 
 public:
-    GlobalChecker() = default;
+    /**
+     * @brief Creates a global checker for the compilation bound to the calling thread.
+     *
+     */
+    GlobalChecker() : GlobalChecker(CompilationContext::current()) {}
+
+    /**
+     * @brief Creates a global checker for the given compilation.
+     *
+     * @param compilation The compilation to check.
+     */
+    explicit GlobalChecker(CompilationContext& compilation)
+        : compilation(compilation), environment(compilation.get_environment()), logger(compilation.get_logger()),
+          instantiator(compilation, [this](Decl* decl) { declare_instance(decl); }) {}
 
     /**
      * @brief Runs the global type checker on a list of statements.
+     * Afterwards, instantiates the generics the statements use, declares the declarations that were deferred and resolves the payloads of enums.
      *
      * @param stmts The list of statements to check.
      */
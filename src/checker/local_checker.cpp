@@ -3,10 +3,67 @@
 #include "../scanner/token.h"
 #include "../utility/type.h"
 #include "../utility/utils.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <optional>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 
+namespace {
+
+// Gets the expression inside any groupings.
+Expr* strip_groupings(Expr* expr) {
+    while (auto grouping = dynamic_cast<Expr::Grouping*>(expr)) {
+        expr = grouping->expression.get();
+    }
+    return expr;
+}
+
+// Gets the value of an integer literal, or nothing if the expression is not one.
+std::optional<int> int_literal_value(Expr* expr) {
+    auto literal = dynamic_cast<Expr::Literal*>(strip_groupings(expr));
+    if (literal == nullptr || literal->token.tok_type != TOK_INT) {
+        return std::nullopt;
+    }
+    return std::any_cast<int>(literal->token.literal);
+}
+
+// Gets the type of the lanes of a vector type, or the type itself if it is not a vector.
+std::shared_ptr<Type> lane_type(const std::shared_ptr<Type>& type) {
+    auto vector_type = std::dynamic_pointer_cast<Type::Vector>(type);
+    return vector_type != nullptr ? vector_type->inner_type : type;
+}
+
+// Gets an aggregate a type holds inside it, or nullptr if it holds none.
+// Such an aggregate is stored behind a pointer to storage of its own, which the memory of an `alloc` does not include.
+std::shared_ptr<Type> nested_aggregate(const std::shared_ptr<Type>& type) {
+    std::vector<std::shared_ptr<Type>> parts;
+    if (auto array_type = std::dynamic_pointer_cast<Type::Array>(type)) {
+        parts.push_back(array_type->inner_type);
+    } else if (auto tuple_type = std::dynamic_pointer_cast<Type::Tuple>(type)) {
+        parts = tuple_type->element_types;
+    } else if (auto struct_type = std::dynamic_pointer_cast<Type::Struct>(type)) {
+        if (auto enum_decl = struct_type->struct_scope->enum_decl) {
+            for (auto& variant : enum_decl->variants) {
+                parts.insert(parts.end(), variant.payload.begin(), variant.payload.end());
+            }
+        }
+        for (auto& member : struct_type->struct_scope->instance_members) {
+            parts.push_back(member.second->type);
+        }
+    }
+    for (auto& part : parts) {
+        if (std::dynamic_pointer_cast<Type::Aggregate>(part) != nullptr) {
+            return part;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
 bool LocalChecker::check_token(TokenType token, const std::vector<TokenType>& types) const {
     for (auto type : types) {
         if (token == type) {
@@ -16,47 +73,103 @@ bool LocalChecker::check_token(TokenType token, const std::vector<TokenType>& ty
     return false;
 }
 
+TokenType LocalChecker::view_declarer(Expr* expr) const {
+    if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(expr->type)) {
+        return slice_type->declarer;
+    }
+    if (auto ptr_type = std::dynamic_pointer_cast<Type::Pointer>(expr->type)) {
+        return ptr_type->declarer;
+    }
+    // The elements of an array are as mutable as the array itself; temporaries can always be modified.
+    if (auto l_value = dynamic_cast<Expr::LValue*>(expr)) {
+        return l_value->get_lvalue_declarer();
+    }
+    return KW_VAR;
+}
+
+bool LocalChecker::is_in_bounds(Expr::Index* expr) const {
+    auto array_type = std::dynamic_pointer_cast<Type::Array>(expr->left->type);
+    auto vector_type = std::dynamic_pointer_cast<Type::Vector>(expr->left->type);
+    int size = array_type != nullptr ? array_type->size : vector_type != nullptr ? vector_type->size : -1;
+
+    // A constant index into an array of known size
+    if (auto value = int_literal_value(expr->right.get())) {
+        return *value >= 0 && *value < size;
+    }
+
+    // The variable of a range loop that starts at a non-negative constant; only its end must be checked
+    auto identifier = dynamic_cast<Expr::Identifier*>(strip_groupings(expr->right.get()));
+    if (identifier == nullptr) {
+        return false;
+    }
+    auto range_end = range_ends.find(identifier->variable.get());
+    if (range_end == range_ends.end()) {
+        return false;
+    }
+    // Casting a non-negative end to another integer type never makes it larger
+    auto end = strip_groupings(range_end->second);
+    while (auto cast = dynamic_cast<Expr::Cast*>(end)) {
+        end = strip_groupings(cast->expression.get());
+    }
+    if (auto value = int_literal_value(end)) {
+        return *value <= size;
+    }
+    auto access = dynamic_cast<Expr::Access*>(end);
+    if (access == nullptr || access->ident.lexeme != "len") {
+        return false;
+    }
+    // The length of an array is part of its type
+    if (auto end_array_type = std::dynamic_pointer_cast<Type::Array>(access->left->type)) {
+        return end_array_type->size <= size;
+    }
+    // The length of a slice only bounds the same slice, which must not be reassigned during the loop
+    auto end_slice = dynamic_cast<Expr::Identifier*>(strip_groupings(access->left.get()));
+    auto indexed_slice = dynamic_cast<Expr::Identifier*>(strip_groupings(expr->left.get()));
+    return IS_TYPE(access->left->type, Type::Slice) && end_slice != nullptr && indexed_slice != nullptr &&
+           end_slice->variable == indexed_slice->variable && end_slice->variable->decl->declarer == KW_CONST;
+}
+
 // MARK: Statements
 
-std::any LocalChecker::visit_declaration_stmt(Stmt::Declaration* stmt) {
+std::shared_ptr<Type> LocalChecker::visit_declaration_stmt(Stmt::Declaration* stmt) {
     // Visit the declaration
     stmt->declaration->accept(this);
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_expression_stmt(Stmt::Expression* stmt) {
+std::shared_ptr<Type> LocalChecker::visit_expression_stmt(Stmt::Expression* stmt) {
     // This is a local expression statement. Any global expression statements should have been caught by the global checker.
     // Visit the expression.
     stmt->expression->accept(this);
     // Expression statements do not produce any value.
     return std::shared_ptr<Type>(nullptr);
 }
-std::any LocalChecker::visit_block_stmt(Stmt::Block* /* stmt */) {
+std::shared_ptr<Type> LocalChecker::visit_block_stmt(Stmt::Block* /* stmt */) {
     // Not yet implemented
     // TODO: Implement block statements
-    // ErrorLogger::inst().log_error(stmt->location, E_UNIMPLEMENTED, "Block statements are not yet implemented.");
+    // logger.log_error(stmt->location, E_UNIMPLEMENTED, "Block statements are not yet implemented.");
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_conditional_stmt(Stmt::Conditional* stmt) {
+std::shared_ptr<Type> LocalChecker::visit_conditional_stmt(Stmt::Conditional* stmt) {
     // First, check that the conditional expression is of type `bool`
-    auto cond_type = std::any_cast<std::shared_ptr<Type>>(stmt->condition->accept(this));
+    auto cond_type = stmt->condition->accept(this);
     if (cond_type->to_string() != "::bool") {
-        ErrorLogger::inst().log_error(stmt->condition->location, E_CONDITIONAL_WITHOUT_BOOL, "Expected expression of type `bool`; Found `" + cond_type->to_string() + "`.");
+        logger.log_error(stmt->condition->location, E_CONDITIONAL_WITHOUT_BOOL, "Expected expression of type `bool`; Found `" + cond_type->to_string() + "`.");
         throw LocalTypeException();
     }
     std::shared_ptr<Stmt> prev_ret_stmt = nullptr;
     std::shared_ptr<Type> ret_type = nullptr;
     // Increase the local scope for the then_branch
-    Environment::inst().increase_local_scope();
+    environment.increase_local_scope();
     // Visit the then_branch
     for (auto& inner_stmt : stmt->then_branch) {
         // If one of these statements returns something...
-        auto temp_type = std::any_cast<std::shared_ptr<Type>>(inner_stmt->accept(this));
+        auto temp_type = inner_stmt->accept(this);
         // Ensure the return type is consistent...
         if (ret_type != nullptr && temp_type != nullptr && Type::are_compatible(ret_type, temp_type) != 0) {
-            ErrorLogger::inst().log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
-            ErrorLogger::inst().log_note(prev_ret_stmt->location, "Previous return statement was here.");
+            logger.log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
+            logger.log_note(prev_ret_stmt->location, "Previous return statement was here.");
             throw LocalTypeException();
         }
         // ...and store the return type
@@ -66,18 +179,17 @@ std::any LocalChecker::visit_conditional_stmt(Stmt::Conditional* stmt) {
         }
     }
     // Exit the local scope for the then_branch
-    Environment::inst().exit_scope();
+    environment.exit_scope();
     // Do the same for the else_branch
-    Environment::inst().increase_local_scope();
+    environment.increase_local_scope();
     // Visit the else_branch
     for (auto& inner_stmt : stmt->else_branch) {
-        auto temp = inner_stmt->accept(this);
         // If one of these statements returns something...
-        auto temp_type = std::any_cast<std::shared_ptr<Type>>(inner_stmt->accept(this));
+        auto temp_type = inner_stmt->accept(this);
         // Ensure the return type is consistent...
         if (ret_type != nullptr && temp_type != nullptr && Type::are_compatible(ret_type, temp_type) != 0) {
-            ErrorLogger::inst().log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
-            ErrorLogger::inst().log_note(prev_ret_stmt->location, "Previous return statement was here.");
+            logger.log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
+            logger.log_note(prev_ret_stmt->location, "Previous return statement was here.");
             throw LocalTypeException();
         }
         // ...and store the return type
@@ -86,30 +198,101 @@ std::any LocalChecker::visit_conditional_stmt(Stmt::Conditional* stmt) {
             prev_ret_stmt = inner_stmt;
         }
     }
+    // Exit the local scope for the else_branch
+    environment.exit_scope();
 
     return ret_type;
 }
 
-std::any LocalChecker::visit_loop_stmt(Stmt::Loop* stmt) {
+std::shared_ptr<Type> LocalChecker::visit_loop_stmt(Stmt::Loop* stmt) {
     // First, check that the conditional expression is of type `bool`
-    auto cond_type = std::any_cast<std::shared_ptr<Type>>(stmt->condition->accept(this));
+    auto cond_type = stmt->condition->accept(this);
     if (cond_type->to_string() != "::bool") {
-        ErrorLogger::inst().log_error(stmt->condition->location, E_CONDITIONAL_WITHOUT_BOOL, "Expected expression of type `bool`; Found `" + cond_type->to_string() + "`.");
+        logger.log_error(stmt->condition->location, E_CONDITIONAL_WITHOUT_BOOL, "Expected expression of type `bool`; Found `" + cond_type->to_string() + "`.");
         throw LocalTypeException();
     }
     std::shared_ptr<Stmt> prev_ret_stmt = nullptr;
     std::shared_ptr<Type> ret_type = nullptr;
     // Increase the local scope for the body
-    Environment::inst().increase_local_scope();
+    environment.increase_local_scope();
+    loop_depth++;
+    // Visit the body
+    for (auto& inner_stmt : stmt->body) {
+        // If one of these statements returns something...
+        auto temp_type = inner_stmt->accept(this);
+        // Ensure the return type is consistent...
+        if (ret_type != nullptr && temp_type != nullptr && Type::are_compatible(ret_type, temp_type) != 0) {
+            logger.log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
+            logger.log_note(prev_ret_stmt->location, "Previous return statement was here.");
+            throw LocalTypeException();
+        }
+        // ...and store the return type
+        if (temp_type != nullptr) {
+            ret_type = temp_type;
+            prev_ret_stmt = inner_stmt;
+        }
+    }
+    // Exit the local scope for the body
+    environment.exit_scope();
+    loop_depth--;
+
+    return ret_type;
+}
+
+std::shared_ptr<Type> LocalChecker::visit_for_stmt(Stmt::For* stmt) {
+    // First, determine the type of the loop variable from the range or the array
+    std::shared_ptr<Type> variable_type = nullptr;
+    auto start_type = stmt->start->accept(this);
+    if (stmt->end != nullptr) {
+        auto end_type = stmt->end->accept(this);
+        if (Type::are_compatible(start_type, end_type) != 0 || !start_type->is_int()) {
+            logger.log_error(stmt->start->location, E_FOR_OVER_NON_ITERABLE, "Cannot iterate over a range from " + start_type->to_string() + " to " + end_type->to_string() + ". Expected two ints of the same type.");
+            throw LocalTypeException();
+        }
+        variable_type = start_type;
+    } else {
+        auto array_type = std::dynamic_pointer_cast<Type::Array>(start_type);
+        auto slice_type = std::dynamic_pointer_cast<Type::Slice>(start_type);
+        if (slice_type != nullptr) {
+            variable_type = slice_type->inner_type;
+        } else if (array_type != nullptr && array_type->size != -1) {
+            variable_type = array_type->inner_type;
+        } else {
+            logger.log_error(stmt->start->location, E_FOR_OVER_NON_ITERABLE, "Cannot iterate over type " + start_type->to_string() + ". Expected a range, a slice, or an array of known size.");
+            throw LocalTypeException();
+        }
+        // Declaring the variable makes a pointer or slice type const, which must not leak into the element type
+        if (auto ptr_type = std::dynamic_pointer_cast<Type::Pointer>(variable_type)) {
+            variable_type = std::make_shared<Type::Pointer>(*ptr_type);
+        } else if (auto inner_slice_type = std::dynamic_pointer_cast<Type::Slice>(variable_type)) {
+            variable_type = std::make_shared<Type::Slice>(*inner_slice_type);
+        }
+    }
+
+    std::shared_ptr<Stmt> prev_ret_stmt = nullptr;
+    std::shared_ptr<Type> ret_type = nullptr;
+    // Increase the local scope for the body, which also holds the loop variable
+    environment.increase_local_scope();
     loop_depth++;
+    stmt->variable->type = variable_type;
+    auto [node, result] = environment.declare_variable(stmt->variable.get());
+    if (result != 0) {
+        logger.log_error(stmt->variable->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(result) + " in LocalChecker::visit_for_stmt.");
+        throw LocalTypeException();
+    }
+    // The loop variable of a range that starts at a non-negative constant stays in [0, end)
+    auto start_value = stmt->end != nullptr ? int_literal_value(stmt->start.get()) : std::nullopt;
+    if (start_value.has_value() && *start_value >= 0) {
+        range_ends[stmt->variable->variable.get()] = stmt->end.get();
+    }
     // Visit the body
     for (auto& inner_stmt : stmt->body) {
         // If one of these statements returns something...
-        auto temp_type = std::any_cast<std::shared_ptr<Type>>(inner_stmt->accept(this));
+        auto temp_type = inner_stmt->accept(this);
         // Ensure the return type is consistent...
         if (ret_type != nullptr && temp_type != nullptr && Type::are_compatible(ret_type, temp_type) != 0) {
-            ErrorLogger::inst().log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
-            ErrorLogger::inst().log_note(prev_ret_stmt->location, "Previous return statement was here.");
+            logger.log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
+            logger.log_note(prev_ret_stmt->location, "Previous return statement was here.");
             throw LocalTypeException();
         }
         // ...and store the return type
@@ -119,13 +302,119 @@ std::any LocalChecker::visit_loop_stmt(Stmt::Loop* stmt) {
         }
     }
     // Exit the local scope for the body
-    Environment::inst().exit_scope();
+    environment.exit_scope();
     loop_depth--;
+    range_ends.erase(stmt->variable->variable.get());
 
     return ret_type;
 }
 
-std::any LocalChecker::visit_return_stmt(Stmt::Return* stmt) {
+std::shared_ptr<Type> LocalChecker::visit_match_stmt(Stmt::Match* stmt) {
+    // First, check that the value is an enum
+    auto value_type = stmt->value->accept(this);
+    auto named_type = std::dynamic_pointer_cast<Type::Named>(value_type);
+    Decl::Enum* enum_decl = named_type != nullptr ? named_type->struct_scope->enum_decl : nullptr;
+    if (enum_decl == nullptr) {
+        logger.log_error(stmt->value->location, E_MATCH_ON_NON_ENUM, "Cannot match on type " + value_type->to_string() + ". Expected an enum.");
+        throw LocalTypeException();
+    }
+
+    std::vector<bool> covered(enum_decl->variants.size(), false);
+    bool has_wildcard = false;
+    std::shared_ptr<Stmt> prev_ret_stmt = nullptr;
+    std::shared_ptr<Type> ret_type = nullptr;
+    for (auto& arm : stmt->arms) {
+        auto& pattern_name = arm.pattern.back();
+        if (arm.pattern.size() == 1 && pattern_name.lexeme == "_") {
+            if (has_wildcard) {
+                logger.log_error(pattern_name.location, E_DUPLICATE_MATCH_ARM, "This match statement already has a `_` arm.");
+                throw LocalTypeException();
+            }
+            has_wildcard = true;
+            arm.variant = -1;
+        } else {
+            // The variant may be named with or without the path of its enum
+            arm.variant = enum_decl->find_variant(pattern_name.lexeme);
+            if (arm.pattern.size() > 1 && environment.get_variant(arm.pattern).first != enum_decl) {
+                arm.variant = -1;
+            }
+            if (arm.variant < 0) {
+                logger.log_error(pattern_name.location, E_UNKNOWN_VARIANT, "Enum " + value_type->to_string() + " has no variant `" + pattern_name.lexeme + "`.");
+                throw LocalTypeException();
+            }
+            if (covered[arm.variant]) {
+                logger.log_error(pattern_name.location, E_DUPLICATE_MATCH_ARM, "Variant `" + pattern_name.lexeme + "` is already matched by a previous arm.");
+                throw LocalTypeException();
+            }
+            covered[arm.variant] = true;
+            auto& variant = enum_decl->variants[arm.variant];
+            // A payload type that did not resolve has been reported by the global checker
+            if (variant.payload.size() != variant.payload_annotations.size()) {
+                throw LocalTypeException();
+            }
+            if (arm.has_bindings && arm.bindings.size() != variant.payload.size()) {
+                logger.log_error(pattern_name.location, E_INVALID_ARITY, "Variant `" + pattern_name.lexeme + "` has " + std::to_string(variant.payload.size()) + " payload fields, found " + std::to_string(arm.bindings.size()) + " bindings.");
+                throw LocalTypeException();
+            }
+        }
+
+        // Increase the local scope for the arm, which also holds its bindings
+        environment.increase_local_scope();
+        for (size_t i = 0; i < arm.bindings.size(); i++) {
+            auto& binding = arm.bindings[i];
+            if (binding->name.lexeme == "_") {
+                continue;
+            }
+            // Declaring the binding makes a pointer or slice type const, which must not leak into the payload type
+            auto binding_type = enum_decl->variants[arm.variant].payload[i];
+            if (auto ptr_type = std::dynamic_pointer_cast<Type::Pointer>(binding_type)) {
+                binding_type = std::make_shared<Type::Pointer>(*ptr_type);
+            } else if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(binding_type)) {
+                binding_type = std::make_shared<Type::Slice>(*slice_type);
+            }
+            binding->type = binding_type;
+            auto [node, result] = environment.declare_variable(binding.get());
+            if (result == E_SYMBOL_ALREADY_DECLARED) {
+                logger.log_error(binding->name.location, E_LOCAL_ALREADY_DECLARED, "A symbol with the same name has already been declared in this scope.");
+                logger.log_note(node->location, "Previous declaration was here.");
+                throw LocalTypeException();
+            } else if (result != 0) {
+                logger.log_error(binding->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(result) + " in LocalChecker::visit_match_stmt.");
+                throw LocalTypeException();
+            }
+        }
+        // Visit the body
+        for (auto& inner_stmt : arm.body) {
+            // If one of these statements returns something...
+            auto temp_type = inner_stmt->accept(this);
+            // Ensure the return type is consistent...
+            if (ret_type != nullptr && temp_type != nullptr && Type::are_compatible(ret_type, temp_type) != 0) {
+                logger.log_error(inner_stmt->location, E_INCONSISTENT_RETURN_TYPES, "Return type is inconsistent with a previous return statement.");
+                logger.log_note(prev_ret_stmt->location, "Previous return statement was here.");
+                throw LocalTypeException();
+            }
+            // ...and store the return type
+            if (temp_type != nullptr) {
+                ret_type = temp_type;
+                prev_ret_stmt = inner_stmt;
+            }
+        }
+        // Exit the local scope for the arm
+        environment.exit_scope();
+    }
+
+    // Every variant must have an arm, unless there is a `_` arm
+    for (size_t i = 0; i < covered.size() && !has_wildcard; i++) {
+        if (!covered[i]) {
+            logger.log_error(stmt->location, E_NON_EXHAUSTIVE_MATCH, "Variant `" + enum_decl->variants[i].name.lexeme + "` is not matched. Add an arm for it or a `_` arm.");
+            throw LocalTypeException();
+        }
+    }
+
+    return ret_type;
+}
+
+std::shared_ptr<Type> LocalChecker::visit_return_stmt(Stmt::Return* stmt) {
     // Return statements are not allowed in global scope
     // We already checked for this in the global checker
 
@@ -133,43 +422,43 @@ std::any LocalChecker::visit_return_stmt(Stmt::Return* stmt) {
         return std::shared_ptr<Type>(nullptr);
     }
 
-    std::shared_ptr<Type> ret_type = std::any_cast<std::shared_ptr<Type>>(stmt->value->accept(this));
+    std::shared_ptr<Type> ret_type = stmt->value->accept(this);
 
     return ret_type;
 }
 
-std::any LocalChecker::visit_break_stmt(Stmt::Break* stmt) {
+std::shared_ptr<Type> LocalChecker::visit_break_stmt(Stmt::Break* stmt) {
     if (loop_depth == 0) {
-        ErrorLogger::inst().log_error(stmt->location, E_BREAK_OUTSIDE_LOOP, "Break statement is not inside a loop.");
+        logger.log_error(stmt->location, E_BREAK_OUTSIDE_LOOP, "Break statement is not inside a loop.");
         throw LocalTypeException();
     }
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_continue_stmt(Stmt::Continue* /* stmt */) {
+std::shared_ptr<Type> LocalChecker::visit_continue_stmt(Stmt::Continue* /* stmt */) {
     // Log error with location
     // TODO: Implement continue statements
-    // ErrorLogger::inst().log_error(stmt->location, E_UNIMPLEMENTED, "Continue statements are not yet implemented.");
+    // logger.log_error(stmt->location, E_UNIMPLEMENTED, "Continue statements are not yet implemented.");
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_eof_stmt(Stmt::EndOfFile* /* stmt */) {
+std::shared_ptr<Type> LocalChecker::visit_eof_stmt(Stmt::EndOfFile* /* stmt */) {
     // Does nothing (for now)
     return std::shared_ptr<Type>(nullptr);
 }
 
 // MARK: Declarations
 
-std::any LocalChecker::visit_var_decl(Decl::Var* decl) {
+std::shared_ptr<Type> LocalChecker::visit_var_decl(Decl::Var* decl) {
     // Handle the case where the initializer is not present
     if (decl->initializer == nullptr) {
         // Ensure the type annotation is not auto and the declarer is not const.
         if (decl->type_annotation->to_string() == "auto") {
-            ErrorLogger::inst().log_error(decl->name.location, E_AUTO_WITHOUT_INITIALIZER, "Cannot infer type without an initializer.");
+            logger.log_error(decl->name.location, E_AUTO_WITHOUT_INITIALIZER, "Cannot infer type without an initializer.");
             throw LocalTypeException();
         }
         if (decl->declarer == KW_CONST) {
-            ErrorLogger::inst().log_error(decl->name.location, E_UNINITIALIZED_CONST, "Cannot declare a constant without an initializer.");
+            logger.log_error(decl->name.location, E_UNINITIALIZED_CONST, "Cannot declare a constant without an initializer.");
             throw LocalTypeException();
         }
     }
@@ -177,30 +466,30 @@ std::any LocalChecker::visit_var_decl(Decl::Var* decl) {
     // Get the type of the initializer
     std::shared_ptr<Type> init_type = std::make_shared<Type::Blank>();
     if (decl->initializer != nullptr) {
-        init_type = std::any_cast<std::shared_ptr<Type>>(decl->initializer->accept(this));
+        init_type = decl->initializer->accept(this);
     }
 
     std::shared_ptr<Node::Locatable> node;
     ErrorCode result = (ErrorCode)0;
 
     // If we are in global scope, the variable is already declared
-    if (Environment::inst().in_global_scope()) {
-        node = Environment::inst().get_variable({decl->name.lexeme});
+    if (environment.in_global_scope()) {
+        node = environment.get_variable({decl->name});
     } else {
         // Declare the variable, do not defer
-        std::tie(node, result) = Environment::inst().declare_variable(decl);
+        std::tie(node, result) = environment.declare_variable(decl);
     }
 
     // Verify that the variable was declared successfully
     if (result == E_SYMBOL_ALREADY_DECLARED) {
-        ErrorLogger::inst().log_error(decl->name.location, E_LOCAL_ALREADY_DECLARED, "A symbol with the same name has already been declared in this scope.");
-        ErrorLogger::inst().log_note(node->location, "Previous declaration was here.");
+        logger.log_error(decl->name.location, E_LOCAL_ALREADY_DECLARED, "A symbol with the same name has already been declared in this scope.");
+        logger.log_note(node->location, "Previous declaration was here.");
         throw LocalTypeException();
     } else if (result == E_UNKNOWN_TYPE) {
-        ErrorLogger::inst().log_error(decl->name.location, result, "Could not resolve type annotation");
+        logger.log_error(decl->name.location, result, "Could not resolve type annotation");
         throw LocalTypeException();
     } else if (result != 0) {
-        ErrorLogger::inst().log_error(decl->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(result) + " in LocalChecker::visit_var_decl.");
+        logger.log_error(decl->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(result) + " in LocalChecker::visit_var_decl.");
         throw LocalTypeException();
     }
     // Neither variable->type nor init_type should be nullptr at this point.
@@ -212,76 +501,98 @@ std::any LocalChecker::visit_var_decl(Decl::Var* decl) {
         // If the error occurred because init_type is an array of blank types, give a more specific error message
         // auto init_array = std::dynamic_pointer_cast<Type::Array>(init_type);
         if (ec == E_INDETERMINATE_ARRAY_TYPE) {
-            ErrorLogger::inst().log_error(decl->initializer->location, ec, "The type of this array could not be determined.");
-            ErrorLogger::inst().log_note(decl->name.location, "Missing type annotation.");
+            logger.log_error(decl->initializer->location, ec, "The type of this array could not be determined.");
+            logger.log_note(decl->name.location, "Missing type annotation.");
             throw LocalTypeException();
         }
         // auto var_array = std::dynamic_pointer_cast<Type::Array>(variable->decl->type);
         if (ec == E_SIZED_ARRAY_WITHOUT_INITIALIZER) {
-            ErrorLogger::inst().log_error(decl->name.location, ec, "An array with a known size must have an initializer.");
+            logger.log_error(decl->name.location, ec, "An array with a known size must have an initializer.");
             throw LocalTypeException();
         }
         if (ec == E_ARRAY_SIZE_UNKNOWN) {
-            ErrorLogger::inst().log_error(decl->name.location, ec, "Cannot implicitly convert from " + init_type->to_string() + " to " + variable->decl->type->to_string() + ".");
-            ErrorLogger::inst().log_note(decl->initializer->location, "Size is unknown.");
+            logger.log_error(decl->name.location, ec, "Cannot implicitly convert from " + init_type->to_string() + " to " + variable->decl->type->to_string() + ".");
+            logger.log_note(decl->initializer->location, "Size is unknown.");
             throw LocalTypeException();
         }
 
-        ErrorLogger::inst().log_error(decl->name.location, ec, "Cannot convert from " + init_type->to_string() + " to " + variable->decl->type->to_string() + ".");
+        logger.log_error(decl->name.location, ec, "Cannot convert from " + init_type->to_string() + " to " + variable->decl->type->to_string() + ".");
         throw LocalTypeException();
     }
     // Verify that none of the types are blank
     if (variable->decl->type->kind() == Type::Kind::BLANK || init_type->kind() == Type::Kind::BLANK) {
-        ErrorLogger::inst().log_error(decl->name.location, E_UNKNOWN_TYPE, "Could not resolve type annotation.");
+        logger.log_error(decl->name.location, E_UNKNOWN_TYPE, "Could not resolve type annotation.");
         throw LocalTypeException();
     }
     // Verify that the right side is not a const pointer being assigned to a non-const pointer
     auto init_ptr_type = std::dynamic_pointer_cast<Type::Pointer>(init_type);
     if (init_ptr_type != nullptr && init_ptr_type->declarer == KW_CONST && variable->decl->declarer != KW_CONST) {
-        ErrorLogger::inst().log_error(decl->name.location, E_INVALID_PTR_DECLARER, "Cannot assign a const pointer to a non-const pointer.");
+        logger.log_error(decl->name.location, E_INVALID_PTR_DECLARER, "Cannot assign a const pointer to a non-const pointer.");
         throw LocalTypeException();
     } else if (init_ptr_type != nullptr && variable->decl->declarer == KW_CONST) {
-        // If the variable is const, the pointer must be const as well
-        init_ptr_type->declarer = KW_CONST;
+        // If the variable is const, the pointer must be const as well.
+        // The type may be shared with the initializer, e.g. a global's, so the variable gets its own copy.
+        auto var_ptr_type = std::make_shared<Type::Pointer>(*std::dynamic_pointer_cast<Type::Pointer>(variable->decl->type));
+        var_ptr_type->declarer = KW_CONST;
+        variable->decl->type = var_ptr_type;
+    }
+    // The same goes for slices, which may also view a const array
+    if (variable->decl->type->kind() == Type::Kind::SLICE) {
+        if (decl->initializer != nullptr && view_declarer(decl->initializer.get()) == KW_CONST && variable->decl->declarer != KW_CONST) {
+            logger.log_error(decl->name.location, E_INVALID_PTR_DECLARER, "Cannot assign a const view to a non-const slice.");
+            throw LocalTypeException();
+        }
+        // The type may be the initializer's own, so the variable gets its own copy
+        auto var_slice_type = std::make_shared<Type::Slice>(*std::dynamic_pointer_cast<Type::Slice>(variable->decl->type));
+        var_slice_type->declarer = variable->decl->declarer;
+        variable->decl->type = var_slice_type;
     }
 
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_fun_decl(Decl::Fun* decl) {
+std::shared_ptr<Type> LocalChecker::visit_fun_decl(Decl::Fun* decl) {
     // Function declarations are not allowed in local scope
-    if (!Environment::inst().in_global_scope()) {
-        ErrorLogger::inst().log_error(decl->name.location, E_FUN_IN_LOCAL_SCOPE, "Function declarations are not allowed in local scope.");
+    if (!environment.in_global_scope()) {
+        logger.log_error(decl->name.location, E_FUN_IN_LOCAL_SCOPE, "Function declarations are not allowed in local scope.");
         throw LocalTypeException();
     }
 
+    // A generic function is checked through its instances
+    if (!decl->type_params.empty()) {
+        for (auto& instance : decl->instances) {
+            instance->accept(this);
+        }
+        return std::shared_ptr<Type>(nullptr);
+    }
+
     // No need to declare the function; we've already done that in the global checker
-    auto variable = Environment::inst().get_variable({decl->name.lexeme});
+    auto variable = environment.get_variable({decl->name});
 
     // We could verify the entire function pointer, but then we'd get less specific error messages
     // So we'll just verify the return type and the parameter types separately
     auto fun_annotation = std::dynamic_pointer_cast<Annotation::Function>(decl->type_annotation);
 
     // Increase the local scope for the parameters and return variable
-    Environment::inst().increase_local_scope();
+    environment.increase_local_scope();
 
     // We don't need to declare the return variable; it's not designed to be accessed directly
     // The return variable is more important during the code generation phase
     // We can instead just verify that the return type is correct
 
     for (unsigned i = 0; i < decl->parameters.size(); i++) {
-        auto [param_node, param_result] = Environment::inst().declare_variable(
+        auto [param_node, param_result] = environment.declare_variable(
             decl->parameters[i].get()
         );
         if (param_result == E_SYMBOL_ALREADY_DECLARED) {
-            ErrorLogger::inst().log_error(decl->parameters[i]->name.location, E_DUPLICATE_PARAM_NAME, "A parameter with the same name has already been declared here.");
-            ErrorLogger::inst().log_note(param_node->location, "Previous declaration was here.");
+            logger.log_error(decl->parameters[i]->name.location, E_DUPLICATE_PARAM_NAME, "A parameter with the same name has already been declared here.");
+            logger.log_note(param_node->location, "Previous declaration was here.");
             throw LocalTypeException();
         } else if (param_result == E_UNKNOWN_TYPE) {
-            ErrorLogger::inst().log_error(decl->parameters[i]->name.location, param_result, "Could not resolve type annotation.");
+            logger.log_error(decl->parameters[i]->name.location, param_result, "Could not resolve type annotation.");
             throw LocalTypeException();
         } else if (param_result != 0) {
-            ErrorLogger::inst().log_error(decl->parameters[i]->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(param_result) + " in LocalChecker::visit_fun_decl.");
+            logger.log_error(decl->parameters[i]->name.location, E_IMPOSSIBLE, "Function `declare_variable` issued error " + std::to_string(param_result) + " in LocalChecker::visit_fun_decl.");
             throw LocalTypeException();
         }
         auto param_var = std::dynamic_pointer_cast<Node::Variable>(param_node);
@@ -297,52 +608,51 @@ std::any LocalChecker::visit_fun_decl(Decl::Fun* decl) {
 
     // At this point, the function type should be fully resolved
     if (variable == nullptr) {
-        ErrorLogger::inst().log_error(decl->name.location, E_IMPOSSIBLE, "Function pointer variable is nullptr in LocalChecker::visit_fun_decl.");
+        logger.log_error(decl->name.location, E_IMPOSSIBLE, "Function pointer variable is nullptr in LocalChecker::visit_fun_decl.");
         throw LocalTypeException();
     }
     auto variable_fun_type = std::dynamic_pointer_cast<Type::Function>(variable->decl->type);
 
     // Increase the local scope for the function body
-    Environment::inst().increase_local_scope();
+    environment.increase_local_scope();
 
     // Verify the body of the function
     // If any statement returns a non-empty any, either the statement is a return statement or is a block containing one
     // Verify the return statement types and log the appropriate error messages
     bool has_return = false;
     for (auto& stmt : decl->body) {
-        // std::any stmt_type = stmt->accept(this);
-        std::shared_ptr<Type> stmt_type = std::any_cast<std::shared_ptr<Type>>(stmt->accept(this));
+        std::shared_ptr<Type> stmt_type = stmt->accept(this);
         if (stmt_type != nullptr) {
             has_return = true;
             if (variable->decl->type->to_string() == "::void") {
-                ErrorLogger::inst().log_error(stmt->location, E_RETURN_IN_VOID_FUN, "Function with return type 'void' cannot return a value.");
+                logger.log_error(stmt->location, E_RETURN_IN_VOID_FUN, "Function with return type 'void' cannot return a value.");
                 throw LocalTypeException();
             } else {
                 // The return type of the function must match the return type of the return statement
                 // This will also catch the case where the function return type is `void` and the return statement has a value
                 if (Type::are_compatible(stmt_type, variable_fun_type->return_type) != 0) {
-                    ErrorLogger::inst().log_error(stmt->location, E_RETURN_INCOMPATIBLE, "Cannot convert from " + stmt_type->to_string() + " to return type " + variable_fun_type->return_type->to_string() + ".");
+                    logger.log_error(stmt->location, E_RETURN_INCOMPATIBLE, "Cannot convert from " + stmt_type->to_string() + " to return type " + variable_fun_type->return_type->to_string() + ".");
                     throw LocalTypeException();
                 }
             }
         }
     }
     if (!has_return && variable_fun_type->return_type->to_string() != "::void") {
-        ErrorLogger::inst().log_error(decl->name.location, E_NO_RETURN_IN_NON_VOID_FUN, "Function with non-void return type must return a value.");
+        logger.log_error(decl->name.location, E_NO_RETURN_IN_NON_VOID_FUN, "Function with non-void return type must return a value.");
         throw LocalTypeException();
     }
 
     // Exit both local scopes
-    Environment::inst().exit_scope();
-    Environment::inst().exit_scope();
+    environment.exit_scope();
+    environment.exit_scope();
 
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_extern_fun_decl(Decl::ExternFun* decl) {
+std::shared_ptr<Type> LocalChecker::visit_extern_fun_decl(Decl::ExternFun* decl) {
     // Function declarations are not allowed in local scope
-    if (!Environment::inst().in_global_scope()) {
-        ErrorLogger::inst().log_error(decl->name.location, E_FUN_IN_LOCAL_SCOPE, "Function declarations are not allowed in local scope.");
+    if (!environment.in_global_scope()) {
+        logger.log_error(decl->name.location, E_FUN_IN_LOCAL_SCOPE, "Function declarations are not allowed in local scope.");
         throw LocalTypeException();
     }
 
@@ -350,15 +660,23 @@ std::any LocalChecker::visit_extern_fun_decl(Decl::ExternFun* decl) {
     return std::shared_ptr<Type>(nullptr);
 }
 
-std::any LocalChecker::visit_struct_decl(Decl::Struct* decl) {
+std::shared_ptr<Type> LocalChecker::visit_struct_decl(Decl::Struct* decl) {
     // Struct declarations are not allowed in local scope
-    if (!Environment::inst().in_global_scope()) {
-        ErrorLogger::inst().log_error(decl->name.location, E_STRUCT_IN_LOCAL_SCOPE, "Struct declarations are not allowed in local scope.");
+    if (!environment.in_global_scope()) {
+        logger.log_error(decl->name.location, E_STRUCT_IN_LOCAL_SCOPE, "Struct declarations are not allowed in local scope.");
         throw LocalTypeException();
     }
 
+    // A generic struct is checked through its instances
+    if (!decl->type_params.empty()) {
+        for (auto& instance : decl->instances) {
+            instance->accept(this);
+        }
+        return std::shared_ptr<Type>(nullptr);
+    }
+
     // Enter the struct scope
-    Environment::inst().enter_scope(decl->name.lexeme);
+    environment.enter_scope(decl->name.lexeme);
 
     // We check only the static declarations of the struct
     for (auto declaration : decl->declarations) {
@@ -368,35 +686,58 @@ std::any LocalChecker::visit_struct_decl(Decl::Struct* decl) {
     }
 
     // Exit the struct scope
-    Environment::inst().exit_scope();
+    environment.exit_scope();
 
     return std::shared_ptr<Type>(nullptr);
 }
 
+std::shared_ptr<Type> LocalChecker::visit_enum_decl(Decl::Enum* decl) {
+    // Enum declarations are not allowed in local scope
+    if (!environment.in_global_scope()) {
+        logger.log_error(decl->name.location, E_STRUCT_IN_LOCAL_SCOPE, "Enum declarations are not allowed in local scope.");
+        throw LocalTypeException();
+    }
+    // Everything else was checked by the global checker
+    return std::shared_ptr<Type>(nullptr);
+}
+
 // MARK: Expressions
 
-std::any LocalChecker::visit_assign_expr(Expr::Assign* expr) {
+std::shared_ptr<Type> LocalChecker::visit_assign_expr(Expr::Assign* expr) {
     // The left side of the assignment must be an lvalue
     // Currently, lvalues can be Expr::Identifier or Expr::Access
     // Visit the left and right sides of the assignment
-    auto l_type = std::any_cast<std::shared_ptr<Type>>(expr->left->accept(this));
-    auto r_type = std::any_cast<std::shared_ptr<Type>>(expr->right->accept(this));
+    auto l_type = expr->left->accept(this);
+    auto r_type = expr->right->accept(this);
 
     auto l_value = std::dynamic_pointer_cast<Expr::LValue>(expr->left);
     if (l_value == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_ASSIGN_TO_NON_LVALUE, "Left side of assignment is not an lvalue.");
+        logger.log_error(expr->location, E_ASSIGN_TO_NON_LVALUE, "Left side of assignment is not an lvalue.");
         throw LocalTypeException();
     }
     auto declarer = l_value->get_lvalue_declarer();
 
     if (declarer == KW_CONST) {
-        ErrorLogger::inst().log_error(expr->location, E_ASSIGN_TO_CONST, "Cannot assign to a constant.");
+        logger.log_error(expr->location, E_ASSIGN_TO_CONST, "Cannot assign to a constant.");
         throw LocalTypeException();
     }
 
     // The types of the left and right sides must match
     if (Type::are_compatible(l_type, r_type) != 0) {
-        ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + r_type->to_string() + " to " + l_type->to_string() + ".");
+        logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + r_type->to_string() + " to " + l_type->to_string() + ".");
+        throw LocalTypeException();
+    }
+
+    // A non-const slice cannot be made to view const elements
+    auto l_slice_type = std::dynamic_pointer_cast<Type::Slice>(l_type);
+    if (l_slice_type != nullptr && l_slice_type->declarer != KW_CONST && view_declarer(expr->right.get()) == KW_CONST) {
+        logger.log_error(expr->location, E_INVALID_PTR_DECLARER, "Cannot assign a const view to a non-const slice.");
+        throw LocalTypeException();
+    }
+
+    // `&&=` and `||=` are logical operators, so both sides must be of type `bool`
+    if (check_token(expr->op.tok_type, {TOK_AMP_AMP_EQ, TOK_BAR_BAR_EQ}) && l_type->to_string() != "::bool") {
+        logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected type 'bool'.");
         throw LocalTypeException();
     }
 
@@ -405,20 +746,21 @@ std::any LocalChecker::visit_assign_expr(Expr::Assign* expr) {
     return expr->type;
 }
 
-std::any LocalChecker::visit_logical_expr(Expr::Logical* expr) {
+std::shared_ptr<Type> LocalChecker::visit_logical_expr(Expr::Logical* expr) {
     // There are 2 logical operators: `&&` and `||`
     // In both cases, the operands must be of type `bool` and the result is of type `bool`
 
-    auto l_type = std::any_cast<std::shared_ptr<Type>>(expr->left->accept(this));
-    auto r_type = std::any_cast<std::shared_ptr<Type>>(expr->right->accept(this));
+    auto l_type = expr->left->accept(this);
+    auto r_type = expr->right->accept(this);
 
     if (Type::are_compatible(l_type, r_type) != 0) {
-        ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
+        logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
         throw LocalTypeException();
     }
 
-    if (l_type->to_string() != "::bool") {
-        ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected type 'bool'.");
+    // Vectors of bools are combined lane by lane
+    if (lane_type(l_type)->to_string() != "::bool") {
+        logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected type 'bool'.");
         throw LocalTypeException();
     }
 
@@ -426,12 +768,14 @@ std::any LocalChecker::visit_logical_expr(Expr::Logical* expr) {
     return expr->type;
 }
 
-std::any LocalChecker::visit_binary_expr(Expr::Binary* expr) {
-    // There are 12 binary operators: `+`, `-`, `*`, `/`, `%`, `^`, `==`, `!=`, `<`, `<=`, `>`, `>=`
+std::shared_ptr<Type> LocalChecker::visit_binary_expr(Expr::Binary* expr) {
+    // There are 17 binary operators: `+`, `-`, `*`, `/`, `%`, `^`, `&`, `|`, `~`, `<<`, `>>`, `==`, `!=`, `<`, `<=`, `>`, `>=`
 
     // For now, we require that operands have the exact required types (no implicit conversions)
-    auto l_type = std::any_cast<std::shared_ptr<Type>>(expr->left->accept(this));
-    auto r_type = std::any_cast<std::shared_ptr<Type>>(expr->right->accept(this));
+    auto l_type = expr->left->accept(this);
+    auto r_type = expr->right->accept(this);
+    // Vectors apply the operator to each lane, so it is their lanes that must have the right type
+    auto l_lane_type = lane_type(l_type);
 
     TokenType op = expr->op.tok_type;
 
@@ -439,79 +783,121 @@ std::any LocalChecker::visit_binary_expr(Expr::Binary* expr) {
         // For PLUS, MINUS, STAR, SLASH the operands must be equal and must be of type `int` or `float` and the result is of the same type
 
         if (Type::are_compatible(l_type, r_type) != 0) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
             throw LocalTypeException();
         }
-        if (!l_type->is_int() && !l_type->is_float()) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int or float.");
+        if (!l_lane_type->is_int() && !l_lane_type->is_float()) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int or float.");
             throw LocalTypeException();
         }
         expr->type = l_type;
-    } else if (check_token(op, {TOK_PERCENT})) {
-        // For PERCENT, the operands must be equal and must be of type `int` and the result is of type `int`
+    } else if (check_token(op, {TOK_PERCENT, TOK_AMP, TOK_BAR, TOK_TILDE})) {
+        // For PERCENT, AMP, BAR, TILDE the operands must be equal and must be of type `int` and the result is of type `int`
         if (Type::are_compatible(l_type, r_type) != 0) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
+            throw LocalTypeException();
+        }
+        if (!l_lane_type->is_int()) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int.");
             throw LocalTypeException();
         }
-        if (!l_type->is_int()) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int.");
+        expr->type = l_type;
+    } else if (check_token(op, {TOK_LT_LT, TOK_GT_GT})) {
+        // For LT_LT, GT_GT the value must be an `int` and the amount may be any `int`; the result has the type of the value.
+        // A vector is shifted lane by lane, by the lanes of a vector of amounts.
+        auto l_vector_type = std::dynamic_pointer_cast<Type::Vector>(l_type);
+        auto r_vector_type = std::dynamic_pointer_cast<Type::Vector>(r_type);
+        bool is_same_shape = l_vector_type == nullptr ? r_vector_type == nullptr : r_vector_type != nullptr && r_vector_type->size == l_vector_type->size;
+        if (!l_lane_type->is_int() || !lane_type(r_type)->is_int() || !is_same_shape) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ". Expected an int shifted by an int.");
             throw LocalTypeException();
         }
         expr->type = l_type;
     } else if (check_token(op, {TOK_CARET})) {
-        // For CARET, the operands must be equal and must be either `int` or `float`. Unlike the other operators, the result is always of type `f64`
-        if (Type::are_compatible(l_type, r_type) != 0) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
+        // For CARET, the operands must be equal and must be either `int` or `float`; a `float` may also be raised to an `int`.
+        // The result has the type of the base.
+        bool is_float_to_int = l_type->is_float() && r_type->is_int();
+        if (!is_float_to_int && Type::are_compatible(l_type, r_type) != 0) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
             throw LocalTypeException();
         }
         if (!l_type->is_int() && !l_type->is_float()) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int or float.");
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int or float.");
             throw LocalTypeException();
         }
-        expr->type = Environment::inst().get_type("f64");
+        expr->type = l_type;
     } else if (check_token(op, {TOK_EQ_EQ, TOK_BANG_EQ, TOK_LT, TOK_LE, TOK_GT, TOK_GE})) {
         // For EQ_EQ, BANG_EQ, LT, LE, GT, GE the operands must be equal and must be of type `int` or `float` and the result is of type `bool`
         if (Type::are_compatible(l_type, r_type) != 0) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to types " + l_type->to_string() + " and " + r_type->to_string() + ".");
             throw LocalTypeException();
         }
-        if (!l_type->is_int() && !l_type->is_float()) {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int or float.");
+        if (!l_lane_type->is_int() && !l_lane_type->is_float()) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply operator '" + expr->op.lexeme + "' to type " + l_type->to_string() + ". Expected int or float.");
             throw LocalTypeException();
         }
-        expr->type = Environment::inst().get_type("bool");
+        // Comparing vectors gives a mask with the result of each lane
+        expr->type = environment.get_type("bool");
+        if (auto l_vector_type = std::dynamic_pointer_cast<Type::Vector>(l_type)) {
+            expr->type = std::make_shared<Type::Vector>(expr->type, l_vector_type->size);
+        }
     } else {
         // Unreachable
-        ErrorLogger::inst().log_error(expr->location, E_UNREACHABLE, "Unknown binary operator.");
+        logger.log_error(expr->location, E_UNREACHABLE, "Unknown binary operator.");
     }
 
     return expr->type;
 }
 
-std::any LocalChecker::visit_unary_expr(Expr::Unary* expr) {
-    // There are 3 unary operators: `!`, `-`, and `&`
+std::shared_ptr<Type> LocalChecker::visit_unary_expr(Expr::Unary* expr) {
+    // There are 4 unary operators: `!`, `-`, `~`, and `&`
 
-    auto operand_type = std::any_cast<std::shared_ptr<Type>>(expr->inner->accept(this));
+    auto operand_type = expr->inner->accept(this);
 
     if (expr->op.tok_type == TOK_BANG) {
-        // The operand must be of type `bool`
-        if (operand_type->to_string() != "::bool") {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply unary operator '!' to type " + operand_type->to_string() + ". Expected type 'bool'.");
+        // The operand must be of type `bool`, or a vector of them
+        if (lane_type(operand_type)->to_string() != "::bool") {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply unary operator '!' to type " + operand_type->to_string() + ". Expected type 'bool'.");
             throw LocalTypeException();
         }
         expr->type = operand_type;
     } else if (expr->op.tok_type == TOK_MINUS) {
-        // The operand must be of type `int` or `float`
-        if (operand_type->is_int() || operand_type->is_float()) {
+        // The operand must be of type `int` or `float`, or a vector of them
+        if (lane_type(operand_type)->is_int() || lane_type(operand_type)->is_float()) {
             expr->type = operand_type;
         } else {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply unary operator '-' to type " + operand_type->to_string() + ". Expected int or float.");
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply unary operator '-' to type " + operand_type->to_string() + ". Expected int or float.");
+            throw LocalTypeException();
+        }
+    } else if (expr->op.tok_type == TOK_TILDE) {
+        // The operand must be of type `int`, or a vector of them
+        if (!lane_type(operand_type)->is_int()) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot apply unary operator '~' to type " + operand_type->to_string() + ". Expected int.");
             throw LocalTypeException();
         }
+        expr->type = operand_type;
     } else if (expr->op.tok_type == TOK_AMP) {
         auto l_value = std::dynamic_pointer_cast<Expr::LValue>(expr->inner);
         if (l_value == nullptr) {
-            ErrorLogger::inst().log_error(expr->location, E_ADDRESS_OF_NON_LVALUE, "Cannot take the address of a non-lvalue.");
+            logger.log_error(expr->location, E_ADDRESS_OF_NON_LVALUE, "Cannot take the address of a non-lvalue.");
+            throw LocalTypeException();
+        }
+        // Enum variants are values, not storage
+        auto identifier = std::dynamic_pointer_cast<Expr::Identifier>(expr->inner);
+        if (identifier != nullptr && identifier->variant >= 0) {
+            logger.log_error(expr->location, E_ADDRESS_OF_NON_LVALUE, "Cannot take the address of an enum variant.");
+            throw LocalTypeException();
+        }
+        // The length of an array or slice is not stored in memory
+        auto access = std::dynamic_pointer_cast<Expr::Access>(expr->inner);
+        if (access != nullptr && (IS_TYPE(access->left->type, Type::Array) || IS_TYPE(access->left->type, Type::Slice))) {
+            logger.log_error(expr->location, E_ADDRESS_OF_NON_LVALUE, "Cannot take the address of the length of an array or slice.");
+            throw LocalTypeException();
+        }
+        // The lanes of a vector live in a register, not each at an address of their own
+        auto index = std::dynamic_pointer_cast<Expr::Index>(expr->inner);
+        if (index != nullptr && IS_TYPE(index->left->type, Type::Vector)) {
+            logger.log_error(expr->location, E_ADDRESS_OF_NON_LVALUE, "Cannot take the address of a lane of a vector.");
             throw LocalTypeException();
         }
         // The type of the expression is a pointer to the type of the operand
@@ -521,22 +907,22 @@ std::any LocalChecker::visit_unary_expr(Expr::Unary* expr) {
 
     } else {
         // Unreachable
-        ErrorLogger::inst().log_error(expr->location, E_UNREACHABLE, "Unknown unary operator.");
+        logger.log_error(expr->location, E_UNREACHABLE, "Unknown unary operator.");
     }
 
     return expr->type;
 }
 
-std::any LocalChecker::visit_dereference_expr(Expr::Dereference* expr) {
-    auto operand_type = std::any_cast<std::shared_ptr<Type>>(expr->inner->accept(this));
+std::shared_ptr<Type> LocalChecker::visit_dereference_expr(Expr::Dereference* expr) {
+    auto operand_type = expr->inner->accept(this);
 
     // The operand must be a pointer type
     auto operand_ptr_type = std::dynamic_pointer_cast<Type::Pointer>(operand_type);
     if (operand_ptr_type == nullptr) {
-        ErrorLogger::inst().log_error(expr->inner->location, E_DEREFERENCE_NON_POINTER, "Cannot dereference non-pointer type " + operand_type->to_string() + ".");
+        logger.log_error(expr->inner->location, E_DEREFERENCE_NON_POINTER, "Cannot dereference non-pointer type " + operand_type->to_string() + ".");
         // If the operator is `->`, we can give a more specific error message
         if (expr->op.tok_type == TOK_ARROW) {
-            ErrorLogger::inst().log_note(expr->op.location, "Did you mean to use '.' instead of '->'?");
+            logger.log_note(expr->op.location, "Did you mean to use '.' instead of '->'?");
         }
         throw LocalTypeException();
     }
@@ -546,55 +932,90 @@ std::any LocalChecker::visit_dereference_expr(Expr::Dereference* expr) {
     return expr->type;
 }
 
-std::any LocalChecker::visit_access_expr(Expr::Access* expr) {
-    auto left_type = std::any_cast<std::shared_ptr<Type>>(expr->left->accept(this));
+std::shared_ptr<Type> LocalChecker::visit_access_expr(Expr::Access* expr) {
+    auto left_type = expr->left->accept(this);
+
+    // Arrays and slices have a single member: their length
+    if (IS_TYPE(left_type, Type::Array) || IS_TYPE(left_type, Type::Slice)) {
+        if (expr->ident.lexeme != "len" || expr->op.tok_type != TOK_DOT) {
+            logger.log_error(expr->ident.location, E_INVALID_STRUCT_MEMBER, "Type " + left_type->to_string() + " does not have member " + expr->ident.lexeme + ".");
+            logger.log_note(expr->ident.location, "Arrays and slices only have the member `len`.");
+            throw LocalTypeException();
+        }
+        expr->type = environment.get_type("i64");
+        return expr->type;
+    }
 
     // The left side of the access must be a struct type
     auto left_seg_type = std::dynamic_pointer_cast<Type::Named>(left_type);
     if (left_seg_type == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_ACCESS_ON_NON_STRUCT, "Cannot access member of non-struct type.");
+        logger.log_error(expr->location, E_ACCESS_ON_NON_STRUCT, "Cannot access member of non-struct type.");
         // If the left side is a pointer, but the operator is `.`, we can give a more specific error message
         if (IS_TYPE(left_type, Type::Pointer) && expr->op.tok_type == TOK_DOT) {
-            ErrorLogger::inst().log_note(expr->op.location, "Did you mean to use '->' instead of '.'?");
+            logger.log_note(expr->op.location, "Did you mean to use '->' instead of '.'?");
         }
         throw LocalTypeException();
     }
 
     // The right side of the access is an identifier
-    auto decl = Environment::inst().get_instance_variable(left_seg_type, expr->ident.lexeme);
-    if (decl != nullptr) {
+    auto struct_scope = left_seg_type->struct_scope;
+    int member_index = struct_scope->instance_members.get_index(expr->ident.lexeme);
+    if (member_index != -1) {
         // The type of the expression is the type of the instance variable
-        expr->type = decl->type;
+        expr->member_index = member_index;
+        expr->type = struct_scope->instance_members.get_pair_at(member_index).second->type;
         return expr->type;
     }
     // If the instance variable is not found, check static variables
-    auto struct_scope = left_seg_type->struct_scope;
-    auto static_var_iter = struct_scope->children.find(expr->ident.lexeme);
+    auto static_var_iter = struct_scope->children.find(expr->ident.symbol);
     if (static_var_iter != struct_scope->children.end()) {
         auto static_var = std::dynamic_pointer_cast<Node::Variable>(static_var_iter->second);
+        expr->static_member = static_var;
         expr->type = static_var->decl->type;
         return expr->type;
     }
 
-    ErrorLogger::inst().log_error(expr->ident.location, E_INVALID_STRUCT_MEMBER, "Struct type " + left_seg_type->to_string() + " does not have member " + expr->ident.lexeme + ".");
+    logger.log_error(expr->ident.location, E_INVALID_STRUCT_MEMBER, "Struct type " + left_seg_type->to_string() + " does not have member " + expr->ident.lexeme + ".");
     throw LocalTypeException();
 }
 
-std::any LocalChecker::visit_index_expr(Expr::Index* expr) {
-    auto left_type = std::any_cast<std::shared_ptr<Type>>(expr->left->accept(this));
+std::shared_ptr<Type> LocalChecker::visit_index_expr(Expr::Index* expr) {
+    auto left_type = expr->left->accept(this);
 
-    // First, handle the case where expr is an array
+    // First, handle the case where expr is an array or a slice
     auto left_arr_type = std::dynamic_pointer_cast<Type::Array>(left_type);
-    if (left_arr_type != nullptr) {
+    auto left_slice_type = std::dynamic_pointer_cast<Type::Slice>(left_type);
+    if (left_arr_type != nullptr || left_slice_type != nullptr) {
         // The index must be an integer
-        auto index_type = std::any_cast<std::shared_ptr<Type>>(expr->right->accept(this));
-        if (index_type != nullptr && index_type->to_string() != "::i32") {
-            ErrorLogger::inst().log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot index array with type " + index_type->to_string() + ". Expected type 'i32'.");
+        auto index_type = expr->right->accept(this);
+        if (index_type != nullptr && !index_type->is_int()) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot index " + left_type->to_string() + " with type " + index_type->to_string() + ". Expected an integer type.");
             throw LocalTypeException();
         }
 
-        // The type of the expression is the type of the array elements
-        expr->type = left_arr_type->inner_type;
+        // The type of the expression is the type of the elements
+        expr->type = left_arr_type != nullptr ? left_arr_type->inner_type : left_slice_type->inner_type;
+        expr->in_bounds = is_in_bounds(expr);
+        return expr->type;
+    }
+
+    // Then, handle the case where expr is a lane of a vector
+    auto left_vector_type = std::dynamic_pointer_cast<Type::Vector>(left_type);
+    if (left_vector_type != nullptr) {
+        // The index must be an integer
+        auto index_type = expr->right->accept(this);
+        if (!index_type->is_int()) {
+            logger.log_error(expr->location, E_INCOMPATIBLE_TYPES, "Cannot index " + left_type->to_string() + " with type " + index_type->to_string() + ". Expected an integer type.");
+            throw LocalTypeException();
+        }
+        // The number of lanes is part of the type, so a constant lane can be checked now
+        auto lane = int_literal_value(expr->right.get());
+        if (lane.has_value() && (*lane < 0 || *lane >= left_vector_type->size)) {
+            logger.log_error(expr->right->location, E_LANE_OUT_OF_RANGE, "Lane " + std::to_string(*lane) + " is out of range for vector of " + std::to_string(left_vector_type->size) + " lanes.");
+            throw LocalTypeException();
+        }
+        expr->type = left_vector_type->inner_type;
+        expr->in_bounds = is_in_bounds(expr);
         return expr->type;
     }
 
@@ -605,12 +1026,12 @@ std::any LocalChecker::visit_index_expr(Expr::Index* expr) {
         auto index_expr = std::dynamic_pointer_cast<Expr::Literal>(expr->right);
         // A literal is required to verify the type at compile time
         if (index_expr == nullptr || index_expr->token.tok_type != TOK_INT) {
-            ErrorLogger::inst().log_error(expr->right->location, E_NO_LITERAL_INDEX_ON_TUPLE, "Tuple index must be a literal integer.");
+            logger.log_error(expr->right->location, E_NO_LITERAL_INDEX_ON_TUPLE, "Tuple index must be a literal integer.");
             throw LocalTypeException();
         }
         auto index = std::any_cast<int>(index_expr->token.literal);
         if (index < 0 || index >= left_tuple_type->element_types.size()) {
-            ErrorLogger::inst().log_error(expr->location, E_TUPLE_INDEX_OUT_OF_RANGE, "Index out of range for tuple of size " + std::to_string(left_tuple_type->element_types.size()) + ".");
+            logger.log_error(expr->location, E_TUPLE_INDEX_OUT_OF_RANGE, "Index out of range for tuple of size " + std::to_string(left_tuple_type->element_types.size()) + ".");
             throw LocalTypeException();
         }
         expr->type = left_tuple_type->element_types[index];
@@ -618,15 +1039,79 @@ std::any LocalChecker::visit_index_expr(Expr::Index* expr) {
     }
 
     // If neither of the above cases are true, the expression is invalid
-    ErrorLogger::inst().log_error(expr->location, E_INDEX_ON_NON_ARRAY, "Subscript operator can only be used on arrays and tuples.");
+    logger.log_error(expr->location, E_INDEX_ON_NON_ARRAY, "Subscript operator can only be used on arrays, slices, vectors, and tuples.");
     throw LocalTypeException();
 }
 
-std::any LocalChecker::visit_call_expr(Expr::Call* expr) {
+std::shared_ptr<Type> LocalChecker::visit_slice_expr(Expr::Slice* expr) {
+    auto left_type = expr->left->accept(this);
+
+    // Find the type of the elements being viewed
+    std::shared_ptr<Type> inner_type = nullptr;
+    if (auto array_type = std::dynamic_pointer_cast<Type::Array>(left_type)) {
+        // A slice of a temporary array would outlive it
+        if (!IS_TYPE(expr->left, Expr::LValue)) {
+            logger.log_error(expr->location, E_INVALID_SLICE, "Cannot slice a temporary array.");
+            logger.log_note(expr->left->location, "Store the array in a variable first.");
+            throw LocalTypeException();
+        }
+        inner_type = array_type->inner_type;
+    } else if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(left_type)) {
+        inner_type = slice_type->inner_type;
+    } else if (auto ptr_type = std::dynamic_pointer_cast<Type::Pointer>(left_type)) {
+        // The number of elements behind a pointer is not known
+        if (expr->end == nullptr) {
+            logger.log_error(expr->location, E_INVALID_SLICE, "A slice of a pointer must have an end.");
+            throw LocalTypeException();
+        }
+        inner_type = ptr_type->inner_type;
+    } else {
+        logger.log_error(expr->location, E_INVALID_SLICE, "Cannot slice type " + left_type->to_string() + ". Expected an array, a slice, or a pointer.");
+        throw LocalTypeException();
+    }
+
+    // The bounds must be integers
+    for (auto& bound : {expr->start, expr->end}) {
+        if (bound == nullptr) {
+            continue;
+        }
+        auto bound_type = bound->accept(this);
+        if (!bound_type->is_int()) {
+            logger.log_error(bound->location, E_INCOMPATIBLE_TYPES, "Cannot use type " + bound_type->to_string() + " as a slice bound. Expected an integer type.");
+            throw LocalTypeException();
+        }
+    }
+
+    // The slice may modify the elements only if the original could
+    auto result_type = std::make_shared<Type::Slice>(inner_type);
+    result_type->declarer = view_declarer(expr->left.get());
+    expr->type = result_type;
+    return expr->type;
+}
+
+std::shared_ptr<Type> LocalChecker::visit_call_expr(Expr::Call* expr) {
+    // Builtins such as `vec::sum` are not functions; each checks its own arguments
+    expr->builtin = find_builtin(expr);
+    // The `bits::` builtins come after the `vec::` ones
+    if (expr->builtin >= Expr::Call::Builtin::BITS_COUNT_ONES) {
+        expr->type = check_bits_builtin(expr);
+        return expr->type;
+    }
+    if (expr->builtin != Expr::Call::Builtin::NONE) {
+        expr->type = check_vector_builtin(expr);
+        return expr->type;
+    }
+    // A call to an enum variant constructs a value of the enum with the arguments as its payload
+    auto variant_type = check_variant_call(expr);
+    if (variant_type != nullptr) {
+        expr->type = variant_type;
+        return expr->type;
+    }
+
     // The left side of the call expression must be callable; i.e. a function pointer type
-    auto left_type = std::any_cast<std::shared_ptr<Type>>(expr->callee->accept(this));
+    auto left_type = expr->callee->accept(this);
     if (!IS_TYPE(left_type, Type::Function)) {
-        ErrorLogger::inst().log_error(expr->location, E_CALL_ON_NON_FUN, "Expression is not callable.");
+        logger.log_error(expr->location, E_CALL_ON_NON_FUN, "Expression is not callable.");
         throw LocalTypeException();
     }
     auto fun_type = std::dynamic_pointer_cast<Type::Function>(left_type);
@@ -634,21 +1119,31 @@ std::any LocalChecker::visit_call_expr(Expr::Call* expr) {
     // First, the number of arguments must match the number of parameters
     // If the function is variadic, the number of arguments must be greater than or equal to the number of parameters
     if (!fun_type->is_variadic && expr->arguments.size() != fun_type->params.size()) {
-        ErrorLogger::inst().log_error(expr->location, E_INVALID_ARITY, "Expected " + std::to_string(fun_type->params.size()) + " arguments, found " + std::to_string(expr->arguments.size()) + ".");
+        logger.log_error(expr->location, E_INVALID_ARITY, "Expected " + std::to_string(fun_type->params.size()) + " arguments, found " + std::to_string(expr->arguments.size()) + ".");
         throw LocalTypeException();
     } else if (fun_type->is_variadic && expr->arguments.size() < fun_type->params.size()) {
-        ErrorLogger::inst().log_error(expr->location, E_INVALID_ARITY, "Expected at least " + std::to_string(fun_type->params.size() - 1) + " arguments, found " + std::to_string(expr->arguments.size()) + ".");
+        logger.log_error(expr->location, E_INVALID_ARITY, "Expected at least " + std::to_string(fun_type->params.size() - 1) + " arguments, found " + std::to_string(expr->arguments.size()) + ".");
         throw LocalTypeException();
     }
 
     // Then, the types of the arguments must match the types of the parameters
     for (unsigned i = 0; i < expr->arguments.size(); i++) {
         // All arguments must be visited to ensure that the types are resolved
-        auto arg_type = std::any_cast<std::shared_ptr<Type>>(expr->arguments[i]->accept(this));
+        auto arg_type = expr->arguments[i]->accept(this);
         // We add a range check here in case the function is variadic
         // If there are more args than params, the extra args will be visited, but not compared against any params
-        if (i < fun_type->params.size() && Type::are_compatible(arg_type, fun_type->params[i].second) != 0) {
-            ErrorLogger::inst().log_error(expr->arguments[i]->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + arg_type->to_string() + " to " + fun_type->params[i].second->to_string() + ".");
+        if (i >= fun_type->params.size()) {
+            continue;
+        }
+        // The parameter is assigned the argument; copy the type, since the check may resolve it.
+        auto param_type = fun_type->params[i].second;
+        if (Type::are_compatible(param_type, arg_type) != 0) {
+            logger.log_error(expr->arguments[i]->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + arg_type->to_string() + " to " + fun_type->params[i].second->to_string() + ".");
+            throw LocalTypeException();
+        }
+        // A non-const slice parameter cannot view const elements
+        if (param_type->kind() == Type::Kind::SLICE && fun_type->params[i].first != KW_CONST && view_declarer(expr->arguments[i].get()) == KW_CONST) {
+            logger.log_error(expr->arguments[i]->location, E_INVALID_PTR_DECLARER, "Cannot pass a const view as a non-const slice.");
             throw LocalTypeException();
         }
     }
@@ -658,12 +1153,262 @@ std::any LocalChecker::visit_call_expr(Expr::Call* expr) {
     return expr->type;
 }
 
-std::any LocalChecker::visit_cast_expr(Expr::Cast* expr) {
-    auto left_type = std::any_cast<std::shared_ptr<Type>>(expr->expression->accept(this));
-    auto target_type = Environment::inst().get_type(expr->annotation);
+std::shared_ptr<Type> LocalChecker::check_variant_call(Expr::Call* expr) {
+    auto identifier = std::dynamic_pointer_cast<Expr::Identifier>(expr->callee);
+    if (identifier == nullptr || !identifier->type_args.empty() || environment.get_variable(identifier->tokens) != nullptr) {
+        return nullptr;
+    }
+    auto [enum_decl, variant_index] = environment.get_variant(identifier->tokens);
+    if (enum_decl == nullptr) {
+        return nullptr;
+    }
+    auto& variant = enum_decl->variants[variant_index];
+    // A payload type that did not resolve has been reported by the global checker
+    if (variant.payload.size() != variant.payload_annotations.size()) {
+        throw LocalTypeException();
+    }
+    if (expr->arguments.size() != variant.payload.size()) {
+        logger.log_error(expr->location, E_INVALID_ARITY, "Expected " + std::to_string(variant.payload.size()) + " arguments, found " + std::to_string(expr->arguments.size()) + ".");
+        throw LocalTypeException();
+    }
+    for (size_t i = 0; i < expr->arguments.size(); i++) {
+        auto arg_type = expr->arguments[i]->accept(this);
+        if (Type::are_compatible(variant.payload[i], arg_type) != 0) {
+            logger.log_error(expr->arguments[i]->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + arg_type->to_string() + " to " + variant.payload[i]->to_string() + ".");
+            throw LocalTypeException();
+        }
+    }
+    // The callee is never visited; it names no variable
+    identifier->variant = variant_index;
+    identifier->type = enum_decl->enum_type;
+    expr->variant = variant_index;
+    return enum_decl->enum_type;
+}
+
+Expr::Call::Builtin LocalChecker::find_builtin(Expr::Call* expr) {
+    using Builtin = Expr::Call::Builtin;
+    static const std::unordered_map<std::string, Builtin> builtins = {
+        {"vec::load", Builtin::VEC_LOAD},
+        {"vec::store", Builtin::VEC_STORE},
+        {"vec::shuffle", Builtin::VEC_SHUFFLE},
+        {"vec::select", Builtin::VEC_SELECT},
+        {"vec::sum", Builtin::VEC_SUM},
+        {"vec::product", Builtin::VEC_PRODUCT},
+        {"vec::min", Builtin::VEC_MIN},
+        {"vec::max", Builtin::VEC_MAX},
+        {"vec::all", Builtin::VEC_ALL},
+        {"vec::any", Builtin::VEC_ANY},
+        {"bits::count_ones", Builtin::BITS_COUNT_ONES},
+        {"bits::leading_zeros", Builtin::BITS_LEADING_ZEROS},
+        {"bits::trailing_zeros", Builtin::BITS_TRAILING_ZEROS},
+        {"bits::swap_bytes", Builtin::BITS_SWAP_BYTES},
+    };
+
+    auto identifier = dynamic_cast<Expr::Identifier*>(expr->callee.get());
+    if (identifier == nullptr || !identifier->type_args.empty() || identifier->tokens.size() != 2) {
+        return Builtin::NONE;
+    }
+    auto iter = builtins.find(identifier->tokens[0].lexeme + "::" + identifier->tokens[1].lexeme);
+    if (iter == builtins.end() || environment.get_variable(identifier->tokens) != nullptr) {
+        return Builtin::NONE;
+    }
+    return iter->second;
+}
+
+std::shared_ptr<Type> LocalChecker::check_bits_builtin(Expr::Call* expr) {
+    // Only identifiers name builtins
+    auto name = dynamic_cast<Expr::Identifier*>(expr->callee.get())->to_string();
+    if (expr->arguments.size() != 1) {
+        logger.log_error(expr->location, E_INVALID_ARITY, "Expected 1 argument to `" + name + "`, found " + std::to_string(expr->arguments.size()) + ".");
+        throw LocalTypeException();
+    }
+    // The result has the type of the argument, so that it combines with it without a cast
+    auto arg_type = expr->arguments[0]->accept(this);
+    if (!lane_type(arg_type)->is_int()) {
+        logger.log_error(expr->arguments[0]->location, E_INCOMPATIBLE_TYPES, "Cannot pass type " + arg_type->to_string() + " to `" + name + "`. Expected an int or a vector of ints.");
+        throw LocalTypeException();
+    }
+    return arg_type;
+}
+
+std::shared_ptr<Type> LocalChecker::check_vector_builtin(Expr::Call* expr) {
+    using Builtin = Expr::Call::Builtin;
+    // Only identifiers name builtins
+    auto name = dynamic_cast<Expr::Identifier*>(expr->callee.get())->to_string();
+    auto& args = expr->arguments;
+
+    // Check the number of arguments before looking at any of them
+    size_t min_arity = 1;
+    size_t max_arity = 1;
+    if (expr->builtin == Builtin::VEC_LOAD || expr->builtin == Builtin::VEC_SELECT) {
+        min_arity = max_arity = 3;
+    } else if (expr->builtin == Builtin::VEC_STORE) {
+        min_arity = 3;
+        max_arity = 4;
+    } else if (expr->builtin == Builtin::VEC_SHUFFLE) {
+        min_arity = 2;
+        max_arity = 3;
+    }
+    if (args.size() < min_arity || args.size() > max_arity) {
+        auto expected = min_arity == max_arity ? std::to_string(min_arity) : std::to_string(min_arity) + " or " + std::to_string(max_arity);
+        logger.log_error(expr->location, E_INVALID_ARITY, "Expected " + expected + " arguments to `" + name + "`, found " + std::to_string(args.size()) + ".");
+        throw LocalTypeException();
+    }
+
+    std::vector<std::shared_ptr<Type>> arg_types;
+    for (auto& argument : args) {
+        arg_types.push_back(argument->accept(this));
+    }
+    auto reject = [&](size_t i, const std::string& expected) {
+        logger.log_error(args[i]->location, E_INCOMPATIBLE_TYPES, "Cannot pass type " + arg_types[i]->to_string() + " to `" + name + "`. Expected " + expected + ".");
+        throw LocalTypeException();
+    };
+    auto vector_arg = [&](size_t i) {
+        auto vector_type = std::dynamic_pointer_cast<Type::Vector>(arg_types[i]);
+        if (vector_type == nullptr) {
+            reject(i, "a vector");
+        }
+        return vector_type;
+    };
+    // A mask has one bool per lane of the vector it applies to; -1 accepts any number of lanes.
+    auto mask_arg = [&](size_t i, int lanes) {
+        auto mask_type = std::dynamic_pointer_cast<Type::Vector>(arg_types[i]);
+        if (mask_type == nullptr || mask_type->inner_type->to_string() != "::bool" || (lanes != -1 && mask_type->size != lanes)) {
+            reject(i, lanes == -1 ? "a vector of bools" : "vec<::bool, " + std::to_string(lanes) + ">");
+        }
+        return mask_type;
+    };
+
+    switch (expr->builtin) {
+    case Builtin::VEC_LOAD:
+    case Builtin::VEC_STORE: {
+        // The lanes are read from or written to the elements in place, which must be numbers laid out like the lanes
+        std::shared_ptr<Type> element_type = nullptr;
+        if (auto array_type = std::dynamic_pointer_cast<Type::Array>(arg_types[0])) {
+            element_type = array_type->inner_type;
+        } else if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(arg_types[0])) {
+            element_type = slice_type->inner_type;
+        }
+        if (element_type == nullptr || !element_type->is_numeric()) {
+            reject(0, "an array or slice of int or float");
+        }
+        if (!arg_types[1]->is_int()) {
+            reject(1, "an integer start");
+        }
+        if (expr->builtin == Builtin::VEC_LOAD) {
+            return std::make_shared<Type::Vector>(element_type, mask_arg(2, -1)->size);
+        }
+        auto value_type = vector_arg(2);
+        if (value_type->inner_type->to_string() != element_type->to_string()) {
+            reject(2, "a vector of " + element_type->to_string());
+        }
+        if (args.size() == 4) {
+            mask_arg(3, value_type->size);
+        }
+        if (view_declarer(args[0].get()) == KW_CONST) {
+            logger.log_error(args[0]->location, E_ASSIGN_TO_CONST, "Cannot store to the elements of a const " + arg_types[0]->to_string() + ".");
+            throw LocalTypeException();
+        }
+        return environment.get_type("void");
+    }
+    case Builtin::VEC_SHUFFLE: {
+        auto source_type = vector_arg(0);
+        int source_lanes = source_type->size;
+        if (args.size() == 3) {
+            // The lanes of the second vector are numbered after those of the first
+            if (vector_arg(1)->to_string() != source_type->to_string()) {
+                reject(1, source_type->to_string());
+            }
+            source_lanes *= 2;
+        }
+        // The lanes are picked at compile time, so they must be literals
+        auto lanes = dynamic_cast<Expr::Array*>(strip_groupings(args.back().get()));
+        if (lanes == nullptr || lanes->elements.empty()) {
+            logger.log_error(args.back()->location, E_INVALID_SHUFFLE, "The lanes of `" + name + "` must be a literal array of integers.");
+            throw LocalTypeException();
+        }
+        for (auto& element : lanes->elements) {
+            auto lane = int_literal_value(element.get());
+            if (!lane.has_value()) {
+                logger.log_error(element->location, E_INVALID_SHUFFLE, "The lanes of `" + name + "` must be a literal array of integers.");
+                throw LocalTypeException();
+            }
+            if (*lane < 0 || *lane >= source_lanes) {
+                logger.log_error(element->location, E_LANE_OUT_OF_RANGE, "Lane " + std::to_string(*lane) + " is out of range for shuffling " + std::to_string(source_lanes) + " lanes.");
+                throw LocalTypeException();
+            }
+        }
+        return std::make_shared<Type::Vector>(source_type->inner_type, (int)lanes->elements.size());
+    }
+    case Builtin::VEC_SELECT: {
+        auto mask_type = mask_arg(0, -1);
+        auto value_type = vector_arg(1);
+        if (value_type->size != mask_type->size) {
+            reject(1, "a vector of " + std::to_string(mask_type->size) + " lanes");
+        }
+        if (vector_arg(2)->to_string() != value_type->to_string()) {
+            reject(2, value_type->to_string());
+        }
+        return value_type;
+    }
+    case Builtin::VEC_SUM:
+    case Builtin::VEC_PRODUCT:
+    case Builtin::VEC_MIN:
+    case Builtin::VEC_MAX: {
+        auto value_type = vector_arg(0);
+        if (!value_type->inner_type->is_numeric()) {
+            reject(0, "a vector of int or float");
+        }
+        return value_type->inner_type;
+    }
+    case Builtin::VEC_ALL:
+    case Builtin::VEC_ANY:
+        return mask_arg(0, -1)->inner_type;
+    default:
+        logger.log_error(expr->location, E_UNREACHABLE, "Unknown builtin `" + name + "`.");
+        throw LocalTypeException();
+    }
+}
+
+std::shared_ptr<Type> LocalChecker::visit_cast_expr(Expr::Cast* expr) {
+    auto left_type = expr->expression->accept(this);
+    auto target_type = environment.get_type(expr->annotation);
+
+    auto left_vector_type = std::dynamic_pointer_cast<Type::Vector>(left_type);
+    auto target_vector_type = std::dynamic_pointer_cast<Type::Vector>(target_type);
+    auto left_array_type = std::dynamic_pointer_cast<Type::Array>(left_type);
+    auto target_array_type = std::dynamic_pointer_cast<Type::Array>(target_type);
 
     // We'll let the code generator handle the specifics of the cast
-    if (left_type->is_numeric() && target_type->is_numeric()) {
+    if (left_array_type != nullptr && target_vector_type != nullptr) {
+        // An array of as many elements as there are lanes is loaded into a vector
+        if (left_array_type->size != target_vector_type->size || left_array_type->inner_type->to_string() != target_vector_type->inner_type->to_string()) {
+            logger.log_error(expr->location, E_INVALID_CAST, "Cannot cast from " + left_type->to_string() + " to " + target_type->to_string() + ". Expected an array of the same element type and size.");
+            throw LocalTypeException();
+        }
+        expr->type = target_type;
+    } else if (left_vector_type != nullptr && target_array_type != nullptr) {
+        // A vector is stored into an array of as many elements as there are lanes
+        if (target_array_type->size != left_vector_type->size || target_array_type->inner_type->to_string() != left_vector_type->inner_type->to_string()) {
+            logger.log_error(expr->location, E_INVALID_CAST, "Cannot cast from " + left_type->to_string() + " to " + target_type->to_string() + ". Expected an array of the same element type and size.");
+            throw LocalTypeException();
+        }
+        expr->type = target_type;
+    } else if (target_vector_type != nullptr) {
+        // Vectors are cast lane by lane, like scalars of their lane type; a scalar is cast and then fills every lane
+        if (left_vector_type != nullptr && left_vector_type->size != target_vector_type->size) {
+            logger.log_error(expr->location, E_INVALID_CAST, "Cannot cast from " + left_type->to_string() + " to " + target_type->to_string() + ". Expected the same number of lanes.");
+            throw LocalTypeException();
+        }
+        auto from = lane_type(left_type);
+        auto to = target_vector_type->inner_type;
+        bool is_same = from->to_string() == to->to_string();
+        if (!is_same && !(from->is_numeric() && (to->is_numeric() || to->to_string() == "::bool"))) {
+            logger.log_error(expr->location, E_INVALID_CAST, "Cannot cast from " + left_type->to_string() + " to " + target_type->to_string() + ".");
+            throw LocalTypeException();
+        }
+        expr->type = target_type;
+    } else if (left_type->is_numeric() && target_type->is_numeric()) {
         // If both types are numeric, the cast is allowed
         expr->type = target_type;
     } else if ((left_type->is_numeric() || left_type->kind() == Type::Kind::POINTER) && target_type->to_string() == "::bool") {
@@ -671,7 +1416,7 @@ std::any LocalChecker::visit_cast_expr(Expr::Cast* expr) {
         expr->type = target_type;
         // This type cast allows people to check if a number is 0 or a pointer is null
     } else {
-        ErrorLogger::inst().log_error(expr->location, E_INVALID_CAST, "Cannot cast from " + left_type->to_string() + " to " + target_type->to_string() + ".");
+        logger.log_error(expr->location, E_INVALID_CAST, "Cannot cast from " + left_type->to_string() + " to " + target_type->to_string() + ".");
         throw LocalTypeException();
     }
     // Currently, no other casts are allowed
@@ -681,45 +1426,60 @@ std::any LocalChecker::visit_cast_expr(Expr::Cast* expr) {
     return expr->type;
 }
 
-std::any LocalChecker::visit_grouping_expr(Expr::Grouping* expr) {
-    expr->type = std::any_cast<std::shared_ptr<Type>>(expr->expression->accept(this));
+std::shared_ptr<Type> LocalChecker::visit_grouping_expr(Expr::Grouping* expr) {
+    expr->type = expr->expression->accept(this);
     return expr->type;
 }
 
-std::any LocalChecker::visit_identifier_expr(Expr::Identifier* expr) {
-    auto var_node = Environment::inst().get_variable(expr->tokens);
+std::shared_ptr<Type> LocalChecker::visit_identifier_expr(Expr::Identifier* expr) {
+    // An identifier with type arguments names an instance of a generic, which the global checker has already created
+    auto var_node = expr->type_args.empty() ? environment.get_variable(expr->tokens) : environment.get_variable(environment.get_path(expr));
+    // `Enum::Variant` names a value of the enum instead of a variable
+    auto [enum_decl, variant_index] = var_node == nullptr && expr->type_args.empty() ? environment.get_variant(expr->tokens) : std::pair<Decl::Enum*, int>(nullptr, -1);
+    if (enum_decl != nullptr) {
+        auto& variant = enum_decl->variants[variant_index];
+        if (!variant.payload_annotations.empty()) {
+            logger.log_error(expr->location, E_INVALID_ARITY, "Variant `" + expr->to_string() + "` has a payload. Expected it to be called with " + std::to_string(variant.payload_annotations.size()) + " arguments.");
+            throw LocalTypeException();
+        }
+        expr->variant = variant_index;
+        expr->type = enum_decl->enum_type;
+        return expr->type;
+    }
     if (var_node == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_UNKNOWN_VAR, "Variable `" + expr->to_string() + "` was not declared.");
+        logger.log_error(expr->location, E_UNKNOWN_VAR, "Variable `" + expr->to_string() + "` was not declared.");
         throw LocalTypeException();
     }
+    // Remember the binding so that later passes do not have to repeat the lookup.
+    expr->variable = var_node;
     expr->type = var_node->decl->type;
     if (expr->type == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_UNKNOWN_TYPE, "Could not resolve type annotation.");
+        logger.log_error(expr->location, E_UNKNOWN_TYPE, "Could not resolve type annotation.");
         throw LocalTypeException();
     }
     return expr->type;
 }
 
-std::any LocalChecker::visit_literal_expr(Expr::Literal* expr) {
+std::shared_ptr<Type> LocalChecker::visit_literal_expr(Expr::Literal* expr) {
 
     std::shared_ptr<Type> type = nullptr;
 
     switch (expr->token.tok_type) {
     case TOK_INT:
-        type = Environment::inst().get_type("i32");
+        type = environment.get_type("i32");
         break;
     case TOK_FLOAT:
-        type = Environment::inst().get_type("f64");
+        type = environment.get_type("f64");
         break;
     case TOK_CHAR:
-        type = Environment::inst().get_type("char");
+        type = environment.get_type("char");
         break;
     case TOK_STR:
-        type = Environment::inst().get_type("char");
+        type = environment.get_type("char");
         type = std::make_shared<Type::Pointer>(type);
         break;
     case TOK_BOOL:
-        type = Environment::inst().get_type("bool");
+        type = environment.get_type("bool");
         break;
     case TOK_NIL:
         type = std::make_shared<Type::Blank>();
@@ -729,12 +1489,12 @@ std::any LocalChecker::visit_literal_expr(Expr::Literal* expr) {
         // However, when later checked for type compatibility, the type will be updated to the correct type.
         break;
     default:
-        ErrorLogger::inst().log_error(expr->location, E_UNRECOGNIZED_LITERAL, "Unknown literal type.");
+        logger.log_error(expr->location, E_UNRECOGNIZED_LITERAL, "Unknown literal type.");
         throw LocalTypeException();
     }
 
     if (type == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_IMPOSSIBLE, "Could not resolve primitive type annotation.");
+        logger.log_error(expr->location, E_IMPOSSIBLE, "Could not resolve primitive type annotation.");
         throw LocalTypeException();
     }
 
@@ -742,7 +1502,7 @@ std::any LocalChecker::visit_literal_expr(Expr::Literal* expr) {
     return type;
 }
 
-std::any LocalChecker::visit_array_expr(Expr::Array* expr) {
+std::shared_ptr<Type> LocalChecker::visit_array_expr(Expr::Array* expr) {
     // Handle the case where the array is empty
     if (expr->elements.empty()) {
         expr->type = std::make_shared<Type::Blank>();
@@ -750,12 +1510,12 @@ std::any LocalChecker::visit_array_expr(Expr::Array* expr) {
         return expr->type;
     } else {
         // Ensure all elements have the same type
-        std::shared_ptr<Type> inner_type = std::any_cast<std::shared_ptr<Type>>(expr->elements[0]->accept(this));
+        std::shared_ptr<Type> inner_type = expr->elements[0]->accept(this);
         // In the case that this element is an `auto` type, the repeated compatibility checks in the following loop will build the type until it is complete.
         for (auto& elem : expr->elements) {
-            auto elem_type = std::any_cast<std::shared_ptr<Type>>(elem->accept(this));
+            auto elem_type = elem->accept(this);
             if (Type::are_compatible(inner_type, elem_type) != 0) {
-                ErrorLogger::inst().log_error(elem->location, E_INCONSISTENT_ARRAY_TYPES, "Array elements must have the same type. Expected " + inner_type->to_string() + ", found " + elem_type->to_string() + ".");
+                logger.log_error(elem->location, E_INCONSISTENT_ARRAY_TYPES, "Array elements must have the same type. Expected " + inner_type->to_string() + ", found " + elem_type->to_string() + ".");
                 throw LocalTypeException();
             }
         }
@@ -766,24 +1526,24 @@ std::any LocalChecker::visit_array_expr(Expr::Array* expr) {
     }
 }
 
-std::any LocalChecker::visit_array_gen_expr(Expr::ArrayGen* expr) {
+std::shared_ptr<Type> LocalChecker::visit_array_gen_expr(Expr::ArrayGen* expr) {
     // The type of the array generator is the type of the elements
-    auto elem_type = std::any_cast<std::shared_ptr<Type>>(expr->generator->accept(this));
+    auto elem_type = expr->generator->accept(this);
     expr->type = std::make_shared<Type::Array>(elem_type, (int)expr->size);
     return expr->type;
 }
 
-std::any LocalChecker::visit_tuple_expr(Expr::Tuple* expr) {
+std::shared_ptr<Type> LocalChecker::visit_tuple_expr(Expr::Tuple* expr) {
     std::vector<std::shared_ptr<Type>> types;
     for (auto& elem : expr->elements) {
-        std::shared_ptr<Type> elem_type = std::any_cast<std::shared_ptr<Type>>(elem->accept(this));
+        std::shared_ptr<Type> elem_type = elem->accept(this);
         types.push_back(elem_type);
     }
     expr->type = std::make_shared<Type::Tuple>(types);
     return expr->type;
 }
 
-std::any LocalChecker::visit_object_expr(Expr::Object* expr) {
+std::shared_ptr<Type> LocalChecker::visit_object_expr(Expr::Object* expr) {
     /*
      * An object expression is valid if:
      * - The struct exists
@@ -794,21 +1554,28 @@ std::any LocalChecker::visit_object_expr(Expr::Object* expr) {
      */
 
     // Get the struct type
-    auto type = Environment::inst().get_type(expr->struct_annotation);
+    auto type = environment.get_type(expr->struct_annotation);
     auto struct_type = std::dynamic_pointer_cast<Type::Named>(type);
     if (struct_type == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_UNKNOWN_TYPE, "Struct type `" + expr->struct_annotation->to_string() + "` was not declared.");
+        logger.log_error(expr->location, E_UNKNOWN_TYPE, "Struct type `" + expr->struct_annotation->to_string() + "` was not declared.");
+        throw LocalTypeException();
+    }
+    // The values of an enum are made from its variants
+    if (struct_type->struct_scope->enum_decl != nullptr) {
+        logger.log_error(expr->location, E_UNKNOWN_TYPE, "Type `" + expr->struct_annotation->to_string() + "` is an enum, not a struct. Construct it from one of its variants.");
         throw LocalTypeException();
     }
 
     // Create a set of the required fields
     std::unordered_set<std::string> required_fields;
+    // The fields left out, whose default values were checked with the struct
+    std::unordered_set<std::string> default_fields;
     for (auto& field : struct_type->struct_scope->instance_members) {
         auto vardeclarable_decl = field.second;
         auto var_decl = dynamic_cast<Decl::Var*>(vardeclarable_decl);
         if (var_decl == nullptr) {
             // This should never happen, since all instance members are variables
-            ErrorLogger::inst().log_error(field.second->location, E_IMPOSSIBLE, "Instance member is not a variable.");
+            logger.log_error(field.second->location, E_IMPOSSIBLE, "Instance member is not a variable.");
             throw LocalTypeException();
         }
         if (var_decl->initializer == nullptr) {
@@ -817,6 +1584,7 @@ std::any LocalChecker::visit_object_expr(Expr::Object* expr) {
         } else if (!HAS_KEY(expr->fields, field.first)) {
             // If the field has a default value, and the object expression does not have that field, add the default value to the object expression
             expr->fields[field.first] = var_decl->initializer;
+            default_fields.insert(field.first);
         }
     }
 
@@ -825,9 +1593,9 @@ std::any LocalChecker::visit_object_expr(Expr::Object* expr) {
         if (!HAS_KEY(struct_type->struct_scope->instance_members, field.first)) {
             // If the field is actually a static field, we can give a more specific error message
             if (HAS_KEY(struct_type->struct_scope->children, field.first)) {
-                ErrorLogger::inst().log_error(field.second->location, E_STATIC_FIELD_IN_OBJ, "Cannot assign to static field `" + field.first + "` in object expression.");
+                logger.log_error(field.second->location, E_STATIC_FIELD_IN_OBJ, "Cannot assign to static field `" + field.first + "` in object expression.");
             } else {
-                ErrorLogger::inst().log_error(field.second->location, E_INVALID_STRUCT_MEMBER, "Struct type `" + struct_type->to_string() + "` does not have instance member `" + field.first + "`.");
+                logger.log_error(field.second->location, E_INVALID_STRUCT_MEMBER, "Struct type `" + struct_type->to_string() + "` does not have instance member `" + field.first + "`.");
             }
             throw LocalTypeException();
         }
@@ -837,21 +1605,26 @@ std::any LocalChecker::visit_object_expr(Expr::Object* expr) {
         auto field_decl = struct_type->struct_scope->instance_members.at(field.first);
         // This should always be valid, since the required fields were taken from the struct's instance members
 
-        // Check that the types of the fields match
-        auto field_type = std::any_cast<std::shared_ptr<Type>>(field.second->accept(this));
+        // Check that the types of the fields match.
+        // A default value is shared with other objects, possibly on other threads, so it is not visited again.
+        auto field_type = HAS_KEY(default_fields, field.first) ? field.second->type : field.second->accept(this);
+        if (field_type == nullptr) {
+            // The default value could not be checked, which was reported with the struct
+            throw LocalTypeException();
+        }
         if (Type::are_compatible(field_type, field_decl->type) != 0) {
-            ErrorLogger::inst().log_error(field.second->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + field_type->to_string() + " to " + field_decl->type->to_string() + ".");
-            ErrorLogger::inst().log_note(field_decl->location, "Field declared here with type " + field_decl->type->to_string() + ".");
+            logger.log_error(field.second->location, E_INCOMPATIBLE_TYPES, "Cannot convert from " + field_type->to_string() + " to " + field_decl->type->to_string() + ".");
+            logger.log_note(field_decl->location, "Field declared here with type " + field_decl->type->to_string() + ".");
             throw LocalTypeException();
         }
     }
 
     // If there are any required fields left, the object expression is invalid
     if (!required_fields.empty()) {
-        ErrorLogger::inst().log_error(expr->location, E_MISSING_FIELD_IN_OBJ, "Object expression is missing required fields.");
+        logger.log_error(expr->location, E_MISSING_FIELD_IN_OBJ, "Object expression is missing required fields.");
         for (auto& field : required_fields) {
             auto field_decl = struct_type->struct_scope->instance_members.at(field);
-            ErrorLogger::inst().log_note(field_decl->location, "This field is required.");
+            logger.log_note(field_decl->location, "This field is required.");
         }
         throw LocalTypeException();
     }
@@ -861,19 +1634,163 @@ std::any LocalChecker::visit_object_expr(Expr::Object* expr) {
     return expr->type;
 }
 
-void LocalChecker::type_check(std::vector<std::shared_ptr<Stmt>> stmts) {
-    for (auto stmt : stmts) {
+std::shared_ptr<Type> LocalChecker::visit_alloc_expr(Expr::Alloc* expr) {
+    auto type = environment.get_type(expr->annotation);
+    if (type == nullptr) {
+        logger.log_error(expr->location, E_UNKNOWN_TYPE, "Could not resolve type annotation `" + expr->annotation->to_string() + "`.");
+        throw LocalTypeException();
+    }
+    if (type->to_string() == "::void") {
+        logger.log_error(expr->location, E_INVALID_ALLOC, "Cannot allocate type " + type->to_string() + ".");
+        throw LocalTypeException();
+    }
+    if (auto nested = nested_aggregate(type)) {
+        logger.log_error(expr->location, E_INVALID_ALLOC, "Cannot allocate type " + type->to_string() + ", because it holds the aggregate " + nested->to_string() + ". Allocate the inner aggregate separately and store a pointer to it.");
+        throw LocalTypeException();
+    }
+
+    if (expr->count == nullptr) {
+        expr->type = std::make_shared<Type::Pointer>(type);
+        return expr->type;
+    }
+
+    // The number of elements is only known at runtime, so the result is a slice
+    auto count_type = expr->count->accept(this);
+    if (!count_type->is_int()) {
+        logger.log_error(expr->count->location, E_INVALID_ALLOC, "Cannot use type " + count_type->to_string() + " as the number of elements. Expected an integer type.");
+        throw LocalTypeException();
+    }
+    expr->type = std::make_shared<Type::Slice>(type);
+    return expr->type;
+}
+
+std::shared_ptr<Type> LocalChecker::visit_dealloc_expr(Expr::Dealloc* expr) {
+    auto type = expr->expression->accept(this);
+    TokenType declarer = KW_CONST;
+    if (auto ptr_type = std::dynamic_pointer_cast<Type::Pointer>(type)) {
+        declarer = ptr_type->declarer;
+    } else if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(type)) {
+        declarer = slice_type->declarer;
+    } else {
+        logger.log_error(expr->location, E_INVALID_DEALLOC, "Cannot deallocate type " + type->to_string() + ". Expected a pointer or a slice.");
+        throw LocalTypeException();
+    }
+    if (declarer != KW_VAR) {
+        logger.log_error(expr->location, E_INVALID_DEALLOC, "Cannot deallocate through a const " + type->to_string() + ".");
+        throw LocalTypeException();
+    }
+
+    expr->type = environment.get_type("void");
+    return expr->type;
+}
+
+void LocalChecker::check_stmt(const std::shared_ptr<Stmt>& stmt) {
+    try {
+        stmt->accept(this);
+    } catch (const LocalTypeException&) {
+        environment.exit_all_local_scopes();
+        loop_depth = 0;
+    } catch (const std::bad_any_cast& e) {
+        environment.exit_all_local_scopes();
+        loop_depth = 0;
+        logger.log_error(stmt->location, E_ANY_CAST, "Any cast failed in local type checking.");
+        std::cerr << e.what() << std::endl;
+    } catch (const std::exception& e) {
+        environment.exit_all_local_scopes();
+        loop_depth = 0;
+        logger.log_error(stmt->location, E_UNKNOWN, "An error occurred while type checking the statement.");
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void LocalChecker::check_struct_defaults(Decl::Struct* decl) {
+    if (!decl->type_params.empty()) {
+        for (auto& instance : decl->instances) {
+            check_struct_defaults(instance.get());
+        }
+        return;
+    }
+    environment.enter_scope(decl->name.lexeme);
+    auto struct_scope = std::dynamic_pointer_cast<Node::StructScope>(environment.get_current_scope());
+    for (auto& [name, member] : struct_scope->instance_members) {
+        auto var_decl = dynamic_cast<Decl::Var*>(member);
+        if (var_decl == nullptr || var_decl->initializer == nullptr) {
+            continue;
+        }
         try {
-            stmt->accept(this);
+            var_decl->initializer->accept(this);
         } catch (const LocalTypeException&) {
-            Environment::inst().exit_all_local_scopes();
-            loop_depth = 0;
-        } catch (const std::bad_any_cast& e) {
-            ErrorLogger::inst().log_error(stmt->location, E_ANY_CAST, "Any cast failed in local type checking.");
-            std::cerr << e.what() << std::endl;
-        } catch (const std::exception& e) {
-            ErrorLogger::inst().log_error(stmt->location, E_UNKNOWN, "An error occurred while type checking the statement.");
-            std::cerr << e.what() << std::endl;
+            // The default's type stays unknown; objects that use it are not checked further
         }
     }
+    environment.exit_scope();
+}
+
+void LocalChecker::type_check_parallel(const std::vector<std::shared_ptr<Stmt>>& stmts) {
+    // Each statement gets its own fork so that its messages can be replayed in order.
+    std::vector<std::unique_ptr<CompilationContext>> forks;
+    forks.reserve(stmts.size());
+    for (size_t i = 0; i < stmts.size(); i++) {
+        forks.push_back(std::make_unique<CompilationContext>(compilation, environment.get_global_tree()));
+    }
+
+    // Global variables may still have their types inferred here, so they are checked before any body.
+    std::vector<size_t> bodies;
+    for (size_t i = 0; i < stmts.size(); i++) {
+        auto decl_stmt = std::dynamic_pointer_cast<Stmt::Declaration>(stmts[i]);
+        if (decl_stmt != nullptr && (IS_TYPE(decl_stmt->declaration, Decl::Fun) || IS_TYPE(decl_stmt->declaration, Decl::Struct))) {
+            bodies.push_back(i);
+            continue;
+        }
+        CompilationContext::Binding binding(*forks[i]);
+        LocalChecker(*forks[i]).check_stmt(stmts[i]);
+    }
+
+    // Workers claim bodies in order until none are left.
+    std::atomic<size_t> next_body = 0;
+    auto work = [&]() {
+        for (size_t body = next_body++; body < bodies.size(); body = next_body++) {
+            auto& fork = *forks[bodies[body]];
+            CompilationContext::Binding binding(fork);
+            LocalChecker(fork).check_stmt(stmts[bodies[body]]);
+        }
+    };
+    unsigned thread_count = worker_count != 0 ? worker_count : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min<size_t>(thread_count, bodies.size());
+    std::vector<std::thread> threads;
+    // The calling thread is one of the workers.
+    for (unsigned i = 1; i < thread_count; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto& fork : forks) {
+        environment.merge(fork->get_environment());
+        logger.replay(fork->get_logger());
+    }
+}
+
+void LocalChecker::set_worker_count(unsigned count) {
+    worker_count = count;
+}
+
+void LocalChecker::type_check(std::vector<std::shared_ptr<Stmt>> stmts) {
+    // Code outside the checker (e.g. lvalue expressions) finds the compilation through the thread's binding.
+    CompilationContext::Binding binding(compilation);
+    for (auto& stmt : stmts) {
+        auto decl_stmt = std::dynamic_pointer_cast<Stmt::Declaration>(stmt);
+        if (decl_stmt != nullptr && IS_TYPE(decl_stmt->declaration, Decl::Struct)) {
+            check_struct_defaults(dynamic_cast<Decl::Struct*>(decl_stmt->declaration.get()));
+        }
+    }
+    if (worker_count != 1) {
+        type_check_parallel(stmts);
+        return;
+    }
+    for (auto& stmt : stmts) {
+        check_stmt(stmt);
+    }
 }
@@ -1,13 +1,14 @@
 #ifndef LOCAL_CHECKER_H
 #define LOCAL_CHECKER_H
 
+#include "../compiler/compilation_context.h"
 #include "../utility/decl.h"
 #include "../utility/expr.h"
 #include "../utility/stmt.h"
 #include "environment.h"
-#include <any>
 #include <exception>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -24,11 +25,50 @@ class LocalTypeException : public std::exception {};
  * Theoretically, this type checker should only have to make one pass over the code since all types are made known from the global checker.
  *
  */
-class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Visitor {
+class LocalChecker : public Stmt::Visitor<std::shared_ptr<Type>>, public Decl::Visitor<std::shared_ptr<Type>>, public Expr::Visitor<std::shared_ptr<Type>> {
+    // The compilation being checked.
+    CompilationContext& compilation;
+    // The environment of the compilation.
+    Environment& environment;
+    // The logger of the compilation.
+    ErrorLogger& logger;
+
 
     // The current depth of loops; useful for checking break and continue statements
     int loop_depth = 0;
 
+    // The end of each enclosing range loop that starts at a non-negative constant, by its loop variable.
+    // Such a loop variable is always in `[0, end)`, which proves indexes in range without a bounds check.
+    std::unordered_map<Node::Variable*, Expr*> range_ends;
+
+    // The number of threads used to check function bodies; 1 checks everything on the calling thread.
+    unsigned worker_count = 1;
+
+    /**
+     * @brief Checks a single top-level statement, recovering from any type error it contains.
+     *
+     * @param stmt The statement to check.
+     */
+    void check_stmt(const std::shared_ptr<Stmt>& stmt);
+
+    /**
+     * @brief Checks the default values of a struct's fields in the struct's scope.
+     * Every object expression that leaves a field out shares its default value, so the default is checked once, before any body.
+     *
+     * @param decl The struct declaration. A generic struct has the defaults of its instances checked.
+     */
+    void check_struct_defaults(Decl::Struct* decl);
+
+    /**
+     * @brief Checks the statements with function and struct bodies on worker threads.
+     * Every statement is checked in a fork of the environment with a buffering logger.
+     * Other statements are checked first on the calling thread, since they may complete the types that the bodies depend on.
+     * Messages are replayed in source order once all statements have been checked.
+     *
+     * @param stmts The list of statements to check.
+     */
+    void type_check_parallel(const std::vector<std::shared_ptr<Stmt>>& stmts);
+
     /**
      * @brief Checks if a token type is of a certain type.
      *
@@ -39,104 +79,186 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      */
     bool check_token(TokenType token, const std::vector<TokenType>& types) const;
 
+    /**
+     * @brief Gets whether the elements viewed by a slice, array, or pointer expression may be modified.
+     * Used to keep a const view from being converted to a non-const slice or pointer.
+     *
+     * @param expr The expression, which must already be checked.
+     * @return TokenType KW_CONST if the elements may not be modified through the expression; KW_VAR otherwise.
+     */
+    TokenType view_declarer(Expr* expr) const;
+
+    /**
+     * @brief Determines whether an array or slice index is always in range.
+     * That is the case for constant indexes into arrays of known size,
+     * and for variables of range loops that end at a constant within the array or at the length of the indexed array or const slice.
+     *
+     * @param expr The index expression, whose sides must already be checked.
+     * @return true If the index is proven in range.
+     * @return false If the index may be out of range.
+     */
+    bool is_in_bounds(Expr::Index* expr) const;
+
+    /**
+     * @brief Finds the builtin a call names, e.g. `vec::sum` or `bits::count_ones`.
+     * A name is only a builtin if no variable of that name was declared.
+     *
+     * @param expr The call expression, whose callee has not been checked yet.
+     * @return Expr::Call::Builtin The builtin, or Builtin::NONE if the callee is not one.
+     */
+    Expr::Call::Builtin find_builtin(Expr::Call* expr);
+
+    /**
+     * @brief Checks a call to an enum variant, e.g. `Shape::Circle(1.0)`, whose arguments become the payload.
+     * A name is only a variant if no variable of that name was declared.
+     *
+     * @param expr The call expression, whose callee has not been checked yet.
+     * @return std::shared_ptr<Type> The type of the enum, or nullptr if the callee is not a variant.
+     * @throws LocalTypeException If the arguments do not match the payload.
+     */
+    std::shared_ptr<Type> check_variant_call(Expr::Call* expr);
+
+    /**
+     * @brief Checks a call to one of the `vec::` builtins and determines its type.
+     * Loads and stores take the elements of an array or slice of numbers, shuffles take a literal array of lanes,
+     * and reductions take a vector of numbers, or of bools for `vec::all` and `vec::any`.
+     *
+     * @param expr The call expression, whose builtin has been found.
+     * @return std::shared_ptr<Type> The type of the call.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> check_vector_builtin(Expr::Call* expr);
+
+    /**
+     * @brief Checks a call to one of the `bits::` builtins and determines its type.
+     * Each takes an int, or a vector of ints that it applies to lane by lane, and gives a result of the same type.
+     *
+     * @param expr The call expression, whose builtin has been found.
+     * @return std::shared_ptr<Type> The type of the call.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> check_bits_builtin(Expr::Call* expr);
+
     /**
      * @brief Visits a declaration statement and determines if the declaration is valid.
      *
      * @param stmt The declaration statement to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_declaration_stmt(Stmt::Declaration* stmt) override;
+    std::shared_ptr<Type> visit_declaration_stmt(Stmt::Declaration* stmt) override;
 
     /**
      * @brief Visits an expression statement and determines if the expression is valid.
      *
      * @param stmt The expression statement to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_expression_stmt(Stmt::Expression* stmt) override;
+    std::shared_ptr<Type> visit_expression_stmt(Stmt::Expression* stmt) override;
 
     /**
      * @brief Visits a block statement and determines if the block is valid.
      *
      * @param stmt The block statement to visit.
-     * @return std::any An std::shared_ptr<Type> if the block has a return type, std::shared_ptr<Type>(nullptr) otherwise.
+     * @return std::shared_ptr<Type> The return type if the block has one, nullptr otherwise.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_block_stmt(Stmt::Block* stmt) override;
+    std::shared_ptr<Type> visit_block_stmt(Stmt::Block* stmt) override;
 
     /**
      * @brief Visits a conditional statement and determines if the condition is valid.
      *
      * @param stmt The conditional statement to visit.
-     * @return std::any An std::shared_ptr<Type> if the block has a return type, std::shared_ptr<Type>(nullptr) otherwise.
+     * @return std::shared_ptr<Type> The return type if the block has one, nullptr otherwise.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_conditional_stmt(Stmt::Conditional* stmt) override;
+    std::shared_ptr<Type> visit_conditional_stmt(Stmt::Conditional* stmt) override;
 
     /**
      * @brief Visits a loop statement and determines if the loop is valid.
      *
      * @param stmt The loop statement to visit.
-     * @return std::any An std::shared_ptr<Type> if the block has a return type, std::shared_ptr<Type>(nullptr) otherwise.
+     * @return std::shared_ptr<Type> The return type if the block has one, nullptr otherwise.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_loop_stmt(Stmt::Loop* stmt) override;
+    std::shared_ptr<Type> visit_loop_stmt(Stmt::Loop* stmt) override;
+
+    /**
+     * @brief Visits a for statement and determines if the loop is valid.
+     * The loop must iterate over a range of two integers of the same type or over an array of known size.
+     * The loop variable is declared in the scope of the body, with the type of the integers or the array elements.
+     *
+     * @param stmt The for statement to visit.
+     * @return std::shared_ptr<Type> The return type if the block has one, nullptr otherwise.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> visit_for_stmt(Stmt::For* stmt) override;
+
+    /**
+     * @brief Visits a match statement and determines if it is valid.
+     * The value must be an enum, each arm must name a different variant of it, and every variant must have an arm unless one is `_`.
+     * The bindings of an arm are declared as constants in the scope of its body, with the types of the payload fields.
+     *
+     * @param stmt The match statement to visit.
+     * @return std::shared_ptr<Type> The return type if an arm has one, nullptr otherwise.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> visit_match_stmt(Stmt::Match* stmt) override;
 
     /**
      * @brief Visits a return statement and determines if the return type is valid.
      *
      * @param stmt The return statement to visit.
-     * @return std::any The std::shared_ptr<Type> of the return type.
+     * @return std::shared_ptr<Type> The return type.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_return_stmt(Stmt::Return* stmt) override;
+    std::shared_ptr<Type> visit_return_stmt(Stmt::Return* stmt) override;
 
     /**
      * @brief Visits a break statement and determines if the break is valid.
      *
      * @param stmt The break statement to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_break_stmt(Stmt::Break* stmt) override;
+    std::shared_ptr<Type> visit_break_stmt(Stmt::Break* stmt) override;
 
     /**
      * @brief Visits a continue statement and determines if the continue is valid.
      *
      * @param stmt The continue statement to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_continue_stmt(Stmt::Continue* stmt) override;
+    std::shared_ptr<Type> visit_continue_stmt(Stmt::Continue* stmt) override;
 
     /**
      * @brief Visits an end of file statement and determines if the end of file is valid.
      *
      * @param stmt The end of file statement to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_eof_stmt(Stmt::EndOfFile* stmt) override;
+    std::shared_ptr<Type> visit_eof_stmt(Stmt::EndOfFile* stmt) override;
 
     /**
      * @brief Visits a variable declaration and determines if the initialization is valid.
      *
      * @param decl The variable declaration to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_var_decl(Decl::Var* decl) override;
+    std::shared_ptr<Type> visit_var_decl(Decl::Var* decl) override;
 
     /**
      * @brief Visits a function declaration and determines if the return type and body are valid.
      *
      * @param decl The function declaration to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_fun_decl(Decl::Fun* decl) override;
+    std::shared_ptr<Type> visit_fun_decl(Decl::Fun* decl) override;
 
     /**
      * @brief Visits an external function declaration and determines if the declaration is not in local space.
@@ -144,20 +266,29 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      *
      *
      * @param decl The external function declaration to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_extern_fun_decl(Decl::ExternFun* decl) override;
+    std::shared_ptr<Type> visit_extern_fun_decl(Decl::ExternFun* decl) override;
 
     /**
      * @brief Visits a struct declaration and determines if the struct is valid.
      * Checks if the struct is not in local space, then visits each declaration.
      *
      * @param decl The struct declaration to visit.
-     * @return std::any std::shared_ptr<Type>(nullptr) always.
+     * @return std::shared_ptr<Type> nullptr always.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_struct_decl(Decl::Struct* decl) override;
+    std::shared_ptr<Type> visit_struct_decl(Decl::Struct* decl) override;
+
+    /**
+     * @brief Visits an enum declaration, which the global checker has already checked.
+     *
+     * @param decl The enum declaration to visit.
+     * @return std::shared_ptr<Type> nullptr always.
+     * @throws LocalTypeException If the enum is declared in local scope.
+     */
+    std::shared_ptr<Type> visit_enum_decl(Decl::Enum* decl) override;
 
     /**
      * @brief Visits an assignment expression and determines if the assignment is valid.
@@ -168,7 +299,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_assign_expr(Expr::Assign* expr) override;
+    std::shared_ptr<Type> visit_assign_expr(Expr::Assign* expr) override;
 
     /**
      * @brief Visits a logical expression and determines if the logical expression is valid.
@@ -178,7 +309,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_logical_expr(Expr::Logical* expr) override;
+    std::shared_ptr<Type> visit_logical_expr(Expr::Logical* expr) override;
 
     /**
      * @brief Visits a binary expression and determines if the binary expression is valid.
@@ -188,7 +319,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_binary_expr(Expr::Binary* expr) override;
+    std::shared_ptr<Type> visit_binary_expr(Expr::Binary* expr) override;
 
     /**
      * @brief Visits a unary expression and determines if the unary expression is valid.
@@ -198,7 +329,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_unary_expr(Expr::Unary* expr) override;
+    std::shared_ptr<Type> visit_unary_expr(Expr::Unary* expr) override;
 
     /**
      * @brief Visits a dereference expression and determines if the dereference expression is valid.
@@ -208,7 +339,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_dereference_expr(Expr::Dereference* expr) override;
+    std::shared_ptr<Type> visit_dereference_expr(Expr::Dereference* expr) override;
 
     /**
      * @brief Visits an access expression and determines if the access expression is valid.
@@ -217,7 +348,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_access_expr(Expr::Access* expr) override;
+    std::shared_ptr<Type> visit_access_expr(Expr::Access* expr) override;
 
     /**
      * @brief Visits an index expression and determines if the index expression is valid.
@@ -226,7 +357,17 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_index_expr(Expr::Index* expr) override;
+    std::shared_ptr<Type> visit_index_expr(Expr::Index* expr) override;
+
+    /**
+     * @brief Visits a slice expression and determines if the slice expression is valid.
+     * Note: Arrays must be lvalues, since a slice of a temporary would outlive it, and pointers must be sliced with an end.
+     *
+     * @param expr The slice expression to visit.
+     * @return An std::shared_ptr<Type> representing the type of the expression.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> visit_slice_expr(Expr::Slice* expr) override;
 
     /**
      * @brief Visits a call expression and determines if the call expression is valid.
@@ -236,7 +377,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_call_expr(Expr::Call* expr) override;
+    std::shared_ptr<Type> visit_call_expr(Expr::Call* expr) override;
 
     /**
      * @brief Visits a cast expression and determines if the cast expression is valid.
@@ -244,10 +385,10 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * Only a few types can be casted to each other.
      *
      * @param expr The cast expression to visit.
-     * @return std::any An std::shared_ptr<Type> representing the type of the casted expression.
+     * @return std::shared_ptr<Type> A type representing the type of the casted expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_cast_expr(Expr::Cast* expr) override;
+    std::shared_ptr<Type> visit_cast_expr(Expr::Cast* expr) override;
 
     /**
      * @brief Visits a grouping expression and determines if the grouping expression is valid.
@@ -256,7 +397,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_grouping_expr(Expr::Grouping* expr) override;
+    std::shared_ptr<Type> visit_grouping_expr(Expr::Grouping* expr) override;
 
     /**
      * @brief Visits an identifier expression and determines if the identifier expression is valid.
@@ -266,7 +407,7 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_identifier_expr(Expr::Identifier* expr) override;
+    std::shared_ptr<Type> visit_identifier_expr(Expr::Identifier* expr) override;
 
     /**
      * @brief Visits a literal expression and determines if the literal expression is valid.
@@ -275,34 +416,34 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * @return An std::shared_ptr<Type> representing the type of the expression.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_literal_expr(Expr::Literal* expr) override;
+    std::shared_ptr<Type> visit_literal_expr(Expr::Literal* expr) override;
 
     /**
      * @brief Visits an array expression and determines if the array expression is valid.
      *
      * @param expr The array expression to visit.
-     * @return std::any An std::shared_ptr<Type> representing the type of the array.
+     * @return std::shared_ptr<Type> A type representing the type of the array.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_array_expr(Expr::Array* expr) override;
+    std::shared_ptr<Type> visit_array_expr(Expr::Array* expr) override;
 
     /**
      * @brief Visit an array generator expression and determine if the array generator expression is valid.
      *
      * @param expr The array generator expression to visit.
-     * @return std::any An std::shared_ptr<Type> representing the type of the array.
+     * @return std::shared_ptr<Type> A type representing the type of the array.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_array_gen_expr(Expr::ArrayGen* expr) override;
+    std::shared_ptr<Type> visit_array_gen_expr(Expr::ArrayGen* expr) override;
 
     /**
      * @brief Visits a tuple expression and determines if the tuple expression is valid.
      *
      * @param expr The tuple expression to visit.
-     * @return std::any An std::shared_ptr<Type> representing the type of the tuple.
+     * @return std::shared_ptr<Type> A type representing the type of the tuple.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_tuple_expr(Expr::Tuple* expr) override;
+    std::shared_ptr<Type> visit_tuple_expr(Expr::Tuple* expr) override;
 
     /**
      * @brief Visits an object expression and determines if the object expression is valid.
@@ -315,12 +456,56 @@ class LocalChecker : public Stmt::Visitor, public Decl::Visitor, public Expr::Vi
      * (We currently do not support default values in struct declarations, so this is not implemented yet.)
      *
      * @param expr The object expression to visit.
-     * @return std::any An std::shared_ptr<Type> representing the type of the object.
+     * @return std::shared_ptr<Type> A type representing the type of the object.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> visit_object_expr(Expr::Object* expr) override;
+
+    /**
+     * @brief Visits an alloc expression and determines if the alloc expression is valid.
+     * `alloc t` has the type `t*`, and `alloc [t; n]` has the type `[t]`; both may be written through.
+     * Note: The type must not be void, and the number of elements must be an integer.
+     *
+     * @param expr The alloc expression to visit.
+     * @return std::shared_ptr<Type> A type representing the type of the allocation.
      * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
      */
-    std::any visit_object_expr(Expr::Object* expr) override;
+    std::shared_ptr<Type> visit_alloc_expr(Expr::Alloc* expr) override;
+
+    /**
+     * @brief Visits a dealloc expression and determines if the dealloc expression is valid.
+     * Note: Only mutable pointers and slices can be deallocated; a const view never owns its memory.
+     *
+     * @param expr The dealloc expression to visit.
+     * @return std::shared_ptr<Type> The void type.
+     * @throws LocalTypeException If an error occurs during type checking. Will be caught by the type_check function.
+     */
+    std::shared_ptr<Type> visit_dealloc_expr(Expr::Dealloc* expr) override;
 
 public:
+    /**
+     * @brief Creates a local checker for the compilation bound to the calling thread.
+     *
+     */
+    LocalChecker() : LocalChecker(CompilationContext::current()) {}
+
+    /**
+     * @brief Creates a local checker for the given compilation.
+     *
+     * @param compilation The compilation to check.
+     */
+    explicit LocalChecker(CompilationContext& compilation)
+        : compilation(compilation), environment(compilation.get_environment()), logger(compilation.get_logger()) {}
+
+    /**
+     * @brief Sets the number of threads used to check function bodies.
+     * Every function and struct body only reads the global declarations, so bodies can be checked independently.
+     * Messages are reported in source order regardless of the number of threads.
+     *
+     * @param count The number of threads. 0 uses one thread per hardware thread; 1 disables parallel checking (default).
+     */
+    void set_worker_count(unsigned count);
+
     /**
      * @brief Runs the local type checker on a list of statements.
      *
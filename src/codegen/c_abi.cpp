@@ -0,0 +1,98 @@
+#include "c_abi.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/TargetParser/Triple.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// The scalars that fall into one eightbyte of an aggregate.
+struct Eightbyte {
+    // Whether any scalar in the eightbyte is an integer or a pointer.
+    bool has_integer = false;
+    // The floating-point scalars in the eightbyte.
+    std::vector<llvm::Type*> floats;
+    // The end of the last scalar, relative to the start of the eightbyte.
+    uint64_t end = 0;
+};
+
+// Records every scalar of `type`, placed at `offset`, in the eightbyte it occupies.
+// Returns false if the type contains a scalar that cannot be passed in registers.
+bool classify(const llvm::DataLayout& data_layout, llvm::Type* type, uint64_t offset, std::vector<Eightbyte>& eightbytes) {
+    if (auto struct_type = llvm::dyn_cast<llvm::StructType>(type)) {
+        auto layout = data_layout.getStructLayout(struct_type);
+        for (unsigned i = 0; i < struct_type->getNumElements(); i++) {
+            uint64_t member_offset = layout->getElementOffset(i);
+            if (!classify(data_layout, struct_type->getElementType(i), offset + member_offset, eightbytes)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (auto array_type = llvm::dyn_cast<llvm::ArrayType>(type)) {
+        auto element_size = data_layout.getTypeAllocSize(array_type->getElementType()).getFixedValue();
+        for (uint64_t i = 0; i < array_type->getNumElements(); i++) {
+            if (!classify(data_layout, array_type->getElementType(), offset + i * element_size, eightbytes)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool is_float = type->isFloatTy() || type->isDoubleTy();
+    if (!is_float && !type->isIntegerTy() && !type->isPointerTy()) {
+        return false;
+    }
+    auto& eightbyte = eightbytes[offset / 8];
+    if (is_float) {
+        eightbyte.floats.push_back(type);
+    } else {
+        eightbyte.has_integer = true;
+    }
+    eightbyte.end = std::max(eightbyte.end, offset % 8 + data_layout.getTypeStoreSize(type).getFixedValue());
+    return true;
+}
+
+} // namespace
+
+CAbi::CAbi(const llvm::Module& ir_module) : data_layout(ir_module.getDataLayout()) {
+    llvm::Triple triple(ir_module.getTargetTriple());
+    is_sysv_x86_64 = triple.getArch() == llvm::Triple::x86_64 && !triple.isOSWindows();
+}
+
+llvm::Type* CAbi::coerced_type(llvm::Type* aggregate_type) const {
+    if (!is_sysv_x86_64) {
+        return nullptr;
+    }
+    auto size = data_layout.getTypeAllocSize(aggregate_type).getFixedValue();
+    if (size == 0 || size > 16) {
+        return nullptr;
+    }
+
+    std::vector<Eightbyte> eightbytes((size + 7) / 8);
+    if (!classify(data_layout, aggregate_type, 0, eightbytes)) {
+        return nullptr;
+    }
+
+    // An eightbyte holding any integer goes in a general-purpose register; otherwise it goes in a vector register.
+    auto& context = aggregate_type->getContext();
+    std::vector<llvm::Type*> pieces;
+    for (auto& eightbyte : eightbytes) {
+        if (eightbyte.end == 0) {
+            // Only padding; C aggregates never look like this.
+            return nullptr;
+        }
+        if (eightbyte.has_integer) {
+            pieces.push_back(llvm::IntegerType::get(context, eightbyte.end * 8));
+        } else if (eightbyte.floats.size() == 2) {
+            pieces.push_back(llvm::FixedVectorType::get(llvm::Type::getFloatTy(context), 2));
+        } else {
+            pieces.push_back(eightbyte.floats[0]);
+        }
+    }
+
+    if (pieces.size() == 1) {
+        return pieces[0];
+    }
+    return llvm::StructType::get(context, pieces);
+}
@@ -0,0 +1,41 @@
+#ifndef C_ABI_H
+#define C_ABI_H
+
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Type.h"
+
+/**
+ * @brief Describes how aggregates cross the boundary of an `extern` function, following the C calling convention of the target.
+ * On System V x86-64, aggregates of up to 16 bytes are passed in registers, split into integer and floating-point pieces;
+ * larger aggregates are passed in memory (`byval` arguments and `sret` returns).
+ * Other targets currently pass every aggregate in memory.
+ *
+ */
+class CAbi {
+    // The data layout of the module the calls are generated in.
+    const llvm::DataLayout& data_layout;
+    // Whether the target follows the System V x86-64 calling convention.
+    bool is_sysv_x86_64;
+
+public:
+    /**
+     * @brief Creates the ABI description for a module.
+     * The module's target triple and data layout must already be set.
+     *
+     * @param ir_module The module the calls are generated in.
+     */
+    explicit CAbi(const llvm::Module& ir_module);
+
+    /**
+     * @brief Get the type an aggregate is coerced to when it is passed in registers.
+     * The coerced type is either a single scalar or a literal struct of two scalars, one per register.
+     * Arguments of a literal struct type are passed as one argument per element.
+     *
+     * @param aggregate_type The LLVM aggregate type.
+     * @return llvm::Type* The coerced type, or nullptr if the aggregate is passed in memory.
+     */
+    llvm::Type* coerced_type(llvm::Type* aggregate_type) const;
+};
+
+#endif // C_ABI_H
@@ -2,18 +2,121 @@
 #include "../checker/environment.h"
 #include "../logger/logger.h"
 #include "../utility/node.h"
+#include "const_evaluator.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Analysis/VectorUtils.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 #include <filesystem>
 #include <iostream>
+#include <mutex>
+
+namespace {
+
+// Creates a target machine for the host, which is what the emitter compiles for.
+std::unique_ptr<llvm::TargetMachine> create_host_target_machine() {
+    // Registering the targets is not thread-safe, and code generators may run on several threads.
+    static std::once_flag targets_initialized;
+    std::call_once(targets_initialized, []() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+    });
+    return std::unique_ptr<llvm::TargetMachine>(
+        llvm::EngineBuilder().setRelocationModel(llvm::Reloc::Model::PIC_).selectTarget()
+    );
+}
+
+// Whether an expression is a scalar whose value is known at compile time.
+// The IR builder folds these into constants without emitting instructions.
+bool is_constant_scalar(Expr* expr) {
+    if (std::dynamic_pointer_cast<Type::Aggregate>(expr->type) != nullptr) {
+        return false;
+    }
+    if (dynamic_cast<Expr::Literal*>(expr) != nullptr) {
+        return true;
+    }
+    if (auto identifier = dynamic_cast<Expr::Identifier*>(expr)) {
+        // A variant of an enum whose values are integers
+        return identifier->variant >= 0;
+    }
+    if (auto grouping = dynamic_cast<Expr::Grouping*>(expr)) {
+        return is_constant_scalar(grouping->expression.get());
+    }
+    if (auto cast = dynamic_cast<Expr::Cast*>(expr)) {
+        return is_constant_scalar(cast->expression.get());
+    }
+    if (auto unary = dynamic_cast<Expr::Unary*>(expr)) {
+        return (unary->op.tok_type == TOK_MINUS || unary->op.tok_type == TOK_BANG || unary->op.tok_type == TOK_TILDE) && is_constant_scalar(unary->inner.get());
+    }
+    return false;
+}
+
+// The number of instructions the right side of a logical operator may take to be evaluated unconditionally.
+constexpr int SPECULATION_BUDGET = 4;
+
+// The largest constant exponent, in magnitude, that a float power is multiplied out for.
+// Every multiplication rounds, so the error grows with the exponent; larger ones are left to powi.
+constexpr uint64_t MAX_MULTIPLIED_FLOAT_POWER = 4;
+
+// Whether an expression can be evaluated even when its value is not needed, within a budget of instructions.
+// Such expressions have no side effects and cannot trap, so `a and b` can become a select instead of a branch.
+bool is_speculatable(Expr* expr, int& budget) {
+    if (dynamic_cast<Expr::Literal*>(expr) != nullptr) {
+        return true;
+    }
+    if (auto grouping = dynamic_cast<Expr::Grouping*>(expr)) {
+        return is_speculatable(grouping->expression.get(), budget);
+    }
+    if (!expr->type->is_int() && !expr->type->is_float() && expr->type->to_string() != "::bool") {
+        return false;
+    }
+    if (dynamic_cast<Expr::Identifier*>(expr) != nullptr) {
+        // A load from the variable's storage, which always exists.
+        return --budget >= 0;
+    }
+    if (auto unary = dynamic_cast<Expr::Unary*>(expr)) {
+        bool is_safe = unary->op.tok_type == TOK_MINUS || unary->op.tok_type == TOK_BANG || unary->op.tok_type == TOK_TILDE;
+        return is_safe && --budget >= 0 && is_speculatable(unary->inner.get(), budget);
+    }
+    if (auto binary = dynamic_cast<Expr::Binary*>(expr)) {
+        // Division may trap, and powers may call a helper.
+        auto op = binary->op.tok_type;
+        bool is_safe = op != TOK_SLASH && op != TOK_PERCENT && op != TOK_CARET;
+        return is_safe && --budget >= 0 && is_speculatable(binary->left.get(), budget) && is_speculatable(binary->right.get(), budget);
+    }
+    if (auto logical = dynamic_cast<Expr::Logical*>(expr)) {
+        return --budget >= 0 && is_speculatable(logical->left.get(), budget) && is_speculatable(logical->right.get(), budget);
+    }
+    return false;
+}
+
+// How C passes an integer narrower than an `int`: the caller of a function extends the arguments, and the function its result.
+llvm::Attribute::AttrKind c_extension(const std::shared_ptr<Type>& type, llvm::Type* llvm_type) {
+    if (!llvm_type->isIntegerTy() || llvm_type->getIntegerBitWidth() >= 32) {
+        return llvm::Attribute::None;
+    }
+    return type->is_unsigned() || type->to_string() == "::bool" ? llvm::Attribute::ZExt : llvm::Attribute::SExt;
+}
+
+} // namespace
 
 void CodeGenerator::declare_all_structs() {
 
-    auto struct_scopes = Environment::inst().get_struct_scopes();
+    auto struct_scopes = environment.get_struct_scopes();
     // First pass: create all the struct types without bodies
     for (auto& struct_scope : struct_scopes) {
+        if (struct_scope->enum_decl != nullptr && struct_scope->enum_decl->layout != Decl::Enum::Layout::TAGGED_UNION) {
+            // Enums whose values are integers keep their integer type
+            continue;
+        }
         auto llvm_safe_name = struct_scope->unique_name;
         std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
         llvm::StructType* llvm_struct_type = llvm::StructType::create(*context, llvm_safe_name);
@@ -22,6 +125,9 @@ void CodeGenerator::declare_all_structs() {
 
     // Second pass: set the bodies of all the struct types
     for (auto& struct_scope : struct_scopes) {
+        if (struct_scope->enum_decl != nullptr) {
+            continue;
+        }
         std::vector<llvm::Type*> member_types;
 
         for (auto& [name, decl] : struct_scope->instance_members) {
@@ -32,14 +138,55 @@ void CodeGenerator::declare_all_structs() {
         auto llvm_struct_type = llvm::cast<llvm::StructType>(struct_scope->ir_type);
         llvm_struct_type->setBody(member_types);
     }
+
+    // Third pass: lay out the tagged unions.
+    // A payload holds aggregates, including other tagged unions, by pointer, so its size never depends on another layout.
+    auto& data_layout = ir_module->getDataLayout();
+    for (auto& struct_scope : struct_scopes) {
+        auto enum_decl = struct_scope->enum_decl;
+        if (enum_decl == nullptr || enum_decl->layout != Decl::Enum::Layout::TAGGED_UNION) {
+            continue;
+        }
+        // The tag is followed by the most aligned payload, padded to the size of the largest one
+        llvm::StructType* aligned_payload = llvm::StructType::get(*context);
+        uint64_t payload_size = 0;
+        for (auto& variant : enum_decl->variants) {
+            auto payload_type = get_payload_type(variant);
+            payload_size = std::max(payload_size, data_layout.getTypeAllocSize(payload_type).getFixedValue());
+            if (data_layout.getABITypeAlign(payload_type) > data_layout.getABITypeAlign(aligned_payload)) {
+                aligned_payload = payload_type;
+            }
+        }
+        std::vector<llvm::Type*> member_types = {llvm::IntegerType::get(*context, enum_decl->tag_bits()), aligned_payload};
+        uint64_t padding = payload_size - data_layout.getTypeAllocSize(aligned_payload).getFixedValue();
+        if (padding > 0) {
+            member_types.push_back(llvm::ArrayType::get(llvm::Type::getInt8Ty(*context), padding));
+        }
+        llvm::cast<llvm::StructType>(struct_scope->ir_type)->setBody(member_types);
+    }
+}
+
+llvm::StructType* CodeGenerator::get_payload_type(const Decl::Enum::Variant& variant) {
+    std::vector<llvm::Type*> field_types;
+    for (auto& field : variant.payload) {
+        field_types.push_back(field->to_llvm_type(context));
+    }
+    return llvm::StructType::get(*context, field_types);
 }
 
 void CodeGenerator::declare_all_functions() {
-    auto fun_nodes = Environment::inst().get_global_functions();
+    auto fun_nodes = environment.get_global_functions();
+
+    auto& data_layout = ir_module->getDataLayout();
+
+    // What each function may do, so LLVM can move, merge and drop calls.
+    PurityAnalyzer purity_analyzer;
+    purity_analyzer.set_bounds_check(bounds_check);
+    auto effects = purity_analyzer.analyze(fun_nodes);
 
     for (auto& fun_node : fun_nodes) {
-        // Create the function type
-        llvm::FunctionType* fun_type = llvm::cast<llvm::FunctionType>(fun_node->decl->type->to_llvm_type(context));
+        auto type = std::dynamic_pointer_cast<Type::Function>(fun_node->decl->type);
+        bool is_extern = dynamic_cast<Decl::ExternFun*>(fun_node->decl) != nullptr;
 
         auto llvm_safe_name = fun_node->unique_name;
         std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
@@ -47,33 +194,486 @@ void CodeGenerator::declare_all_functions() {
         // Create the function
         // If the declaration is an extern function, create an external function
         llvm::Function* fun;
-        if (dynamic_cast<Decl::ExternFun*>(fun_node->decl) != nullptr) {
+        if (is_extern) {
             llvm_safe_name = fun_node->decl->name.lexeme;
-            fun = llvm::Function::Create(fun_type, llvm::Function::ExternalLinkage, llvm_safe_name, ir_module.get());
+            fun = llvm::Function::Create(lower_c_function_type(*type), llvm::Function::ExternalLinkage, llvm_safe_name, ir_module.get());
+            extern_functions.insert(fun);
         } else {
+            llvm::FunctionType* fun_type = llvm::cast<llvm::FunctionType>(type->to_llvm_type(context));
             fun = llvm::Function::Create(fun_type, llvm::Function::InternalLinkage, llvm_safe_name, ir_module.get());
         }
         fun_node->llvm_allocation = fun;
+
+        // Foreign functions may do anything.
+        const FunctionEffects* fun_effects = nullptr;
+        if (!is_extern) {
+            fun_effects = &effects.at(fun_node.get());
+            add_effect_attributes(fun, *fun_effects);
+            function_effects[fun] = {fun_node.get(), *fun_effects};
+        }
+        // Without writes to shared memory, nothing can change what a constant parameter points to during the call.
+        bool is_unmodified = fun_effects != nullptr && !fun_effects->writes_memory;
+
+        if (is_extern) {
+            auto extension = c_extension(type->return_type, fun->getReturnType());
+            if (extension != llvm::Attribute::None) {
+                fun->addRetAttr(extension);
+            }
+        }
+
+        // Describe how aggregates are passed, so LLVM knows who owns which storage.
+        unsigned arg_index = 0;
+        auto aggregate_return_type = std::dynamic_pointer_cast<Type::Aggregate>(type->return_type);
+        if (aggregate_return_type != nullptr) {
+            auto llvm_return_type = aggregate_return_type->to_llvm_aggregate_type(context);
+            if (!is_extern || c_abi->coerced_type(llvm_return_type) == nullptr) {
+                fun->addParamAttr(0, llvm::Attribute::getWithStructRetType(*context, llvm_return_type));
+                fun->addParamAttr(0, llvm::Attribute::NoAlias);
+                arg_index++;
+            }
+        }
+        for (auto& [declarer, param_type] : type->params) {
+            auto aggregate_param_type = std::dynamic_pointer_cast<Type::Aggregate>(param_type);
+            if (aggregate_param_type == nullptr) {
+                auto extension = c_extension(param_type, fun->getArg(arg_index)->getType());
+                if (is_extern && extension != llvm::Attribute::None) {
+                    fun->addParamAttr(arg_index, extension);
+                }
+                // A pointer to constant memory is never written through.
+                auto pointer_param_type = std::dynamic_pointer_cast<Type::Pointer>(param_type);
+                if (!is_extern && pointer_param_type != nullptr && pointer_param_type->declarer == KW_CONST) {
+                    fun->addParamAttr(arg_index, llvm::Attribute::ReadOnly);
+                    if (is_unmodified) {
+                        fun->addParamAttr(arg_index, llvm::Attribute::NoAlias);
+                    }
+                }
+                arg_index++;
+                continue;
+            }
+            auto llvm_param_type = aggregate_param_type->to_llvm_aggregate_type(context);
+            if (is_extern) {
+                if (auto coerced_type = c_abi->coerced_type(llvm_param_type)) {
+                    // Passed in registers, one argument per piece.
+                    auto coerced_struct_type = llvm::dyn_cast<llvm::StructType>(coerced_type);
+                    arg_index += coerced_struct_type != nullptr ? coerced_struct_type->getNumElements() : 1;
+                    continue;
+                }
+            }
+            if (is_extern || declarer == KW_VAR) {
+                // The callee gets its own copy, so it may modify the aggregate without affecting the caller.
+                fun->addParamAttr(arg_index, llvm::Attribute::getWithByValType(*context, llvm_param_type));
+                fun->addParamAttr(arg_index, llvm::Attribute::getWithAlignment(*context, data_layout.getABITypeAlign(llvm_param_type)));
+            } else {
+                // A constant aggregate is never written through, so the caller's storage is passed directly.
+                fun->addParamAttr(arg_index, llvm::Attribute::ReadOnly);
+                fun->addParamAttr(arg_index, llvm::Attribute::getWithDereferenceableBytes(*context, data_layout.getTypeAllocSize(llvm_param_type).getFixedValue()));
+                if (is_unmodified) {
+                    fun->addParamAttr(arg_index, llvm::Attribute::NoAlias);
+                }
+            }
+            arg_index++;
+        }
+    }
+}
+
+void CodeGenerator::add_effect_attributes(llvm::Function* fun, const FunctionEffects& effects) {
+    if (!effects.may_unwind) {
+        fun->setDoesNotThrow();
+    }
+    if (!effects.may_not_return) {
+        fun->setWillReturn();
+    }
+    if (!effects.may_recurse) {
+        fun->setDoesNotRecurse();
+    }
+    bool reads = effects.reads_memory || effects.reads_args;
+    bool writes = effects.writes_memory || effects.writes_args;
+    if (!reads && !writes) {
+        fun->setDoesNotAccessMemory();
+        return;
+    }
+    if (!writes) {
+        fun->setOnlyReadsMemory();
+    }
+    if (!effects.reads_memory && !effects.writes_memory) {
+        fun->setOnlyAccessesArgMemory();
+    }
+}
+
+llvm::FunctionType* CodeGenerator::lower_c_function_type(const Type::Function& type) {
+    std::vector<llvm::Type*> param_types;
+    llvm::Type* return_type = type.return_type->to_llvm_type(context);
+
+    auto aggregate_return_type = std::dynamic_pointer_cast<Type::Aggregate>(type.return_type);
+    if (aggregate_return_type != nullptr) {
+        auto llvm_return_type = aggregate_return_type->to_llvm_aggregate_type(context);
+        if (auto coerced_type = c_abi->coerced_type(llvm_return_type)) {
+            return_type = coerced_type;
+        } else {
+            // Returned in memory provided by the caller.
+            return_type = llvm::Type::getVoidTy(*context);
+            param_types.push_back(llvm::PointerType::getUnqual(*context));
+        }
+    }
+
+    for (auto& [declarer, param_type] : type.params) {
+        auto aggregate_param_type = std::dynamic_pointer_cast<Type::Aggregate>(param_type);
+        llvm::Type* coerced_type = nullptr;
+        if (aggregate_param_type != nullptr) {
+            coerced_type = c_abi->coerced_type(aggregate_param_type->to_llvm_aggregate_type(context));
+        }
+        if (coerced_type == nullptr) {
+            param_types.push_back(param_type->to_llvm_type(context));
+        } else if (auto coerced_struct_type = llvm::dyn_cast<llvm::StructType>(coerced_type)) {
+            param_types.insert(param_types.end(), coerced_struct_type->element_begin(), coerced_struct_type->element_end());
+        } else {
+            param_types.push_back(coerced_type);
+        }
+    }
+
+    return llvm::FunctionType::get(return_type, param_types, type.is_variadic);
+}
+
+llvm::Value* CodeGenerator::generate_c_call(llvm::Function* fun, const Type::Function& type, Expr::Call* expr) {
+    auto& data_layout = ir_module->getDataLayout();
+    // Copies the bytes of an aggregate between its own storage and storage of its coerced type.
+    auto copy_coerced = [&](llvm::Value* destination, llvm::Type* destination_type, llvm::Value* source, llvm::Type* source_type) {
+        auto size = std::min(data_layout.getTypeAllocSize(destination_type).getFixedValue(), data_layout.getTypeAllocSize(source_type).getFixedValue());
+        builder->CreateMemCpy(destination, data_layout.getABITypeAlign(destination_type), source, data_layout.getABITypeAlign(source_type), size);
+    };
+
+    std::vector<llvm::Value*> args;
+
+    // An aggregate result is either returned in registers or written to storage provided by the caller.
+    llvm::AllocaInst* result = nullptr;
+    llvm::Type* llvm_return_type = nullptr;
+    llvm::Type* coerced_return_type = nullptr;
+    auto aggregate_return_type = std::dynamic_pointer_cast<Type::Aggregate>(type.return_type);
+    if (aggregate_return_type != nullptr) {
+        llvm_return_type = aggregate_return_type->to_llvm_aggregate_type(context);
+        result = create_temporary(llvm_return_type);
+        coerced_return_type = c_abi->coerced_type(llvm_return_type);
+        if (coerced_return_type == nullptr) {
+            args.push_back(result);
+        }
+    }
+
+    for (size_t i = 0; i < expr->arguments.size(); i++) {
+        auto value = expr->arguments[i]->accept(this);
+        if (i < type.params.size()) {
+            value = convert_implicitly(value, expr->arguments[i]->type, type.params[i].second);
+        }
+        // Variadic arguments are never aggregates in C; they are passed as they are.
+        auto aggregate_param_type = i < type.params.size() ? std::dynamic_pointer_cast<Type::Aggregate>(type.params[i].second) : nullptr;
+        if (aggregate_param_type == nullptr) {
+            args.push_back(value);
+            continue;
+        }
+
+        auto llvm_param_type = aggregate_param_type->to_llvm_aggregate_type(context);
+        auto coerced_type = c_abi->coerced_type(llvm_param_type);
+        if (coerced_type == nullptr) {
+            // Passed `byval`; the call makes the copy.
+            args.push_back(value);
+            continue;
+        }
+
+        // Passed in registers: reinterpret the aggregate as its coerced type and pass each piece.
+        auto coerced = create_entry_alloca(coerced_type, "coerced");
+        copy_coerced(coerced, coerced_type, value, llvm_param_type);
+        if (auto coerced_struct_type = llvm::dyn_cast<llvm::StructType>(coerced_type)) {
+            for (unsigned piece = 0; piece < coerced_struct_type->getNumElements(); piece++) {
+                auto piece_alloc = builder->CreateStructGEP(coerced_struct_type, coerced, piece);
+                args.push_back(builder->CreateLoad(coerced_struct_type->getElementType(piece), piece_alloc));
+            }
+        } else {
+            args.push_back(builder->CreateLoad(coerced_type, coerced));
+        }
+    }
+
+    auto call = builder->CreateCall(fun, args);
+    call->setAttributes(fun->getAttributes());
+
+    if (result == nullptr) {
+        return call;
+    }
+    if (coerced_return_type != nullptr) {
+        auto coerced = create_entry_alloca(coerced_return_type, "coerced");
+        builder->CreateStore(call, coerced);
+        copy_coerced(result, llvm_return_type, coerced, coerced_return_type);
+    }
+    return result;
+}
+
+llvm::AllocaInst* CodeGenerator::create_entry_alloca(llvm::Type* type, const std::string& name) {
+    // We are only inside a function if there is an exit block to jump to.
+    if (block_stack.empty()) {
+        logger.log_error(E_NOT_A_CONSTANT, "Aggregate values outside of functions must be constant.");
+        throw CodeGenException();
+    }
+    auto& entry_block = block_stack.front()->getParent()->getEntryBlock();
+
+    // Keep the allocas together, in order, at the start of the entry block.
+    llvm::IRBuilder<> entry_builder(*context);
+    if (last_entry_alloca != nullptr) {
+        entry_builder.SetInsertPoint(&entry_block, std::next(last_entry_alloca->getIterator()));
+    } else {
+        entry_builder.SetInsertPoint(&entry_block, entry_block.begin());
+    }
+    last_entry_alloca = entry_builder.CreateAlloca(type, nullptr, name);
+    return last_entry_alloca;
+}
+
+llvm::AllocaInst* CodeGenerator::create_temporary(llvm::Type* type, const std::string& name) {
+    auto alloca = create_entry_alloca(type, name);
+    if (!temporary_scopes.empty()) {
+        // Each iteration gets a fresh temporary; the lifetime ends with the iteration.
+        builder->CreateLifetimeStart(alloca);
+        temporary_scopes.back().push_back(alloca);
     }
+    return alloca;
+}
+
+void CodeGenerator::retain_temporary(llvm::Value* value) {
+    auto alloca = llvm::dyn_cast<llvm::AllocaInst>(value);
+    if (alloca == nullptr) {
+        return;
+    }
+    for (auto& scope : temporary_scopes) {
+        scope.erase(std::remove(scope.begin(), scope.end(), alloca), scope.end());
+    }
+}
+
+void CodeGenerator::end_temporary_scope() {
+    for (auto alloca : temporary_scopes.back()) {
+        builder->CreateLifetimeEnd(alloca);
+    }
+    temporary_scopes.pop_back();
+}
+
+void CodeGenerator::copy_aggregate(llvm::Value* destination, llvm::Value* source, const std::shared_ptr<Type::Aggregate>& type) {
+    auto llvm_type = type->to_llvm_aggregate_type(context);
+    auto& data_layout = ir_module->getDataLayout();
+    auto align = data_layout.getABITypeAlign(llvm_type);
+    builder->CreateMemCpy(destination, align, source, align, data_layout.getTypeAllocSize(llvm_type).getFixedValue());
 }
 
-std::any CodeGenerator::visit_declaration_stmt(Stmt::Declaration* stmt) {
+llvm::Constant* CodeGenerator::constant_aggregate(Expr* expr) {
+    auto aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(expr->type);
+    if (aggregate_type == nullptr) {
+        return nullptr;
+    }
+    auto llvm_type = aggregate_type->to_llvm_aggregate_type(context);
+
+    // An array generator with a constant generator repeats the same element.
+    if (auto array_gen = dynamic_cast<Expr::ArrayGen*>(expr)) {
+        if (!is_constant_scalar(array_gen->generator.get())) {
+            return nullptr;
+        }
+        auto element = llvm::cast<llvm::Constant>(array_gen->generator->accept(this));
+        auto array_type = llvm::cast<llvm::ArrayType>(llvm_type);
+        return llvm::ConstantArray::get(array_type, std::vector<llvm::Constant*>(array_type->getNumElements(), element));
+    }
+
+    std::vector<Expr*> elements;
+    if (auto array = dynamic_cast<Expr::Array*>(expr)) {
+        for (auto& element : array->elements) {
+            elements.push_back(element.get());
+        }
+    } else if (auto tuple = dynamic_cast<Expr::Tuple*>(expr)) {
+        for (auto& element : tuple->elements) {
+            elements.push_back(element.get());
+        }
+    } else if (auto object = dynamic_cast<Expr::Object*>(expr)) {
+        for (auto& [name, element] : object->fields) {
+            elements.push_back(element.get());
+        }
+    } else {
+        return nullptr;
+    }
+
+    // Check every element first, so nothing is generated for literals that are not constant.
+    for (auto element : elements) {
+        if (!is_constant_scalar(element)) {
+            return nullptr;
+        }
+    }
+    std::vector<llvm::Constant*> values;
+    values.reserve(elements.size());
+    for (auto element : elements) {
+        values.push_back(llvm::cast<llvm::Constant>(element->accept(this)));
+    }
+
+    if (auto array_type = llvm::dyn_cast<llvm::ArrayType>(llvm_type)) {
+        return llvm::ConstantArray::get(array_type, values);
+    }
+    return llvm::ConstantStruct::get(llvm::cast<llvm::StructType>(llvm_type), values);
+}
+
+llvm::GlobalVariable* CodeGenerator::create_constant_global(llvm::Constant* constant) {
+    auto global = new llvm::GlobalVariable(*ir_module, constant->getType(), true, llvm::GlobalValue::PrivateLinkage, constant, "constant");
+    global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    global->setAlignment(ir_module->getDataLayout().getABITypeAlign(constant->getType()));
+    return global;
+}
+
+llvm::Value* CodeGenerator::copy_constant_aggregate(llvm::Constant* constant, const std::shared_ptr<Type::Aggregate>& type) {
+    auto temporary = create_temporary(constant->getType());
+    copy_aggregate(temporary, create_constant_global(constant), type);
+    return temporary;
+}
+
+void CodeGenerator::defer_initializer(Decl::Var* decl, llvm::GlobalVariable* destination) {
+    auto fun_type = llvm::FunctionType::get(llvm::Type::getVoidTy(*context), false);
+    auto fun = llvm::Function::Create(fun_type, llvm::Function::InternalLinkage, destination->getName() + ".init", ir_module.get());
+
+    // The initializer is generated like the body of a function without parameters or result.
+    auto entry_block = llvm::BasicBlock::Create(*context, "entry", fun);
+    auto exit_block = llvm::BasicBlock::Create(*context, "exit", fun);
+    block_stack.push_back(exit_block);
+    builder->SetInsertPoint(entry_block);
+    last_entry_alloca = nullptr;
+    bounds_trap_block = nullptr;
+
+    llvm::Value* value = decl->initializer->accept(this);
+    auto aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(decl->initializer->type);
+    // A scalar the builder folded, e.g. `1 + 2`, needs nothing to run.
+    bool is_folded = aggregate_type == nullptr && llvm::isa<llvm::Constant>(value) && builder->GetInsertBlock() == entry_block && entry_block->empty();
+    if (is_folded) {
+        destination->setInitializer(llvm::cast<llvm::Constant>(value));
+    } else if (aggregate_type != nullptr) {
+        copy_aggregate(destination, value, aggregate_type);
+    } else {
+        builder->CreateStore(value, destination);
+    }
+    builder->CreateBr(exit_block);
+    builder->SetInsertPoint(exit_block);
+    builder->CreateRetVoid();
+
+    block_stack.clear();
+    last_entry_alloca = nullptr;
+    bounds_trap_block = nullptr;
+
+    if (is_folded) {
+        fun->eraseFromParent();
+        return;
+    }
+    pending_initializers.push_back({decl, fun, destination});
+}
+
+std::string CodeGenerator::find_compile_time_obstacle(llvm::Function* initializer, llvm::GlobalVariable* destination, const std::unordered_map<llvm::GlobalVariable*, Decl::Var*>& unevaluated) {
+    std::vector<llvm::Function*> worklist = {initializer};
+    std::unordered_set<llvm::Function*> visited = {initializer};
+    while (!worklist.empty()) {
+        auto fun = worklist.back();
+        worklist.pop_back();
+        for (auto& block : *fun) {
+            for (auto& instruction : block) {
+                for (auto& operand : instruction.operands()) {
+                    auto global = llvm::dyn_cast<llvm::GlobalVariable>(llvm::getUnderlyingObject(operand.get()));
+                    auto later = global != nullptr ? unevaluated.find(global) : unevaluated.end();
+                    if (later != unevaluated.end()) {
+                        return "reads `" + later->second->name.lexeme + "`, which is initialized after it";
+                    }
+                }
+
+                // The initializer itself may only write its result; the functions it calls are covered by their effects.
+                llvm::Value* written = nullptr;
+                if (auto store = llvm::dyn_cast<llvm::StoreInst>(&instruction)) {
+                    written = store->getPointerOperand();
+                } else if (auto transfer = llvm::dyn_cast<llvm::MemIntrinsic>(&instruction)) {
+                    written = transfer->getRawDest();
+                }
+                if (fun == initializer && written != nullptr) {
+                    auto global = llvm::dyn_cast<llvm::GlobalVariable>(llvm::getUnderlyingObject(written));
+                    if (global != nullptr && global != destination) {
+                        return "writes another global variable";
+                    }
+                }
+
+                auto call = llvm::dyn_cast<llvm::CallBase>(&instruction);
+                if (call == nullptr) {
+                    continue;
+                }
+                auto callee = call->getCalledFunction();
+                if (callee == nullptr) {
+                    return "calls a function through a pointer";
+                }
+                if (callee->isIntrinsic()) {
+                    continue;
+                }
+                if (extern_functions.count(callee) != 0) {
+                    return "calls the extern function `" + callee->getName().str() + "`";
+                }
+                if (callee->isDeclaration()) {
+                    // e.g. the C library functions behind the runtime allocator.
+                    return "calls `" + callee->getName().str() + "`, which only exists when the program runs";
+                }
+                auto effects = function_effects.find(callee);
+                if (effects != function_effects.end() && effects->second.second.writes_memory) {
+                    return "calls `" + effects->second.first->decl->name.lexeme + "`, which may write memory other than its own";
+                }
+                if (visited.insert(callee).second) {
+                    worklist.push_back(callee);
+                }
+            }
+        }
+    }
+    return "";
+}
+
+void CodeGenerator::evaluate_initializers() {
+    // Until its initializer is computed, a variable only holds zeroes.
+    std::unordered_map<llvm::GlobalVariable*, Decl::Var*> unevaluated;
+    for (auto& pending : pending_initializers) {
+        unevaluated[pending.destination] = pending.decl;
+        unevaluated[llvm::cast<llvm::GlobalVariable>(pending.decl->variable->llvm_allocation)] = pending.decl;
+    }
+
+    ConstEvaluator evaluator(*ir_module);
+    for (auto& pending : pending_initializers) {
+        auto variable = llvm::cast<llvm::GlobalVariable>(pending.decl->variable->llvm_allocation);
+        unevaluated.erase(pending.destination);
+        unevaluated.erase(variable);
+
+        const std::string& name = pending.decl->name.lexeme;
+        if (!ConstEvaluator::can_materialize(pending.destination->getValueType())) {
+            logger.log_error(pending.decl->location, E_NOT_A_CONSTANT, "The initializer of `" + name + "` cannot be computed at compile time, because it holds pointers or vectors of bools.");
+            throw CodeGenException();
+        }
+        auto obstacle = find_compile_time_obstacle(pending.initializer, pending.destination, unevaluated);
+        if (!obstacle.empty()) {
+            logger.log_error(pending.decl->location, E_NOT_A_CONSTANT, "The initializer of `" + name + "` cannot be computed at compile time, because it " + obstacle + ".");
+            throw CodeGenException();
+        }
+        auto constant = evaluator.evaluate(pending.initializer, pending.destination);
+        if (constant == nullptr) {
+            logger.log_error(pending.decl->location, E_CONST_EVAL_FAILED, "Computing the initializer of `" + name + "` at compile time " + evaluator.get_failure() + ".");
+            throw CodeGenException();
+        }
+        pending.destination->setInitializer(constant);
+        pending.initializer->eraseFromParent();
+    }
+    pending_initializers.clear();
+}
+
+llvm::Value* CodeGenerator::visit_declaration_stmt(Stmt::Declaration* stmt) {
     stmt->declaration->accept(this);
     return nullptr;
 }
 
-std::any CodeGenerator::visit_expression_stmt(Stmt::Expression* stmt) {
+llvm::Value* CodeGenerator::visit_expression_stmt(Stmt::Expression* stmt) {
     stmt->expression->accept(this);
     return nullptr;
 }
 
-std::any CodeGenerator::visit_block_stmt(Stmt::Block*) {
+llvm::Value* CodeGenerator::visit_block_stmt(Stmt::Block*) {
     // TODO: Implement block statements
     return nullptr;
 }
 
-std::any CodeGenerator::visit_conditional_stmt(Stmt::Conditional* stmt) {
-    auto condition = std::any_cast<llvm::Value*>(stmt->condition->accept(this));
+llvm::Value* CodeGenerator::visit_conditional_stmt(Stmt::Conditional* stmt) {
+    auto condition = stmt->condition->accept(this);
 
     // Create the blocks
     auto then_block = llvm::BasicBlock::Create(*context, "cond_then", block_stack.front()->getParent());
@@ -84,23 +684,19 @@ std::any CodeGenerator::visit_conditional_stmt(Stmt::Conditional* stmt) {
     builder->CreateCondBr(condition, then_block, else_block);
 
     // Generate code for the then block
-    Environment::inst().increase_local_scope();
     builder->SetInsertPoint(then_block);
     for (auto& then_stmt : stmt->then_branch) {
         then_stmt->accept(this);
     }
     builder->CreateBr(end_block);
-    Environment::inst().exit_scope();
 
     // Generate code for the else block
-    Environment::inst().increase_local_scope();
     builder->SetInsertPoint(else_block);
     for (auto& else_stmt : stmt->else_branch) {
         else_stmt->accept(this);
     }
     // If the else block is empty, the else block will just contain the branch instruction.
     builder->CreateBr(end_block);
-    Environment::inst().exit_scope();
 
     // Set the insert point to the end block
     builder->SetInsertPoint(end_block);
@@ -108,7 +704,7 @@ std::any CodeGenerator::visit_conditional_stmt(Stmt::Conditional* stmt) {
     return nullptr;
 }
 
-std::any CodeGenerator::visit_loop_stmt(Stmt::Loop* stmt) {
+llvm::Value* CodeGenerator::visit_loop_stmt(Stmt::Loop* stmt) {
     // Create the blocks
     auto start_block = llvm::BasicBlock::Create(*context, "loop_start", block_stack.front()->getParent());
     auto continue_block = llvm::BasicBlock::Create(*context, "loop_continue", block_stack.front()->getParent());
@@ -120,18 +716,20 @@ std::any CodeGenerator::visit_loop_stmt(Stmt::Loop* stmt) {
 
     // Generate code for the start block
     builder->SetInsertPoint(start_block);
+    temporary_scopes.emplace_back();
 
-    auto condition = std::any_cast<llvm::Value*>(stmt->condition->accept(this));
+    auto condition = stmt->condition->accept(this);
     builder->CreateCondBr(condition, continue_block, end_block);
 
     // Generate code for the continue block
-    Environment::inst().increase_local_scope();
     builder->SetInsertPoint(continue_block);
     for (auto& continue_stmt : stmt->body) {
         continue_stmt->accept(this);
     }
-    builder->CreateBr(start_block);
-    Environment::inst().exit_scope();
+    end_temporary_scope();
+    auto back_edge = builder->CreateBr(start_block);
+    attach_loop_hints(back_edge, stmt->hints, {start_block, continue_block}, end_block);
+    block_stack.pop_back();
 
     // Set the insert point to the end block
     builder->SetInsertPoint(end_block);
@@ -139,13 +737,192 @@ std::any CodeGenerator::visit_loop_stmt(Stmt::Loop* stmt) {
     return nullptr;
 }
 
-std::any CodeGenerator::visit_return_stmt(Stmt::Return* stmt) {
+llvm::Value* CodeGenerator::visit_match_stmt(Stmt::Match* stmt) {
+    auto enum_decl = std::dynamic_pointer_cast<Type::Named>(stmt->value->type)->struct_scope->enum_decl;
+    auto value = stmt->value->accept(this);
+    bool is_niche = enum_decl->layout == Decl::Enum::Layout::NICHE;
+
+    // The tag of a tagged union is stored before its payload; other enums are their own tag
+    llvm::Value* discriminant = value;
+    llvm::Value* payload = nullptr;
+    if (enum_decl->layout == Decl::Enum::Layout::TAGGED_UNION) {
+        auto union_type = std::dynamic_pointer_cast<Type::Struct>(stmt->value->type)->to_llvm_aggregate_type(context);
+        discriminant = builder->CreateLoad(llvm::IntegerType::get(*context, enum_decl->tag_bits()), builder->CreateStructGEP(union_type, value, 0));
+        payload = builder->CreateStructGEP(union_type, value, 1);
+    }
+
+    // Create the blocks
+    auto fun = block_stack.front()->getParent();
+    std::vector<llvm::BasicBlock*> arm_blocks;
+    std::vector<llvm::BasicBlock*> targets(enum_decl->variants.size(), nullptr);
+    for (auto& arm : stmt->arms) {
+        arm_blocks.push_back(llvm::BasicBlock::Create(*context, "match_arm", fun));
+        if (arm.variant >= 0) {
+            targets[arm.variant] = arm_blocks.back();
+        }
+    }
+    auto end_block = llvm::BasicBlock::Create(*context, "match_end", fun);
+    // The wildcard arm takes the variants without an arm of their own
+    for (size_t i = 0; i < stmt->arms.size(); i++) {
+        if (stmt->arms[i].variant < 0) {
+            for (auto& target : targets) {
+                target = target != nullptr ? target : arm_blocks[i];
+            }
+        }
+    }
+
+    // Every tag is a case, so the default is never taken and LLVM needs no range check before the jump table.
+    // A niche enum's payload variant has every value the other variants do not, so it is the default instead.
+    llvm::BasicBlock* default_block = nullptr;
+    if (is_niche) {
+        for (size_t i = 0; i < enum_decl->variants.size(); i++) {
+            if (!enum_decl->variants[i].payload.empty()) {
+                default_block = targets[i];
+            }
+        }
+    } else {
+        default_block = llvm::BasicBlock::Create(*context, "match_unreachable", fun);
+        llvm::IRBuilder<> unreachable_builder(default_block);
+        unreachable_builder.CreateUnreachable();
+    }
+    auto switch_inst = builder->CreateSwitch(discriminant, default_block, enum_decl->variants.size());
+    auto tag_type = llvm::cast<llvm::IntegerType>(discriminant->getType());
+    for (size_t i = 0; i < enum_decl->variants.size(); i++) {
+        if (is_niche && !enum_decl->variants[i].payload.empty()) {
+            continue;
+        }
+        unsigned tag = is_niche ? enum_decl->niche_start + i : i;
+        switch_inst->addCase(llvm::ConstantInt::get(tag_type, tag), targets[i]);
+    }
+
+    // Generate code for the arms
+    for (size_t i = 0; i < stmt->arms.size(); i++) {
+        auto& arm = stmt->arms[i];
+        builder->SetInsertPoint(arm_blocks[i]);
+        if (arm.variant >= 0) {
+            auto& variant = enum_decl->variants[arm.variant];
+            auto payload_type = get_payload_type(variant);
+            for (size_t j = 0; j < arm.bindings.size(); j++) {
+                auto var_node = arm.bindings[j]->variable;
+                // `_` binds nothing
+                if (var_node == nullptr) {
+                    continue;
+                }
+                auto field_type = payload_type->getElementType(j);
+                llvm::Value* field_value = nullptr;
+                if (is_niche) {
+                    field_value = builder->CreateTrunc(discriminant, field_type);
+                } else {
+                    field_value = builder->CreateLoad(field_type, builder->CreateStructGEP(payload_type, payload, j));
+                }
+                auto llvm_safe_name = var_node->unique_name;
+                std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
+                auto alloca = create_entry_alloca(field_type, llvm_safe_name);
+                builder->CreateStore(field_value, alloca);
+                var_node->llvm_allocation = alloca;
+            }
+        }
+        for (auto& arm_stmt : arm.body) {
+            arm_stmt->accept(this);
+        }
+        builder->CreateBr(end_block);
+    }
+
+    // Set the insert point to the end block
+    builder->SetInsertPoint(end_block);
+
+    return nullptr;
+}
+
+llvm::Value* CodeGenerator::visit_for_stmt(Stmt::For* stmt) {
+    auto var_node = stmt->variable->variable;
+    auto llvm_safe_name = var_node->unique_name;
+    std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
+
+    // The range or the array is evaluated once, before the loop.
+    llvm::Value* start_val = nullptr;
+    llvm::Value* end_val = nullptr;
+    // The elements of an array or a slice are indexed from a pointer to the first one.
+    llvm::Value* data_val = nullptr;
+    llvm::Type* element_type = nullptr;
+    if (stmt->end != nullptr) {
+        start_val = stmt->start->accept(this);
+        end_val = stmt->end->accept(this);
+    } else if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(stmt->start->type)) {
+        auto slice_val = stmt->start->accept(this);
+        data_val = builder->CreateExtractValue(slice_val, 0);
+        element_type = slice_type->inner_type->to_llvm_type(context);
+        start_val = builder->getInt64(0);
+        end_val = builder->CreateExtractValue(slice_val, 1);
+    } else {
+        data_val = stmt->start->accept(this);
+        auto array_type = std::dynamic_pointer_cast<Type::Array>(stmt->start->type);
+        element_type = array_type->inner_type->to_llvm_type(context);
+        start_val = builder->getInt64(0);
+        end_val = builder->getInt64(array_type->size);
+    }
+    auto index_type = start_val->getType();
+    // Indexes of elements count from 0, so they compare the same either way.
+    bool is_unsigned = stmt->end != nullptr && stmt->start->type->is_unsigned();
+    auto create_less_than = [&](llvm::Value* left, llvm::Value* right) {
+        return is_unsigned ? builder->CreateICmpULT(left, right) : builder->CreateICmpSLT(left, right);
+    };
+
+    // The loop variable lives in an alloca like any other variable; the optimizer replaces it with the induction variable.
+    auto variable_alloca = create_entry_alloca(var_node->decl->type->to_llvm_type(context), llvm_safe_name);
+    var_node->llvm_allocation = variable_alloca;
+
+    // Create the blocks
+    auto preheader = builder->GetInsertBlock();
+    auto body_block = llvm::BasicBlock::Create(*context, "for_body", block_stack.front()->getParent());
+    auto end_block = llvm::BasicBlock::Create(*context, "for_end", block_stack.front()->getParent());
+    block_stack.push_back(end_block);
+
+    // The loop is emitted in the canonical form LLVM's loop passes expect: the range is checked once before the loop,
+    // and the body block starts with an induction variable that counts up by one and is tested at the bottom.
+    builder->CreateCondBr(create_less_than(start_val, end_val), body_block, end_block);
+
+    // Generate code for the body block
+    builder->SetInsertPoint(body_block);
+    auto index = builder->CreatePHI(index_type, 2, llvm_safe_name + ".index");
+    index->addIncoming(start_val, preheader);
+    temporary_scopes.emplace_back();
+    llvm::Value* value = index;
+    if (data_val != nullptr) {
+        auto element = builder->CreateInBoundsGEP(element_type, data_val, index);
+        value = builder->CreateLoad(element_type, element);
+    }
+    builder->CreateStore(value, variable_alloca);
+    for (auto& body_stmt : stmt->body) {
+        body_stmt->accept(this);
+    }
+    end_temporary_scope();
+
+    // The index stays below the end of the range, so the increment cannot overflow; element indexes are also never negative.
+    auto next_index = builder->CreateAdd(index, llvm::ConstantInt::get(index_type, 1), llvm_safe_name + ".next", data_val != nullptr || is_unsigned, !is_unsigned);
+    index->addIncoming(next_index, builder->GetInsertBlock());
+    auto back_edge = builder->CreateCondBr(create_less_than(next_index, end_val), body_block, end_block);
+    attach_loop_hints(back_edge, stmt->hints, {body_block}, end_block);
+    block_stack.pop_back();
+
+    // Set the insert point to the end block
+    builder->SetInsertPoint(end_block);
+
+    return nullptr;
+}
+
+llvm::Value* CodeGenerator::visit_return_stmt(Stmt::Return* stmt) {
     if (stmt->value != nullptr) {
-        auto value = std::any_cast<llvm::Value*>(stmt->value->accept(this));
-        builder->CreateStore(value, Environment::inst().get_variable({"__return_val__"})->llvm_allocation);
+        auto value = stmt->value->accept(this);
+        if (return_aggregate_type != nullptr) {
+            // Copy the aggregate into the storage the caller provided.
+            copy_aggregate(return_allocation, value, return_aggregate_type);
+        } else {
+            builder->CreateStore(value, return_allocation);
+        }
     }
     if (block_stack.size() == 0) {
-        ErrorLogger::inst().log_error(stmt->location, E_IMPOSSIBLE, "Return statement outside of function.");
+        logger.log_error(stmt->location, E_IMPOSSIBLE, "Return statement outside of function.");
         throw CodeGenException();
     }
 
@@ -163,7 +940,7 @@ std::any CodeGenerator::visit_return_stmt(Stmt::Return* stmt) {
     return nullptr;
 }
 
-std::any CodeGenerator::visit_break_stmt(Stmt::Break*) {
+llvm::Value* CodeGenerator::visit_break_stmt(Stmt::Break*) {
     // Jump to the last block in the block stack, which, at this point, should be the end block of the loop.
     builder->CreateBr(block_stack.back());
     // We allow statements to appear after a break statement. Theoretically, these statements should be unreachable.
@@ -177,39 +954,96 @@ std::any CodeGenerator::visit_break_stmt(Stmt::Break*) {
     return nullptr;
 }
 
-std::any CodeGenerator::visit_continue_stmt(Stmt::Continue*) {
+llvm::Value* CodeGenerator::visit_continue_stmt(Stmt::Continue*) {
     // TODO: Implement continue statement
     return nullptr;
 }
 
-std::any CodeGenerator::visit_eof_stmt(Stmt::EndOfFile*) {
+llvm::Value* CodeGenerator::visit_eof_stmt(Stmt::EndOfFile*) {
     // TODO: Implement eof statement
     return nullptr;
 }
 
-std::any CodeGenerator::visit_var_decl(Decl::Var* decl) {
+llvm::Value* CodeGenerator::visit_var_decl(Decl::Var* decl) {
+    // The variable node was created when the checkers declared the variable.
+    auto var_node = decl->variable;
+    if (var_node == nullptr) {
+        logger.log_error(decl->location, E_IMPOSSIBLE, "Variable `" + decl->name.lexeme + "` was never declared.");
+        throw CodeGenException();
+    }
+
+    auto aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(var_node->decl->type);
+    auto llvm_safe_name = var_node->unique_name;
+    std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
 
     // This function behaves differently depending on whether this is a global or local variable.
     // If it is a global variable, we need to create a global variable instead of an alloca instruction.
-    if (Environment::inst().in_global_scope()) {
-        // The node already exists in the tree, so we can just get it.
-        auto var_node = Environment::inst().get_variable({decl->name.lexeme});
+    // We are only inside a function if there is an exit block to jump to.
+    if (block_stack.empty()) {
         // Generate code for the initializer expression.
         llvm::Value* initializer = nullptr;
-        if (decl->initializer != nullptr) {
-            initializer = std::any_cast<llvm::Value*>(decl->initializer->accept(this));
+        // Whether the initializer is computed at compile time, after the variable is created.
+        bool is_deferred = false;
+        auto initializer_aggregate_type = decl->initializer != nullptr ? std::dynamic_pointer_cast<Type::Aggregate>(decl->initializer->type) : nullptr;
+        if (initializer_aggregate_type != nullptr) {
+            // An aggregate variable points to its storage, which is initialized with the constant.
+            auto constant = constant_aggregate(decl->initializer.get());
+            if (constant == nullptr) {
+                // Anything but a literal is computed at compile time; the storage stays zeroed until then.
+                auto llvm_aggregate_type = initializer_aggregate_type->to_llvm_aggregate_type(context);
+                auto storage = new llvm::GlobalVariable(
+                    *ir_module,
+                    llvm_aggregate_type,
+                    decl->declarer == KW_CONST,
+                    llvm::GlobalValue::InternalLinkage,
+                    llvm::Constant::getNullValue(llvm_aggregate_type),
+                    llvm_safe_name + ".storage"
+                );
+                storage->setAlignment(ir_module->getDataLayout().getABITypeAlign(llvm_aggregate_type));
+                defer_initializer(decl, storage);
+                initializer = storage;
+            } else if (decl->declarer == KW_CONST) {
+                initializer = create_constant_global(constant);
+            } else {
+                auto storage = new llvm::GlobalVariable(
+                    *ir_module,
+                    constant->getType(),
+                    false,
+                    llvm::GlobalValue::InternalLinkage,
+                    constant,
+                    llvm_safe_name + ".storage"
+                );
+                storage->setAlignment(ir_module->getDataLayout().getABITypeAlign(constant->getType()));
+                initializer = storage;
+            }
+            // A slice variable views the whole array.
+            initializer = convert_implicitly(initializer, decl->initializer->type, var_node->decl->type);
+        } else if (decl->initializer != nullptr && is_constant_scalar(decl->initializer.get())) {
+            initializer = decl->initializer->accept(this);
+        } else if (decl->initializer != nullptr) {
+            // Anything else, e.g. a call, is computed at compile time; the variable stays zeroed until then.
+            initializer = llvm::Constant::getNullValue(var_node->decl->type->to_llvm_type(context));
+            is_deferred = true;
+        } else if (aggregate_type != nullptr) {
+            // An aggregate variable points to its storage, which is zeroed by default.
+            auto llvm_aggregate_type = aggregate_type->to_llvm_aggregate_type(context);
+            initializer = new llvm::GlobalVariable(
+                *ir_module,
+                llvm_aggregate_type,
+                false,
+                llvm::GlobalValue::InternalLinkage,
+                llvm::Constant::getNullValue(llvm_aggregate_type),
+                llvm_safe_name + ".storage"
+            );
         } else {
             // If there is no initializer, store the default value.
             initializer = llvm::Constant::getNullValue(var_node->decl->type->to_llvm_type(context));
         }
-        // This should never be nullptr
-        auto llvm_safe_name = var_node->unique_name;
-        std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
 
         // Attempt to cast the initializer to an llvm constant
         auto constant_initializer = llvm::dyn_cast<llvm::Constant>(initializer);
         if (constant_initializer == nullptr) {
-            ErrorLogger::inst().log_error(decl->location, E_NOT_A_CONSTANT, "Global variable initializer is not a constant.");
+            logger.log_error(decl->location, E_NOT_A_CONSTANT, "Global variable initializer is not a constant.");
             throw CodeGenException();
         }
 
@@ -223,29 +1057,57 @@ std::any CodeGenerator::visit_var_decl(Decl::Var* decl) {
             llvm_safe_name
         );
         var_node->llvm_allocation = global;
+        if (is_deferred) {
+            defer_initializer(decl, global);
+        }
     } else {
         // For local variables, we need to create an alloca instruction.
-        // The node does not exist in the tree, so we need to create it.
-        auto [node, _] = Environment::inst().declare_variable(decl);
-        auto var_node = std::dynamic_pointer_cast<Node::Variable>(node);
-        // This should never be nullptr
-
         // Generate code for the initializer expression.
         llvm::Value* initializer = nullptr;
-        std::shared_ptr<Type> init_type = std::make_shared<Type::Blank>();
 
-        if (decl->initializer != nullptr) {
-            initializer = std::any_cast<llvm::Value*>(decl->initializer->accept(this));
-            init_type = decl->initializer->type;
-        } else {
+        llvm::Constant* constant = nullptr;
+        if (aggregate_type != nullptr && decl->declarer == KW_CONST && decl->initializer != nullptr) {
+            constant = constant_aggregate(decl->initializer.get());
+        }
+        if (constant != nullptr) {
+            // A constant binding can never be written through, so it refers to the read-only global directly.
+            initializer = create_constant_global(constant);
+        } else if (decl->initializer != nullptr) {
+            initializer = decl->initializer->accept(this);
+            if (var_node->decl->type->kind() == Type::Kind::SLICE) {
+                // A slice of a temporary array keeps the array alive for as long as the variable.
+                retain_temporary(initializer);
+                initializer = convert_implicitly(initializer, decl->initializer->type, var_node->decl->type);
+            }
+        }
+
+        if (aggregate_type != nullptr && constant == nullptr) {
+            // Each aggregate variable owns its storage, so copying a variable never aliases it.
+            if (llvm::isa_and_nonnull<llvm::AllocaInst>(initializer)) {
+                // A fresh temporary (e.g. a literal or a call result) becomes the variable's storage.
+                retain_temporary(initializer);
+            } else {
+                auto llvm_aggregate_type = aggregate_type->to_llvm_aggregate_type(context);
+                auto storage = create_entry_alloca(llvm_aggregate_type, llvm_safe_name + ".storage");
+                if (initializer != nullptr) {
+                    copy_aggregate(storage, initializer, aggregate_type);
+                } else {
+                    auto& data_layout = ir_module->getDataLayout();
+                    builder->CreateMemSet(
+                        storage,
+                        builder->getInt8(0),
+                        data_layout.getTypeAllocSize(llvm_aggregate_type).getFixedValue(),
+                        data_layout.getABITypeAlign(llvm_aggregate_type)
+                    );
+                }
+                initializer = storage;
+            }
+        } else if (aggregate_type == nullptr && initializer == nullptr) {
             // If there is no initializer, store the default value.
             initializer = llvm::Constant::getNullValue(var_node->decl->type->to_llvm_type(context));
         }
 
-        auto llvm_safe_name = var_node->unique_name;
-        std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
-
-        llvm::AllocaInst* alloca = builder->CreateAlloca(var_node->decl->type->to_llvm_type(context), nullptr, llvm_safe_name);
+        llvm::AllocaInst* alloca = create_entry_alloca(var_node->decl->type->to_llvm_type(context), llvm_safe_name);
         // Store the value in the alloca instruction.
         builder->CreateStore(initializer, alloca);
 
@@ -256,9 +1118,17 @@ std::any CodeGenerator::visit_var_decl(Decl::Var* decl) {
     return nullptr;
 }
 
-std::any CodeGenerator::visit_fun_decl(Decl::Fun* decl) {
-    // Get the function node from the environment tree
-    auto fun_node = Environment::inst().get_variable({decl->name});
+llvm::Value* CodeGenerator::visit_fun_decl(Decl::Fun* decl) {
+    // A generic function is generated through its instances
+    if (!decl->type_params.empty()) {
+        for (auto& instance : decl->instances) {
+            instance->accept(this);
+        }
+        return nullptr;
+    }
+
+    // The function node was created by the global checker
+    auto fun_node = decl->variable;
     // This should never be nullptr
 
     // The function is already created
@@ -271,29 +1141,40 @@ std::any CodeGenerator::visit_fun_decl(Decl::Fun* decl) {
     }
 
     // Create the entry block
-    Environment::inst().increase_local_scope();
     auto entry_block = llvm::BasicBlock::Create(*context, "entry", fun);
     auto exit_block = llvm::BasicBlock::Create(*context, "exit", fun);
     block_stack.push_back(exit_block);
     builder->SetInsertPoint(entry_block);
+    last_entry_alloca = nullptr;
+    bounds_trap_block = nullptr;
 
     // Handle the return variable
-    if (decl->return_var != nullptr) {
-        decl->return_var->accept(this);
+    // The checkers never declare the return variable, so it is allocated directly.
+    auto return_type = std::dynamic_pointer_cast<Type::Function>(fun_node->decl->type)->return_type;
+    auto llvm_arg_iter = fun->arg_begin();
+    return_aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(return_type);
+    return_allocation = nullptr;
+    if (return_aggregate_type != nullptr) {
+        // The caller provides the storage for an aggregate result as the first argument.
+        return_allocation = &*llvm_arg_iter;
+        llvm_arg_iter++;
+    } else if (decl->return_var != nullptr) {
+        return_allocation = create_entry_alloca(return_type->to_llvm_type(context), decl->return_var->name.lexeme);
     }
 
-    auto llvm_arg_iter = fun->arg_begin();
     // Visit each parameter
     for (auto& param : decl->parameters) {
-        param->accept(this);
-        auto var_node = Environment::inst().get_variable({param->name});
-        builder->CreateStore(&*llvm_arg_iter, llvm::cast<llvm::AllocaInst>(var_node->llvm_allocation));
+        auto param_type = param->variable->decl->type;
+        auto llvm_safe_name = param->variable->unique_name;
+        std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
+
+        // A mutable aggregate parameter is passed `byval`, so the argument already points to the callee's own copy.
+        auto alloca = create_entry_alloca(param_type->to_llvm_type(context), llvm_safe_name);
+        builder->CreateStore(&*llvm_arg_iter, alloca);
+        param->variable->llvm_allocation = alloca;
         llvm_arg_iter++;
     }
 
-    // Increase scope again
-    Environment::inst().increase_local_scope();
-
     // Visit the body
     for (auto& stmt : decl->body) {
         stmt->accept(this);
@@ -302,102 +1183,332 @@ std::any CodeGenerator::visit_fun_decl(Decl::Fun* decl) {
     // Exit the function
     builder->CreateBr(exit_block);
     builder->SetInsertPoint(exit_block);
-    if (decl->return_var != nullptr) {
-
-        // Get the variable node for the return variable
-        auto var_node = Environment::inst().get_variable({decl->return_var->name});
-        auto return_alloc = llvm::cast<llvm::AllocaInst>(var_node->llvm_allocation);
-        var_node->decl->type->to_llvm_type(context);
-        llvm::Value* return_value = builder->CreateLoad(var_node->decl->type->to_llvm_type(context), return_alloc);
-
-        // If this is an aggregate type, we should load the value again
-        auto aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(var_node->decl->type);
-        if (aggregate_type != nullptr) {
-            return_value = builder->CreateLoad(aggregate_type->to_llvm_aggregate_type(context), return_value);
-        }
-
+    if (return_allocation != nullptr && return_aggregate_type == nullptr) {
+        llvm::Value* return_value = builder->CreateLoad(return_type->to_llvm_type(context), return_allocation);
         builder->CreateRet(return_value);
     } else {
         builder->CreateRetVoid();
     }
 
     block_stack.clear();
-    // Decrease scope
-    Environment::inst().exit_scope();
-    Environment::inst().exit_scope();
+    return_allocation = nullptr;
+    return_aggregate_type = nullptr;
+    last_entry_alloca = nullptr;
+    bounds_trap_block = nullptr;
 
     return nullptr;
 }
 
-std::any CodeGenerator::visit_extern_fun_decl(Decl::ExternFun*) {
+llvm::Value* CodeGenerator::visit_extern_fun_decl(Decl::ExternFun*) {
     // The function is already declared; we don't need to do anything here.
     return nullptr;
 }
 
-std::any CodeGenerator::visit_struct_decl(Decl::Struct* decl) {
+llvm::Value* CodeGenerator::visit_enum_decl(Decl::Enum*) {
+    // The enum is already declared; its variants are values, not functions.
+    return nullptr;
+}
+
+llvm::Value* CodeGenerator::visit_struct_decl(Decl::Struct* decl) {
     // This function should visit all static members of the struct.
     // Right now, that's just the declarations that are functions.
-
-    Environment::inst().enter_scope(decl->name.lexeme);
-
+    // Each declaration already knows its variable node, so there is no need to enter the struct's scope.
+    // A generic struct is generated through its instances.
+    if (!decl->type_params.empty()) {
+        for (auto& instance : decl->instances) {
+            instance->accept(this);
+        }
+        return nullptr;
+    }
     for (auto& declaration : decl->declarations) {
         if (IS_TYPE(declaration, Decl::Fun)) {
             declaration->accept(this);
         }
     }
 
-    Environment::inst().exit_scope();
-
     return nullptr;
 }
 
-std::any CodeGenerator::visit_assign_expr(Expr::Assign* expr) {
+llvm::Value* CodeGenerator::visit_assign_expr(Expr::Assign* expr) {
+    // A lane has no address of its own; the vector is read, updated, and written back as a whole.
+    auto lane = dynamic_cast<Expr::LIndex*>(expr->left.get());
+    if (lane != nullptr && lane->left->type->kind() == Type::Kind::VECTOR) {
+        auto vector_type = std::dynamic_pointer_cast<Type::Vector>(lane->left->type);
+        auto llvm_vector_type = vector_type->to_llvm_type(context);
+        auto vector_allocation = lane->left_lvalue->get_llvm_allocation(this);
+        auto index_value = generate_index(lane->right.get());
+        check_bounds(lane, index_value, builder->getInt64(vector_type->size));
+
+        llvm::Value* value = nullptr;
+        if (expr->op.tok_type == TOK_AMP_AMP_EQ || expr->op.tok_type == TOK_BAR_BAR_EQ) {
+            auto current = builder->CreateLoad(llvm_vector_type, vector_allocation);
+            tag_access(current, lane->left.get());
+            value = generate_logical(expr->op.tok_type == TOK_AMP_AMP_EQ, builder->CreateExtractElement(current, index_value), expr->right.get());
+        } else {
+            value = expr->right->accept(this);
+        }
+        // The right side may have changed the other lanes, so they are loaded after it.
+        auto vector = builder->CreateLoad(llvm_vector_type, vector_allocation);
+        tag_access(vector, lane->left.get());
+        tag_access(builder->CreateStore(builder->CreateInsertElement(vector, value, index_value), vector_allocation), lane->left.get());
+        return value;
+    }
+
     // Get the llvm allocation of the left side
     auto lvalue = std::dynamic_pointer_cast<Expr::LValue>(expr->left);
     // This should never be nullptr
     auto llvm_allocation = lvalue->get_llvm_allocation(this);
 
+    // `a &&= b` and `a ||= b` only evaluate `b` if `a` does not already decide the result.
+    if (expr->op.tok_type == TOK_AMP_AMP_EQ || expr->op.tok_type == TOK_BAR_BAR_EQ) {
+        auto current = builder->CreateLoad(expr->left->type->to_llvm_type(context), llvm_allocation);
+        tag_access(current, expr->left.get());
+        auto value = generate_logical(expr->op.tok_type == TOK_AMP_AMP_EQ, current, expr->right.get());
+        tag_access(builder->CreateStore(value, llvm_allocation), expr->left.get());
+        return value;
+    }
+
     // Get the value of the right side
-    auto value = std::any_cast<llvm::Value*>(expr->right->accept(this));
+    auto value = expr->right->accept(this);
+    if (expr->left->type->kind() == Type::Kind::SLICE) {
+        // A slice of a temporary array keeps the array alive for the rest of the function.
+        retain_temporary(value);
+        value = convert_implicitly(value, expr->right->type, expr->left->type);
+    }
+
+    // Aggregates are assigned by value: copy into the storage the left side refers to.
+    auto aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(expr->left->type);
+    if (aggregate_type != nullptr) {
+        auto storage = builder->CreateLoad(expr->left->type->to_llvm_type(context), llvm_allocation);
+        tag_access(storage, expr->left.get());
+        copy_aggregate(storage, value, aggregate_type);
+        return storage;
+    }
 
     // Store the value in the llvm allocation
-    builder->CreateStore(value, llvm_allocation);
+    tag_access(builder->CreateStore(value, llvm_allocation), expr->left.get());
 
     return value;
 }
 
-std::any CodeGenerator::visit_logical_expr(Expr::Logical*) {
-    // TODO: Implement logical expressions
-    return nullptr;
+llvm::Value* CodeGenerator::visit_logical_expr(Expr::Logical* expr) {
+    // There are 2 logical operators, each with a keyword and a symbol: `and`/`&&` and `or`/`||`
+    auto left_val = expr->left->accept(this);
+    bool is_and = expr->op.tok_type == KW_AND || expr->op.tok_type == TOK_AMP_AMP;
+    if (expr->type->kind() == Type::Kind::VECTOR) {
+        // Vectors of bools are combined lane by lane, so both sides are always evaluated.
+        auto right_val = expr->right->accept(this);
+        return is_and ? builder->CreateAnd(left_val, right_val) : builder->CreateOr(left_val, right_val);
+    }
+    return generate_logical(is_and, left_val, expr->right.get());
+}
+
+llvm::MDNode* CodeGenerator::get_tbaa_type(const std::shared_ptr<Type>& type) {
+    // Aggregates are stored as pointers to their storage.
+    bool is_pointer = type->kind() == Type::Kind::POINTER || type->kind() == Type::Kind::FUNCTION || std::dynamic_pointer_cast<Type::Aggregate>(type) != nullptr;
+    auto name = is_pointer ? "any pointer" : type->to_string();
+    auto& node = tbaa_types[name];
+    if (node == nullptr) {
+        llvm::MDBuilder md_builder(*context);
+        if (tbaa_root == nullptr) {
+            tbaa_root = md_builder.createTBAARoot("Niter TBAA");
+        }
+        node = md_builder.createTBAAScalarTypeNode(name, tbaa_root);
+    }
+    return node;
+}
+
+llvm::MDNode* CodeGenerator::get_tbaa_struct_type(const std::shared_ptr<Type::Aggregate>& type) {
+    auto name = type->to_string();
+    auto iter = tbaa_types.find(name);
+    if (iter != tbaa_types.end()) {
+        return iter->second;
+    }
+
+    std::vector<std::shared_ptr<Type>> member_types;
+    if (auto struct_type = std::dynamic_pointer_cast<Type::Struct>(type)) {
+        for (auto& [member_name, member_decl] : struct_type->struct_scope->instance_members) {
+            member_types.push_back(member_decl->type);
+        }
+    } else if (auto tuple_type = std::dynamic_pointer_cast<Type::Tuple>(type)) {
+        member_types = tuple_type->element_types;
+    }
+
+    auto layout = ir_module->getDataLayout().getStructLayout(llvm::cast<llvm::StructType>(type->to_llvm_aggregate_type(context)));
+    std::vector<std::pair<llvm::MDNode*, uint64_t>> fields;
+    for (size_t i = 0; i < member_types.size(); i++) {
+        fields.push_back({get_tbaa_type(member_types[i]), layout->getElementOffset(i)});
+    }
+    llvm::MDBuilder md_builder(*context);
+    auto node = md_builder.createTBAAStructTypeNode(name, fields);
+    tbaa_types[name] = node;
+    return node;
+}
+
+void CodeGenerator::tag_access(llvm::Instruction* access, Expr* expr) {
+    if (!strict_aliasing) {
+        return;
+    }
+    while (auto grouping = dynamic_cast<Expr::Grouping*>(expr)) {
+        expr = grouping->expression.get();
+    }
+
+    // The aggregate the access is a member of, if it is a struct member or tuple element.
+    std::shared_ptr<Type::Aggregate> base_type = nullptr;
+    unsigned member_index = 0;
+    if (auto access_expr = dynamic_cast<Expr::Access*>(expr); access_expr != nullptr && access_expr->member_index != -1) {
+        base_type = std::dynamic_pointer_cast<Type::Aggregate>(access_expr->left->type);
+        member_index = access_expr->member_index;
+    } else if (auto index_expr = dynamic_cast<Expr::Index*>(expr); index_expr != nullptr && index_expr->left->type->kind() == Type::Kind::TUPLE) {
+        base_type = std::dynamic_pointer_cast<Type::Aggregate>(index_expr->left->type);
+        member_index = std::any_cast<int>(std::dynamic_pointer_cast<Expr::Literal>(index_expr->right)->token.literal);
+    }
+
+    llvm::MDBuilder md_builder(*context);
+    auto access_type = get_tbaa_type(expr->type);
+    llvm::MDNode* tag;
+    if (base_type != nullptr) {
+        auto layout = ir_module->getDataLayout().getStructLayout(llvm::cast<llvm::StructType>(base_type->to_llvm_aggregate_type(context)));
+        tag = md_builder.createTBAAStructTagNode(get_tbaa_struct_type(base_type), access_type, layout->getElementOffset(member_index));
+    } else {
+        tag = md_builder.createTBAAStructTagNode(access_type, access_type, 0);
+    }
+    access->setMetadata(llvm::LLVMContext::MD_tbaa, tag);
+}
+
+llvm::MDNode* CodeGenerator::create_loop_id(const LoopHints& hints, llvm::MDNode* access_group) {
+    auto hint = [&](const std::string& name, llvm::Metadata* value = nullptr) -> llvm::Metadata* {
+        std::vector<llvm::Metadata*> operands = {llvm::MDString::get(*context, name)};
+        if (value != nullptr) {
+            operands.push_back(value);
+        }
+        return llvm::MDNode::get(*context, operands);
+    };
+    auto constant = [&](llvm::Constant* value) {
+        return llvm::ConstantAsMetadata::get(value);
+    };
+
+    // The first operand is the loop ID itself, so that every loop has distinct metadata.
+    std::vector<llvm::Metadata*> operands = {nullptr};
+    if (hints.vectorize) {
+        operands.push_back(hint("llvm.loop.vectorize.enable", constant(builder->getTrue())));
+        if (hints.vectorize_width > 0) {
+            operands.push_back(hint("llvm.loop.vectorize.width", constant(builder->getInt32(hints.vectorize_width))));
+        }
+    }
+    if (hints.unroll) {
+        if (hints.unroll_count > 0) {
+            operands.push_back(hint("llvm.loop.unroll.count", constant(builder->getInt32(hints.unroll_count))));
+        } else {
+            operands.push_back(hint("llvm.loop.unroll.enable"));
+        }
+    }
+    if (access_group != nullptr) {
+        operands.push_back(hint("llvm.loop.parallel_accesses", access_group));
+    }
+
+    auto loop_id = llvm::MDNode::getDistinct(*context, operands);
+    loop_id->replaceOperandWith(0, loop_id);
+    return loop_id;
+}
+
+void CodeGenerator::attach_loop_hints(llvm::Instruction* back_edge, const LoopHints& hints, const std::vector<llvm::BasicBlock*>& header_blocks, llvm::BasicBlock* end_block) {
+    if (!hints.vectorize && !hints.unroll && !hints.parallel) {
+        return;
+    }
+    llvm::MDNode* access_group = nullptr;
+    if (hints.parallel) {
+        // Every memory access of the loop joins one access group, which the loop declares free of loop-carried dependencies.
+        // The blocks of the body were created after the end block, so they follow it in the function.
+        access_group = llvm::MDNode::getDistinct(*context, {});
+        for (auto block : header_blocks) {
+            add_access_group(block, access_group);
+        }
+        for (auto block = std::next(end_block->getIterator()); block != end_block->getParent()->end(); ++block) {
+            add_access_group(&*block, access_group);
+        }
+    }
+    back_edge->setMetadata(llvm::LLVMContext::MD_loop, create_loop_id(hints, access_group));
+}
+
+void CodeGenerator::add_access_group(llvm::BasicBlock* block, llvm::MDNode* access_group) {
+    for (auto& instruction : *block) {
+        if (!instruction.mayReadOrWriteMemory()) {
+            continue;
+        }
+        // Accesses in nested parallel loops already belong to the groups of those loops.
+        auto groups = instruction.getMetadata(llvm::LLVMContext::MD_access_group);
+        instruction.setMetadata(llvm::LLVMContext::MD_access_group, groups == nullptr ? access_group : llvm::uniteAccessGroups(groups, access_group));
+    }
+}
+
+llvm::Value* CodeGenerator::generate_logical(bool is_and, llvm::Value* left_val, Expr* right) {
+    // The result when the left side decides it on its own: false for `and`, true for `or`.
+    auto short_circuit_val = is_and ? builder->getFalse() : builder->getTrue();
+
+    // A constant left side decides at compile time whether the right side is evaluated.
+    if (auto constant_left = llvm::dyn_cast<llvm::ConstantInt>(left_val)) {
+        if (constant_left == short_circuit_val) {
+            return short_circuit_val;
+        }
+        return right->accept(this);
+    }
+
+    // A cheap right side without side effects is always evaluated, which avoids a branch.
+    // Outside of a function there are no blocks to branch between; the result must fold to a constant anyway.
+    int budget = SPECULATION_BUDGET;
+    if (block_stack.empty() || is_speculatable(right, budget)) {
+        auto right_val = right->accept(this);
+        if (is_and) {
+            return builder->CreateSelect(left_val, right_val, short_circuit_val);
+        }
+        return builder->CreateSelect(left_val, short_circuit_val, right_val);
+    }
+
+    auto current_fun = builder->GetInsertBlock()->getParent();
+    auto left_block = builder->GetInsertBlock();
+    auto right_block = llvm::BasicBlock::Create(*context, is_and ? "and_rhs" : "or_rhs", current_fun);
+    auto end_block = llvm::BasicBlock::Create(*context, is_and ? "and_end" : "or_end", current_fun);
+    if (is_and) {
+        builder->CreateCondBr(left_val, right_block, end_block);
+    } else {
+        builder->CreateCondBr(left_val, end_block, right_block);
+    }
+
+    builder->SetInsertPoint(right_block);
+    auto right_val = right->accept(this);
+    // The right side may have added blocks of its own.
+    auto right_end_block = builder->GetInsertBlock();
+    builder->CreateBr(end_block);
+
+    builder->SetInsertPoint(end_block);
+    auto phi = builder->CreatePHI(builder->getInt1Ty(), 2);
+    phi->addIncoming(short_circuit_val, left_block);
+    phi->addIncoming(right_val, right_end_block);
+    return phi;
 }
 
-std::any CodeGenerator::visit_binary_expr(Expr::Binary* expr) {
-    // There are 12 binary operators: `+`, `-`, `*`, `/`, `%`, `^`, `==`, `!=`, `<`, `<=`, `>`, `>=`
-    // TOK_PLUS, TOK_MINUS, TOK_STAR, TOK_SLASH, TOK_PERCENT, TOK_CARET, TOK_EQ_EQ, TOK_NE, TOK_LT, TOK_LE, TOK_GT, TOK_GE
-    auto left_val = std::any_cast<llvm::Value*>(expr->left->accept(this));
-    auto right_val = std::any_cast<llvm::Value*>(expr->right->accept(this));
+llvm::Value* CodeGenerator::visit_binary_expr(Expr::Binary* expr) {
+    // There are 17 binary operators: `+`, `-`, `*`, `/`, `%`, `^`, `&`, `|`, `~`, `<<`, `>>`, `==`, `!=`, `<`, `<=`, `>`, `>=`
+    // TOK_PLUS, TOK_MINUS, TOK_STAR, TOK_SLASH, TOK_PERCENT, TOK_CARET, TOK_AMP, TOK_BAR, TOK_TILDE, TOK_LT_LT, TOK_GT_GT,
+    // TOK_EQ_EQ, TOK_NE, TOK_LT, TOK_LE, TOK_GT, TOK_GE
+    auto left_val = expr->left->accept(this);
+    auto right_val = expr->right->accept(this);
 
     if (expr->op.tok_type == TOK_CARET) {
         // This is exponentiation, not bitwise XOR
-        // Get the function; declare it if it doesn't exist
-        auto pow_fun = ir_module->getFunction("pow");
-        if (pow_fun == nullptr) {
-            std::vector<llvm::Type*> pow_args = {llvm::Type::getDoubleTy(*context), llvm::Type::getDoubleTy(*context)};
-            llvm::FunctionType* pow_type = llvm::FunctionType::get(llvm::Type::getDoubleTy(*context), pow_args, false);
-            pow_fun = llvm::Function::Create(pow_type, llvm::Function::ExternalLinkage, "pow", ir_module.get());
-        }
-        // If the operands are ints, convert them to doubles
-        if (left_val->getType()->isIntegerTy()) {
-            left_val = builder->CreateSIToFP(left_val, llvm::Type::getDoubleTy(*context));
-            right_val = builder->CreateSIToFP(right_val, llvm::Type::getDoubleTy(*context));
-        }
-        // Call the function
-        std::vector<llvm::Value*> args = {left_val, right_val};
-        llvm::Value* ret = builder->CreateCall(pow_fun, args);
-        return ret;
+        return generate_power(left_val, right_val, expr->right->type->is_unsigned());
+    }
+
+    // Vectors apply the operator to each lane; the builder takes vector operands as they are.
+    auto operand_type = expr->left->type;
+    if (auto vector_type = std::dynamic_pointer_cast<Type::Vector>(operand_type)) {
+        operand_type = vector_type->inner_type;
     }
 
-    if (expr->left->type->is_int()) {
+    if (operand_type->is_int()) {
+        // Only division, remainder and ordering depend on the sign; the bits of a sum or a product do not.
+        bool is_unsigned = operand_type->is_unsigned();
         if (expr->op.tok_type == TOK_PLUS) {
             return builder->CreateAdd(left_val, right_val);
         } else if (expr->op.tok_type == TOK_MINUS) {
@@ -405,23 +1516,39 @@ std::any CodeGenerator::visit_binary_expr(Expr::Binary* expr) {
         } else if (expr->op.tok_type == TOK_STAR) {
             return builder->CreateMul(left_val, right_val);
         } else if (expr->op.tok_type == TOK_SLASH) {
-            return builder->CreateSDiv(left_val, right_val);
+            return is_unsigned ? builder->CreateUDiv(left_val, right_val) : builder->CreateSDiv(left_val, right_val);
         } else if (expr->op.tok_type == TOK_PERCENT) {
-            return builder->CreateSRem(left_val, right_val);
+            return is_unsigned ? builder->CreateURem(left_val, right_val) : builder->CreateSRem(left_val, right_val);
+        } else if (expr->op.tok_type == TOK_AMP) {
+            return builder->CreateAnd(left_val, right_val);
+        } else if (expr->op.tok_type == TOK_BAR) {
+            return builder->CreateOr(left_val, right_val);
+        } else if (expr->op.tok_type == TOK_TILDE) {
+            return builder->CreateXor(left_val, right_val);
+        } else if (expr->op.tok_type == TOK_LT_LT || expr->op.tok_type == TOK_GT_GT) {
+            // Only the low bits of the amount count, as on most machines, so shifting by the width or more is defined.
+            auto type = left_val->getType();
+            auto amount = builder->CreateIntCast(right_val, type, false);
+            amount = builder->CreateAnd(amount, llvm::ConstantInt::get(type, type->getScalarSizeInBits() - 1));
+            if (expr->op.tok_type == TOK_LT_LT) {
+                return builder->CreateShl(left_val, amount);
+            }
+            // Unsigned integers shift in zeros, the others copies of the sign bit.
+            return is_unsigned ? builder->CreateLShr(left_val, amount) : builder->CreateAShr(left_val, amount);
         } else if (expr->op.tok_type == TOK_EQ_EQ) {
             return builder->CreateICmpEQ(left_val, right_val);
         } else if (expr->op.tok_type == TOK_BANG_EQ) {
             return builder->CreateICmpNE(left_val, right_val);
         } else if (expr->op.tok_type == TOK_LT) {
-            return builder->CreateICmpSLT(left_val, right_val);
+            return is_unsigned ? builder->CreateICmpULT(left_val, right_val) : builder->CreateICmpSLT(left_val, right_val);
         } else if (expr->op.tok_type == TOK_LE) {
-            return builder->CreateICmpSLE(left_val, right_val);
+            return is_unsigned ? builder->CreateICmpULE(left_val, right_val) : builder->CreateICmpSLE(left_val, right_val);
         } else if (expr->op.tok_type == TOK_GT) {
-            return builder->CreateICmpSGT(left_val, right_val);
+            return is_unsigned ? builder->CreateICmpUGT(left_val, right_val) : builder->CreateICmpSGT(left_val, right_val);
         } else if (expr->op.tok_type == TOK_GE) {
-            return builder->CreateICmpSGE(left_val, right_val);
+            return is_unsigned ? builder->CreateICmpUGE(left_val, right_val) : builder->CreateICmpSGE(left_val, right_val);
         }
-    } else if (expr->left->type->is_float()) {
+    } else if (operand_type->is_float()) {
         if (expr->op.tok_type == TOK_PLUS) {
             return builder->CreateFAdd(left_val, right_val);
         } else if (expr->op.tok_type == TOK_MINUS) {
@@ -445,58 +1572,342 @@ std::any CodeGenerator::visit_binary_expr(Expr::Binary* expr) {
         }
     }
 
-    ErrorLogger::inst().log_error(expr->location, E_UNREACHABLE, "Code generator could not perform binary operation.");
+    logger.log_error(expr->location, E_UNREACHABLE, "Code generator could not perform binary operation.");
     throw CodeGenException();
 }
 
-std::any CodeGenerator::visit_unary_expr(Expr::Unary* expr) {
-    auto right_val = std::any_cast<llvm::Value*>(expr->inner->accept(this));
+llvm::Value* CodeGenerator::generate_power(llvm::Value* base, llvm::Value* exponent, bool is_unsigned) {
+    auto type = base->getType();
+    bool is_float = type->isFloatingPointTy();
+    auto one = is_float ? llvm::ConstantFP::get(type, 1.0) : llvm::ConstantInt::get(type, 1);
+
+    // Square-and-multiply for a constant, non-negative exponent; x^2 becomes x * x.
+    // Integer results are exact; float results may be off by an ulp for each multiplication.
+    auto multiply_power = [&](uint64_t power) -> llvm::Value* {
+        llvm::Value* result = nullptr;
+        llvm::Value* square = base;
+        while (power != 0) {
+            if (power & 1) {
+                result = result == nullptr ? square : (is_float ? builder->CreateFMul(result, square) : builder->CreateMul(result, square));
+            }
+            power >>= 1;
+            if (power != 0) {
+                square = is_float ? builder->CreateFMul(square, square) : builder->CreateMul(square, square);
+            }
+        }
+        return result == nullptr ? one : result;
+    };
+
+    if (auto constant_exponent = llvm::dyn_cast<llvm::ConstantInt>(exponent)) {
+        bool is_negative = !is_unsigned && constant_exponent->isNegative();
+        if (!is_float && !is_negative) {
+            return multiply_power(constant_exponent->getZExtValue());
+        }
+        uint64_t magnitude = is_negative ? -(uint64_t)constant_exponent->getSExtValue() : constant_exponent->getZExtValue();
+        if (is_float && magnitude <= MAX_MULTIPLIED_FLOAT_POWER) {
+            // x ^ -n is computed as 1 / x ^ n, which rounds once more.
+            return is_negative ? builder->CreateFDiv(one, multiply_power(magnitude)) : multiply_power(magnitude);
+        }
+    }
+
+    if (!is_float) {
+        return builder->CreateCall(get_integer_power_function(llvm::cast<llvm::IntegerType>(type), is_unsigned), {base, exponent});
+    }
+
+    if (exponent->getType()->isIntegerTy()) {
+        // powi takes a signed 32-bit exponent; wider exponents go through pow.
+        unsigned width = exponent->getType()->getIntegerBitWidth();
+        if (width < 32 || (width == 32 && !is_unsigned)) {
+            exponent = builder->CreateIntCast(exponent, builder->getInt32Ty(), !is_unsigned);
+            return builder->CreateIntrinsic(llvm::Intrinsic::powi, {type, builder->getInt32Ty()}, {base, exponent});
+        }
+        exponent = is_unsigned ? builder->CreateUIToFP(exponent, type) : builder->CreateSIToFP(exponent, type);
+    }
+
+    // pow is exact for the exponents 0, 1 and 2.
+    if (auto constant_exponent = llvm::dyn_cast<llvm::ConstantFP>(exponent)) {
+        auto& value = constant_exponent->getValueAPF();
+        if (value.isZero() || value.isExactlyValue(1.0) || value.isExactlyValue(2.0)) {
+            return multiply_power((uint64_t)value.convertToDouble());
+        }
+    }
+    return builder->CreateIntrinsic(llvm::Intrinsic::pow, {type}, {base, exponent});
+}
+
+llvm::Function* CodeGenerator::get_integer_power_function(llvm::IntegerType* type, bool is_unsigned) {
+    auto name = std::string(is_unsigned ? "__niter_ipow_u" : "__niter_ipow_i") + std::to_string(type->getBitWidth());
+    if (auto existing = ir_module->getFunction(name)) {
+        return existing;
+    }
+
+    auto fun_type = llvm::FunctionType::get(type, {type, type}, false);
+    auto fun = llvm::Function::Create(fun_type, llvm::Function::InternalLinkage, name, ir_module.get());
+    auto base = fun->getArg(0);
+    auto exponent = fun->getArg(1);
+    auto zero = llvm::ConstantInt::get(type, 0);
+    auto one = llvm::ConstantInt::get(type, 1);
+    auto minus_one = llvm::ConstantInt::getSigned(type, -1);
+
+    // The helper is built with its own builder, so the insertion point of the current function is left alone.
+    llvm::IRBuilder<> fun_builder(*context);
+    auto entry_block = llvm::BasicBlock::Create(*context, "entry", fun);
+    auto negative_block = llvm::BasicBlock::Create(*context, "negative", fun);
+    auto loop_block = llvm::BasicBlock::Create(*context, "loop", fun);
+    auto body_block = llvm::BasicBlock::Create(*context, "body", fun);
+    auto exit_block = llvm::BasicBlock::Create(*context, "exit", fun);
+
+    fun_builder.SetInsertPoint(entry_block);
+    // An unsigned exponent is never negative.
+    fun_builder.CreateCondBr(is_unsigned ? fun_builder.getFalse() : fun_builder.CreateICmpSLT(exponent, zero), negative_block, loop_block);
+
+    // A negative exponent gives 1 / base^-exponent, truncated.
+    fun_builder.SetInsertPoint(negative_block);
+    auto is_odd = fun_builder.CreateTrunc(exponent, fun_builder.getInt1Ty());
+    auto minus_one_power = fun_builder.CreateSelect(is_odd, minus_one, one);
+    auto negative_result = fun_builder.CreateSelect(fun_builder.CreateICmpEQ(base, minus_one), minus_one_power, zero);
+    fun_builder.CreateRet(fun_builder.CreateSelect(fun_builder.CreateICmpEQ(base, one), one, negative_result));
+
+    // Square-and-multiply over the bits of the exponent.
+    fun_builder.SetInsertPoint(loop_block);
+    auto result = fun_builder.CreatePHI(type, 2, "result");
+    auto square = fun_builder.CreatePHI(type, 2, "square");
+    auto remaining = fun_builder.CreatePHI(type, 2, "remaining");
+    fun_builder.CreateCondBr(fun_builder.CreateICmpEQ(remaining, zero), exit_block, body_block);
+
+    fun_builder.SetInsertPoint(body_block);
+    auto bit_set = fun_builder.CreateTrunc(remaining, fun_builder.getInt1Ty());
+    auto next_result = fun_builder.CreateSelect(bit_set, fun_builder.CreateMul(result, square), result);
+    auto next_square = fun_builder.CreateMul(square, square);
+    auto next_remaining = fun_builder.CreateLShr(remaining, one);
+    fun_builder.CreateBr(loop_block);
+
+    result->addIncoming(one, entry_block);
+    result->addIncoming(next_result, body_block);
+    square->addIncoming(base, entry_block);
+    square->addIncoming(next_square, body_block);
+    remaining->addIncoming(exponent, entry_block);
+    remaining->addIncoming(next_remaining, body_block);
+
+    fun_builder.SetInsertPoint(exit_block);
+    fun_builder.CreateRet(result);
+
+    return fun;
+}
+
+llvm::Value* CodeGenerator::generate_bits_builtin(Expr::Call* expr) {
+    using Builtin = Expr::Call::Builtin;
+    auto value = expr->arguments[0]->accept(this);
+    auto type = value->getType();
+    switch (expr->builtin) {
+    case Builtin::BITS_COUNT_ONES:
+        return builder->CreateUnaryIntrinsic(llvm::Intrinsic::ctpop, value);
+    case Builtin::BITS_LEADING_ZEROS:
+        // Defined for 0 as well, which costs nothing on machines with `lzcnt`.
+        return builder->CreateIntrinsic(llvm::Intrinsic::ctlz, {type}, {value, builder->getFalse()});
+    case Builtin::BITS_TRAILING_ZEROS:
+        return builder->CreateIntrinsic(llvm::Intrinsic::cttz, {type}, {value, builder->getFalse()});
+    case Builtin::BITS_SWAP_BYTES:
+        // A single byte has nothing to swap, and `llvm.bswap` does not take one.
+        if (type->getScalarSizeInBits() == 8) {
+            return value;
+        }
+        return builder->CreateUnaryIntrinsic(llvm::Intrinsic::bswap, value);
+    default:
+        logger.log_error(expr->location, E_UNREACHABLE, "Code generator could not perform builtin call.");
+        throw CodeGenException();
+    }
+}
+
+llvm::Value* CodeGenerator::generate_vector_builtin(Expr::Call* expr) {
+    using Builtin = Expr::Call::Builtin;
+    auto& args = expr->arguments;
+
+    if (expr->builtin == Builtin::VEC_LOAD || expr->builtin == Builtin::VEC_STORE) {
+        // Find the first element and the number of elements, as a slice of the whole array would.
+        auto elements = args[0]->accept(this);
+        llvm::Value* data = elements;
+        llvm::Value* length = nullptr;
+        std::shared_ptr<Type> element_type = nullptr;
+        if (auto array_type = std::dynamic_pointer_cast<Type::Array>(args[0]->type)) {
+            length = builder->getInt64(array_type->size);
+            element_type = array_type->inner_type;
+        } else {
+            data = builder->CreateExtractValue(elements, 0);
+            length = builder->CreateExtractValue(elements, 1);
+            element_type = std::dynamic_pointer_cast<Type::Slice>(args[0]->type)->inner_type;
+        }
+        auto llvm_element_type = element_type->to_llvm_type(context);
+        auto start = generate_index(args[1].get());
+        // Not `inbounds`: with a mask, the first lanes may be before the elements, as long as they are disabled.
+        auto address = builder->CreateGEP(llvm_element_type, data, start);
+        auto align = ir_module->getDataLayout().getABITypeAlign(llvm_element_type);
+
+        if (expr->builtin == Builtin::VEC_LOAD) {
+            auto mask = args[2]->accept(this);
+            check_lanes(start, length, mask);
+            // The lanes the mask disables are never read, and are zero.
+            auto llvm_vector_type = expr->type->to_llvm_type(context);
+            return builder->CreateMaskedLoad(llvm_vector_type, address, align, mask, llvm::Constant::getNullValue(llvm_vector_type));
+        }
+        auto value = args[2]->accept(this);
+        if (args.size() == 3) {
+            auto lanes = llvm::cast<llvm::FixedVectorType>(value->getType())->getNumElements();
+            check_lanes(start, length, llvm::ConstantInt::getTrue(llvm::FixedVectorType::get(builder->getInt1Ty(), lanes)));
+            builder->CreateAlignedStore(value, address, align);
+        } else {
+            auto mask = args[3]->accept(this);
+            check_lanes(start, length, mask);
+            builder->CreateMaskedStore(value, address, align, mask);
+        }
+        return nullptr;
+    }
+
+    if (expr->builtin == Builtin::VEC_SHUFFLE) {
+        auto first = args[0]->accept(this);
+        auto second = args.size() == 3 ? args[1]->accept(this) : llvm::PoisonValue::get(first->getType());
+        // The local checker made sure that the lanes are integer literals.
+        Expr* lanes_expr = args.back().get();
+        while (auto grouping = dynamic_cast<Expr::Grouping*>(lanes_expr)) {
+            lanes_expr = grouping->expression.get();
+        }
+        std::vector<int> lanes;
+        for (auto& element : static_cast<Expr::Array*>(lanes_expr)->elements) {
+            Expr* lane = element.get();
+            while (auto grouping = dynamic_cast<Expr::Grouping*>(lane)) {
+                lane = grouping->expression.get();
+            }
+            lanes.push_back(std::any_cast<int>(static_cast<Expr::Literal*>(lane)->token.literal));
+        }
+        return builder->CreateShuffleVector(first, second, lanes);
+    }
+
+    if (expr->builtin == Builtin::VEC_SELECT) {
+        auto mask = args[0]->accept(this);
+        auto if_true = args[1]->accept(this);
+        auto if_false = args[2]->accept(this);
+        return builder->CreateSelect(mask, if_true, if_false);
+    }
+
+    // The rest reduce the lanes of a vector to a single value.
+    auto value = args[0]->accept(this);
+    auto lane_type = std::dynamic_pointer_cast<Type::Vector>(args[0]->type)->inner_type;
+    bool is_float = lane_type->is_float();
+    llvm::Value* result = nullptr;
+    switch (expr->builtin) {
+    case Builtin::VEC_SUM:
+        result = is_float ? builder->CreateFAddReduce(llvm::ConstantFP::get(expr->type->to_llvm_type(context), -0.0), value) : builder->CreateAddReduce(value);
+        break;
+    case Builtin::VEC_PRODUCT:
+        result = is_float ? builder->CreateFMulReduce(llvm::ConstantFP::get(expr->type->to_llvm_type(context), 1.0), value) : builder->CreateMulReduce(value);
+        break;
+    case Builtin::VEC_MIN:
+        result = is_float ? builder->CreateFPMinReduce(value) : builder->CreateIntMinReduce(value, !lane_type->is_unsigned());
+        break;
+    case Builtin::VEC_MAX:
+        result = is_float ? builder->CreateFPMaxReduce(value) : builder->CreateIntMaxReduce(value, !lane_type->is_unsigned());
+        break;
+    case Builtin::VEC_ALL:
+        return builder->CreateAndReduce(value);
+    case Builtin::VEC_ANY:
+        return builder->CreateOrReduce(value);
+    default:
+        logger.log_error(expr->location, E_UNREACHABLE, "Code generator could not perform builtin call.");
+        throw CodeGenException();
+    }
+    if (is_float) {
+        // Without reassociation, the lanes would be combined one after another instead of pairwise.
+        llvm::cast<llvm::Instruction>(result)->setHasAllowReassoc(true);
+    }
+    return result;
+}
+
+llvm::Value* CodeGenerator::load_lanes(llvm::Value* data, const std::shared_ptr<Type::Vector>& type) {
+    auto llvm_element_type = type->inner_type->to_llvm_type(context);
+    if (!llvm_element_type->isIntegerTy(1)) {
+        // The elements are laid out like the lanes, but may only be aligned like a single element.
+        return builder->CreateAlignedLoad(type->to_llvm_type(context), data, ir_module->getDataLayout().getABITypeAlign(llvm_element_type));
+    }
+    // A vector packs bools into bits, while memory stores each in a byte of its own.
+    llvm::Value* vector = llvm::PoisonValue::get(type->to_llvm_type(context));
+    for (int i = 0; i < type->size; i++) {
+        auto element = builder->CreateLoad(llvm_element_type, builder->CreateConstInBoundsGEP1_64(llvm_element_type, data, i));
+        vector = builder->CreateInsertElement(vector, element, builder->getInt64(i));
+    }
+    return vector;
+}
+
+void CodeGenerator::store_lanes(llvm::Value* vector, llvm::Value* data, const std::shared_ptr<Type::Vector>& type) {
+    auto llvm_element_type = type->inner_type->to_llvm_type(context);
+    if (!llvm_element_type->isIntegerTy(1)) {
+        builder->CreateAlignedStore(vector, data, ir_module->getDataLayout().getABITypeAlign(llvm_element_type));
+        return;
+    }
+    for (int i = 0; i < type->size; i++) {
+        auto element = builder->CreateExtractElement(vector, builder->getInt64(i));
+        builder->CreateStore(element, builder->CreateConstInBoundsGEP1_64(llvm_element_type, data, i));
+    }
+}
+
+llvm::Value* CodeGenerator::visit_unary_expr(Expr::Unary* expr) {
+    auto right_val = expr->inner->accept(this);
     if (expr->op.tok_type == TOK_BANG) {
         return builder->CreateICmpEQ(right_val, llvm::ConstantInt::get(right_val->getType(), 0));
     } else if (expr->op.tok_type == TOK_MINUS) {
+        if (right_val->getType()->isFPOrFPVectorTy()) {
+            return builder->CreateFNeg(right_val);
+        }
         return builder->CreateNeg(right_val);
+    } else if (expr->op.tok_type == TOK_TILDE) {
+        return builder->CreateNot(right_val);
     } else if (expr->op.tok_type == TOK_AMP) {
         auto right_lvalue = std::dynamic_pointer_cast<Expr::LValue>(expr->inner);
         // This should never be nullptr
         return right_lvalue->get_llvm_allocation(this);
     } else {
-        ErrorLogger::inst().log_error(expr->location, E_UNREACHABLE, "Code generator could not perform unary operation.");
+        logger.log_error(expr->location, E_UNREACHABLE, "Code generator could not perform unary operation.");
         throw CodeGenException();
     }
 }
 
-std::any CodeGenerator::visit_dereference_expr(Expr::Dereference* expr) {
-    auto right_val = std::any_cast<llvm::Value*>(expr->inner->accept(this));
+llvm::Value* CodeGenerator::visit_dereference_expr(Expr::Dereference* expr) {
+    auto right_val = expr->inner->accept(this);
     std::shared_ptr<Type> right_type = expr->inner->type;
     auto right_ptr_type = std::dynamic_pointer_cast<Type::Pointer>(right_type);
     // This should never be nullptr
     auto right_inner_type = right_ptr_type->inner_type;
 
-    llvm::Value* ret = builder->CreateLoad(right_inner_type->to_llvm_type(context), right_val);
+    auto ret = builder->CreateLoad(right_inner_type->to_llvm_type(context), right_val);
+    tag_access(ret, expr);
     return ret;
 }
 
-std::any CodeGenerator::visit_access_expr(Expr::Access* expr) {
+llvm::Value* CodeGenerator::visit_access_expr(Expr::Access* expr) {
     // First visit the left side of the access expression
-    auto struct_alloca = std::any_cast<llvm::Value*>(expr->left->accept(this));
+    auto struct_alloca = expr->left->accept(this);
     // This is a pointer to the struct
 
+    // The length of an array is known, and the length of a slice is stored in it.
+    if (auto array_type = std::dynamic_pointer_cast<Type::Array>(expr->left->type)) {
+        return builder->getInt64(array_type->size);
+    }
+    if (expr->left->type->kind() == Type::Kind::SLICE) {
+        return builder->CreateExtractValue(struct_alloca, 1, "len");
+    }
+
     auto struct_type = std::dynamic_pointer_cast<Type::Struct>(expr->left->type);
     // This should never be nullptr
 
-    // Check if this is a struct member
-    int index = struct_type->struct_scope->instance_members.get_index(expr->ident.lexeme);
-    if (index != -1) {
+    // Check if this is a struct member; the local checker resolved the member's slot
+    if (expr->member_index != -1) {
         // Create a GEP instruction to get the member
-        auto gep = builder->CreateStructGEP(struct_type->to_llvm_aggregate_type(context), struct_alloca, index);
-        llvm::Value* ret = builder->CreateLoad(expr->type->to_llvm_type(context), gep);
+        auto gep = builder->CreateStructGEP(struct_type->to_llvm_aggregate_type(context), struct_alloca, expr->member_index);
+        auto ret = builder->CreateLoad(expr->type->to_llvm_type(context), gep);
+        tag_access(ret, expr);
         return ret;
     }
 
     // Else, we are accessing a static member
-    auto node = struct_type->struct_scope->children.at(expr->ident.lexeme);
-    // This should never throw
-    auto var_node = std::dynamic_pointer_cast<Node::Variable>(node);
+    auto var_node = expr->static_member;
     // This should never be nullptr
 
     // If var_node is a function, the llvm_allocation is the function itself
@@ -504,93 +1915,287 @@ std::any CodeGenerator::visit_access_expr(Expr::Access* expr) {
         return var_node->llvm_allocation;
     }
     // Load the value from the variable
-    llvm::Value* ret = builder->CreateLoad(expr->type->to_llvm_type(context), var_node->llvm_allocation);
+    auto ret = builder->CreateLoad(expr->type->to_llvm_type(context), var_node->llvm_allocation);
+    tag_access(ret, expr);
     return ret;
 }
 
-std::any CodeGenerator::visit_index_expr(Expr::Index* expr) {
+llvm::Value* CodeGenerator::visit_index_expr(Expr::Index* expr) {
     auto tuple_type = std::dynamic_pointer_cast<Type::Tuple>(expr->left->type);
     if (tuple_type != nullptr) {
-        auto tuple_alloca = std::any_cast<llvm::Value*>(expr->left->accept(this));
+        auto tuple_alloca = expr->left->accept(this);
 
         auto literal_right = std::dynamic_pointer_cast<Expr::Literal>(expr->right);
         // This should never be nullptr
         auto index = std::any_cast<int>(literal_right->token.literal);
 
         llvm::Value* val = builder->CreateStructGEP(tuple_type->to_llvm_aggregate_type(context), tuple_alloca, index);
-        llvm::Value* ret = builder->CreateLoad(tuple_type->element_types[index]->to_llvm_type(context), val);
+        auto ret = builder->CreateLoad(tuple_type->element_types[index]->to_llvm_type(context), val);
+        tag_access(ret, expr);
 
         return ret;
     }
 
     auto array_type = std::dynamic_pointer_cast<Type::Array>(expr->left->type);
     if (array_type != nullptr) {
-        auto array_alloca = std::any_cast<llvm::Value*>(expr->left->accept(this));
-        auto index_value = std::any_cast<llvm::Value*>(expr->right->accept(this));
+        auto array_alloca = expr->left->accept(this);
+        auto index_value = generate_index(expr->right.get());
+        check_bounds(expr, index_value, builder->getInt64(array_type->size));
 
         llvm::Value* val = builder->CreateGEP(
             array_type->to_llvm_aggregate_type(context),
             array_alloca,
             {llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0), index_value}
         );
-        llvm::Value* ret = builder->CreateLoad(array_type->inner_type->to_llvm_type(context), val);
+        auto ret = builder->CreateLoad(array_type->inner_type->to_llvm_type(context), val);
+        tag_access(ret, expr);
+        return ret;
+    }
+
+    auto slice_type = std::dynamic_pointer_cast<Type::Slice>(expr->left->type);
+    if (slice_type != nullptr) {
+        auto slice = expr->left->accept(this);
+        auto index_value = generate_index(expr->right.get());
+        check_bounds(expr, index_value, builder->CreateExtractValue(slice, 1));
+        auto ret = builder->CreateLoad(slice_type->inner_type->to_llvm_type(context), get_slice_element(slice, slice_type, index_value));
+        tag_access(ret, expr);
         return ret;
     }
 
-    ErrorLogger::inst().log_error(expr->location, E_UNREACHABLE, "Code generator could not perform index operation.");
+    auto vector_type = std::dynamic_pointer_cast<Type::Vector>(expr->left->type);
+    if (vector_type != nullptr) {
+        auto vector = expr->left->accept(this);
+        auto index_value = generate_index(expr->right.get());
+        check_bounds(expr, index_value, builder->getInt64(vector_type->size));
+        return builder->CreateExtractElement(vector, index_value);
+    }
+
+    logger.log_error(expr->location, E_UNREACHABLE, "Code generator could not perform index operation.");
     throw CodeGenException();
 }
 
-std::any CodeGenerator::visit_call_expr(Expr::Call* expr) {
-    llvm::Value* ret;
+llvm::Value* CodeGenerator::visit_slice_expr(Expr::Slice* expr) {
+    auto left = expr->left->accept(this);
+    auto slice_type = std::dynamic_pointer_cast<Type::Slice>(expr->type);
+    auto element_type = slice_type->inner_type->to_llvm_type(context);
+
+    // Find the first element and the number of elements of what is being sliced; the length of a pointer is unknown.
+    llvm::Value* data = left;
+    llvm::Value* length = nullptr;
+    if (auto array_type = std::dynamic_pointer_cast<Type::Array>(expr->left->type)) {
+        // The array's storage starts with its first element.
+        length = builder->getInt64(array_type->size);
+    } else if (expr->left->type->kind() == Type::Kind::SLICE) {
+        data = builder->CreateExtractValue(left, 0);
+        length = builder->CreateExtractValue(left, 1);
+    }
+
+    auto start = expr->start != nullptr ? generate_index(expr->start.get()) : builder->getInt64(0);
+    auto end = expr->end != nullptr ? generate_index(expr->end.get()) : length;
+    check_slice_bounds(start, end, length);
+
+    // Only the pointer and the length change; the elements are never copied.
+    auto new_data = expr->start != nullptr ? builder->CreateInBoundsGEP(element_type, data, start) : data;
+    auto new_length = expr->start != nullptr ? builder->CreateSub(end, start, "", false, true) : end;
+    return create_slice(new_data, new_length, slice_type);
+}
+
+llvm::Value* CodeGenerator::create_slice(llvm::Value* data, llvm::Value* length, const std::shared_ptr<Type::Slice>& type) {
+    llvm::Value* slice = llvm::PoisonValue::get(type->to_llvm_type(context));
+    slice = builder->CreateInsertValue(slice, data, 0);
+    return builder->CreateInsertValue(slice, length, 1);
+}
+
+llvm::Value* CodeGenerator::get_slice_element(llvm::Value* slice, const std::shared_ptr<Type::Slice>& type, llvm::Value* index) {
+    auto data = builder->CreateExtractValue(slice, 0);
+    return builder->CreateInBoundsGEP(type->inner_type->to_llvm_type(context), data, index);
+}
+
+llvm::Value* CodeGenerator::generate_index(Expr* index) {
+    // An unsigned index is never negative, however large it is.
+    return builder->CreateIntCast(index->accept(this), builder->getInt64Ty(), !index->type->is_unsigned());
+}
+
+void CodeGenerator::check_bounds(Expr::Index* expr, llvm::Value* index, llvm::Value* length) {
+    if (!bounds_check || expr->in_bounds || block_stack.empty()) {
+        return;
+    }
+    // A negative index wraps to a huge unsigned one, so a single unsigned comparison checks both ends.
+    trap_unless(builder->CreateICmpULT(index, length, "in_bounds"));
+}
+
+void CodeGenerator::check_slice_bounds(llvm::Value* start, llvm::Value* end, llvm::Value* length) {
+    if (!bounds_check || block_stack.empty()) {
+        return;
+    }
+    if (length == nullptr) {
+        trap_unless(builder->CreateICmpSLE(start, end, "in_bounds"));
+        return;
+    }
+    // As with indexes, negative bounds wrap to huge unsigned ones and fail the comparisons.
+    auto end_in_bounds = builder->CreateICmpULE(end, length);
+    auto in_bounds = builder->CreateAnd(builder->CreateICmpULE(start, end), end_in_bounds, "in_bounds");
+    // Constant bounds, e.g. `array[1..3]`, fold to a constant that needs no check.
+    if (auto constant = llvm::dyn_cast<llvm::ConstantInt>(in_bounds); constant != nullptr && constant->isOne()) {
+        return;
+    }
+    trap_unless(in_bounds);
+}
+
+void CodeGenerator::check_lanes(llvm::Value* start, llvm::Value* length, llvm::Value* mask) {
+    if (!bounds_check || block_stack.empty()) {
+        return;
+    }
+    // Each lane is checked like an index of its own.
+    auto lanes = llvm::cast<llvm::FixedVectorType>(mask->getType())->getNumElements();
+    std::vector<llvm::Constant*> offsets;
+    for (unsigned i = 0; i < lanes; i++) {
+        offsets.push_back(builder->getInt64(i));
+    }
+    auto indexes = builder->CreateAdd(builder->CreateVectorSplat(lanes, start), llvm::ConstantVector::get(offsets));
+    auto in_range = builder->CreateICmpULT(indexes, builder->CreateVectorSplat(lanes, length));
+    // The lanes the mask disables are never accessed, so they are always fine.
+    auto accessible = builder->CreateOr(in_range, builder->CreateNot(mask));
+    trap_unless(builder->CreateAndReduce(accessible));
+}
+
+void CodeGenerator::trap_unless(llvm::Value* condition) {
+    auto fun = builder->GetInsertBlock()->getParent();
+    if (bounds_trap_block == nullptr) {
+        // Every failed check of a function stops the program in the same block, placed before the exit block to keep it out of loops.
+        bounds_trap_block = llvm::BasicBlock::Create(*context, "bounds_trap", fun, block_stack.front());
+        llvm::IRBuilder<> trap_builder(bounds_trap_block);
+        trap_builder.CreateIntrinsic(llvm::Intrinsic::trap, {}, {});
+        trap_builder.CreateUnreachable();
+    }
+
+    auto in_bounds_block = llvm::BasicBlock::Create(*context, "in_bounds", fun);
+    llvm::MDBuilder md_builder(*context);
+    builder->CreateCondBr(condition, in_bounds_block, bounds_trap_block, md_builder.createBranchWeights(1 << 20, 1));
+    builder->SetInsertPoint(in_bounds_block);
+}
+
+llvm::Value* CodeGenerator::convert_implicitly(llvm::Value* value, const std::shared_ptr<Type>& from, const std::shared_ptr<Type>& to) {
+    auto array_type = std::dynamic_pointer_cast<Type::Array>(from);
+    auto slice_type = std::dynamic_pointer_cast<Type::Slice>(to);
+    if (array_type != nullptr && slice_type != nullptr) {
+        // The array's storage starts with its first element.
+        return create_slice(value, builder->getInt64(array_type->size), slice_type);
+    }
+    return value;
+}
+
+llvm::Value* CodeGenerator::visit_call_expr(Expr::Call* expr) {
+    // Builtins are not functions; their callee was never resolved.
+    if (expr->builtin >= Expr::Call::Builtin::BITS_COUNT_ONES) {
+        return generate_bits_builtin(expr);
+    }
+    if (expr->builtin != Expr::Call::Builtin::NONE) {
+        return generate_vector_builtin(expr);
+    }
+    // Variants with a payload are called like functions
+    if (expr->variant >= 0) {
+        return generate_variant(expr->type, expr->variant, expr->arguments);
+    }
+
     // Get the function
-    auto fun = llvm::cast<llvm::Function>(std::any_cast<llvm::Value*>(expr->callee->accept(this)));
-    // Get the arguments
+    auto fun = llvm::cast<llvm::Function>(expr->callee->accept(this));
+    auto type = std::dynamic_pointer_cast<Type::Function>(expr->callee->type);
+    // This should never be nullptr
+    if (extern_functions.count(fun) != 0) {
+        return generate_c_call(fun, *type, expr);
+    }
+
     std::vector<llvm::Value*> args;
-    for (auto& arg : expr->arguments) {
-        args.push_back(std::any_cast<llvm::Value*>(arg->accept(this)));
+    // An aggregate result is written to storage provided by the caller.
+    llvm::AllocaInst* result = nullptr;
+    auto aggregate_return_type = std::dynamic_pointer_cast<Type::Aggregate>(type->return_type);
+    if (aggregate_return_type != nullptr) {
+        result = create_temporary(aggregate_return_type->to_llvm_aggregate_type(context));
+        args.push_back(result);
+    }
+    // Get the arguments
+    for (size_t i = 0; i < expr->arguments.size(); i++) {
+        args.push_back(expr->arguments[i]->accept(this));
+        // The callee may keep a pointer to an aggregate argument.
+        retain_temporary(args.back());
+        args.back() = convert_implicitly(args.back(), expr->arguments[i]->type, type->params[i].second);
     }
     // Call the function
-    ret = builder->CreateCall(fun, args);
+    auto call = builder->CreateCall(fun, args);
+    call->setAttributes(fun->getAttributes());
 
-    if (fun->getReturnType()->isAggregateType()) {
-        // If the function returns an aggregate type, we need to store the return value in an alloca instruction
-        auto alloca = builder->CreateAlloca(fun->getReturnType());
-        builder->CreateStore(ret, alloca);
-        return (llvm::Value*)alloca;
+    if (result != nullptr) {
+        return result;
     }
-
-    return ret;
+    return call;
 }
 
-std::any CodeGenerator::visit_cast_expr(Expr::Cast* expr) {
-    auto left_value = std::any_cast<llvm::Value*>(expr->expression->accept(this));
+llvm::Value* CodeGenerator::visit_cast_expr(Expr::Cast* expr) {
+    auto left_value = expr->expression->accept(this);
     auto left_type = expr->expression->type;
     auto target_type = expr->type;
+    auto llvm_target_type = target_type->to_llvm_type(context);
+
+    // An array and a vector with as many lanes convert through the array's storage, which starts with its first element.
+    auto target_vector_type = std::dynamic_pointer_cast<Type::Vector>(target_type);
+    if (target_vector_type != nullptr && left_type->kind() == Type::Kind::ARRAY) {
+        return load_lanes(left_value, target_vector_type);
+    }
+    if (auto target_array_type = std::dynamic_pointer_cast<Type::Array>(target_type)) {
+        auto storage = create_temporary(target_array_type->to_llvm_aggregate_type(context));
+        store_lanes(left_value, storage, std::dynamic_pointer_cast<Type::Vector>(left_type));
+        return storage;
+    }
+
+    // Vectors are cast lane by lane, like scalars of their lane type; a scalar fills every lane first.
+    if (target_vector_type != nullptr) {
+        auto left_vector_type = std::dynamic_pointer_cast<Type::Vector>(left_type);
+        if (left_vector_type == nullptr) {
+            left_value = builder->CreateVectorSplat(target_vector_type->size, left_value);
+        } else {
+            left_type = left_vector_type->inner_type;
+        }
+        target_type = target_vector_type->inner_type;
+        if (left_type->to_string() == target_type->to_string()) {
+            return left_value;
+        }
+    }
+
+    // Widening keeps the value of the source, so it extends with the source's sign.
     if (left_type->is_int() && target_type->is_int()) {
-        return builder->CreateIntCast(left_value, target_type->to_llvm_type(context), true);
+        return builder->CreateIntCast(left_value, llvm_target_type, !left_type->is_unsigned());
     } else if (left_type->is_float() && target_type->is_float()) {
-        return builder->CreateFPCast(left_value, target_type->to_llvm_type(context));
+        return builder->CreateFPCast(left_value, llvm_target_type);
     } else if (left_type->is_int() && target_type->is_float()) {
-        return builder->CreateSIToFP(left_value, target_type->to_llvm_type(context));
+        return left_type->is_unsigned() ? builder->CreateUIToFP(left_value, llvm_target_type) : builder->CreateSIToFP(left_value, llvm_target_type);
     } else if (left_type->is_float() && target_type->is_int()) {
-        return builder->CreateFPToSI(left_value, target_type->to_llvm_type(context));
+        return target_type->is_unsigned() ? builder->CreateFPToUI(left_value, llvm_target_type) : builder->CreateFPToSI(left_value, llvm_target_type);
+    } else if (left_type->is_float() && target_type->to_string() == "::bool") {
+        // NaN is not zero, so it is true.
+        return builder->CreateFCmpUNE(left_value, llvm::Constant::getNullValue(left_value->getType()));
     } else if ((left_type->is_numeric() || left_type->kind() == Type::Kind::POINTER) && target_type->to_string() == "::bool") {
         return builder->CreateICmpNE(left_value, llvm::Constant::getNullValue(left_value->getType()));
     } else {
-        ErrorLogger::inst().log_error(expr->location, E_UNREACHABLE, "Code generator could not perform cast from " + left_type->to_string() + " to " + target_type->to_string() + ".");
+        logger.log_error(expr->location, E_UNREACHABLE, "Code generator could not perform cast from " + left_type->to_string() + " to " + target_type->to_string() + ".");
         throw CodeGenException();
     }
 }
 
-std::any CodeGenerator::visit_grouping_expr(Expr::Grouping* expr) {
-    return std::any_cast<llvm::Value*>(expr->expression->accept(this));
+llvm::Value* CodeGenerator::visit_grouping_expr(Expr::Grouping* expr) {
+    return expr->expression->accept(this);
 }
 
-std::any CodeGenerator::visit_identifier_expr(Expr::Identifier* expr) {
-    // Get the variable node
-    auto var_node = Environment::inst().get_variable(expr->tokens);
-    // This should never be nullptr
+llvm::Value* CodeGenerator::visit_identifier_expr(Expr::Identifier* expr) {
+    if (expr->variant >= 0) {
+        return generate_variant(expr->type, expr->variant, {});
+    }
+    // The local checker already resolved the variable node
+    auto var_node = expr->variable;
+    if (var_node == nullptr) {
+        logger.log_error(expr->location, E_IMPOSSIBLE, "Identifier `" + expr->to_string() + "` was never resolved.");
+        throw CodeGenException();
+    }
 
     // If var_node is a function, the llvm_allocation is the function itself
     if (var_node->decl->type->kind() == Type::Kind::FUNCTION) {
@@ -601,16 +2206,17 @@ std::any CodeGenerator::visit_identifier_expr(Expr::Identifier* expr) {
     llvm::AllocaInst* alloca = llvm::dyn_cast<llvm::AllocaInst>(var_node->llvm_allocation);
     llvm::GlobalVariable* global = llvm::dyn_cast<llvm::GlobalVariable>(var_node->llvm_allocation);
     if (alloca == nullptr && global == nullptr) {
-        ErrorLogger::inst().log_error(expr->location, E_IMPOSSIBLE, "Variable allocation is neither alloca nor global.");
+        logger.log_error(expr->location, E_IMPOSSIBLE, "Variable allocation is neither alloca nor global.");
         throw CodeGenException();
     }
     llvm::Type* type = alloca != nullptr ? alloca->getAllocatedType() : global->getValueType();
 
-    llvm::Value* ret = builder->CreateLoad(type, var_node->llvm_allocation);
+    auto ret = builder->CreateLoad(type, var_node->llvm_allocation);
+    tag_access(ret, expr);
     return ret;
 }
 
-std::any CodeGenerator::visit_literal_expr(Expr::Literal* expr) {
+llvm::Value* CodeGenerator::visit_literal_expr(Expr::Literal* expr) {
     llvm::Value* ret;
 
     if (expr->token.tok_type == TOK_NIL) {
@@ -628,25 +2234,29 @@ std::any CodeGenerator::visit_literal_expr(Expr::Literal* expr) {
         ret = llvm::ConstantInt::get(llvm::Type::getInt8Ty(*context), value, false);
     } else if (expr->token.tok_type == TOK_STR) {
         auto value = std::any_cast<std::string>(expr->token.literal);
-        ret = builder->CreateGlobalStringPtr(value);
+        ret = builder->CreateGlobalStringPtr(value, "", 0, ir_module.get());
     } else {
-        ErrorLogger::inst().log_error(expr->location, E_IMPOSSIBLE, "Unknown literal type.");
+        logger.log_error(expr->location, E_IMPOSSIBLE, "Unknown literal type.");
         throw CodeGenException();
     }
 
     return ret;
 }
 
-std::any CodeGenerator::visit_array_expr(Expr::Array* expr) {
+llvm::Value* CodeGenerator::visit_array_expr(Expr::Array* expr) {
     auto array_type = std::dynamic_pointer_cast<Type::Array>(expr->type);
+    if (auto constant = constant_aggregate(expr)) {
+        return copy_constant_aggregate(constant, array_type);
+    }
 
     // Allocate space for the array
     auto llvm_array_type = array_type->to_llvm_aggregate_type(context);
-    auto array_alloca = builder->CreateAlloca(llvm_array_type);
+    auto array_alloca = create_temporary(llvm_array_type);
 
     unsigned i = 0;
     for (auto& val_expr : expr->elements) {
-        auto member_value = std::any_cast<llvm::Value*>(val_expr->accept(this));
+        auto member_value = val_expr->accept(this);
+        retain_temporary(member_value);
         auto member_alloc = builder->CreateGEP(
             llvm_array_type,
             array_alloca,
@@ -662,42 +2272,65 @@ std::any CodeGenerator::visit_array_expr(Expr::Array* expr) {
     return (llvm::Value*)array_alloca;
 }
 
-std::any CodeGenerator::visit_array_gen_expr(Expr::ArrayGen* expr) {
+llvm::Value* CodeGenerator::visit_array_gen_expr(Expr::ArrayGen* expr) {
     auto array_type = std::dynamic_pointer_cast<Type::Array>(expr->type);
+    if (auto constant = constant_aggregate(expr)) {
+        return copy_constant_aggregate(constant, array_type);
+    }
 
     // Allocate space for the array
     auto llvm_array_type = array_type->to_llvm_aggregate_type(context);
-    auto array_alloca = builder->CreateAlloca(llvm_array_type);
+    auto array_alloca = create_temporary(llvm_array_type);
+
+    // The generator is evaluated once per element, so aggregate elements are copied into storage of their own.
+    auto element_aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(array_type->inner_type);
+    llvm::Type* llvm_elements_type = nullptr;
+    llvm::AllocaInst* elements_alloca = nullptr;
+    if (element_aggregate_type != nullptr) {
+        llvm_elements_type = llvm::ArrayType::get(element_aggregate_type->to_llvm_aggregate_type(context), array_type->size);
+        elements_alloca = create_temporary(llvm_elements_type);
+    }
 
-    llvm::Value* start_val = llvm::ConstantInt::get(*context, llvm::APInt(32, 0, true));
-    llvm::AllocaInst* counter = builder->CreateAlloca(llvm::Type::getInt32Ty(*context), nullptr, "loop_counter");
-    builder->CreateStore(start_val, counter);
+    if (array_type->size == 0) {
+        return (llvm::Value*)array_alloca;
+    }
 
+    // The loop is emitted in the canonical form LLVM's loop passes expect: a single block that is entered once,
+    // with an induction variable counting up from 0 and the exit test at the bottom.
     llvm::Function* current_fun = builder->GetInsertBlock()->getParent();
-    llvm::BasicBlock* start_arraygen = llvm::BasicBlock::Create(*context, "arraygen_start", current_fun);
+    llvm::BasicBlock* preheader = builder->GetInsertBlock();
     llvm::BasicBlock* loop_arraygen = llvm::BasicBlock::Create(*context, "arraygen_loop", current_fun);
     llvm::BasicBlock* end_arraygen = llvm::BasicBlock::Create(*context, "arraygen_end", current_fun);
-    builder->CreateBr(start_arraygen);
-
-    // Start block: checks the loop condition
-    builder->SetInsertPoint(start_arraygen);
-    llvm::Value* counter_val = builder->CreateLoad(llvm::Type::getInt32Ty(*context), counter);
-    llvm::Value* cond = builder->CreateICmpSLT(counter_val, llvm::ConstantInt::get(*context, llvm::APInt(32, array_type->size, true)));
-    builder->CreateCondBr(cond, loop_arraygen, end_arraygen);
+    builder->CreateBr(loop_arraygen);
 
     // Loop block: runs the loop iteration
     builder->SetInsertPoint(loop_arraygen);
-    llvm::Value* index = builder->CreateLoad(llvm::Type::getInt32Ty(*context), counter);
-    llvm::Value* value = std::any_cast<llvm::Value*>(expr->generator->accept(this));
-    llvm::Value* member_alloc = builder->CreateGEP(
+    auto index_type = llvm::Type::getInt64Ty(*context);
+    llvm::PHINode* index = builder->CreatePHI(index_type, 2, "arraygen_index");
+    index->addIncoming(llvm::ConstantInt::get(index_type, 0), preheader);
+    temporary_scopes.emplace_back();
+    llvm::Value* value = expr->generator->accept(this);
+    if (element_aggregate_type != nullptr) {
+        auto element_storage = builder->CreateGEP(
+            llvm_elements_type,
+            elements_alloca,
+            {llvm::ConstantInt::get(index_type, 0), index}
+        );
+        copy_aggregate(element_storage, value, element_aggregate_type);
+        value = element_storage;
+    }
+    llvm::Value* member_alloc = builder->CreateInBoundsGEP(
         llvm_array_type,
         array_alloca,
-        {llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0), index}
+        {llvm::ConstantInt::get(index_type, 0), index}
     );
     builder->CreateStore(value, member_alloc);
-    llvm::Value* new_counter = builder->CreateAdd(counter_val, llvm::ConstantInt::get(*context, llvm::APInt(32, 1, true)));
-    builder->CreateStore(new_counter, counter);
-    builder->CreateBr(start_arraygen);
+    end_temporary_scope();
+    // The index stays below the array size, so the increment cannot wrap.
+    llvm::Value* next_index = builder->CreateAdd(index, llvm::ConstantInt::get(index_type, 1), "arraygen_next", true, true);
+    index->addIncoming(next_index, builder->GetInsertBlock());
+    llvm::Value* done = builder->CreateICmpEQ(next_index, llvm::ConstantInt::get(index_type, array_type->size));
+    builder->CreateCondBr(done, end_arraygen, loop_arraygen);
 
     // End block: continues after the loop
     builder->SetInsertPoint(end_arraygen);
@@ -705,19 +2338,23 @@ std::any CodeGenerator::visit_array_gen_expr(Expr::ArrayGen* expr) {
     return (llvm::Value*)array_alloca;
 }
 
-std::any CodeGenerator::visit_tuple_expr(Expr::Tuple* expr) {
+llvm::Value* CodeGenerator::visit_tuple_expr(Expr::Tuple* expr) {
     auto tuple_type = std::dynamic_pointer_cast<Type::Tuple>(expr->type);
+    if (auto constant = constant_aggregate(expr)) {
+        return copy_constant_aggregate(constant, tuple_type);
+    }
 
     // Allocate space for the tuple
     auto llvm_tuple_type = tuple_type->to_llvm_aggregate_type(context);
-    auto tuple_alloca = builder->CreateAlloca(llvm_tuple_type);
+    auto tuple_alloca = create_temporary(llvm_tuple_type);
     // An llvm tuple is actually a struct
     // Structs in llvm do not have member names
     // Members are accessed by index, which is what we do for tuples anyway
 
     unsigned i = 0;
     for (auto& val_expr : expr->elements) {
-        auto member_value = std::any_cast<llvm::Value*>(val_expr->accept(this));
+        auto member_value = val_expr->accept(this);
+        retain_temporary(member_value);
         auto member_alloc = builder->CreateStructGEP(llvm_tuple_type, tuple_alloca, i);
         builder->CreateStore(member_value, member_alloc);
 
@@ -727,18 +2364,22 @@ std::any CodeGenerator::visit_tuple_expr(Expr::Tuple* expr) {
     return (llvm::Value*)tuple_alloca;
 }
 
-std::any CodeGenerator::visit_object_expr(Expr::Object* expr) {
+llvm::Value* CodeGenerator::visit_object_expr(Expr::Object* expr) {
     auto struct_type = std::dynamic_pointer_cast<Type::Struct>(expr->type);
     // This should never be nullptr
+    if (auto constant = constant_aggregate(expr)) {
+        return copy_constant_aggregate(constant, struct_type);
+    }
 
     // Create the struct
     auto llvm_struct_type = struct_type->to_llvm_aggregate_type(context);
-    auto struct_alloca = builder->CreateAlloca(llvm_struct_type);
+    auto struct_alloca = create_temporary(llvm_struct_type);
 
     unsigned i = 0;
     for (auto& [name, val_expr] : expr->fields) {
         // Add the value to the struct
-        auto member_value = std::any_cast<llvm::Value*>(val_expr->accept(this));
+        auto member_value = val_expr->accept(this);
+        retain_temporary(member_value);
         auto member_alloc = builder->CreateStructGEP(llvm_struct_type, struct_alloca, i);
         builder->CreateStore(member_value, member_alloc);
 
@@ -748,13 +2389,149 @@ std::any CodeGenerator::visit_object_expr(Expr::Object* expr) {
     return (llvm::Value*)struct_alloca;
 }
 
-CodeGenerator::CodeGenerator() {
-    context = Environment::inst().get_llvm_context();
+llvm::Value* CodeGenerator::generate_variant(const std::shared_ptr<Type>& type, int variant_index, const std::vector<std::shared_ptr<Expr>>& arguments) {
+    auto enum_decl = std::dynamic_pointer_cast<Type::Named>(type)->struct_scope->enum_decl;
+    auto& variant = enum_decl->variants[variant_index];
+    auto tag_type = llvm::IntegerType::get(*context, enum_decl->tag_bits());
+
+    if (enum_decl->layout == Decl::Enum::Layout::TAG) {
+        return llvm::ConstantInt::get(tag_type, variant_index);
+    }
+    if (enum_decl->layout == Decl::Enum::Layout::NICHE) {
+        // The payload is the value; the other variants take the values the payload never has
+        if (arguments.empty()) {
+            return llvm::ConstantInt::get(tag_type, enum_decl->niche_start + variant_index);
+        }
+        return builder->CreateZExt(arguments[0]->accept(this), tag_type);
+    }
+
+    auto union_type = std::dynamic_pointer_cast<Type::Struct>(type)->to_llvm_aggregate_type(context);
+    auto storage = create_temporary(union_type);
+    builder->CreateStore(llvm::ConstantInt::get(tag_type, variant_index), builder->CreateStructGEP(union_type, storage, 0));
+    auto payload_type = get_payload_type(variant);
+    auto payload = builder->CreateStructGEP(union_type, storage, 1);
+    for (size_t i = 0; i < arguments.size(); i++) {
+        auto field_value = arguments[i]->accept(this);
+        retain_temporary(field_value);
+        field_value = convert_implicitly(field_value, arguments[i]->type, variant.payload[i]);
+        builder->CreateStore(field_value, builder->CreateStructGEP(payload_type, payload, i));
+    }
+    return storage;
+}
+
+llvm::Value* CodeGenerator::visit_alloc_expr(Expr::Alloc* expr) {
+    if (block_stack.empty()) {
+        logger.log_error(expr->location, E_NOT_A_CONSTANT, "Global variable initializer is not a constant.");
+        throw CodeGenException();
+    }
+    auto slice_type = std::dynamic_pointer_cast<Type::Slice>(expr->type);
+    auto element_type = slice_type != nullptr ? slice_type->inner_type : std::dynamic_pointer_cast<Type::Pointer>(expr->type)->inner_type;
+    auto count = expr->count != nullptr ? generate_index(expr->count.get()) : builder->getInt64(1);
+
+    // A negative count, a size that does not fit in 64 bits, or running out of memory stops the program.
+    auto layout = heap_layout(element_type, count);
+    auto valid_count = builder->CreateICmpSGE(count, builder->getInt64(0));
+    trap_unless(builder->CreateAnd(valid_count, builder->CreateNot(layout.overflow), "valid_size"));
+    auto memory = builder->CreateCall(runtime->get_alloc(), {layout.size, builder->getInt64(layout.align)}, "heap");
+    trap_unless(builder->CreateIsNotNull(memory, "allocated"));
+    builder->CreateMemSet(memory, builder->getInt8(0), layout.size, llvm::MaybeAlign(layout.align));
+
+    if (layout.storage_offset != nullptr) {
+        // Point each aggregate element at its storage.
+        auto storage_type = std::dynamic_pointer_cast<Type::Aggregate>(element_type)->to_llvm_aggregate_type(context);
+        auto storage = builder->CreateInBoundsGEP(builder->getInt8Ty(), memory, layout.storage_offset);
+        if (expr->count == nullptr) {
+            builder->CreateStore(storage, memory);
+        } else {
+            auto fun = builder->GetInsertBlock()->getParent();
+            auto before_block = builder->GetInsertBlock();
+            auto init_block = llvm::BasicBlock::Create(*context, "alloc_init", fun);
+            auto done_block = llvm::BasicBlock::Create(*context, "alloc_done", fun);
+            builder->CreateCondBr(builder->CreateICmpSGT(count, builder->getInt64(0)), init_block, done_block);
+
+            builder->SetInsertPoint(init_block);
+            auto i = builder->CreatePHI(builder->getInt64Ty(), 2, "i");
+            i->addIncoming(builder->getInt64(0), before_block);
+            auto element = builder->CreateInBoundsGEP(element_type->to_llvm_type(context), memory, i);
+            builder->CreateStore(builder->CreateInBoundsGEP(storage_type, storage, i), element);
+            auto next = builder->CreateAdd(i, builder->getInt64(1), "", true, true);
+            i->addIncoming(next, init_block);
+            builder->CreateCondBr(builder->CreateICmpSLT(next, count), init_block, done_block);
+            builder->SetInsertPoint(done_block);
+        }
+    }
+
+    if (slice_type == nullptr) {
+        return memory;
+    }
+    return create_slice(memory, count, slice_type);
+}
+
+llvm::Value* CodeGenerator::visit_dealloc_expr(Expr::Dealloc* expr) {
+    auto value = expr->expression->accept(this);
+    llvm::Value* memory = value;
+    llvm::Value* count = builder->getInt64(1);
+    std::shared_ptr<Type> element_type = nullptr;
+    if (auto slice_type = std::dynamic_pointer_cast<Type::Slice>(expr->expression->type)) {
+        memory = builder->CreateExtractValue(value, 0);
+        count = builder->CreateExtractValue(value, 1);
+        element_type = slice_type->inner_type;
+    } else {
+        element_type = std::dynamic_pointer_cast<Type::Pointer>(expr->expression->type)->inner_type;
+    }
+
+    // The allocator is told the size the memory was allocated with.
+    auto layout = heap_layout(element_type, count);
+    builder->CreateCall(runtime->get_dealloc(), {memory, layout.size, builder->getInt64(layout.align)});
+    return nullptr;
+}
+
+CodeGenerator::HeapLayout CodeGenerator::heap_layout(const std::shared_ptr<Type>& element_type, llvm::Value* count) {
+    auto& data_layout = ir_module->getDataLayout();
+    auto llvm_element_type = element_type->to_llvm_type(context);
+    HeapLayout layout;
+    layout.overflow = builder->getFalse();
+    // Each step of the size records whether it overflowed.
+    auto checked = [&](llvm::Intrinsic::ID id, llvm::Value* left, llvm::Value* right) {
+        auto result = builder->CreateBinaryIntrinsic(id, left, right);
+        layout.overflow = builder->CreateOr(layout.overflow, builder->CreateExtractValue(result, 1));
+        return builder->CreateExtractValue(result, 0);
+    };
+    layout.size = checked(llvm::Intrinsic::umul_with_overflow, count, builder->getInt64(data_layout.getTypeAllocSize(llvm_element_type).getFixedValue()));
+    layout.align = data_layout.getABITypeAlign(llvm_element_type).value();
+
+    auto aggregate_type = std::dynamic_pointer_cast<Type::Aggregate>(element_type);
+    if (aggregate_type != nullptr) {
+        auto storage_type = aggregate_type->to_llvm_aggregate_type(context);
+        auto storage_size = data_layout.getTypeAllocSize(storage_type).getFixedValue();
+        auto storage_align = data_layout.getABITypeAlign(storage_type).value();
+        // The storage follows the pointers to it, aligned for the aggregate.
+        auto padded_size = checked(llvm::Intrinsic::uadd_with_overflow, layout.size, builder->getInt64(storage_align - 1));
+        layout.storage_offset = builder->CreateAnd(padded_size, builder->getInt64(~(storage_align - 1)));
+        auto total_storage_size = checked(llvm::Intrinsic::umul_with_overflow, count, builder->getInt64(storage_size));
+        layout.size = checked(llvm::Intrinsic::uadd_with_overflow, layout.storage_offset, total_storage_size);
+        layout.align = std::max(layout.align, storage_align);
+    }
+    return layout;
+}
+
+CodeGenerator::CodeGenerator(CompilationContext& compilation)
+    : compilation(compilation), environment(compilation.get_environment()), logger(compilation.get_logger()) {
+    context = environment.get_llvm_context();
     builder = std::make_shared<llvm::IRBuilder<>>(*context);
     ir_module = std::make_unique<llvm::Module>("main", *context);
+    // Aggregate layouts and the C calling convention depend on the target, so generate for the host from the start.
+    if (auto target_machine = create_host_target_machine()) {
+        ir_module->setTargetTriple(target_machine->getTargetTriple().str());
+        ir_module->setDataLayout(target_machine->createDataLayout());
+    }
+    c_abi = std::make_unique<CAbi>(*ir_module);
+    runtime = std::make_unique<Runtime>(*ir_module);
 }
 
 std::unique_ptr<llvm::Module> CodeGenerator::generate(std::vector<std::shared_ptr<Stmt>> stmts, const std::string& ir_target_destination) {
+    // Code outside the generator (e.g. lvalue expressions) finds the compilation through the thread's binding.
+    CompilationContext::Binding binding(compilation);
     declare_all_structs();
     declare_all_functions();
     try {
@@ -762,13 +2539,17 @@ std::unique_ptr<llvm::Module> CodeGenerator::generate(std::vector<std::shared_pt
         for (auto& stmt : stmts) {
             stmt->accept(this);
         }
+        // Define the parts of the runtime the module uses.
+        runtime->define();
+        // Initializers run last, since they may call anything.
+        evaluate_initializers();
     } catch (const CodeGenException&) {
         return nullptr;
     } catch (const std::bad_any_cast&) {
-        ErrorLogger::inst().log_error(E_ANY_CAST, "Bad any cast in code generation.");
+        logger.log_error(E_ANY_CAST, "Bad any cast in code generation.");
         return nullptr;
     } catch (const std::exception& e) {
-        ErrorLogger::inst().log_error(E_UNKNOWN, e.what());
+        logger.log_error(E_UNKNOWN, e.what());
         return nullptr;
     }
 
@@ -778,7 +2559,7 @@ std::unique_ptr<llvm::Module> CodeGenerator::generate(std::vector<std::shared_pt
 
     // Verify the module
     if (llvm::verifyModule(*ir_module, &llvm::errs())) {
-        ErrorLogger::inst().log_error(E_UNVERIFIED_MODULE, "The generated module could not be verified.");
+        logger.log_error(E_UNVERIFIED_MODULE, "The generated module could not be verified.");
         return nullptr;
     }
 
@@ -791,7 +2572,7 @@ void CodeGenerator::dump_ir(const std::string& filename) {
     llvm::raw_fd_ostream ir_stream(filename, ec, llvm::sys::fs::OF_Text);
 
     if (ec) {
-        ErrorLogger::inst().log_error(E_IO, std::string("Could not dump IR to file: ") + ec.message());
+        logger.log_error(E_IO, std::string("Could not dump IR to file: ") + ec.message());
         return;
     }
 
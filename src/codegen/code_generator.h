@@ -1,16 +1,21 @@
 #ifndef CODE_GENERATOR_H
 #define CODE_GENERATOR_H
 
+#include "../compiler/compilation_context.h"
 #include "../utility/decl.h"
 #include "../utility/expr.h"
 #include "../utility/stmt.h"
+#include "c_abi.h"
+#include "purity_analyzer.h"
+#include "runtime.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
-#include <any>
 #include <exception>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /**
@@ -26,11 +31,23 @@ class CodeGenException : public std::exception {};
  * That is the responsibility of the type checker.
  *
  */
-class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::Visitor {
+class CodeGenerator : public Stmt::Visitor<llvm::Value*>, public Decl::Visitor<llvm::Value*>, public Expr::Visitor<llvm::Value*> {
+    // The compilation being generated.
+    CompilationContext& compilation;
+    // The environment of the compilation.
+    Environment& environment;
+    // The logger of the compilation.
+    ErrorLogger& logger;
     // A shared pointer to the LLVM context, created in Environment.
     std::shared_ptr<llvm::LLVMContext> context;
     // The LLVM module that will be generated.
     std::unique_ptr<llvm::Module> ir_module;
+    // How aggregates are passed to and returned from `extern` functions on the target.
+    std::unique_ptr<CAbi> c_abi;
+    // The `extern` functions of the module; calls to them follow the C calling convention.
+    std::unordered_set<llvm::Function*> extern_functions;
+    // The runtime allocator that `alloc` and `dealloc` call into.
+    std::unique_ptr<Runtime> runtime;
 
     // The current function being generated.
     // llvm::Function* current_function;
@@ -38,14 +55,72 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
 
     // A stack of blocks for control flow; break stmts will jump to the last block in this stack; return stmts will jump to the first block in this stack.
     std::vector<llvm::BasicBlock*> block_stack;
+    // The allocation of the return value of the current function; nullptr if the function returns nothing.
+    llvm::Value* return_allocation = nullptr;
+    // The aggregate return type of the current function; nullptr if it returns a scalar or nothing.
+    // Aggregates are returned through `return_allocation`, which points to storage provided by the caller.
+    std::shared_ptr<Type::Aggregate> return_aggregate_type = nullptr;
+    // The last alloca placed in the entry block of the current function; new allocas go right after it.
+    llvm::AllocaInst* last_entry_alloca = nullptr;
+    // For each loop being generated, the temporaries created in its body whose lifetime ends with the iteration.
+    std::vector<std::vector<llvm::AllocaInst*>> temporary_scopes;
+
+    // Whether loads and stores are tagged with type-based alias analysis (TBAA) metadata.
+    bool strict_aliasing = false;
+    // Whether indexes into arrays and slices are checked at runtime, unless the local checker proved them in range.
+    bool bounds_check = false;
+    // The block a failed bounds check of the current function branches to; nullptr until the first check.
+    llvm::BasicBlock* bounds_trap_block = nullptr;
+    // The root of the TBAA type descriptors; nullptr until the first access is tagged.
+    llvm::MDNode* tbaa_root = nullptr;
+    // The TBAA type descriptors, by the name of the Niter type they describe.
+    std::unordered_map<std::string, llvm::MDNode*> tbaa_types;
+
+    // The function node of each function with a body, and what the PurityAnalyzer inferred it may do.
+    std::unordered_map<llvm::Function*, std::pair<Node::Variable*, FunctionEffects>> function_effects;
+
+    /**
+     * @brief A global variable whose initializer is computed at compile time, once the rest of the module has been generated.
+     *
+     */
+    struct PendingInitializer {
+        // The declaration of the variable.
+        Decl::Var* decl;
+        // The function that computes the initializer and stores it to the destination.
+        llvm::Function* initializer;
+        // The global the initializer is stored to: the variable itself, or the storage of an aggregate variable.
+        llvm::GlobalVariable* destination;
+    };
+    // The initializers to compute, in the order the variables are declared in.
+    std::vector<PendingInitializer> pending_initializers;
 
     /**
      * @brief Traverses the entire namespace tree and declares all structs.
      * Also assigns the struct type to the struct node in the tree.
+     * Enums whose values are integers keep their integer type; tagged unions are laid out last.
      *
      */
     void declare_all_structs();
 
+    /**
+     * @brief Gets the literal struct that holds the payload of an enum variant, e.g. `{ double, double }` for `Rect(f64, f64)`.
+     *
+     * @param variant The variant.
+     * @return llvm::StructType* The struct of the payload fields, in order; empty if the variant has no payload.
+     */
+    llvm::StructType* get_payload_type(const Decl::Enum::Variant& variant);
+
+    /**
+     * @brief Generates a value of an enum from one of its variants.
+     * A scalar enum is an integer; a tagged union is a temporary with the tag and the payload stored in it.
+     *
+     * @param type The enum type.
+     * @param variant_index The index of the variant.
+     * @param arguments The payload of the variant, if it has one.
+     * @return llvm::Value* The value, or a pointer to its storage for a tagged union.
+     */
+    llvm::Value* generate_variant(const std::shared_ptr<Type>& type, int variant_index, const std::vector<std::shared_ptr<Expr>>& arguments);
+
     /**
      * @brief Goes through all the functions in the namespace tree and creates the function prototypes.
      * This allows functions to be called before they are defined.
@@ -53,94 +128,439 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
      */
     void declare_all_functions();
 
+    /**
+     * @brief Adds the function attributes that follow from a function's inferred effects,
+     * e.g. `memory(none)` for a function that only computes its result from its arguments.
+     *
+     * @param fun The function.
+     * @param effects The effects of the function, as inferred by the PurityAnalyzer.
+     */
+    void add_effect_attributes(llvm::Function* fun, const FunctionEffects& effects);
+
+    /**
+     * @brief Lowers the type of an `extern` function according to the C calling convention.
+     * Aggregates are coerced to registers where the ABI allows it, and passed in memory otherwise.
+     *
+     * @param type The type of the function.
+     * @return llvm::FunctionType* The LLVM type of the function.
+     */
+    llvm::FunctionType* lower_c_function_type(const Type::Function& type);
+
+    /**
+     * @brief Generates a call to an `extern` function, marshalling aggregates according to the C calling convention.
+     *
+     * @param fun The function to call.
+     * @param type The type of the function.
+     * @param expr The call expression.
+     * @return llvm::Value* The result of the call; for aggregates, a pointer to the storage holding the result.
+     */
+    llvm::Value* generate_c_call(llvm::Function* fun, const Type::Function& type, Expr::Call* expr);
+
+    /**
+     * @brief Creates an alloca in the entry block of the current function, regardless of the current insertion point.
+     * Allocas in the entry block are static, so they do not grow the stack inside loops and can be promoted to registers.
+     *
+     * @param type The type to allocate.
+     * @param name The name of the allocation.
+     * @return llvm::AllocaInst* The allocation.
+     * @throws CodeGenException If there is no function to allocate in.
+     */
+    llvm::AllocaInst* create_entry_alloca(llvm::Type* type, const std::string& name = "");
+
+    /**
+     * @brief Allocates storage for a temporary aggregate, such as a literal or the result of a call.
+     * Inside a loop, the temporary only lives for one iteration; its lifetime is marked so the stack slot can be reused.
+     *
+     * @param type The aggregate type to allocate.
+     * @param name The name of the allocation.
+     * @return llvm::AllocaInst* The allocation.
+     */
+    llvm::AllocaInst* create_temporary(llvm::Type* type, const std::string& name = "");
+
+    /**
+     * @brief Keeps a temporary alive past the end of its loop iteration.
+     * Used when a pointer to the temporary is stored somewhere, e.g. when it becomes the storage of a variable.
+     * Does nothing if the value is not a temporary.
+     *
+     * @param value The value that escapes.
+     */
+    void retain_temporary(llvm::Value* value);
+
+    /**
+     * @brief Ends the lifetime of the temporaries of the innermost loop iteration.
+     * Must be called at the end of the iteration, before branching back to the loop condition.
+     *
+     */
+    void end_temporary_scope();
+
+    /**
+     * @brief Copies the contents of an aggregate from one storage location to another.
+     *
+     * @param destination A pointer to the destination storage.
+     * @param source A pointer to the source storage.
+     * @param type The aggregate type being copied.
+     */
+    void copy_aggregate(llvm::Value* destination, llvm::Value* source, const std::shared_ptr<Type::Aggregate>& type);
+
+    /**
+     * @brief Builds the constant value of an aggregate literal whose elements are all compile-time constants.
+     * Only literals of scalar elements are folded; nested aggregates are separate storage and are built at runtime.
+     *
+     * @param expr The expression to fold.
+     * @return llvm::Constant* The constant aggregate, or nullptr if the expression is not a constant aggregate literal.
+     */
+    llvm::Constant* constant_aggregate(Expr* expr);
+
+    /**
+     * @brief Places a constant aggregate in a private, read-only global.
+     *
+     * @param constant The constant aggregate.
+     * @return llvm::GlobalVariable* The global holding the constant.
+     */
+    llvm::GlobalVariable* create_constant_global(llvm::Constant* constant);
+
+    /**
+     * @brief Builds a slice value from a pointer to its first element and its length.
+     *
+     * @param data A pointer to the first element.
+     * @param length The number of elements, as an i64.
+     * @param type The slice type.
+     * @return llvm::Value* The slice; a constant if both parts are constants.
+     */
+    llvm::Value* create_slice(llvm::Value* data, llvm::Value* length, const std::shared_ptr<Type::Slice>& type);
+
+    /**
+     * @brief The layout of the memory `alloc` gets from the runtime allocator.
+     * The elements come first; aggregate elements are pointers, as everywhere else, to storage that follows them in the same memory.
+     *
+     */
+    struct HeapLayout {
+        // The size of the memory in bytes, as an i64.
+        llvm::Value* size = nullptr;
+        // The offset of the storage of the first aggregate element, as an i64; nullptr if the elements are not aggregates.
+        llvm::Value* storage_offset = nullptr;
+        // The alignment of the memory.
+        uint64_t align = 1;
+        // Whether computing the size overflowed, as an i1; the size is then meaningless.
+        llvm::Value* overflow = nullptr;
+    };
+
+    /**
+     * @brief Computes the layout of the memory for a number of elements, as `alloc` allocates it and `dealloc` deallocates it.
+     * The size is computed as an unsigned number, so a negative count overflows unless the elements are a single byte.
+     *
+     * @param element_type The type of the elements.
+     * @param count The number of elements, as an i64.
+     * @return HeapLayout The layout of the memory.
+     */
+    HeapLayout heap_layout(const std::shared_ptr<Type>& element_type, llvm::Value* count);
+
+    /**
+     * @brief Converts a value to the type it is assigned or passed to, where the language allows it implicitly.
+     * A sized array becomes a slice of all its elements; the elements are not copied.
+     * Any other value is returned as it is.
+     *
+     * @param value The value to convert.
+     * @param from The type of the value.
+     * @param to The type the value is converted to.
+     * @return llvm::Value* The converted value.
+     */
+    llvm::Value* convert_implicitly(llvm::Value* value, const std::shared_ptr<Type>& from, const std::shared_ptr<Type>& to);
+
+    /**
+     * @brief Creates a temporary holding a copy of a constant aggregate.
+     * The constant is copied from a read-only global with a single memcpy, instead of one store per element.
+     *
+     * @param constant The constant aggregate.
+     * @param type The type of the aggregate.
+     * @return llvm::Value* A pointer to the temporary.
+     */
+    llvm::Value* copy_constant_aggregate(llvm::Constant* constant, const std::shared_ptr<Type::Aggregate>& type);
+
+    /**
+     * @brief Generates a function that computes the initializer of a global variable and stores it to a destination global.
+     * The function is run at compile time by evaluate_initializers, once everything it may call has been generated.
+     * If the initializer folds to a constant without emitting any instructions, the destination is initialized right away instead.
+     *
+     * @param decl The declaration of the global variable.
+     * @param destination The global to store the initializer to; the variable itself, or the storage of an aggregate variable.
+     */
+    void defer_initializer(Decl::Var* decl, llvm::GlobalVariable* destination);
+
+    /**
+     * @brief Finds what keeps a deferred initializer from being computed at compile time, if anything.
+     * The initializer, and any function it may call, must not call foreign code, write memory outside its own,
+     * or read a global variable whose initializer has not been computed yet.
+     *
+     * @param initializer The function generated by defer_initializer.
+     * @param destination The global the initializer is stored to.
+     * @param unevaluated The globals whose initializers have not been computed yet, and their declarations.
+     * @return std::string What the initializer does that it must not, to complete "... because it ..."; empty if nothing.
+     */
+    std::string find_compile_time_obstacle(llvm::Function* initializer, llvm::GlobalVariable* destination, const std::unordered_map<llvm::GlobalVariable*, Decl::Var*>& unevaluated);
+
+    /**
+     * @brief Computes the deferred initializers of global variables by running them at compile time, in the order they were declared.
+     * Each result becomes the constant initializer of its global, and the function that computed it is removed.
+     *
+     * @throws CodeGenException If an initializer cannot be computed.
+     */
+    void evaluate_initializers();
+
+    /**
+     * @brief Gets the TBAA type descriptor of the values of a type, as they are stored in memory.
+     * Every scalar type has its own descriptor; aggregates and pointers are all stored as pointers, and share one.
+     *
+     * @param type The Niter type.
+     * @return llvm::MDNode* The scalar type descriptor.
+     */
+    llvm::MDNode* get_tbaa_type(const std::shared_ptr<Type>& type);
+
+    /**
+     * @brief Gets the TBAA type descriptor of a struct or tuple, which lists the descriptor and offset of each member.
+     * This lets LLVM tell apart different members of the same type.
+     *
+     * @param type The struct or tuple type.
+     * @return llvm::MDNode* The struct type descriptor.
+     */
+    llvm::MDNode* get_tbaa_struct_type(const std::shared_ptr<Type::Aggregate>& type);
+
+    /**
+     * @brief Tags a load or store with the TBAA access tag of the expression it accesses, if strict aliasing is enabled.
+     * Struct members and tuple elements are tagged with their path from the enclosing aggregate; anything else with its own type.
+     *
+     * @param access The load or store instruction.
+     * @param expr The expression whose memory is accessed; e.g. an identifier, member access, or index expression.
+     */
+    void tag_access(llvm::Instruction* access, Expr* expr);
+
+    /**
+     * @brief Creates the `llvm.loop` metadata that carries the hints of a loop to LLVM's loop passes.
+     *
+     * @param hints The hints written before the loop.
+     * @param access_group The access group of the loop's memory accesses if the loop is parallel; otherwise nullptr.
+     * @return llvm::MDNode* The loop ID, to be attached to the back edge of the loop.
+     */
+    llvm::MDNode* create_loop_id(const LoopHints& hints, llvm::MDNode* access_group);
+
+    /**
+     * @brief Attaches the hints of a loop to its back edge.
+     * For a parallel loop, this also adds the memory accesses of the loop to a new access group.
+     *
+     * @param back_edge The branch that jumps back to the start of the loop.
+     * @param hints The hints written before the loop.
+     * @param header_blocks The blocks of the loop created before its end block.
+     * @param end_block The block after the loop. Every block after it was created for the loop body.
+     */
+    void attach_loop_hints(llvm::Instruction* back_edge, const LoopHints& hints, const std::vector<llvm::BasicBlock*>& header_blocks, llvm::BasicBlock* end_block);
+
+    /**
+     * @brief Adds every instruction of a block that accesses memory to an access group, in addition to the groups it already belongs to.
+     *
+     * @param block The block.
+     * @param access_group The access group.
+     */
+    void add_access_group(llvm::BasicBlock* block, llvm::MDNode* access_group);
+
+    /**
+     * @brief Generates a short-circuiting `and` or `or`.
+     * The right side is only evaluated if the left side does not decide the result, using a branch and a phi node.
+     * A cheap right side without side effects is evaluated unconditionally and combined with a select instead.
+     *
+     * @param is_and Whether the operator is `and`; otherwise it is `or`.
+     * @param left_val The value of the left side.
+     * @param right The right side.
+     * @return llvm::Value* The boolean result.
+     */
+    llvm::Value* generate_logical(bool is_and, llvm::Value* left_val, Expr* right);
+
+    /**
+     * @brief Generates `base ^ exponent`.
+     * Constant integer exponents are strength-reduced to multiplications, for a float base only while they are small.
+     * Integers use square-and-multiply, floats raised to an int use `llvm.powi`, and floats raised to a float use `llvm.pow`.
+     *
+     * @param base The base; an int or a float.
+     * @param exponent The exponent; the same type as the base, or an int if the base is a float.
+     * @param is_unsigned Whether the exponent is an unsigned integer.
+     * @return llvm::Value* The result, of the same type as the base.
+     */
+    llvm::Value* generate_power(llvm::Value* base, llvm::Value* exponent, bool is_unsigned);
+
+    /**
+     * @brief Gets the runtime helper that raises an integer to an integer power, emitting it into the module on first use.
+     * Negative exponents truncate towards zero, like integer division: the result is 0 unless the base is 1 or -1.
+     *
+     * @param type The integer type of the base, the exponent, and the result.
+     * @param is_unsigned Whether the integers are unsigned, in which case the exponent is never negative.
+     * @return llvm::Function* The helper function.
+     */
+    llvm::Function* get_integer_power_function(llvm::IntegerType* type, bool is_unsigned);
+
+    /**
+     * @brief Generates a call to one of the `vec::` builtins, which the local checker has already checked.
+     * Loads and stores become masked load and store intrinsics, or plain vector stores without a mask;
+     * reductions become `llvm.vector.reduce.*`, where float sums and products may combine the lanes in any order.
+     *
+     * @param expr The call expression.
+     * @return llvm::Value* The result of the builtin, or nullptr for `vec::store`.
+     */
+    llvm::Value* generate_vector_builtin(Expr::Call* expr);
+
+    /**
+     * @brief Generates a call to one of the `bits::` builtins, which the local checker has already checked.
+     * Each becomes the LLVM intrinsic of the same operation: `llvm.ctpop`, `llvm.ctlz`, `llvm.cttz` or `llvm.bswap`.
+     *
+     * @param expr The call expression.
+     * @return llvm::Value* The result of the builtin.
+     */
+    llvm::Value* generate_bits_builtin(Expr::Call* expr);
+
+    /**
+     * @brief Loads the lanes of a vector from consecutive elements in memory, e.g. the storage of an array.
+     *
+     * @param data A pointer to the first element.
+     * @param type The vector type.
+     * @return llvm::Value* The vector.
+     */
+    llvm::Value* load_lanes(llvm::Value* data, const std::shared_ptr<Type::Vector>& type);
+
+    /**
+     * @brief Stores the lanes of a vector to consecutive elements in memory, e.g. the storage of an array.
+     *
+     * @param vector The vector.
+     * @param data A pointer to the first element.
+     * @param type The vector type.
+     */
+    void store_lanes(llvm::Value* vector, llvm::Value* data, const std::shared_ptr<Type::Vector>& type);
+
+    /**
+     * @brief Checks that the elements the lanes of a vector load or store reach are in range, if bounds checks are enabled.
+     * Only the lanes the mask enables are checked, since only those are accessed.
+     *
+     * @param start The index of the element of the first lane, as an i64.
+     * @param length The number of elements, as an i64.
+     * @param mask The lanes that are accessed, as a vector of bools.
+     */
+    void check_lanes(llvm::Value* start, llvm::Value* length, llvm::Value* mask);
+
+    /**
+     * @brief Stops the program unless a condition holds; the code after it runs only if it does.
+     * Every failed check of a function branches to the same block, which traps.
+     *
+     * @param condition The condition, as a bool.
+     */
+    void trap_unless(llvm::Value* condition);
+
     /**
      * @brief Visits a declaration statement.
      *
      * @param stmt The declaration statement to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_declaration_stmt(Stmt::Declaration* stmt) override;
+    llvm::Value* visit_declaration_stmt(Stmt::Declaration* stmt) override;
 
     /**
      * @brief Visits an expression statement.
      *
      * @param stmt The expression statement to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_expression_stmt(Stmt::Expression* stmt) override;
+    llvm::Value* visit_expression_stmt(Stmt::Expression* stmt) override;
 
     /**
      * @brief Visits a block statement.
      *
      * @param stmt The block statement to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_block_stmt(Stmt::Block* stmt) override;
+    llvm::Value* visit_block_stmt(Stmt::Block* stmt) override;
 
     /**
      * @brief Visits a conditional statement.
      *
      * @param stmt The conditional statement to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_conditional_stmt(Stmt::Conditional* stmt) override;
+    llvm::Value* visit_conditional_stmt(Stmt::Conditional* stmt) override;
 
     /**
      * @brief Visits a loop statement.
      *
      * @param stmt The loop statement to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
+     * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
+     */
+    llvm::Value* visit_loop_stmt(Stmt::Loop* stmt) override;
+
+    /**
+     * @brief Visits a for statement.
+     * The loop counts with an integer induction variable; a loop over an array loads the element at that index into the loop variable.
+     *
+     * @param stmt The for statement to visit.
+     * @return llvm::Value* nullptr always.
+     * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
+     */
+    llvm::Value* visit_for_stmt(Stmt::For* stmt) override;
+
+    /**
+     * @brief Visits a match statement.
+     * The variant of the value is switched on, so that LLVM can lower the arms to a jump table.
+     * Every variant is a case, except the payload variant of a niche enum, whose values are the default.
+     * An arm's bindings are loaded from the payload before its body runs.
+     *
+     * @param stmt The match statement to visit.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_loop_stmt(Stmt::Loop* stmt) override;
+    llvm::Value* visit_match_stmt(Stmt::Match* stmt) override;
 
     /**
      * @brief Visits a return statement.
      * A return statement doesn't actually create a return instruction.
-     * It instead assigns "__return_val__" to the return value, then jumps to the exit block where the return instruction is created.
+     * It instead stores the value in the return allocation, then jumps to the exit block where the return instruction is created.
      * It also creates a new block for any statements that may appear after the return statement.
      *
      * @param stmt The return statement to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_return_stmt(Stmt::Return* stmt) override;
+    llvm::Value* visit_return_stmt(Stmt::Return* stmt) override;
 
-    std::any visit_break_stmt(Stmt::Break* stmt) override;
-    std::any visit_continue_stmt(Stmt::Continue* stmt) override;
-    std::any visit_eof_stmt(Stmt::EndOfFile* stmt) override;
+    llvm::Value* visit_break_stmt(Stmt::Break* stmt) override;
+    llvm::Value* visit_continue_stmt(Stmt::Continue* stmt) override;
+    llvm::Value* visit_eof_stmt(Stmt::EndOfFile* stmt) override;
 
     /**
      * @brief Visits a variable declaration.
      *
      * @param decl The variable declaration to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_var_decl(Decl::Var* decl) override;
+    llvm::Value* visit_var_decl(Decl::Var* decl) override;
 
     /**
      * @brief Visits a function declaration.
      * If the function is named `main`, its linkage will be automatically set to external.
      *
      * @param decl The function declaration to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_fun_decl(Decl::Fun* decl) override;
+    llvm::Value* visit_fun_decl(Decl::Fun* decl) override;
 
     /**
      * @brief Does nothing and returns nullptr.
      * External functions are declared using the `declare_all_functions` function.
      *
      * @param decl The external function declaration to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      */
-    std::any visit_extern_fun_decl(Decl::ExternFun* decl) override;
+    llvm::Value* visit_extern_fun_decl(Decl::ExternFun* decl) override;
 
     /**
      * @brief Visits a struct declaration.
@@ -148,9 +568,18 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
      * All structs are declared in advance using the `declare_all_structs` function.
      *
      * @param decl The struct declaration to visit.
-     * @return std::any nullptr always.
+     * @return llvm::Value* nullptr always.
      */
-    std::any visit_struct_decl(Decl::Struct* decl) override;
+    llvm::Value* visit_struct_decl(Decl::Struct* decl) override;
+
+    /**
+     * @brief Does nothing and returns nullptr.
+     * Enums are declared in advance using the `declare_all_structs` function.
+     *
+     * @param decl The enum declaration to visit.
+     * @return llvm::Value* nullptr always.
+     */
+    llvm::Value* visit_enum_decl(Decl::Enum* decl) override;
 
     /**
      * @brief Visits an assign expression.
@@ -159,40 +588,40 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
      * Instead, the `get_llvm_allocation` function will be called on the left side to get the llvm::Value*.
      *
      * @param expr The assign expression to visit.
-     * @return std::any An llvm::Value* representing the result of the assignment.
+     * @return llvm::Value* A value representing the result of the assignment.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_assign_expr(Expr::Assign* expr) override;
+    llvm::Value* visit_assign_expr(Expr::Assign* expr) override;
 
-    std::any visit_logical_expr(Expr::Logical* expr) override;
+    llvm::Value* visit_logical_expr(Expr::Logical* expr) override;
 
     /**
      * @brief Visits a binary expression.
      *
      * @param expr The binary expression to visit.
-     * @return std::any An llvm::Value* representing the result of the binary operation.
+     * @return llvm::Value* A value representing the result of the binary operation.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_binary_expr(Expr::Binary* expr) override;
+    llvm::Value* visit_binary_expr(Expr::Binary* expr) override;
 
     /**
      * @brief Visits a unary expression.
      *
      * @param expr The unary expression to visit.
-     * @return std::any An llvm::Value* representing the result of the unary operation.
+     * @return llvm::Value* A value representing the result of the unary operation.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_unary_expr(Expr::Unary* expr) override;
+    llvm::Value* visit_unary_expr(Expr::Unary* expr) override;
 
     /**
      * @brief Visits a dereference expression.
      * Dereferencing is performed via the `load` instruction.
      *
      * @param expr The dereference expression to visit.
-     * @return std::any An llvm::Value* representing the value stored at the address.
+     * @return llvm::Value* A value representing the value stored at the address.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_dereference_expr(Expr::Dereference* expr) override;
+    llvm::Value* visit_dereference_expr(Expr::Dereference* expr) override;
 
     /**
      * @brief Visits an access expression.
@@ -200,10 +629,10 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
      * The instance members will be checked first, then the static members.
      *
      * @param expr The access expression to visit.
-     * @return std::any An llvm::Value* representing the value of the accessed member.
+     * @return llvm::Value* A value representing the value of the accessed member.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_access_expr(Expr::Access* expr) override;
+    llvm::Value* visit_access_expr(Expr::Access* expr) override;
 
     /**
      * @brief Visits an index expression.
@@ -211,40 +640,50 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
      * If the left side is an array, the index may be any integer expression.
      *
      * @param expr The index expression to visit.
-     * @return std::any An llvm::Value* representing the value stored at the index.
+     * @return llvm::Value* A value representing the value stored at the index.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_index_expr(Expr::Index* expr) override;
+    llvm::Value* visit_index_expr(Expr::Index* expr) override;
+
+    /**
+     * @brief Visits a slice expression.
+     * Generates a slice that views part of an array, a slice, or the memory behind a pointer.
+     *
+     * @param expr The slice expression to visit.
+     * @return llvm::Value* The slice value, a pointer and a length.
+     * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
+     */
+    llvm::Value* visit_slice_expr(Expr::Slice* expr) override;
 
     /**
      * @brief Visits a call expression.
      * Generates code for the function call.
      *
      * @param expr The call expression to visit.
-     * @return std::any An llvm::Value* representing the result of the call.
+     * @return llvm::Value* A value representing the result of the call.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_call_expr(Expr::Call* expr) override;
+    llvm::Value* visit_call_expr(Expr::Call* expr) override;
 
     /**
      * @brief Visits a cast expression.
      * Generates code for the cast expression.
      *
      * @param expr The cast expression to visit.
-     * @return std::any An llvm::Value* representing the result of the cast.
+     * @return llvm::Value* A value representing the result of the cast.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_cast_expr(Expr::Cast* expr) override;
+    llvm::Value* visit_cast_expr(Expr::Cast* expr) override;
 
     /**
      * @brief Visits a grouping expression.
      * Simply visits the expression inside the grouping and returns the Value*.
      *
      * @param expr The grouping expression to visit.
-     * @return std::any An llvm::Value* representing the value of the expression inside the grouping.
+     * @return llvm::Value* A value representing the value of the expression inside the grouping.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_grouping_expr(Expr::Grouping* expr) override;
+    llvm::Value* visit_grouping_expr(Expr::Grouping* expr) override;
 
     /**
      * @brief Visits an identifier expression.
@@ -252,65 +691,119 @@ class CodeGenerator : public Stmt::Visitor, public Decl::Visitor, public Expr::V
      * This function should not be used when the identifier is used as an lvalue.
      *
      * @param expr The identifier expression to visit.
-     * @return std::any The llvm::Value* representing the value stored in the variable.
+     * @return llvm::Value* The value representing the value stored in the variable.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_identifier_expr(Expr::Identifier* expr) override;
+    llvm::Value* visit_identifier_expr(Expr::Identifier* expr) override;
 
     /**
      * @brief Visits a literal expression.
      *
      * @param expr The literal expression to visit.
-     * @return std::any An llvm::Value* representing the literal.
+     * @return llvm::Value* A value representing the literal.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_literal_expr(Expr::Literal* expr) override;
+    llvm::Value* visit_literal_expr(Expr::Literal* expr) override;
 
     /**
      * @brief Visits an array expression.
      *
      * @param expr The array expression to visit.
-     * @return std::any An llvm::Value* representing the array.
+     * @return llvm::Value* A value representing the array.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_array_expr(Expr::Array* expr) override;
+    llvm::Value* visit_array_expr(Expr::Array* expr) override;
 
     /**
      * @brief Visits an array generator expression.
      *
      * @param expr The array generator expression to visit.
-     * @return std::any
+     * @return llvm::Value*
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_array_gen_expr(Expr::ArrayGen* expr) override;
+    llvm::Value* visit_array_gen_expr(Expr::ArrayGen* expr) override;
 
     /**
      * @brief Visits a tuple expression.
      * Tuple expressions are represented as structs in LLVM IR.
      *
      * @param expr The tuple expression to visit.
-     * @return std::any An llvm::Value* representing the tuple.
+     * @return llvm::Value* A value representing the tuple.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_tuple_expr(Expr::Tuple* expr) override;
+    llvm::Value* visit_tuple_expr(Expr::Tuple* expr) override;
 
     /**
      * @brief Visits an object expression.
      * Object expressions are represented as structs in LLVM IR.
      *
      * @param expr The object expression to visit.
-     * @return std::any An llvm::Value* representing the object.
+     * @return llvm::Value* A value representing the object.
      * Note: Space for structs is allocated using the `alloca` instruction, but the struct will be loaded before being returned.
      * That is, the return value *is* the struct, not a pointer to the struct.
      * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
      */
-    std::any visit_object_expr(Expr::Object* expr) override;
+    llvm::Value* visit_object_expr(Expr::Object* expr) override;
+
+    /**
+     * @brief Visits an alloc expression.
+     * The memory comes from the runtime allocator and is zeroed, like a variable without an initializer.
+     *
+     * @param expr The alloc expression to visit.
+     * @return llvm::Value* A pointer to the memory, or a slice of it if a number of elements was allocated.
+     * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
+     */
+    llvm::Value* visit_alloc_expr(Expr::Alloc* expr) override;
+
+    /**
+     * @brief Visits a dealloc expression.
+     * The size of the memory is computed from the type of the pointer or from the length of the slice.
+     *
+     * @param expr The dealloc expression to visit.
+     * @return llvm::Value* nullptr, since deallocating has no value.
+     * @throws CodeGenException If an error occurs during code generation. Will be caught by the generate function.
+     */
+    llvm::Value* visit_dealloc_expr(Expr::Dealloc* expr) override;
 
 public:
     // The IR builder that will be used to generate the IR. Remember to always set the insertion point before using it.
     std::shared_ptr<llvm::IRBuilder<>> builder;
 
-    CodeGenerator();
+    /**
+     * @brief Creates a code generator for the compilation bound to the calling thread.
+     *
+     */
+    CodeGenerator() : CodeGenerator(CompilationContext::current()) {}
+
+    /**
+     * @brief Creates a code generator for the given compilation.
+     * The module is created in the LLVM context of the compilation's environment.
+     *
+     * @param compilation The compilation to generate code for.
+     */
+    explicit CodeGenerator(CompilationContext& compilation);
+
+    /**
+     * @brief Sets whether to emit type-based alias analysis metadata.
+     * Niter never reinterprets memory as a different type, so accesses to different types never overlap;
+     * the metadata lets the optimizer reorder them, e.g. to vectorize loops or hoist loads out of them.
+     *
+     * @param enabled Set to true to tag loads and stores with their types; false by default.
+     */
+    void set_strict_aliasing(bool enabled) {
+        strict_aliasing = enabled;
+    }
+
+    /**
+     * @brief Sets whether to check that indexes into arrays and slices are in range.
+     * A failed check stops the program with a trap.
+     * Indexes the local checker proved in range are never checked; repeated checks are left for the optimizer to merge.
+     *
+     * @param enabled Set to true to emit bounds checks; false by default.
+     */
+    void set_bounds_check(bool enabled) {
+        bounds_check = enabled;
+    }
 
     /**
      * @brief Runs the code generator on the given statements.
@@ -333,6 +826,47 @@ public:
      * @param filename
      */
     void dump_ir(const std::string& filename = "./debug/output.ll");
+
+    /**
+     * @brief Gets a pointer to an element of a slice.
+     * Used for indexing slices, including on the left side of assignments.
+     *
+     * @param slice The slice value.
+     * @param type The slice type.
+     * @param index The index of the element, as an i64; see generate_index.
+     * @return llvm::Value* A pointer to the element.
+     */
+    llvm::Value* get_slice_element(llvm::Value* slice, const std::shared_ptr<Type::Slice>& type, llvm::Value* index);
+
+    /**
+     * @brief Generates an index, count or bound and widens it to an i64.
+     * Unsigned integers are zero-extended and the others sign-extended, so that a `u8` of 200 stays 200.
+     *
+     * @param index The expression; of any integer type.
+     * @return llvm::Value* The index, as an i64.
+     */
+    llvm::Value* generate_index(Expr* index);
+
+    /**
+     * @brief Checks that an index into an array or slice is in range, if bounds checks are enabled.
+     * Does nothing if bounds checks are disabled or the local checker proved the index in range.
+     * Otherwise, the code after the check runs only if the index is in range.
+     *
+     * @param expr The index expression.
+     * @param index The index, as an i64; see generate_index.
+     * @param length The number of elements, as an i64.
+     */
+    void check_bounds(Expr::Index* expr, llvm::Value* index, llvm::Value* length);
+
+    /**
+     * @brief Checks that the range of a sub-slice is in range, if bounds checks are enabled.
+     * The range must have `start <= end <= length`; without a length, e.g. when slicing a pointer, only `start <= end` is checked.
+     *
+     * @param start The index of the first element, as an i64.
+     * @param end The index after the last element, as an i64.
+     * @param length The number of elements of what is sliced, as an i64, or nullptr if it is unknown.
+     */
+    void check_slice_bounds(llvm::Value* start, llvm::Value* end, llvm::Value* length);
 };
 
 #endif // CODE_GENERATOR_H
@@ -0,0 +1,346 @@
+#include "const_evaluator.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/GenericValue.h"
+#include "llvm/ExecutionEngine/Interpreter.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/LowerMemIntrinsics.h"
+#include <memory>
+#include <unordered_set>
+
+namespace {
+
+// What the status global of an evaluation holds; anything but running means every function returns at once.
+enum EvaluationStatus : uint32_t {
+    STATUS_RUNNING = 0,
+    STATUS_TRAPPED,
+    STATUS_OUT_OF_STEPS,
+    STATUS_TOO_DEEP,
+};
+
+// The globals the instrumented functions of an evaluation count in.
+struct Counters {
+    llvm::GlobalVariable* status;
+    llvm::GlobalVariable* steps;
+    llvm::GlobalVariable* depth;
+};
+
+// Whether the interpreter runs an intrinsic itself, once instrument has turned traps, memory intrinsics and powi into plain code
+// and dropped the lifetime markers.
+bool is_interpretable(llvm::Intrinsic::ID id) {
+    switch (id) {
+    case llvm::Intrinsic::trap:
+    case llvm::Intrinsic::memcpy:
+    case llvm::Intrinsic::memset:
+    case llvm::Intrinsic::lifetime_start:
+    case llvm::Intrinsic::lifetime_end:
+    case llvm::Intrinsic::powi:
+    case llvm::Intrinsic::ctpop:
+    case llvm::Intrinsic::ctlz:
+    case llvm::Intrinsic::cttz:
+    case llvm::Intrinsic::bswap:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Replaces a call to powi with the loop the C runtime runs for it: the base is squared for every bit of the exponent,
+// the bits that are set multiply it into the result, and a negative exponent takes the reciprocal at the end.
+void expand_powi(llvm::CallInst* powi) {
+    auto base = powi->getArgOperand(0);
+    auto exponent = powi->getArgOperand(1);
+    auto type = powi->getType();
+    auto zero = llvm::ConstantInt::get(exponent->getType(), 0);
+    auto before = powi->getParent();
+    auto after = before->splitBasicBlock(powi, "powi_done");
+    auto loop = llvm::BasicBlock::Create(powi->getContext(), "powi_loop", before->getParent(), after);
+    auto step = llvm::BasicBlock::Create(powi->getContext(), "powi_step", before->getParent(), after);
+    before->getTerminator()->eraseFromParent();
+
+    llvm::IRBuilder<> builder(before);
+    auto negative = builder.CreateICmpSLT(exponent, zero);
+    // The magnitude of the smallest exponent only fits unsigned, which is how it is shifted.
+    auto magnitude = builder.CreateSelect(negative, builder.CreateNeg(exponent), exponent);
+    builder.CreateBr(loop);
+
+    builder.SetInsertPoint(loop);
+    auto result = builder.CreatePHI(type, 2);
+    auto power = builder.CreatePHI(type, 2);
+    auto bits = builder.CreatePHI(exponent->getType(), 2);
+    builder.CreateCondBr(builder.CreateICmpEQ(bits, zero), after, step);
+
+    builder.SetInsertPoint(step);
+    auto is_set = builder.CreateICmpNE(builder.CreateAnd(bits, llvm::ConstantInt::get(exponent->getType(), 1)), zero);
+    auto next_result = builder.CreateSelect(is_set, builder.CreateFMul(result, power), result);
+    auto next_power = builder.CreateFMul(power, power);
+    auto next_bits = builder.CreateLShr(bits, llvm::ConstantInt::get(exponent->getType(), 1));
+    builder.CreateBr(loop);
+
+    result->addIncoming(llvm::ConstantFP::get(type, 1.0), before);
+    result->addIncoming(next_result, step);
+    power->addIncoming(base, before);
+    power->addIncoming(next_power, step);
+    bits->addIncoming(magnitude, before);
+    bits->addIncoming(next_bits, step);
+
+    builder.SetInsertPoint(powi);
+    powi->replaceAllUsesWith(builder.CreateSelect(negative, builder.CreateFDiv(llvm::ConstantFP::get(type, 1.0), result), result));
+    powi->eraseFromParent();
+}
+
+// Rewrites a function so that it stops instead of trapping, counts a step for every block it enters and
+// the depth of the calls it makes, and returns as soon as the status says the evaluation stopped.
+void instrument(llvm::Function* fun, const Counters& counters, int32_t depth_limit) {
+    llvm::LLVMContext& context = fun->getContext();
+
+    // The interpreter would call the C library for these, and does not know the lifetime markers.
+    llvm::TargetTransformInfo target_info(fun->getParent()->getDataLayout());
+    std::vector<llvm::MemIntrinsic*> memory_intrinsics;
+    std::vector<llvm::CallInst*> powers;
+    std::vector<llvm::Instruction*> lifetime_markers;
+    for (auto& instruction : llvm::instructions(fun)) {
+        if (auto memory_intrinsic = llvm::dyn_cast<llvm::MemIntrinsic>(&instruction)) {
+            memory_intrinsics.push_back(memory_intrinsic);
+        } else if (instruction.isLifetimeStartOrEnd()) {
+            lifetime_markers.push_back(&instruction);
+        } else if (auto call = llvm::dyn_cast<llvm::CallInst>(&instruction); call != nullptr && call->getIntrinsicID() == llvm::Intrinsic::powi) {
+            powers.push_back(call);
+        }
+    }
+    for (auto lifetime_marker : lifetime_markers) {
+        lifetime_marker->eraseFromParent();
+    }
+    for (auto power : powers) {
+        expand_powi(power);
+    }
+    for (auto memory_intrinsic : memory_intrinsics) {
+        if (auto memcpy = llvm::dyn_cast<llvm::MemCpyInst>(memory_intrinsic)) {
+            llvm::expandMemCpyAsLoop(memcpy, target_info);
+        } else {
+            llvm::expandMemSetAsLoop(llvm::cast<llvm::MemSetInst>(memory_intrinsic));
+        }
+        memory_intrinsic->eraseFromParent();
+    }
+
+    std::vector<llvm::BasicBlock*> blocks;
+    std::vector<llvm::CallInst*> traps;
+    std::vector<llvm::CallInst*> calls;
+    std::vector<llvm::ReturnInst*> returns;
+    for (auto& block : *fun) {
+        blocks.push_back(&block);
+        for (auto& instruction : block) {
+            if (auto ret = llvm::dyn_cast<llvm::ReturnInst>(&instruction)) {
+                returns.push_back(ret);
+            } else if (auto call = llvm::dyn_cast<llvm::CallInst>(&instruction)) {
+                if (call->getIntrinsicID() == llvm::Intrinsic::trap) {
+                    traps.push_back(call);
+                } else if (!call->getCalledFunction()->isIntrinsic()) {
+                    calls.push_back(call);
+                }
+            }
+        }
+    }
+
+    // Every way out of an evaluation that stopped ends here; the caller does not look at the result.
+    auto bail = llvm::BasicBlock::Create(context, "eval_bail", fun);
+    llvm::IRBuilder<> builder(bail);
+    if (fun->getReturnType()->isVoidTy()) {
+        builder.CreateRetVoid();
+    } else {
+        builder.CreateRet(llvm::PoisonValue::get(fun->getReturnType()));
+    }
+    auto stop = [&](EvaluationStatus status) {
+        auto block = llvm::BasicBlock::Create(context, "eval_stop", fun);
+        llvm::IRBuilder<> builder(block);
+        builder.CreateStore(builder.getInt32(status), counters.status);
+        builder.CreateBr(bail);
+        return block;
+    };
+    auto trapped = stop(STATUS_TRAPPED);
+    auto out_of_steps = stop(STATUS_OUT_OF_STEPS);
+    auto too_deep = stop(STATUS_TOO_DEEP);
+
+    for (auto ret : returns) {
+        builder.SetInsertPoint(ret);
+        builder.CreateStore(builder.CreateSub(builder.CreateLoad(builder.getInt32Ty(), counters.depth), builder.getInt32(1)), counters.depth);
+    }
+    for (auto call : calls) {
+        auto block = call->getParent();
+        auto rest = block->splitBasicBlock(call->getNextNode(), "eval_returned");
+        block->getTerminator()->eraseFromParent();
+        builder.SetInsertPoint(block);
+        auto stopped = builder.CreateICmpNE(builder.CreateLoad(builder.getInt32Ty(), counters.status), builder.getInt32(STATUS_RUNNING));
+        builder.CreateCondBr(stopped, bail, rest);
+    }
+    for (auto trap : traps) {
+        auto block = trap->getParent();
+        auto dead = block->splitBasicBlock(trap);
+        block->getTerminator()->eraseFromParent();
+        llvm::BranchInst::Create(trapped, block);
+        llvm::DeleteDeadBlock(dead);
+    }
+
+    auto entry = &fun->getEntryBlock();
+    auto entered = entry->splitBasicBlock(entry->getFirstInsertionPt(), "eval_entered");
+    entry->getTerminator()->eraseFromParent();
+    builder.SetInsertPoint(entry);
+    auto depth = builder.CreateAdd(builder.CreateLoad(builder.getInt32Ty(), counters.depth), builder.getInt32(1));
+    builder.CreateStore(depth, counters.depth);
+    builder.CreateCondBr(builder.CreateICmpUGT(depth, builder.getInt32(depth_limit)), too_deep, entered);
+
+    for (auto block : blocks) {
+        auto counted = block->splitBasicBlock(block->getFirstInsertionPt(), "eval_counted");
+        block->getTerminator()->eraseFromParent();
+        builder.SetInsertPoint(block);
+        auto steps = builder.CreateSub(builder.CreateLoad(builder.getInt64Ty(), counters.steps), builder.getInt64(1));
+        builder.CreateStore(steps, counters.steps);
+        builder.CreateCondBr(builder.CreateICmpEQ(steps, builder.getInt64(0)), out_of_steps, counted);
+    }
+}
+
+} // namespace
+
+bool ConstEvaluator::can_materialize(llvm::Type* type) {
+    if (type->isIntegerTy() || type->isFloatingPointTy()) {
+        return true;
+    }
+    if (auto array_type = llvm::dyn_cast<llvm::ArrayType>(type)) {
+        return can_materialize(array_type->getElementType());
+    }
+    if (auto vector_type = llvm::dyn_cast<llvm::FixedVectorType>(type)) {
+        // Bools are packed into bits in a vector, which the interpreter does not do.
+        return !vector_type->getElementType()->isIntegerTy(1) && can_materialize(vector_type->getElementType());
+    }
+    if (auto struct_type = llvm::dyn_cast<llvm::StructType>(type)) {
+        for (auto element_type : struct_type->elements()) {
+            if (!can_materialize(element_type)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+llvm::Constant* ConstEvaluator::materialize(llvm::Type* type, uint8_t* data) {
+    if (auto int_type = llvm::dyn_cast<llvm::IntegerType>(type)) {
+        llvm::APInt value(int_type->getBitWidth(), 0);
+        llvm::LoadIntFromMemory(value, data, data_layout.getTypeStoreSize(type).getFixedValue());
+        return llvm::ConstantInt::get(int_type, value);
+    }
+    if (type->isFloatingPointTy()) {
+        llvm::APInt bits(type->getPrimitiveSizeInBits().getFixedValue(), 0);
+        llvm::LoadIntFromMemory(bits, data, data_layout.getTypeStoreSize(type).getFixedValue());
+        return llvm::ConstantFP::get(type->getContext(), llvm::APFloat(type->getFltSemantics(), bits));
+    }
+    if (auto array_type = llvm::dyn_cast<llvm::ArrayType>(type)) {
+        auto element_type = array_type->getElementType();
+        uint64_t stride = data_layout.getTypeAllocSize(element_type).getFixedValue();
+        std::vector<llvm::Constant*> elements;
+        elements.reserve(array_type->getNumElements());
+        for (uint64_t i = 0; i < array_type->getNumElements(); i++) {
+            elements.push_back(materialize(element_type, data + i * stride));
+        }
+        return llvm::ConstantArray::get(array_type, elements);
+    }
+    if (auto vector_type = llvm::dyn_cast<llvm::FixedVectorType>(type)) {
+        auto element_type = vector_type->getElementType();
+        uint64_t stride = data_layout.getTypeAllocSize(element_type).getFixedValue();
+        std::vector<llvm::Constant*> elements;
+        elements.reserve(vector_type->getNumElements());
+        for (unsigned i = 0; i < vector_type->getNumElements(); i++) {
+            elements.push_back(materialize(element_type, data + i * stride));
+        }
+        return llvm::ConstantVector::get(elements);
+    }
+    auto struct_type = llvm::cast<llvm::StructType>(type);
+    auto layout = data_layout.getStructLayout(struct_type);
+    std::vector<llvm::Constant*> members;
+    for (unsigned i = 0; i < struct_type->getNumElements(); i++) {
+        members.push_back(materialize(struct_type->getElementType(i), data + layout->getElementOffset(i)));
+    }
+    return llvm::ConstantStruct::get(struct_type, members);
+}
+
+bool ConstEvaluator::collect_functions(llvm::Function* fun, std::vector<llvm::Function*>& functions) {
+    std::unordered_set<llvm::Function*> visited = {fun};
+    functions = {fun};
+    for (size_t i = 0; i < functions.size(); i++) {
+        for (auto& instruction : llvm::instructions(functions[i])) {
+            auto call = llvm::dyn_cast<llvm::CallInst>(&instruction);
+            if (call == nullptr) {
+                continue;
+            }
+            auto callee = call->getCalledFunction();
+            if (callee->isIntrinsic()) {
+                if (!is_interpretable(callee->getIntrinsicID())) {
+                    failure = "needs `" + callee->getName().str() + "`, which cannot be run at compile time";
+                    return false;
+                }
+            } else if (visited.insert(callee).second) {
+                functions.push_back(callee);
+            }
+        }
+    }
+    return true;
+}
+
+llvm::Constant* ConstEvaluator::evaluate(llvm::Function* fun, llvm::GlobalVariable* result) {
+    failure.clear();
+    std::vector<llvm::Function*> functions;
+    if (!collect_functions(fun, functions)) {
+        return nullptr;
+    }
+
+    // The instrumentation goes into a copy, which holds every global but only the functions that may run.
+    std::unordered_set<const llvm::GlobalValue*> copied(functions.begin(), functions.end());
+    llvm::ValueToValueMapTy copies;
+    auto copy = llvm::CloneModule(ir_module, copies, [&](const llvm::GlobalValue* global) {
+        return llvm::isa<llvm::GlobalVariable>(global) || copied.count(global) != 0;
+    });
+    auto counter = [&](llvm::Type* type, uint64_t value, const char* name) {
+        return new llvm::GlobalVariable(*copy, type, false, llvm::GlobalValue::PrivateLinkage, llvm::ConstantInt::get(type, value), name);
+    };
+    auto int32_type = llvm::Type::getInt32Ty(ir_module.getContext());
+    Counters counters = {
+        counter(int32_type, STATUS_RUNNING, "eval_status"),
+        counter(llvm::Type::getInt64Ty(ir_module.getContext()), STEP_LIMIT, "eval_steps"),
+        counter(int32_type, 0, "eval_depth"),
+    };
+    for (auto function : functions) {
+        instrument(llvm::cast<llvm::Function>(copies[function]), counters, DEPTH_LIMIT);
+    }
+
+    auto copied_fun = llvm::cast<llvm::Function>(copies[fun]);
+    auto copied_result = llvm::cast<llvm::GlobalVariable>(copies[result]);
+    std::string error_str;
+    std::unique_ptr<llvm::ExecutionEngine> engine(llvm::EngineBuilder(std::move(copy))
+                                                      .setEngineKind(llvm::EngineKind::Interpreter)
+                                                      .setErrorStr(&error_str)
+                                                      .create());
+    if (engine == nullptr) {
+        failure = "could not be run: " + error_str;
+        return nullptr;
+    }
+    engine->runFunction(copied_fun, {});
+
+    switch (*static_cast<uint32_t*>(engine->getPointerToGlobal(counters.status))) {
+    case STATUS_TRAPPED:
+        failure = "stopped before it finished, e.g. because of a failed bounds check";
+        return nullptr;
+    case STATUS_OUT_OF_STEPS:
+        failure = "did not finish within " + std::to_string(STEP_LIMIT) + " steps";
+        return nullptr;
+    case STATUS_TOO_DEEP:
+        failure = "nested more than " + std::to_string(DEPTH_LIMIT) + " calls";
+        return nullptr;
+    default:
+        return materialize(copied_result->getValueType(), static_cast<uint8_t*>(engine->getPointerToGlobal(copied_result)));
+    }
+}
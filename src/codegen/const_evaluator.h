@@ -0,0 +1,90 @@
+#ifndef CONST_EVALUATOR_H
+#define CONST_EVALUATOR_H
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Module.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs generated code at compile time, so that global variables can be initialized with what it computes.
+ * The code is run by LLVM's interpreter on an instrumented copy of the module: a trap, a loop that never ends or
+ * a recursion that never ends stops the evaluation by returning from every function, so it fails the evaluation, not the compiler.
+ * The caller must make sure the code has no effects outside the result, e.g. that it never calls `extern` functions.
+ *
+ */
+class ConstEvaluator {
+    // The module the code is in; it must be complete, since anything it calls may run.
+    llvm::Module& ir_module;
+    // The data layout of the module, which the result is laid out with.
+    const llvm::DataLayout& data_layout;
+    // Why the last evaluation failed.
+    std::string failure;
+
+    // How many basic blocks an evaluation may enter before it is stopped.
+    static constexpr int64_t STEP_LIMIT = 5000000;
+    // How deep calls may nest in an evaluation before it is stopped.
+    static constexpr int32_t DEPTH_LIMIT = 10000;
+
+    /**
+     * @brief Collects the functions a function may call, and checks that the interpreter can run all of them.
+     * The interpreter hands some intrinsics, e.g. pow, to the C library, which it caches by the address of the declaration;
+     * the copies of the module come and go, so a later copy could call the wrong function.
+     *
+     * @param fun The function.
+     * @param functions The functions, starting with fun.
+     * @return true If the interpreter can run all of them; otherwise get_failure says why.
+     */
+    bool collect_functions(llvm::Function* fun, std::vector<llvm::Function*>& functions);
+
+    /**
+     * @brief Builds the constant of a type from its bytes in memory.
+     *
+     * @param type The type; see can_materialize.
+     * @param data The bytes of the value.
+     * @return llvm::Constant* The constant.
+     */
+    llvm::Constant* materialize(llvm::Type* type, uint8_t* data);
+
+public:
+    /**
+     * @brief Creates an evaluator for a module.
+     *
+     * @param ir_module The module.
+     */
+    explicit ConstEvaluator(llvm::Module& ir_module) : ir_module(ir_module), data_layout(ir_module.getDataLayout()) {}
+
+    /**
+     * @brief Checks whether a value of a type can be turned into a constant after it has been computed.
+     * Integers, floats, and arrays, structs and vectors of them can; pointers cannot, since they point into the memory of the evaluation.
+     * Neither can vectors of bools, which the interpreter lays out differently from the compiled program.
+     *
+     * @param type The type.
+     * @return true If the type holds no pointers.
+     */
+    static bool can_materialize(llvm::Type* type);
+
+    /**
+     * @brief Runs a function and returns the value it leaves in a global.
+     *
+     * @param fun A function without parameters or result.
+     * @param result The global the function writes its result to. Its value type must be one that can_materialize.
+     * @return llvm::Constant* The value of the global after the function returned, or nullptr if it did not; see get_failure.
+     */
+    llvm::Constant* evaluate(llvm::Function* fun, llvm::GlobalVariable* result);
+
+    /**
+     * @brief Describes why the last evaluation failed, e.g. "did not finish within 5000000 steps".
+     *
+     * @return const std::string& The description.
+     */
+    const std::string& get_failure() const {
+        return failure;
+    }
+};
+
+#endif // CONST_EVALUATOR_H
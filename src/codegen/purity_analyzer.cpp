@@ -0,0 +1,482 @@
+#include "purity_analyzer.h"
+
+#include "../utility/type.h"
+
+namespace {
+
+// The memory an access reaches.
+enum class Region {
+    // Storage owned by the function: its variables and temporaries.
+    LOCAL,
+    // Storage the caller handed over: `byval` copies and aggregate parameters.
+    ARGS,
+    // Memory a pointer parameter points to; the caller may share it.
+    POINTEE,
+    // Anything else, e.g. globals or memory behind an arbitrary pointer.
+    MEMORY,
+};
+
+bool is_aggregate(const std::shared_ptr<Type>& type) {
+    return std::dynamic_pointer_cast<Type::Aggregate>(type) != nullptr;
+}
+
+} // namespace
+
+std::unordered_map<Node::Variable*, FunctionEffects> PurityAnalyzer::analyze(const std::vector<std::shared_ptr<Node::Variable>>& functions) {
+    for (auto& function : functions) {
+        auto fun_decl = dynamic_cast<Decl::Fun*>(function->decl);
+        if (fun_decl == nullptr) {
+            continue;
+        }
+        current_function = function.get();
+        current_params.clear();
+        current_const_params.clear();
+        current_locals.clear();
+        for (auto& param : fun_decl->parameters) {
+            current_params.insert(param->variable.get());
+            if (param->declarer == KW_CONST) {
+                current_const_params.insert(param->variable.get());
+            }
+            current_locals.insert(param->variable.get());
+        }
+        fun_decl->accept(this);
+    }
+    current_function = nullptr;
+    return propagate();
+}
+
+std::unordered_map<Node::Variable*, FunctionEffects> PurityAnalyzer::propagate() {
+    // Callees that were never scanned are not known to be safe.
+    for (auto& [function, function_callees] : callees) {
+        for (auto callee : function_callees) {
+            if (local_effects.count(callee) == 0) {
+                local_effects[callee] = {true, true, true, true, true, true, true};
+            }
+        }
+    }
+    auto effects = local_effects;
+
+    // The effects only ever grow, so this terminates once every caller has absorbed its callees.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto& [function, function_effects] : effects) {
+            for (auto callee : callees[function]) {
+                auto& callee_effects = effects.at(callee);
+                // A callee's accesses to its own arguments are the caller's accesses to what it passed; those were recorded at the call.
+                FunctionEffects merged = function_effects;
+                merged.reads_memory |= callee_effects.reads_memory;
+                merged.writes_memory |= callee_effects.writes_memory;
+                merged.may_unwind |= callee_effects.may_unwind;
+                merged.may_not_return |= callee_effects.may_not_return;
+                if (merged.reads_memory != function_effects.reads_memory || merged.writes_memory != function_effects.writes_memory ||
+                    merged.may_unwind != function_effects.may_unwind || merged.may_not_return != function_effects.may_not_return) {
+                    function_effects = merged;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Recursion may not terminate, so a recursive function may not return.
+    std::unordered_set<Node::Variable*> on_stack;
+    std::unordered_map<Node::Variable*, bool> recursion;
+    for (auto& [function, function_effects] : effects) {
+        if (find_recursion(function, on_stack, recursion)) {
+            function_effects.may_recurse = true;
+            function_effects.may_not_return = true;
+        }
+    }
+    return effects;
+}
+
+bool PurityAnalyzer::find_recursion(Node::Variable* function, std::unordered_set<Node::Variable*>& on_stack, std::unordered_map<Node::Variable*, bool>& results) {
+    if (on_stack.count(function) != 0) {
+        return true;
+    }
+    auto result = results.find(function);
+    if (result != results.end()) {
+        return result->second;
+    }
+
+    on_stack.insert(function);
+    bool recurses = false;
+    for (auto callee : callees[function]) {
+        // Every callee is visited, so the functions in a cycle all find it.
+        recurses = find_recursion(callee, on_stack, results) || recurses;
+    }
+    on_stack.erase(function);
+    results[function] = recurses;
+    return recurses;
+}
+
+void PurityAnalyzer::record_access(Expr* expr, bool is_write) {
+    // Walk down to the root of the access, counting how many members and elements it reaches through.
+    Expr* root = expr;
+    Node::Variable* variable = nullptr;
+    int depth = 0;
+    // Whether the access reaches through a slice, whose elements live wherever it points to.
+    bool through_slice = false;
+    while (variable == nullptr) {
+        if (auto grouping = dynamic_cast<Expr::Grouping*>(root)) {
+            root = grouping->expression.get();
+        } else if (auto access = dynamic_cast<Expr::Access*>(root)) {
+            if (access->static_member != nullptr) {
+                variable = access->static_member.get();
+                break;
+            }
+            root = access->left.get();
+            depth++;
+        } else if (auto index = dynamic_cast<Expr::Index*>(root)) {
+            if (bounds_check && !index->in_bounds && index->left->type->kind() != Type::Kind::TUPLE) {
+                // A failed bounds check stops the program.
+                current_effects().may_not_return = true;
+            }
+            index->right->accept(this);
+            root = index->left.get();
+            depth++;
+            if (root->type->kind() == Type::Kind::SLICE) {
+                through_slice = true;
+            }
+        } else if (auto identifier = dynamic_cast<Expr::Identifier*>(root)) {
+            variable = identifier->variable.get();
+            break;
+        } else {
+            break;
+        }
+    }
+
+    Region region = Region::LOCAL;
+    if (variable != nullptr) {
+        if (dynamic_cast<Decl::Var*>(variable->decl) == nullptr) {
+            // Functions are not stored in memory.
+            return;
+        }
+        if (current_locals.count(variable) == 0) {
+            region = Region::MEMORY;
+        } else if (current_params.count(variable) != 0 && is_aggregate(variable->decl->type)) {
+            region = Region::ARGS;
+        }
+    } else if (auto dereference = dynamic_cast<Expr::Dereference*>(root)) {
+        dereference->inner->accept(this);
+        auto pointer = dynamic_cast<Expr::Identifier*>(dereference->inner.get());
+        bool is_param = pointer != nullptr && current_const_params.count(pointer->variable.get()) != 0;
+        region = is_param ? Region::POINTEE : Region::MEMORY;
+    } else {
+        // A temporary, like the result of a call.
+        root->accept(this);
+    }
+
+    // A slice is passed as a value, not as a pointer argument, so its elements are not argument memory to LLVM.
+    if (through_slice) {
+        region = Region::MEMORY;
+    }
+
+    // Nested aggregates are stored behind pointers, which shallow copies share with other storage.
+    if (depth >= 2 || (depth >= 1 && is_aggregate(expr->type))) {
+        region = Region::MEMORY;
+    }
+
+    auto& effects = current_effects();
+    switch (region) {
+    case Region::LOCAL:
+        break;
+    case Region::ARGS:
+        (is_write ? effects.writes_args : effects.reads_args) = true;
+        break;
+    case Region::POINTEE:
+        // The caller may share the pointee, so writing it is not private to the call.
+        (is_write ? effects.writes_memory : effects.reads_args) = true;
+        break;
+    case Region::MEMORY:
+        (is_write ? effects.writes_memory : effects.reads_memory) = true;
+        break;
+    }
+}
+
+void PurityAnalyzer::record_call(Expr::Call* expr) {
+    if (expr->builtin != Expr::Call::Builtin::NONE) {
+        record_builtin_call(expr);
+        return;
+    }
+
+    if (expr->variant >= 0) {
+        // Constructing an enum value only stores the arguments in local storage.
+        for (auto& argument : expr->arguments) {
+            argument->accept(this);
+        }
+        return;
+    }
+
+    Node::Variable* callee = nullptr;
+    if (auto identifier = dynamic_cast<Expr::Identifier*>(expr->callee.get())) {
+        callee = identifier->variable.get();
+    } else if (auto access = dynamic_cast<Expr::Access*>(expr->callee.get())) {
+        callee = access->static_member.get();
+    }
+
+    if (callee != nullptr && dynamic_cast<Decl::Fun*>(callee->decl) != nullptr) {
+        callees[current_function].insert(callee);
+    } else {
+        expr->callee->accept(this);
+        record_unknown_call();
+    }
+
+    for (auto& argument : expr->arguments) {
+        argument->accept(this);
+        record_argument_read(argument.get());
+    }
+}
+
+void PurityAnalyzer::record_builtin_call(Expr::Call* expr) {
+    using Builtin = Expr::Call::Builtin;
+    for (auto& argument : expr->arguments) {
+        argument->accept(this);
+    }
+    if (expr->builtin != Builtin::VEC_LOAD && expr->builtin != Builtin::VEC_STORE) {
+        // The others only compute with the values of their arguments.
+        return;
+    }
+    if (bounds_check) {
+        // A lane out of range stops the program.
+        current_effects().may_not_return = true;
+    }
+
+    auto elements = expr->arguments[0].get();
+    if (expr->builtin == Builtin::VEC_LOAD) {
+        record_argument_read(elements);
+    } else if (elements->type->kind() == Type::Kind::SLICE) {
+        // The elements are wherever the slice points to.
+        current_effects().writes_memory = true;
+    } else {
+        record_access(elements, true);
+    }
+}
+
+void PurityAnalyzer::record_argument_read(Expr* argument) {
+    if (argument->type->kind() == Type::Kind::SLICE) {
+        // The elements are not behind a pointer argument, so they count as any memory.
+        current_effects().reads_memory = true;
+        return;
+    }
+    if (argument->type->kind() != Type::Kind::POINTER) {
+        // Aggregate arguments were read when they were visited; scalars are passed by value.
+        return;
+    }
+    auto unary = dynamic_cast<Expr::Unary*>(argument);
+    if (unary != nullptr && unary->op.tok_type == TOK_AMP) {
+        // Already recorded as a read of the operand.
+        return;
+    }
+    auto identifier = dynamic_cast<Expr::Identifier*>(argument);
+    if (identifier != nullptr && current_const_params.count(identifier->variable.get()) != 0) {
+        current_effects().reads_args = true;
+    } else {
+        current_effects().reads_memory = true;
+    }
+}
+
+void PurityAnalyzer::record_unknown_call() {
+    auto& effects = current_effects();
+    effects.reads_memory = true;
+    effects.writes_memory = true;
+    effects.may_unwind = true;
+    effects.may_not_return = true;
+}
+
+void PurityAnalyzer::visit_declaration_stmt(Stmt::Declaration* stmt) {
+    stmt->declaration->accept(this);
+}
+
+void PurityAnalyzer::visit_expression_stmt(Stmt::Expression* stmt) {
+    stmt->expression->accept(this);
+}
+
+void PurityAnalyzer::visit_conditional_stmt(Stmt::Conditional* stmt) {
+    stmt->condition->accept(this);
+    for (auto& then_stmt : stmt->then_branch) {
+        then_stmt->accept(this);
+    }
+    for (auto& else_stmt : stmt->else_branch) {
+        else_stmt->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_loop_stmt(Stmt::Loop* stmt) {
+    // Whether a `while` loop terminates is not known.
+    current_effects().may_not_return = true;
+    stmt->condition->accept(this);
+    for (auto& body_stmt : stmt->body) {
+        body_stmt->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_for_stmt(Stmt::For* stmt) {
+    // A `for` loop runs a known number of times, so it always terminates.
+    stmt->start->accept(this);
+    if (stmt->end != nullptr) {
+        stmt->end->accept(this);
+    } else if (stmt->start->type->kind() == Type::Kind::SLICE) {
+        // The elements of a slice are read through it.
+        record_argument_read(stmt->start.get());
+    }
+    current_locals.insert(stmt->variable->variable.get());
+    for (auto& body_stmt : stmt->body) {
+        body_stmt->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_match_stmt(Stmt::Match* stmt) {
+    stmt->value->accept(this);
+    for (auto& arm : stmt->arms) {
+        for (auto& binding : arm.bindings) {
+            // An aggregate field is bound to the storage the enum value points to, which is not the function's own.
+            if (binding->variable != nullptr && !is_aggregate(binding->type)) {
+                current_locals.insert(binding->variable.get());
+            }
+        }
+        for (auto& body_stmt : arm.body) {
+            body_stmt->accept(this);
+        }
+    }
+}
+
+void PurityAnalyzer::visit_return_stmt(Stmt::Return* stmt) {
+    if (stmt->value != nullptr) {
+        stmt->value->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_var_decl(Decl::Var* decl) {
+    current_locals.insert(decl->variable.get());
+    if (decl->initializer != nullptr) {
+        decl->initializer->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_fun_decl(Decl::Fun* decl) {
+    // Make sure every function has an entry, even if its body has no effects.
+    auto& effects = current_effects();
+    // An aggregate result is written to storage provided by the caller.
+    auto fun_type = std::dynamic_pointer_cast<Type::Function>(decl->type);
+    if (fun_type != nullptr && is_aggregate(fun_type->return_type)) {
+        effects.writes_args = true;
+    }
+    for (auto& stmt : decl->body) {
+        stmt->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_assign_expr(Expr::Assign* expr) {
+    expr->right->accept(this);
+    if (expr->op.tok_type != TOK_EQ) {
+        // Compound assignments also read the left side.
+        record_access(expr->left.get(), false);
+    }
+    record_access(expr->left.get(), true);
+}
+
+void PurityAnalyzer::visit_logical_expr(Expr::Logical* expr) {
+    expr->left->accept(this);
+    expr->right->accept(this);
+}
+
+void PurityAnalyzer::visit_binary_expr(Expr::Binary* expr) {
+    expr->left->accept(this);
+    expr->right->accept(this);
+}
+
+void PurityAnalyzer::visit_unary_expr(Expr::Unary* expr) {
+    if (expr->op.tok_type == TOK_AMP) {
+        // Taking an address computes it, which may load the pointers to nested storage on the way.
+        record_access(expr->inner.get(), false);
+        return;
+    }
+    expr->inner->accept(this);
+}
+
+void PurityAnalyzer::visit_dereference_expr(Expr::Dereference* expr) {
+    record_access(expr, false);
+}
+
+void PurityAnalyzer::visit_access_expr(Expr::Access* expr) {
+    record_access(expr, false);
+}
+
+void PurityAnalyzer::visit_index_expr(Expr::Index* expr) {
+    record_access(expr, false);
+}
+
+void PurityAnalyzer::visit_slice_expr(Expr::Slice* expr) {
+    // A slice only computes an address, which may load the pointers to nested storage on the way.
+    record_access(expr->left.get(), false);
+    if (bounds_check) {
+        // A range out of bounds stops the program.
+        current_effects().may_not_return = true;
+    }
+    if (expr->start != nullptr) {
+        expr->start->accept(this);
+    }
+    if (expr->end != nullptr) {
+        expr->end->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_call_expr(Expr::Call* expr) {
+    record_call(expr);
+}
+
+void PurityAnalyzer::visit_cast_expr(Expr::Cast* expr) {
+    expr->expression->accept(this);
+}
+
+void PurityAnalyzer::visit_grouping_expr(Expr::Grouping* expr) {
+    expr->expression->accept(this);
+}
+
+void PurityAnalyzer::visit_identifier_expr(Expr::Identifier* expr) {
+    if (expr->variant >= 0) {
+        // An enum variant is a value, not storage.
+        return;
+    }
+    record_access(expr, false);
+}
+
+void PurityAnalyzer::visit_array_expr(Expr::Array* expr) {
+    for (auto& element : expr->elements) {
+        element->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_array_gen_expr(Expr::ArrayGen* expr) {
+    expr->generator->accept(this);
+}
+
+void PurityAnalyzer::visit_tuple_expr(Expr::Tuple* expr) {
+    for (auto& element : expr->elements) {
+        element->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_object_expr(Expr::Object* expr) {
+    for (auto& [name, field] : expr->fields) {
+        field->accept(this);
+    }
+}
+
+void PurityAnalyzer::visit_alloc_expr(Expr::Alloc* expr) {
+    // The runtime allocator keeps its state in memory shared by every function; it never unwinds.
+    if (expr->count != nullptr) {
+        expr->count->accept(this);
+    }
+    current_effects().reads_memory = true;
+    current_effects().writes_memory = true;
+    // An invalid size or running out of memory stops the program.
+    current_effects().may_not_return = true;
+}
+
+void PurityAnalyzer::visit_dealloc_expr(Expr::Dealloc* expr) {
+    expr->expression->accept(this);
+    current_effects().reads_memory = true;
+    current_effects().writes_memory = true;
+}
@@ -0,0 +1,183 @@
+#ifndef PURITY_ANALYZER_H
+#define PURITY_ANALYZER_H
+
+#include "../utility/decl.h"
+#include "../utility/expr.h"
+#include "../utility/node.h"
+#include "../utility/stmt.h"
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief What calling a function may do, besides computing its result.
+ * Memory that is local to the function (its variables and temporaries) is never counted.
+ *
+ */
+struct FunctionEffects {
+    // Whether the function may read memory it did not receive through its parameters, e.g. globals.
+    bool reads_memory = false;
+    // Whether the function may write memory it did not receive through its parameters.
+    bool writes_memory = false;
+    // Whether the function may read memory its parameters point to.
+    bool reads_args = false;
+    // Whether the function may write memory its parameters point to.
+    // This only covers `sret` results and `byval` copies, which the caller gives up to the callee.
+    bool writes_args = false;
+    // Whether the function may unwind; only foreign code can.
+    bool may_unwind = false;
+    // Whether the function may loop forever, directly or through the functions it calls.
+    bool may_not_return = false;
+    // Whether the function may call itself, directly or indirectly, or calls a function that may.
+    bool may_recurse = false;
+};
+
+/**
+ * @brief An interprocedural analysis of the checked AST that infers the effects of every function.
+ * Each function body is scanned for the memory it accesses, loops, and calls;
+ * the effects of the called functions are then propagated to their callers until nothing changes.
+ * The analysis is conservative: anything it cannot see through, like `extern` functions, may do anything.
+ *
+ */
+class PurityAnalyzer : public Stmt::Visitor<void>, public Decl::Visitor<void>, public Expr::Visitor<void> {
+    // The effects of each function's own body, not counting the functions it calls.
+    std::unordered_map<Node::Variable*, FunctionEffects> local_effects;
+    // The functions each function calls directly.
+    std::unordered_map<Node::Variable*, std::unordered_set<Node::Variable*>> callees;
+
+    // The function being scanned.
+    Node::Variable* current_function = nullptr;
+    // The parameters of the function being scanned.
+    std::unordered_set<Node::Variable*> current_params;
+    // The `const` parameters of the function being scanned. Only these still hold the caller's pointer when they are dereferenced;
+    // a `var` parameter may have been repointed at any memory.
+    std::unordered_set<Node::Variable*> current_const_params;
+    // The parameters and the local variables declared so far in the function being scanned; any other variable is global.
+    std::unordered_set<Node::Variable*> current_locals;
+
+    // Whether indexes the local checker did not prove in range are bounds checked; a failed check does not return.
+    bool bounds_check = false;
+
+    /**
+     * @brief Gets the effects of the function being scanned.
+     *
+     * @return FunctionEffects& The effects, to be updated by the scan.
+     */
+    FunctionEffects& current_effects() {
+        return local_effects[current_function];
+    }
+
+    /**
+     * @brief Records an access to an lvalue-like expression: an identifier, or a chain of member accesses and indexes rooted at one.
+     * The root decides which memory is accessed: local storage, a parameter's storage, or anything else.
+     * Accesses that reach through a nested aggregate may touch storage shared with the caller or a global, so they count as any memory.
+     *
+     * @param expr The expression being accessed.
+     * @param is_write Whether the access writes the expression; otherwise it reads it.
+     */
+    void record_access(Expr* expr, bool is_write);
+
+    /**
+     * @brief Records that the function being scanned calls a function, or something unknown if the callee is not a function declaration.
+     *
+     * @param expr The call expression.
+     */
+    void record_call(Expr::Call* expr);
+
+    /**
+     * @brief Records the effects of a call to a builtin, e.g. `vec::store`, which calls no function.
+     * Only loads and stores access memory; they access the elements of their first argument.
+     *
+     * @param expr The call expression.
+     */
+    void record_builtin_call(Expr::Call* expr);
+
+    /**
+     * @brief Records reading the memory an argument points to, for a callee that reads its arguments.
+     *
+     * @param argument The argument expression.
+     */
+    void record_argument_read(Expr* argument);
+
+    /**
+     * @brief Marks the function being scanned as calling code the analysis cannot see into.
+     *
+     */
+    void record_unknown_call();
+
+    /**
+     * @brief Propagates the effects of callees to their callers.
+     *
+     * @return std::unordered_map<Node::Variable*, FunctionEffects> The effects of every function, including the functions it calls.
+     */
+    std::unordered_map<Node::Variable*, FunctionEffects> propagate();
+
+    /**
+     * @brief Finds the functions that may call themselves, and every function that calls them.
+     *
+     * @param function The function to visit.
+     * @param on_stack The functions on the current call path.
+     * @param results Whether each visited function may recurse or calls a function that does.
+     * @return true If the function may call itself, or calls a function that may.
+     */
+    bool find_recursion(Node::Variable* function, std::unordered_set<Node::Variable*>& on_stack, std::unordered_map<Node::Variable*, bool>& results);
+
+    void visit_declaration_stmt(Stmt::Declaration* stmt) override;
+    void visit_expression_stmt(Stmt::Expression* stmt) override;
+    void visit_block_stmt(Stmt::Block* /*stmt*/) override {}
+    void visit_conditional_stmt(Stmt::Conditional* stmt) override;
+    void visit_loop_stmt(Stmt::Loop* stmt) override;
+    void visit_for_stmt(Stmt::For* stmt) override;
+    void visit_match_stmt(Stmt::Match* stmt) override;
+    void visit_return_stmt(Stmt::Return* stmt) override;
+    void visit_break_stmt(Stmt::Break* /*stmt*/) override {}
+    void visit_continue_stmt(Stmt::Continue* /*stmt*/) override {}
+    void visit_eof_stmt(Stmt::EndOfFile* /*stmt*/) override {}
+
+    void visit_var_decl(Decl::Var* decl) override;
+    void visit_fun_decl(Decl::Fun* decl) override;
+    void visit_extern_fun_decl(Decl::ExternFun* /*decl*/) override {}
+    void visit_struct_decl(Decl::Struct* /*decl*/) override {}
+    void visit_enum_decl(Decl::Enum* /*decl*/) override {}
+
+    void visit_assign_expr(Expr::Assign* expr) override;
+    void visit_logical_expr(Expr::Logical* expr) override;
+    void visit_binary_expr(Expr::Binary* expr) override;
+    void visit_unary_expr(Expr::Unary* expr) override;
+    void visit_dereference_expr(Expr::Dereference* expr) override;
+    void visit_access_expr(Expr::Access* expr) override;
+    void visit_index_expr(Expr::Index* expr) override;
+    void visit_slice_expr(Expr::Slice* expr) override;
+    void visit_call_expr(Expr::Call* expr) override;
+    void visit_cast_expr(Expr::Cast* expr) override;
+    void visit_grouping_expr(Expr::Grouping* expr) override;
+    void visit_identifier_expr(Expr::Identifier* expr) override;
+    void visit_literal_expr(Expr::Literal* /*expr*/) override {}
+    void visit_array_expr(Expr::Array* expr) override;
+    void visit_array_gen_expr(Expr::ArrayGen* expr) override;
+    void visit_tuple_expr(Expr::Tuple* expr) override;
+    void visit_object_expr(Expr::Object* expr) override;
+    void visit_alloc_expr(Expr::Alloc* expr) override;
+    void visit_dealloc_expr(Expr::Dealloc* expr) override;
+
+public:
+    /**
+     * @brief Sets whether indexes into arrays and slices are bounds checked, as in CodeGenerator::set_bounds_check.
+     *
+     * @param enabled Set to true if bounds checks are emitted; false by default.
+     */
+    void set_bounds_check(bool enabled) {
+        bounds_check = enabled;
+    }
+
+    /**
+     * @brief Infers the effects of functions.
+     *
+     * @param functions The global function nodes, as returned by Environment::get_global_functions.
+     * @return std::unordered_map<Node::Variable*, FunctionEffects> The effects of each function with a body; `extern` functions are left out.
+     */
+    std::unordered_map<Node::Variable*, FunctionEffects> analyze(const std::vector<std::shared_ptr<Node::Variable>>& functions);
+};
+
+#endif // PURITY_ANALYZER_H
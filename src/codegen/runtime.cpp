@@ -0,0 +1,497 @@
+#include "runtime.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Intrinsics.h"
+
+namespace {
+
+// The kinds of scoped allocators.
+constexpr uint64_t ARENA = 0;
+constexpr uint64_t POOL = 1;
+
+// The fields of the state of a scoped allocator.
+constexpr unsigned PREVIOUS = 0;
+constexpr unsigned KIND = 1;
+constexpr unsigned CHUNKS = 2;
+constexpr unsigned OFFSET = 3;
+constexpr unsigned CAPACITY = 4;
+constexpr unsigned FREE_LISTS = 5;
+
+// The number of pool size classes, from 16 to 256 bytes.
+constexpr uint64_t SIZE_CLASSES = 5;
+// Pool blocks up to this size come from the free lists; larger ones are chunks of their own.
+constexpr uint64_t MAX_BLOCK_SIZE = 256;
+// The alignment malloc guarantees on the 64-bit targets; anything aligned for more is padded to its alignment.
+constexpr uint64_t MALLOC_ALIGN = 16;
+// Pool blocks are aligned to their smallest size class, which is also what malloc guarantees.
+constexpr uint64_t BLOCK_ALIGN = MALLOC_ALIGN;
+// The size of a chunk, unless one allocation needs more.
+constexpr uint64_t CHUNK_SIZE = 64 * 1024;
+// Each chunk starts with a pointer to the next one, padded to the alignment malloc guarantees.
+constexpr uint64_t CHUNK_HEADER = MALLOC_ALIGN;
+
+// `ptr (i64 size, i64 align)`
+llvm::FunctionType* alloc_type(llvm::LLVMContext& context) {
+    auto i64 = llvm::Type::getInt64Ty(context);
+    return llvm::FunctionType::get(llvm::PointerType::getUnqual(context), {i64, i64}, false);
+}
+
+// `void (ptr memory, i64 size, i64 align)`
+llvm::FunctionType* dealloc_type(llvm::LLVMContext& context) {
+    auto i64 = llvm::Type::getInt64Ty(context);
+    return llvm::FunctionType::get(llvm::Type::getVoidTy(context), {llvm::PointerType::getUnqual(context), i64, i64}, false);
+}
+
+// `void ()`, the type of the functions that control the scoped allocators.
+llvm::FunctionType* scope_type(llvm::LLVMContext& context) {
+    return llvm::FunctionType::get(llvm::Type::getVoidTy(context), false);
+}
+
+} // namespace
+
+Runtime::Runtime(llvm::Module& ir_module) : ir_module(ir_module), context(ir_module.getContext()), builder(ir_module.getContext()) {}
+
+llvm::FunctionCallee Runtime::get_alloc() {
+    return ir_module.getOrInsertFunction("niter_alloc", alloc_type(context));
+}
+
+llvm::FunctionCallee Runtime::get_dealloc() {
+    return ir_module.getOrInsertFunction("niter_dealloc", dealloc_type(context));
+}
+
+void Runtime::define() {
+    auto define_if_declared = [&](const std::string& name, llvm::FunctionType* type, auto define_body) {
+        auto fun = ir_module.getFunction(name);
+        if (fun != nullptr && fun->isDeclaration() && fun->getFunctionType() == type) {
+            define_body(fun);
+        }
+    };
+    define_if_declared("niter_alloc", alloc_type(context), [&](llvm::Function* fun) { define_alloc(fun); });
+    define_if_declared("niter_dealloc", dealloc_type(context), [&](llvm::Function* fun) { define_dealloc(fun); });
+    define_if_declared("niter_arena_begin", scope_type(context), [&](llvm::Function* fun) { define_begin(fun, ARENA); });
+    define_if_declared("niter_pool_begin", scope_type(context), [&](llvm::Function* fun) { define_begin(fun, POOL); });
+    define_if_declared("niter_allocator_reset", scope_type(context), [&](llvm::Function* fun) { define_reset(fun); });
+    define_if_declared("niter_allocator_end", scope_type(context), [&](llvm::Function* fun) { define_end(fun); });
+}
+
+llvm::GlobalVariable* Runtime::get_current_allocator() {
+    if (auto global = ir_module.getGlobalVariable("niter_allocator")) {
+        return global;
+    }
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto global = new llvm::GlobalVariable(
+        ir_module,
+        ptr_type,
+        false,
+        llvm::GlobalValue::WeakAnyLinkage,
+        llvm::ConstantPointerNull::get(ptr_type),
+        "niter_allocator"
+    );
+    // Each thread has its own allocator scopes.
+    global->setThreadLocal(true);
+    return global;
+}
+
+llvm::StructType* Runtime::get_state_type() {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto i64 = llvm::Type::getInt64Ty(context);
+    return llvm::StructType::get(context, {ptr_type, i64, ptr_type, i64, i64, llvm::ArrayType::get(ptr_type, SIZE_CLASSES)});
+}
+
+llvm::FunctionCallee Runtime::get_libc_function(const std::string& name, llvm::FunctionType* type) {
+    return ir_module.getOrInsertFunction(name, type);
+}
+
+void Runtime::begin_definition(llvm::Function* fun, bool internal) {
+    fun->setLinkage(internal ? llvm::GlobalValue::InternalLinkage : llvm::GlobalValue::WeakAnyLinkage);
+    fun->addFnAttr(llvm::Attribute::NoUnwind);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", fun));
+}
+
+llvm::Value* Runtime::size_class(llvm::Value* size) {
+    // One class for each power of two the size exceeds, starting from 16.
+    llvm::Value* result = builder.getInt64(0);
+    for (uint64_t bound = BLOCK_ALIGN; bound < MAX_BLOCK_SIZE; bound *= 2) {
+        auto exceeds = builder.CreateICmpUGT(size, builder.getInt64(bound));
+        result = builder.CreateAdd(result, builder.CreateZExt(exceeds, builder.getInt64Ty()));
+    }
+    return result;
+}
+
+llvm::Value* Runtime::align_offset(llvm::Value* base, llvm::Value* offset, llvm::Value* align) {
+    // The alignment is a power of two.
+    auto align_mask = builder.CreateSub(align, builder.getInt64(1));
+    auto address = builder.CreatePtrToInt(base, builder.getInt64Ty());
+    auto aligned = builder.CreateAnd(builder.CreateAdd(builder.CreateAdd(address, offset), align_mask), builder.CreateNot(align_mask));
+    return builder.CreateSub(aligned, address);
+}
+
+llvm::Value* Runtime::padded_size(llvm::Value* size, llvm::Value* align, llvm::BasicBlock* failed_block, llvm::BasicBlock* next_block) {
+    // Memory from malloc starts MALLOC_ALIGN-aligned, so reaching the alignment past a header of that size takes at most align - MALLOC_ALIGN bytes.
+    auto malloc_align = builder.getInt64(MALLOC_ALIGN);
+    auto padding = builder.CreateSelect(builder.CreateICmpUGT(align, malloc_align), align, malloc_align);
+    auto padded = builder.CreateBinaryIntrinsic(llvm::Intrinsic::uadd_with_overflow, size, padding);
+    auto result = builder.CreateExtractValue(padded, 0);
+    builder.CreateCondBr(builder.CreateExtractValue(padded, 1), failed_block, next_block);
+    return result;
+}
+
+llvm::Function* Runtime::get_aligned_malloc() {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto i64 = builder.getInt64Ty();
+    if (auto fun = ir_module.getFunction("niter.aligned_malloc")) {
+        return fun;
+    }
+    auto fun = llvm::Function::Create(
+        llvm::FunctionType::get(ptr_type, {i64, i64}, false), llvm::GlobalValue::InternalLinkage, "niter.aligned_malloc", ir_module
+    );
+    begin_definition(fun, true);
+    auto size = fun->getArg(0);
+    auto align = fun->getArg(1);
+    auto malloc = get_libc_function("malloc", llvm::FunctionType::get(ptr_type, {i64}, false));
+    auto plain_block = llvm::BasicBlock::Create(context, "plain", fun);
+    auto padded_block = llvm::BasicBlock::Create(context, "padded", fun);
+    auto allocate_block = llvm::BasicBlock::Create(context, "allocate", fun);
+    auto place_block = llvm::BasicBlock::Create(context, "place", fun);
+    auto failed_block = llvm::BasicBlock::Create(context, "failed", fun);
+    builder.CreateCondBr(builder.CreateICmpULE(align, builder.getInt64(MALLOC_ALIGN)), plain_block, padded_block);
+
+    builder.SetInsertPoint(plain_block);
+    builder.CreateRet(builder.CreateCall(malloc, {size}));
+
+    builder.SetInsertPoint(padded_block);
+    auto padded = padded_size(size, align, failed_block, allocate_block);
+
+    builder.SetInsertPoint(allocate_block);
+    auto raw = builder.CreateCall(malloc, {padded}, "raw");
+    builder.CreateCondBr(builder.CreateIsNull(raw), failed_block, place_block);
+
+    builder.SetInsertPoint(failed_block);
+    builder.CreateRet(llvm::ConstantPointerNull::get(ptr_type));
+
+    // The pointer to free goes right before the memory, in the padding.
+    builder.SetInsertPoint(place_block);
+    auto memory = builder.CreateGEP(builder.getInt8Ty(), raw, align_offset(raw, builder.getInt64(MALLOC_ALIGN), align), "memory");
+    builder.CreateStore(raw, builder.CreateGEP(ptr_type, memory, builder.getInt64(-1)));
+    builder.CreateRet(memory);
+    return fun;
+}
+
+llvm::Function* Runtime::get_aligned_free() {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto i64 = builder.getInt64Ty();
+    if (auto fun = ir_module.getFunction("niter.aligned_free")) {
+        return fun;
+    }
+    auto fun = llvm::Function::Create(
+        llvm::FunctionType::get(builder.getVoidTy(), {ptr_type, i64}, false), llvm::GlobalValue::InternalLinkage, "niter.aligned_free", ir_module
+    );
+    begin_definition(fun, true);
+    auto memory = fun->getArg(0);
+    auto align = fun->getArg(1);
+    auto free = get_libc_function("free", llvm::FunctionType::get(builder.getVoidTy(), {ptr_type}, false));
+    auto plain_block = llvm::BasicBlock::Create(context, "plain", fun);
+    auto padded_block = llvm::BasicBlock::Create(context, "padded", fun);
+    builder.CreateCondBr(builder.CreateICmpULE(align, builder.getInt64(MALLOC_ALIGN)), plain_block, padded_block);
+
+    builder.SetInsertPoint(plain_block);
+    builder.CreateCall(free, {memory});
+    builder.CreateRetVoid();
+
+    builder.SetInsertPoint(padded_block);
+    builder.CreateCall(free, {builder.CreateLoad(ptr_type, builder.CreateGEP(ptr_type, memory, builder.getInt64(-1)), "raw")});
+    builder.CreateRetVoid();
+    return fun;
+}
+
+llvm::Function* Runtime::get_bump() {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto i64 = builder.getInt64Ty();
+    if (auto fun = ir_module.getFunction("niter.bump")) {
+        return fun;
+    }
+    auto fun = llvm::Function::Create(
+        llvm::FunctionType::get(ptr_type, {ptr_type, i64, i64}, false), llvm::GlobalValue::InternalLinkage, "niter.bump", ir_module
+    );
+    begin_definition(fun, true);
+    auto state = fun->getArg(0);
+    auto size = fun->getArg(1);
+    auto align = fun->getArg(2);
+    auto state_type = get_state_type();
+    auto chunks_field = builder.CreateStructGEP(state_type, state, CHUNKS);
+    auto offset_field = builder.CreateStructGEP(state_type, state, OFFSET);
+    auto capacity_field = builder.CreateStructGEP(state_type, state, CAPACITY);
+
+    // Before the first chunk, nothing fits, not even an empty allocation.
+    auto chunk = builder.CreateLoad(ptr_type, chunks_field, "chunk");
+    auto start = align_offset(chunk, builder.CreateLoad(i64, offset_field, "offset"), align);
+    auto end = builder.CreateAdd(start, size);
+    auto fits = builder.CreateAnd(builder.CreateIsNotNull(chunk), builder.CreateICmpULE(end, builder.CreateLoad(i64, capacity_field, "capacity")));
+    auto bump_block = llvm::BasicBlock::Create(context, "bump", fun);
+    auto grow_block = llvm::BasicBlock::Create(context, "grow", fun);
+    builder.CreateCondBr(fits, bump_block, grow_block);
+
+    builder.SetInsertPoint(bump_block);
+    builder.CreateStore(end, offset_field);
+    builder.CreateRet(builder.CreateGEP(builder.getInt8Ty(), chunk, start));
+
+    // The newest chunk is full: start a new one, large enough for the header, the allocation and the padding that aligns it.
+    builder.SetInsertPoint(grow_block);
+    auto failed_block = llvm::BasicBlock::Create(context, "failed", fun);
+    auto allocate_block = llvm::BasicBlock::Create(context, "allocate", fun);
+    auto needed = padded_size(size, align, failed_block, allocate_block);
+
+    builder.SetInsertPoint(allocate_block);
+    auto chunk_size = builder.getInt64(CHUNK_SIZE);
+    auto capacity = builder.CreateSelect(builder.CreateICmpUGT(needed, chunk_size), needed, chunk_size);
+    auto new_chunk = builder.CreateCall(get_libc_function("malloc", llvm::FunctionType::get(ptr_type, {i64}, false)), {capacity}, "new_chunk");
+    // Out of memory, the allocation fails like malloc does.
+    auto link_block = llvm::BasicBlock::Create(context, "link", fun);
+    builder.CreateCondBr(builder.CreateIsNull(new_chunk), failed_block, link_block);
+
+    builder.SetInsertPoint(failed_block);
+    builder.CreateRet(llvm::ConstantPointerNull::get(ptr_type));
+
+    builder.SetInsertPoint(link_block);
+    builder.CreateStore(chunk, new_chunk);
+    builder.CreateStore(new_chunk, chunks_field);
+    builder.CreateStore(capacity, capacity_field);
+    auto new_start = align_offset(new_chunk, builder.getInt64(CHUNK_HEADER), align);
+    builder.CreateStore(builder.CreateAdd(new_start, size), offset_field);
+    builder.CreateRet(builder.CreateGEP(builder.getInt8Ty(), new_chunk, new_start));
+    return fun;
+}
+
+llvm::Function* Runtime::get_free_chunks() {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    if (auto fun = ir_module.getFunction("niter.free_chunks")) {
+        return fun;
+    }
+    auto fun = llvm::Function::Create(
+        llvm::FunctionType::get(builder.getVoidTy(), {ptr_type}, false), llvm::GlobalValue::InternalLinkage, "niter.free_chunks", ir_module
+    );
+    begin_definition(fun, true);
+    auto entry_block = builder.GetInsertBlock();
+    auto loop_block = llvm::BasicBlock::Create(context, "loop", fun);
+    auto body_block = llvm::BasicBlock::Create(context, "body", fun);
+    auto done_block = llvm::BasicBlock::Create(context, "done", fun);
+    builder.CreateBr(loop_block);
+
+    builder.SetInsertPoint(loop_block);
+    auto chunk = builder.CreatePHI(ptr_type, 2, "chunk");
+    chunk->addIncoming(fun->getArg(0), entry_block);
+    builder.CreateCondBr(builder.CreateIsNull(chunk), done_block, body_block);
+
+    builder.SetInsertPoint(body_block);
+    auto next = builder.CreateLoad(ptr_type, chunk, "next");
+    builder.CreateCall(get_libc_function("free", llvm::FunctionType::get(builder.getVoidTy(), {ptr_type}, false)), {chunk});
+    chunk->addIncoming(next, body_block);
+    builder.CreateBr(loop_block);
+
+    builder.SetInsertPoint(done_block);
+    builder.CreateRetVoid();
+    return fun;
+}
+
+void Runtime::define_alloc(llvm::Function* fun) {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto i64 = builder.getInt64Ty();
+    auto bump = get_bump();
+    auto aligned_malloc = get_aligned_malloc();
+    begin_definition(fun, false);
+    auto size = fun->getArg(0);
+    auto align = fun->getArg(1);
+    auto state_type = get_state_type();
+    auto heap_block = llvm::BasicBlock::Create(context, "heap", fun);
+    auto scoped_block = llvm::BasicBlock::Create(context, "scoped", fun);
+    auto arena_block = llvm::BasicBlock::Create(context, "arena", fun);
+    auto pool_block = llvm::BasicBlock::Create(context, "pool", fun);
+    auto small_block = llvm::BasicBlock::Create(context, "small", fun);
+    auto reuse_block = llvm::BasicBlock::Create(context, "reuse", fun);
+    auto carve_block = llvm::BasicBlock::Create(context, "carve", fun);
+    auto large_block = llvm::BasicBlock::Create(context, "large", fun);
+    auto allocate_block = llvm::BasicBlock::Create(context, "allocate", fun);
+    auto track_block = llvm::BasicBlock::Create(context, "track", fun);
+    auto failed_block = llvm::BasicBlock::Create(context, "failed", fun);
+
+    auto state = builder.CreateLoad(ptr_type, get_current_allocator(), "state");
+    builder.CreateCondBr(builder.CreateIsNull(state), heap_block, scoped_block);
+
+    builder.SetInsertPoint(heap_block);
+    builder.CreateRet(builder.CreateCall(aligned_malloc, {size, align}));
+
+    builder.SetInsertPoint(scoped_block);
+    auto kind = builder.CreateLoad(i64, builder.CreateStructGEP(state_type, state, KIND), "kind");
+    builder.CreateCondBr(builder.CreateICmpEQ(kind, builder.getInt64(POOL)), pool_block, arena_block);
+
+    builder.SetInsertPoint(arena_block);
+    builder.CreateRet(builder.CreateCall(bump, {state, size, align}));
+
+    // Large or overaligned blocks do not fit a size class.
+    builder.SetInsertPoint(pool_block);
+    auto is_small = builder.CreateAnd(builder.CreateICmpULE(size, builder.getInt64(MAX_BLOCK_SIZE)), builder.CreateICmpULE(align, builder.getInt64(BLOCK_ALIGN)));
+    builder.CreateCondBr(is_small, small_block, large_block);
+
+    // A large block is a chunk of its own, so that resetting or ending the pool frees it with the others.
+    // It is linked after the newest chunk, which the pool keeps bumping.
+    builder.SetInsertPoint(large_block);
+    auto needed = padded_size(size, align, failed_block, allocate_block);
+
+    builder.SetInsertPoint(allocate_block);
+    auto large_chunk = builder.CreateCall(get_libc_function("malloc", llvm::FunctionType::get(ptr_type, {i64}, false)), {needed}, "large_chunk");
+    builder.CreateCondBr(builder.CreateIsNull(large_chunk), failed_block, track_block);
+
+    builder.SetInsertPoint(failed_block);
+    builder.CreateRet(llvm::ConstantPointerNull::get(ptr_type));
+
+    builder.SetInsertPoint(track_block);
+    auto chunks_field = builder.CreateStructGEP(state_type, state, CHUNKS);
+    auto newest = builder.CreateLoad(ptr_type, chunks_field, "newest");
+    // Each chunk starts with the pointer to the next one, like the head of the list does.
+    auto link = builder.CreateSelect(builder.CreateIsNull(newest), chunks_field, newest, "link");
+    builder.CreateStore(builder.CreateLoad(ptr_type, link, "next"), large_chunk);
+    builder.CreateStore(large_chunk, link);
+    builder.CreateRet(builder.CreateGEP(builder.getInt8Ty(), large_chunk, align_offset(large_chunk, builder.getInt64(CHUNK_HEADER), align)));
+
+    builder.SetInsertPoint(small_block);
+    auto block_class = size_class(size);
+    auto free_list = builder.CreateInBoundsGEP(state_type, state, {builder.getInt32(0), builder.getInt32(FREE_LISTS), block_class}, "free_list");
+    auto head = builder.CreateLoad(ptr_type, free_list, "head");
+    builder.CreateCondBr(builder.CreateIsNull(head), carve_block, reuse_block);
+
+    // A free block holds the next free block of its class.
+    builder.SetInsertPoint(reuse_block);
+    builder.CreateStore(builder.CreateLoad(ptr_type, head, "next"), free_list);
+    builder.CreateRet(head);
+
+    builder.SetInsertPoint(carve_block);
+    auto block_size = builder.CreateShl(builder.getInt64(BLOCK_ALIGN), block_class);
+    builder.CreateRet(builder.CreateCall(bump, {state, block_size, builder.getInt64(BLOCK_ALIGN)}));
+}
+
+void Runtime::define_dealloc(llvm::Function* fun) {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto i64 = builder.getInt64Ty();
+    auto aligned_free = get_aligned_free();
+    begin_definition(fun, false);
+    auto memory = fun->getArg(0);
+    auto size = fun->getArg(1);
+    auto align = fun->getArg(2);
+    auto state_type = get_state_type();
+    auto check_block = llvm::BasicBlock::Create(context, "check", fun);
+    auto heap_block = llvm::BasicBlock::Create(context, "heap", fun);
+    auto scoped_block = llvm::BasicBlock::Create(context, "scoped", fun);
+    auto pool_block = llvm::BasicBlock::Create(context, "pool", fun);
+    auto push_block = llvm::BasicBlock::Create(context, "push", fun);
+    auto done_block = llvm::BasicBlock::Create(context, "done", fun);
+
+    builder.CreateCondBr(builder.CreateIsNull(memory), done_block, check_block);
+
+    builder.SetInsertPoint(check_block);
+    auto state = builder.CreateLoad(ptr_type, get_current_allocator(), "state");
+    builder.CreateCondBr(builder.CreateIsNull(state), heap_block, scoped_block);
+
+    builder.SetInsertPoint(heap_block);
+    builder.CreateCall(aligned_free, {memory, align});
+    builder.CreateRetVoid();
+
+    // An arena only releases its memory all at once.
+    builder.SetInsertPoint(scoped_block);
+    auto kind = builder.CreateLoad(i64, builder.CreateStructGEP(state_type, state, KIND), "kind");
+    builder.CreateCondBr(builder.CreateICmpEQ(kind, builder.getInt64(POOL)), pool_block, done_block);
+
+    // A large block is a chunk, which is only freed with the others.
+    builder.SetInsertPoint(pool_block);
+    auto is_small = builder.CreateAnd(builder.CreateICmpULE(size, builder.getInt64(MAX_BLOCK_SIZE)), builder.CreateICmpULE(align, builder.getInt64(BLOCK_ALIGN)));
+    builder.CreateCondBr(is_small, push_block, done_block);
+
+    builder.SetInsertPoint(push_block);
+    auto free_list = builder.CreateInBoundsGEP(state_type, state, {builder.getInt32(0), builder.getInt32(FREE_LISTS), size_class(size)}, "free_list");
+    builder.CreateStore(builder.CreateLoad(ptr_type, free_list, "head"), memory);
+    builder.CreateStore(memory, free_list);
+    builder.CreateRetVoid();
+
+    builder.SetInsertPoint(done_block);
+    builder.CreateRetVoid();
+}
+
+void Runtime::define_begin(llvm::Function* fun, uint64_t kind) {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    begin_definition(fun, false);
+    auto state_type = get_state_type();
+    auto& data_layout = ir_module.getDataLayout();
+    auto state_size = builder.getInt64(data_layout.getTypeAllocSize(state_type).getFixedValue());
+    auto state = builder.CreateCall(get_libc_function("malloc", llvm::FunctionType::get(ptr_type, {builder.getInt64Ty()}, false)), {state_size}, "state");
+    // No chunks and empty free lists; the first allocation adds a chunk.
+    builder.CreateMemSet(state, builder.getInt8(0), state_size, data_layout.getABITypeAlign(state_type));
+    builder.CreateStore(builder.getInt64(kind), builder.CreateStructGEP(state_type, state, KIND));
+    auto current = get_current_allocator();
+    builder.CreateStore(builder.CreateLoad(ptr_type, current, "previous"), builder.CreateStructGEP(state_type, state, PREVIOUS));
+    builder.CreateStore(state, current);
+    builder.CreateRetVoid();
+}
+
+void Runtime::define_reset(llvm::Function* fun) {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto free_chunks = get_free_chunks();
+    begin_definition(fun, false);
+    auto state_type = get_state_type();
+    auto reset_block = llvm::BasicBlock::Create(context, "reset", fun);
+    auto bumped_block = llvm::BasicBlock::Create(context, "bumped", fun);
+    auto rewind_block = llvm::BasicBlock::Create(context, "rewind", fun);
+    auto release_block = llvm::BasicBlock::Create(context, "release", fun);
+    auto done_block = llvm::BasicBlock::Create(context, "done", fun);
+
+    auto state = builder.CreateLoad(ptr_type, get_current_allocator(), "state");
+    builder.CreateCondBr(builder.CreateIsNull(state), done_block, reset_block);
+
+    builder.SetInsertPoint(reset_block);
+    auto chunks_field = builder.CreateStructGEP(state_type, state, CHUNKS);
+    auto chunk = builder.CreateLoad(ptr_type, chunks_field, "chunk");
+    builder.CreateCondBr(builder.CreateIsNull(chunk), done_block, bumped_block);
+
+    // Without a capacity, nothing was bumped yet, and every chunk is a large pool block.
+    builder.SetInsertPoint(bumped_block);
+    auto capacity = builder.CreateLoad(builder.getInt64Ty(), builder.CreateStructGEP(state_type, state, CAPACITY), "capacity");
+    builder.CreateCondBr(builder.CreateICmpEQ(capacity, builder.getInt64(0)), release_block, rewind_block);
+
+    builder.SetInsertPoint(release_block);
+    builder.CreateCall(free_chunks, {chunk});
+    builder.CreateStore(llvm::ConstantPointerNull::get(ptr_type), chunks_field);
+    builder.CreateBr(done_block);
+
+    // Keep the newest chunk, so the next allocations do not go back to malloc.
+    builder.SetInsertPoint(rewind_block);
+    builder.CreateCall(free_chunks, {builder.CreateLoad(ptr_type, chunk, "next")});
+    builder.CreateStore(llvm::ConstantPointerNull::get(ptr_type), chunk);
+    builder.CreateStore(builder.getInt64(CHUNK_HEADER), builder.CreateStructGEP(state_type, state, OFFSET));
+    // Every free block was in a chunk that is gone or rewound.
+    auto free_lists_type = state_type->getElementType(FREE_LISTS);
+    builder.CreateStore(llvm::Constant::getNullValue(free_lists_type), builder.CreateStructGEP(state_type, state, FREE_LISTS));
+    builder.CreateBr(done_block);
+
+    builder.SetInsertPoint(done_block);
+    builder.CreateRetVoid();
+}
+
+void Runtime::define_end(llvm::Function* fun) {
+    auto ptr_type = llvm::PointerType::getUnqual(context);
+    auto free_chunks = get_free_chunks();
+    begin_definition(fun, false);
+    auto state_type = get_state_type();
+    auto end_block = llvm::BasicBlock::Create(context, "end", fun);
+    auto done_block = llvm::BasicBlock::Create(context, "done", fun);
+
+    auto current = get_current_allocator();
+    auto state = builder.CreateLoad(ptr_type, current, "state");
+    builder.CreateCondBr(builder.CreateIsNull(state), done_block, end_block);
+
+    builder.SetInsertPoint(end_block);
+    builder.CreateCall(free_chunks, {builder.CreateLoad(ptr_type, builder.CreateStructGEP(state_type, state, CHUNKS), "chunks")});
+    builder.CreateStore(builder.CreateLoad(ptr_type, builder.CreateStructGEP(state_type, state, PREVIOUS), "previous"), current);
+    builder.CreateCall(get_libc_function("free", llvm::FunctionType::get(builder.getVoidTy(), {ptr_type}, false)), {state});
+    builder.CreateBr(done_block);
+
+    builder.SetInsertPoint(done_block);
+    builder.CreateRetVoid();
+}
@@ -0,0 +1,203 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include <string>
+
+/**
+ * @brief The Niter runtime allocator, which `alloc` and `dealloc` are lowered to.
+ * There is no separate runtime library: the runtime functions are defined in each module that uses them, with weak linkage.
+ * A program can replace the allocator at link time by defining `niter_alloc` and `niter_dealloc` itself, e.g. in C:
+ *
+ *     void* niter_alloc(int64_t size, int64_t align);
+ *     void niter_dealloc(void* ptr, int64_t size, int64_t align);
+ *
+ * By default, memory comes from malloc and goes back to free; memory aligned for more than malloc guarantees (16 bytes) is over-allocated and aligned.
+ * Niter code can also swap the allocator for a scope of its thread, by declaring the scope functions it uses as `extern` functions:
+ *
+ *     extern fun niter_arena_begin()       // Allocates from a bump arena; dealloc does nothing.
+ *     extern fun niter_pool_begin()        // Allocates small blocks from size-class free lists, and larger ones from malloc.
+ *     extern fun niter_allocator_reset()   // Releases everything the current arena or pool allocated, at once.
+ *     extern fun niter_allocator_end()     // Releases everything and returns to the previous allocator.
+ *
+ * Memory from an arena or a pool must not be deallocated or used after its scope ends.
+ * A pool keeps the blocks larger than 256 bytes with its chunks, so deallocating one only releases it when the pool is reset or ended.
+ *
+ */
+class Runtime {
+    // The module the runtime is defined in.
+    llvm::Module& ir_module;
+    // The context of the module.
+    llvm::LLVMContext& context;
+    // A builder of its own, so that defining the runtime never moves the code generator's insertion point.
+    llvm::IRBuilder<> builder;
+
+    /**
+     * @brief Gets the thread-local global pointing to the state of the current scoped allocator, or null for malloc/free.
+     *
+     * @return llvm::GlobalVariable* The global.
+     */
+    llvm::GlobalVariable* get_current_allocator();
+
+    /**
+     * @brief Gets the type of the state of a scoped allocator.
+     * `{previous, kind, chunks, offset, capacity, free_lists}`: the allocator to return to, whether it is an arena or a pool,
+     * the list of chunks, with the newest first, the bump offset into and the size of the newest chunk,
+     * and, for pools, the free list of each size class.
+     *
+     * @return llvm::StructType* The type of the state.
+     */
+    llvm::StructType* get_state_type();
+
+    /**
+     * @brief Gets a C library function, declaring it if needed.
+     *
+     * @param name The name of the function.
+     * @param type The type of the function.
+     * @return llvm::FunctionCallee The function, to be called with the given type.
+     */
+    llvm::FunctionCallee get_libc_function(const std::string& name, llvm::FunctionType* type);
+
+    /**
+     * @brief Starts a function body; creates its entry block and points the builder at it.
+     *
+     * @param fun The function to define.
+     * @param internal Whether the function is a helper of the runtime rather than part of its interface.
+     */
+    void begin_definition(llvm::Function* fun, bool internal);
+
+    /**
+     * @brief Computes the offset past which the memory at an address is aligned.
+     * The address itself is rounded, since chunks are only as aligned as malloc makes them.
+     *
+     * @param base The start of the memory.
+     * @param offset The first offset the result may be.
+     * @param align The alignment, a power of two.
+     * @return llvm::Value* The smallest offset from base, at least offset, whose address is a multiple of align, as an i64.
+     */
+    llvm::Value* align_offset(llvm::Value* base, llvm::Value* offset, llvm::Value* align);
+
+    /**
+     * @brief Computes how much to malloc for memory of a size and alignment, with a header of 16 bytes before it.
+     * Ends the current block with a branch to failed_block if the size does not fit in 64 bits, and to next_block otherwise.
+     *
+     * @param size The size of the memory.
+     * @param align The alignment of the memory.
+     * @param failed_block Where to go if the size overflows.
+     * @param next_block Where to go otherwise; the result may be used there.
+     * @return llvm::Value* The size to malloc, as an i64.
+     */
+    llvm::Value* padded_size(llvm::Value* size, llvm::Value* align, llvm::BasicBlock* failed_block, llvm::BasicBlock* next_block);
+
+    /**
+     * @brief Gets the helper that allocates memory of any alignment from malloc.
+     * Memory aligned for more than malloc guarantees is over-allocated, and the pointer malloc returned is kept just before it.
+     * Returns null when malloc does.
+     *
+     * @return llvm::Function* `ptr aligned_malloc(i64 size, i64 align)`.
+     */
+    llvm::Function* get_aligned_malloc();
+
+    /**
+     * @brief Gets the helper that frees memory from aligned_malloc.
+     *
+     * @return llvm::Function* `void aligned_free(ptr memory, i64 align)`.
+     */
+    llvm::Function* get_aligned_free();
+
+    /**
+     * @brief Gets the helper that bumps the offset of the newest chunk of an allocator, adding a chunk if it is full.
+     * Returns null if a new chunk is needed and malloc returns null.
+     *
+     * @return llvm::Function* `ptr bump(ptr state, i64 size, i64 align)`.
+     */
+    llvm::Function* get_bump();
+
+    /**
+     * @brief Gets the helper that frees a list of chunks.
+     *
+     * @return llvm::Function* `void free_chunks(ptr first)`.
+     */
+    llvm::Function* get_free_chunks();
+
+    /**
+     * @brief Computes the size class of a small pool block: 0 for 16 bytes, then one class per power of two, up to 4 for 256 bytes.
+     *
+     * @param size The size of the block, at most 256.
+     * @return llvm::Value* The size class, as an i64.
+     */
+    llvm::Value* size_class(llvm::Value* size);
+
+    /**
+     * @brief Defines `niter_alloc`: malloc without a scoped allocator, a bump in an arena, and a free list pop in a pool.
+     * A large pool block is a chunk of its own. Returns null when malloc does.
+     *
+     * @param fun The declaration to define.
+     */
+    void define_alloc(llvm::Function* fun);
+
+    /**
+     * @brief Defines `niter_dealloc`: free without a scoped allocator, nothing in an arena, and a free list push in a pool.
+     * A large pool block stays with the chunks until the pool is reset or ended.
+     *
+     * @param fun The declaration to define.
+     */
+    void define_dealloc(llvm::Function* fun);
+
+    /**
+     * @brief Defines `niter_arena_begin` or `niter_pool_begin`, which push a new scoped allocator.
+     *
+     * @param fun The declaration to define.
+     * @param kind The kind of allocator to push.
+     */
+    void define_begin(llvm::Function* fun, uint64_t kind);
+
+    /**
+     * @brief Defines `niter_allocator_reset`, which frees every chunk of the current allocator but the newest, and rewinds it.
+     * If nothing was bumped yet, the chunks are all large pool blocks, and none is kept.
+     *
+     * @param fun The declaration to define.
+     */
+    void define_reset(llvm::Function* fun);
+
+    /**
+     * @brief Defines `niter_allocator_end`, which frees the current allocator and everything it allocated.
+     *
+     * @param fun The declaration to define.
+     */
+    void define_end(llvm::Function* fun);
+
+public:
+    /**
+     * @brief Creates the runtime for a module.
+     *
+     * @param ir_module The module.
+     */
+    explicit Runtime(llvm::Module& ir_module);
+
+    /**
+     * @brief Gets the allocation function, declaring it if needed.
+     *
+     * @return llvm::FunctionCallee `ptr niter_alloc(i64 size, i64 align)`.
+     */
+    llvm::FunctionCallee get_alloc();
+
+    /**
+     * @brief Gets the deallocation function, declaring it if needed.
+     * The size and alignment must be the ones the memory was allocated with.
+     *
+     * @return llvm::FunctionCallee `void niter_dealloc(ptr memory, i64 size, i64 align)`.
+     */
+    llvm::FunctionCallee get_dealloc();
+
+    /**
+     * @brief Defines the runtime functions the module declares, either through `alloc` and `dealloc` or as `extern` functions.
+     * Declarations that do not have the type of the runtime function are left alone.
+     *
+     */
+    void define();
+};
+
+#endif // RUNTIME_H
@@ -0,0 +1,33 @@
+#include "compilation_context.h"
+
+namespace {
+
+// The context bound to this thread; nullptr if the thread uses its default context.
+thread_local CompilationContext* bound_context = nullptr;
+
+} // namespace
+
+CompilationContext& CompilationContext::current() {
+    if (bound_context != nullptr) {
+        return *bound_context;
+    }
+    // Created lazily, once per thread, so threads that never bind a context still never share state.
+    thread_local CompilationContext default_context;
+    return default_context;
+}
+
+CompilationContext::Binding::Binding(CompilationContext& context) : previous(bound_context) {
+    bound_context = &context;
+}
+
+CompilationContext::Binding::~Binding() {
+    bound_context = previous;
+}
+
+Environment& Environment::inst() {
+    return CompilationContext::current().get_environment();
+}
+
+ErrorLogger& ErrorLogger::inst() {
+    return CompilationContext::current().get_logger();
+}
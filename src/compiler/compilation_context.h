@@ -0,0 +1,75 @@
+#ifndef COMPILATION_CONTEXT_H
+#define COMPILATION_CONTEXT_H
+
+#include "../checker/environment.h"
+#include "../logger/logger.h"
+
+/**
+ * @brief The state belonging to a single compilation.
+ * Owns the environment (namespace tree, LLVM context, scope counters) and the error logger.
+ * Independent compilations each use their own context, so they may run concurrently on different threads.
+ * A context must only be used by one thread at a time.
+ *
+ * Environment::inst() and ErrorLogger::inst() resolve to the context bound to the calling thread.
+ * A thread that never binds a context gets a default context of its own.
+ *
+ */
+class CompilationContext {
+    // The environment for the type checkers and code generator.
+    Environment environment;
+    // The logger that collects diagnostics for this compilation.
+    ErrorLogger logger;
+
+public:
+    CompilationContext() = default;
+
+    /**
+     * @brief Creates a context for checking part of another compilation on a worker thread.
+     * The environment is a fork of the parent's environment, positioned at the given scope.
+     * Messages are buffered; replay them into the parent's logger once the worker is done.
+     *
+     * @param parent The compilation being checked.
+     * @param scope The scope to start in. Must belong to the parent's namespace tree.
+     */
+    CompilationContext(CompilationContext& parent, std::shared_ptr<Node::Scope> scope)
+        : environment(parent.environment, scope) {
+        logger.set_buffering(true);
+    }
+
+    CompilationContext(const CompilationContext&) = delete;
+    CompilationContext& operator=(const CompilationContext&) = delete;
+
+    Environment& get_environment() {
+        return environment;
+    }
+
+    ErrorLogger& get_logger() {
+        return logger;
+    }
+
+    /**
+     * @brief Get the context bound to the calling thread.
+     * If no context is bound, returns the thread's default context.
+     *
+     * @return CompilationContext& A reference to the current context.
+     */
+    static CompilationContext& current();
+
+    /**
+     * @brief Binds a context to the calling thread for the lifetime of this object.
+     * The previously bound context is restored on destruction, so bindings may nest.
+     *
+     */
+    class Binding {
+        // The context that was bound before this one; nullptr for the thread's default context.
+        CompilationContext* previous;
+
+    public:
+        explicit Binding(CompilationContext& context);
+        ~Binding();
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+    };
+};
+
+#endif // COMPILATION_CONTEXT_H
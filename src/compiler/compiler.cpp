@@ -36,6 +36,9 @@ int Compiler::compile() {
         }
     }
 
+    // The scanner, parser, optimizer, and emitter log through ErrorLogger::inst(), which resolves to this compilation while it is bound.
+    CompilationContext::Binding binding(this->context);
+
     std::vector<std::function<bool()>> stages = {
         [this]() {
             Scanner scanner;
@@ -43,32 +46,35 @@ int Compiler::compile() {
                 scanner.scan_file(this->file_names[i], this->src_codes[i]);
             }
             this->tokens = scanner.get_tokens();
-            return ErrorLogger::inst().get_errors().size() == 0;
+            return this->context.get_logger().get_errors().size() == 0;
         },
         [this]() {
             Parser parser;
             this->stmts = parser.parse(this->tokens);
-            return ErrorLogger::inst().get_errors().size() == 0;
+            return this->context.get_logger().get_errors().size() == 0;
         },
         [this]() {
-            GlobalChecker global_checker;
+            GlobalChecker global_checker(this->context);
             global_checker.type_check(this->stmts);
-            return ErrorLogger::inst().get_errors().size() == 0;
+            return this->context.get_logger().get_errors().size() == 0;
         },
         [this]() {
-            LocalChecker local_checker;
+            LocalChecker local_checker(this->context);
+            local_checker.set_worker_count(this->jobs);
             local_checker.type_check(this->stmts);
-            return ErrorLogger::inst().get_errors().size() == 0;
+            return this->context.get_logger().get_errors().size() == 0;
         },
         [this]() {
-            CodeGenerator codegen;
+            CodeGenerator codegen(this->context);
+            codegen.set_strict_aliasing(this->strict_aliasing);
+            codegen.set_bounds_check(this->bounds_check);
             this->ir_module = codegen.generate(this->stmts, this->ir_target_destination);
-            return ErrorLogger::inst().get_errors().size() == 0 && this->ir_module != nullptr;
+            return this->context.get_logger().get_errors().size() == 0 && this->ir_module != nullptr;
         },
         [this]() {
             Optimizer optimizer;
             optimizer.optimize(this->ir_module);
-            return ErrorLogger::inst().get_errors().size() == 0;
+            return this->context.get_logger().get_errors().size() == 0;
         },
         [this]() {
             Emitter emitter;
@@ -77,7 +83,7 @@ int Compiler::compile() {
                 target += ".o";
             }
             emitter.emit(this->ir_module, target);
-            return ErrorLogger::inst().get_errors().size() == 0;
+            return this->context.get_logger().get_errors().size() == 0;
         }
     };
 
@@ -2,6 +2,7 @@
 #define COMPILER_H
 
 #include "../parser/parser.h"
+#include "compilation_context.h"
 #include "../scanner/scanner.h"
 #include "llvm/IR/Module.h"
 #include <memory>
@@ -11,6 +12,7 @@
 /**
  * @brief A class to compile Niter code.
  * Runs code through the scanner, parser, type checker, and code generator.
+ * Each compiler owns its own CompilationContext, so separate compilers may run on separate threads.
  *
  */
 class Compiler {
@@ -24,6 +26,16 @@ class Compiler {
     std::string ir_target_destination;
     // Whether to run the linker after compilation.
     bool run_linker = true;
+    // The number of threads used to check function bodies; 0 uses one per hardware thread.
+    unsigned jobs = 1;
+    // Whether to emit type-based alias analysis metadata.
+    bool strict_aliasing = false;
+    // Whether to check indexes into arrays and slices at runtime.
+    bool bounds_check = false;
+
+    // The environment and diagnostics of this compilation.
+    // Declared before the module so that the LLVM context outlives it.
+    CompilationContext context;
 
     // The list of tokens generated by the scanner.
     std::vector<std::shared_ptr<Token>> tokens;
@@ -85,6 +97,36 @@ public:
         run_linker = run;
     }
 
+    /**
+     * @brief Set the number of threads used to check function bodies.
+     * Default behavior is to check everything on the calling thread.
+     *
+     * @param count The number of threads; 0 uses one thread per hardware thread.
+     */
+    void set_jobs(unsigned count) {
+        jobs = count;
+    }
+
+    /**
+     * @brief Set whether the optimizer may assume that accesses to different types never overlap.
+     * Default behavior is to make no such assumption.
+     *
+     * @param enabled Set to true to emit type-based alias analysis metadata.
+     */
+    void set_strict_aliasing(bool enabled) {
+        strict_aliasing = enabled;
+    }
+
+    /**
+     * @brief Set whether indexes into arrays and slices are checked at runtime.
+     * Default behavior is to leave them unchecked.
+     *
+     * @param enabled Set to true to stop the program with a trap when an index is out of range.
+     */
+    void set_bounds_check(bool enabled) {
+        bounds_check = enabled;
+    }
+
     /**
      * @brief Checks if the compiler has any input files.
      *
@@ -95,6 +137,16 @@ public:
         return file_names.size() > 0;
     }
 
+    /**
+     * @brief Get the context of this compilation.
+     * Useful for inspecting the diagnostics after compiling.
+     *
+     * @return CompilationContext& A reference to the context.
+     */
+    CompilationContext& get_context() {
+        return context;
+    }
+
     /**
      * @brief Compiles the source code under the configured settings.
      * Runs the source code through each stage of the compiler pipeline.
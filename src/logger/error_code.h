@@ -135,6 +135,36 @@ enum ErrorCode {
     E_UNMATCHED_BRACE_IN_WHILE_STMT,
     // A break statement was found outside of a loop
     E_BREAK_OUTSIDE_LOOP,
+    // A loop hint was found that is unknown or has an invalid argument
+    E_INVALID_LOOP_HINT,
+    // Loop hints were found that are not followed by a loop
+    E_LOOP_HINT_WITHOUT_LOOP,
+    // A for statement was found without a loop variable
+    E_NO_IDENT_IN_FOR,
+    // A for statement was found without the `in` keyword after the loop variable
+    E_NO_IN_IN_FOR,
+    // A for statement was found without a matching right brace
+    E_UNMATCHED_BRACE_IN_FOR_STMT,
+    // A list of type parameters was found with something other than an identifier in it
+    E_MISSING_IDENT_IN_TYPE_PARAMS,
+    // A list of type parameters was found without a matching right angle bracket
+    E_UNMATCHED_ANGLE_IN_TYPE_PARAMS,
+    // A vector type was found without a literal number of lanes
+    E_MISSING_SIZE_IN_VECTOR_TYPE,
+    // An enum declaration was found without an identifier
+    E_NO_IDENT_IN_ENUM,
+    // An enum declaration was found without a left brace
+    E_NO_LBRACE_IN_ENUM,
+    // An enum declaration was found without a matching right brace
+    E_UNMATCHED_BRACE_IN_ENUM,
+    // A match statement was found without a left brace after the value
+    E_NO_LBRACE_IN_MATCH,
+    // A match arm was found without a variant name or `_` as its pattern
+    E_INVALID_MATCH_PATTERN,
+    // A match arm was found without a double arrow after its pattern
+    E_NO_ARROW_IN_MATCH_ARM,
+    // A match statement was found without a matching right brace
+    E_UNMATCHED_BRACE_IN_MATCH_STMT,
 
     // Global type errors
     E_GLOBAL_TYPE = 4000,
@@ -154,6 +184,12 @@ enum ErrorCode {
     E_GLOBAL_RETURN,
     // A print statement was found outside of a function
     E_GLOBAL_PRINT,
+    // A generic struct or function was given the wrong number of type arguments
+    E_WRONG_TYPE_ARG_COUNT,
+    // A generic struct or function was instantiated inside too many of its own instances, e.g. `A<T>` using `A<[T; 1]>`
+    E_INSTANTIATION_TOO_DEEP,
+    // An enum was declared with two variants of the same name
+    E_DUPLICATE_VARIANT,
 
     // Local type errors
     E_LOCAL_TYPE = 5000,
@@ -225,6 +261,26 @@ enum ErrorCode {
     E_ASSIGN_TO_CONST,
     // A conditional statement was found with a non-boolean condition
     E_CONDITIONAL_WITHOUT_BOOL,
+    // A for statement was found that iterates over something other than an integer range or a sized array
+    E_FOR_OVER_NON_ITERABLE,
+    // A slice expression was found on something that cannot be sliced, e.g. a temporary array or a pointer without an end
+    E_INVALID_SLICE,
+    // An alloc expression was found with a type that cannot be allocated or a count that is not an integer
+    E_INVALID_ALLOC,
+    // A dealloc expression was found on something other than a mutable pointer or slice
+    E_INVALID_DEALLOC,
+    // A lane of a vector was indexed or shuffled with a literal that is out of range
+    E_LANE_OUT_OF_RANGE,
+    // A shuffle was found whose lanes are not a literal array of integers
+    E_INVALID_SHUFFLE,
+    // A match statement was found on a value that is not an enum
+    E_MATCH_ON_NON_ENUM,
+    // A variant was named that its enum does not have
+    E_UNKNOWN_VARIANT,
+    // A match statement was found with two arms for the same variant, or a second `_` arm
+    E_DUPLICATE_MATCH_ARM,
+    // A match statement was found that has no arm for some variants and no `_` arm
+    E_NON_EXHAUSTIVE_MATCH,
 
     // Code generation errors
     E_CODEGEN = 6000,
@@ -236,6 +292,8 @@ enum ErrorCode {
     E_INVALID_OUTPUT,
     // The target machine could not emit a file of the specified type
     E_INVALID_OUTPUT_TYPE,
+    // The initializer of a global variable failed or did not finish when it was run at compile time
+    E_CONST_EVAL_FAILED,
 
     // Post-processing errors
     E_POST_PROCESSING = 8000,
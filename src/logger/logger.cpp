@@ -135,6 +135,11 @@ void ErrorLogger::print_pretty_note(const Location& location, const std::string&
 }
 
 void ErrorLogger::log_error(const Location& location, ErrorCode error_code, const std::string& message) {
+    if (buffering) {
+        errors.push_back(error_code);
+        buffered_messages.push_back({false, true, location, error_code, message});
+        return;
+    }
     auto new_message = std::to_string(static_cast<int>(error_code)) + " " + message;
     errors.push_back(error_code);
     if (printing_enabled)
@@ -142,6 +147,11 @@ void ErrorLogger::log_error(const Location& location, ErrorCode error_code, cons
 }
 
 void ErrorLogger::log_error(ErrorCode error_code, const std::string& message) {
+    if (buffering) {
+        errors.push_back(error_code);
+        buffered_messages.push_back({false, false, Location(), error_code, message});
+        return;
+    }
     auto new_message = std::to_string(static_cast<int>(error_code)) + " " + message;
     errors.push_back(error_code);
     if (printing_enabled)
@@ -149,12 +159,31 @@ void ErrorLogger::log_error(ErrorCode error_code, const std::string& message) {
 }
 
 void ErrorLogger::log_note(const Location& location, const std::string& message) {
+    if (buffering) {
+        buffered_messages.push_back({true, true, location, (ErrorCode)0, message});
+        return;
+    }
     if (printing_enabled)
         print_pretty_note(location, message);
 }
 
+void ErrorLogger::replay(ErrorLogger& other) {
+    for (auto& buffered : other.buffered_messages) {
+        if (buffered.is_note) {
+            log_note(buffered.location, buffered.message);
+        } else if (buffered.has_location) {
+            log_error(buffered.location, buffered.error_code, buffered.message);
+        } else {
+            log_error(buffered.error_code, buffered.message);
+        }
+    }
+    other.buffered_messages.clear();
+}
+
 void ErrorLogger::reset() {
     out = &std::cerr;
     errors.clear();
     printing_enabled = true;
+    buffering = false;
+    buffered_messages.clear();
 }
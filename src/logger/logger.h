@@ -32,7 +32,8 @@ enum class Color {
 std::string colorize(Color color = Color::RESET);
 
 /**
- * @brief A singleton class to log compiler errors and warnings.
+ * @brief A class to log compiler errors and warnings.
+ * Each compilation owns its own logger through its CompilationContext.
  *
  */
 class ErrorLogger {
@@ -44,6 +45,25 @@ private:
     // A boolean to determine if the error logger should print to the ostream.
     bool printing_enabled = true;
 
+    /**
+     * @brief A message held back by a buffering logger.
+     *
+     */
+    struct BufferedMessage {
+        // True for notes, false for errors.
+        bool is_note;
+        // False for errors logged without a location.
+        bool has_location;
+        Location location;
+        ErrorCode error_code;
+        std::string message;
+    };
+
+    // A boolean to determine if messages are held back instead of printed.
+    bool buffering = false;
+    // The messages held back while buffering, in the order they were logged.
+    std::vector<BufferedMessage> buffered_messages;
+
     /**
      * @brief Prints a pretty error message to the console.
      * The error message includes the location of the error and will display the line where the error occurred.
@@ -71,11 +91,11 @@ private:
      */
     void print_pretty_note(const Location& location, const std::string& display_text);
 
+public:
     ErrorLogger() = default;
     ErrorLogger(const ErrorLogger&) = delete;
     ErrorLogger& operator=(const ErrorLogger&) = delete;
 
-public:
     /**
      * @brief Logs an error message to the console.
      *
@@ -121,15 +141,32 @@ public:
     }
 
     /**
-     * @brief Get the instance object of the ErrorLogger singleton. Will create the instance if it does not exist.
+     * @brief Sets whether the error logger should hold back messages instead of printing them.
+     * Errors are still recorded while buffering. Buffered messages can be replayed into another logger.
+     * Useful for checking parts of a program in parallel while still reporting messages in source order.
      *
-     * @return ErrorLogger& A reference to the ErrorLogger singleton instance.
+     * @param enabled If true, messages will be buffered. If false, they will be printed as usual.
      */
-    static ErrorLogger& inst() {
-        static ErrorLogger instance;
-        return instance;
+    void set_buffering(bool enabled) {
+        buffering = enabled;
     }
 
+    /**
+     * @brief Logs the buffered messages of another logger into this logger, in the order they were logged.
+     * The other logger's buffer is cleared.
+     *
+     * @param other The logger whose buffered messages should be replayed.
+     */
+    void replay(ErrorLogger& other);
+
+    /**
+     * @brief Get the ErrorLogger of the compilation bound to the calling thread.
+     * See CompilationContext for how contexts are bound.
+     *
+     * @return ErrorLogger& A reference to the current ErrorLogger.
+     */
+    static ErrorLogger& inst();
+
     /**
      * @brief Get the errors object.
      *
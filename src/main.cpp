@@ -7,7 +7,7 @@
 
 int main(int argc, char** argv) {
     if (argc <= 1) {
-        std::cout << "Usage: niterc [-c] [-o output] [-dump-ir output] <source files>" << std::endl;
+        std::cout << "Usage: niterc [-c] [-o output] [-dump-ir output] [-j jobs] [-fstrict-aliasing] [-fbounds-check] <source files>" << std::endl;
         return 2;
     }
 
@@ -15,6 +15,9 @@ int main(int argc, char** argv) {
     bool target_set = false;
     bool ir_target_set = false;
     bool run_linker_set = false;
+    bool jobs_set = false;
+    bool strict_aliasing_set = false;
+    bool bounds_check_set = false;
 
     for (int i = 1; i < argc; i++) {
         auto str = std::make_shared<std::string>(argv[i]);
@@ -51,6 +54,37 @@ int main(int argc, char** argv) {
                     std::cerr << "Expected IR output file after -dump-ir" << std::endl;
                     return 2;
                 }
+            } else if (*str == "-j") {
+                if (jobs_set) {
+                    std::cerr << "Multiple -j flags specified" << std::endl;
+                    return 2;
+                } else if (i + 1 < argc) {
+                    i++;
+                    try {
+                        compiler.set_jobs(std::stoul(argv[i]));
+                    } catch (const std::exception&) {
+                        std::cerr << "Expected a number of jobs after -j" << std::endl;
+                        return 2;
+                    }
+                    jobs_set = true;
+                } else {
+                    std::cerr << "Expected a number of jobs after -j" << std::endl;
+                    return 2;
+                }
+            } else if (*str == "-fstrict-aliasing") {
+                if (strict_aliasing_set) {
+                    std::cerr << "Multiple -fstrict-aliasing flags specified" << std::endl;
+                    return 2;
+                }
+                compiler.set_strict_aliasing(true);
+                strict_aliasing_set = true;
+            } else if (*str == "-fbounds-check") {
+                if (bounds_check_set) {
+                    std::cerr << "Multiple -fbounds-check flags specified" << std::endl;
+                    return 2;
+                }
+                compiler.set_bounds_check(true);
+                bounds_check_set = true;
             } else {
                 std::cerr << "Unknown option: " << str << std::endl;
                 return 2;
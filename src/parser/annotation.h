@@ -2,6 +2,7 @@
 #define ANNOTATION_H
 
 #include "../scanner/token.h"
+#include "../utility/core.h"
 #include "../utility/utils.h"
 
 #include <memory>
@@ -17,7 +18,9 @@ enum class AnnotationType {
     FUNCTION,
     ARRAY,
     POINTER,
-    TUPLE
+    TUPLE,
+    SCOPED,
+    VECTOR
 };
 
 /**
@@ -31,6 +34,8 @@ public:
     class Array;
     class Pointer;
     class Tuple;
+    class Scoped;
+    class Vector;
 
     virtual ~Annotation() = default;
 
@@ -136,14 +141,14 @@ public:
 
 /**
  * @brief An array annotation.
- * E.g. `[t; 10]` or `[t; *]`
+ * E.g. `[t; 10]`, or `[t; *]` and `[t]` for slices
  *
  */
 class Annotation::Array : public Annotation {
 public:
     // The inner type of the array. E.g. "[int; 1]" has the inner type "int".
     std::shared_ptr<Annotation> inner;
-    // The size of the array. E.g. "[int; 1]" has the size 1. Unknown size is represented by -1.
+    // The size of the array. E.g. "[int; 1]" has the size 1. Unknown size is represented by -1; such an array is a slice, also written "[int]".
     int size = -1;
 
     Array(std::shared_ptr<Annotation> inner, int size)
@@ -196,4 +201,45 @@ public:
     }
 };
 
+/**
+ * @brief An annotation that is resolved from a fixed scope, rather than from the scope it appears in.
+ * The parser substitutes type arguments into generic instances this way,
+ * so that a type argument keeps the meaning it had where the generic was used.
+ *
+ */
+class Annotation::Scoped : public Annotation {
+public:
+    // The annotation to resolve.
+    std::shared_ptr<Annotation> inner;
+    // The scope to resolve the annotation from.
+    std::shared_ptr<Node::Scope> scope;
+
+    Scoped(std::shared_ptr<Annotation> inner, std::shared_ptr<Node::Scope> scope)
+        : inner(inner), scope(scope) {}
+
+    std::string to_string() const override {
+        return inner->to_string();
+    }
+};
+
+/**
+ * @brief A vector annotation.
+ * E.g. `vec<t, 4>`
+ *
+ */
+class Annotation::Vector : public Annotation {
+public:
+    // The element type of the vector. E.g. "vec<f64, 4>" has the element type "f64".
+    std::shared_ptr<Annotation> inner;
+    // The number of lanes of the vector. E.g. "vec<f64, 4>" has 4 lanes.
+    int size;
+
+    Vector(std::shared_ptr<Annotation> inner, int size)
+        : inner(inner), size(size) {}
+
+    std::string to_string() const override {
+        return "vec<" + inner->to_string() + ", " + std::to_string(size) + ">";
+    }
+};
+
 #endif // ANNOTATION_H
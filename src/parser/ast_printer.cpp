@@ -4,23 +4,36 @@
 #include <sstream>
 
 std::string AstPrinter::print(std::shared_ptr<Expr> expr) {
-    return std::any_cast<std::string>(expr->accept(this));
+    return expr->accept(this);
 }
 
 std::string AstPrinter::print(std::shared_ptr<Stmt> stmt) {
-    return std::any_cast<std::string>(stmt->accept(this));
+    return stmt->accept(this);
 }
 
 std::string AstPrinter::parenthesize(const std::string& name, const std::vector<std::shared_ptr<Expr>>& exprs) {
     std::string result = "(" + name;
     for (const auto& expr : exprs) {
         result += " ";
-        result += std::any_cast<std::string>(expr->accept(this));
+        result += expr->accept(this);
     }
     result += ")";
     return result;
 }
 
+std::string AstPrinter::type_params_to_string(const std::vector<Token>& type_params) {
+    if (type_params.empty()) {
+        return "";
+    }
+    std::string result = "<";
+    for (size_t i = 0; i < type_params.size(); i++) {
+        result += type_params[i].lexeme;
+        result += i < type_params.size() - 1 ? ", " : "";
+    }
+    result += ">";
+    return result;
+}
+
 std::string AstPrinter::double_to_string(double value, int precision) {
     std::stringstream ss;
     ss << std::fixed << std::setprecision(precision) << value;
@@ -49,25 +62,25 @@ std::string AstPrinter::any_to_string(const std::any& value) {
     return std::string("[object]");
 }
 
-std::any AstPrinter::visit_block_stmt(Stmt::Block* /*stmt*/) {
+std::string AstPrinter::visit_block_stmt(Stmt::Block* /*stmt*/) {
     // TODO: Implement this
-    return std::any();
+    return std::string();
 }
 
-std::any AstPrinter::visit_conditional_stmt(Stmt::Conditional* stmt) {
+std::string AstPrinter::visit_conditional_stmt(Stmt::Conditional* stmt) {
     std::string result = "(stmt:" + stmt->keyword.lexeme;
     result += " ";
-    result += std::any_cast<std::string>(stmt->condition->accept(this));
+    result += stmt->condition->accept(this);
     result += " { ";
     for (const auto& stmt : stmt->then_branch) {
-        result += std::any_cast<std::string>(stmt->accept(this));
+        result += stmt->accept(this);
         result += " ";
     }
     result += "}";
     if (!stmt->else_branch.empty()) {
         result += " else { ";
         for (const auto& stmt : stmt->else_branch) {
-            result += std::any_cast<std::string>(stmt->accept(this));
+            result += stmt->accept(this);
             result += " ";
         }
         result += "}";
@@ -76,50 +89,110 @@ std::any AstPrinter::visit_conditional_stmt(Stmt::Conditional* stmt) {
     return result;
 }
 
-std::any AstPrinter::visit_loop_stmt(Stmt::Loop* stmt) {
+std::string AstPrinter::print_hints(const LoopHints& hints) {
+    std::string result;
+    if (hints.vectorize) {
+        result += "@vectorize(" + std::to_string(hints.vectorize_width) + ") ";
+    }
+    if (hints.unroll) {
+        result += "@unroll(" + std::to_string(hints.unroll_count) + ") ";
+    }
+    if (hints.parallel) {
+        result += "@parallel ";
+    }
+    return result;
+}
+
+std::string AstPrinter::visit_loop_stmt(Stmt::Loop* stmt) {
+    std::string result = "(stmt:" + stmt->keyword.lexeme;
+    result += " ";
+    result += print_hints(stmt->hints);
+    result += stmt->condition->accept(this);
+    result += " { ";
+    for (const auto& stmt : stmt->body) {
+        result += stmt->accept(this);
+        result += " ";
+    }
+    result += "})";
+    return result;
+}
+
+std::string AstPrinter::visit_for_stmt(Stmt::For* stmt) {
     std::string result = "(stmt:" + stmt->keyword.lexeme;
     result += " ";
-    result += std::any_cast<std::string>(stmt->condition->accept(this));
+    result += print_hints(stmt->hints);
+    result += stmt->variable->name.lexeme + " in ";
+    result += stmt->start->accept(this);
+    if (stmt->end != nullptr) {
+        result += ".." + stmt->end->accept(this);
+    }
     result += " { ";
     for (const auto& stmt : stmt->body) {
-        result += std::any_cast<std::string>(stmt->accept(this));
+        result += stmt->accept(this);
         result += " ";
     }
     result += "})";
     return result;
 }
 
-std::any AstPrinter::visit_return_stmt(Stmt::Return* stmt) {
+std::string AstPrinter::visit_match_stmt(Stmt::Match* stmt) {
+    std::string result = "(stmt:" + stmt->keyword.lexeme;
+    result += " ";
+    result += stmt->value->accept(this);
+    result += " { ";
+    for (const auto& arm : stmt->arms) {
+        for (size_t i = 0; i < arm.pattern.size(); i++) {
+            result += (i > 0 ? "::" : "") + arm.pattern[i].lexeme;
+        }
+        if (arm.has_bindings) {
+            result += "(";
+            for (size_t i = 0; i < arm.bindings.size(); i++) {
+                result += (i > 0 ? ", " : "") + arm.bindings[i]->name.lexeme;
+            }
+            result += ")";
+        }
+        result += " => { ";
+        for (const auto& stmt : arm.body) {
+            result += stmt->accept(this);
+            result += " ";
+        }
+        result += "} ";
+    }
+    result += "})";
+    return result;
+}
+
+std::string AstPrinter::visit_return_stmt(Stmt::Return* stmt) {
     std::string result = "(stmt:return";
     if (stmt->value != nullptr) {
-        result += " " + std::any_cast<std::string>(stmt->value->accept(this));
+        result += " " + stmt->value->accept(this);
     }
     result += ")";
     return result;
 }
 
-std::any AstPrinter::visit_break_stmt(Stmt::Break* stmt) {
+std::string AstPrinter::visit_break_stmt(Stmt::Break* stmt) {
     return std::string("(stmt:break)");
 }
 
-std::any AstPrinter::visit_continue_stmt(Stmt::Continue* /*stmt*/) {
+std::string AstPrinter::visit_continue_stmt(Stmt::Continue* /*stmt*/) {
     // TODO: Implement this
-    return std::any();
+    return std::string();
 }
 
-std::any AstPrinter::visit_declaration_stmt(Stmt::Declaration* stmt) {
+std::string AstPrinter::visit_declaration_stmt(Stmt::Declaration* stmt) {
     return stmt->declaration->accept(this);
 }
 
-std::any AstPrinter::visit_eof_stmt(Stmt::EndOfFile* /*stmt*/) {
+std::string AstPrinter::visit_eof_stmt(Stmt::EndOfFile* /*stmt*/) {
     return std::string("(stmt:eof)");
 }
 
-std::any AstPrinter::visit_expression_stmt(Stmt::Expression* stmt) {
+std::string AstPrinter::visit_expression_stmt(Stmt::Expression* stmt) {
     return stmt->expression->accept(this);
 }
 
-std::any AstPrinter::visit_var_decl(Decl::Var* decl) {
+std::string AstPrinter::visit_var_decl(Decl::Var* decl) {
     std::string result = "(decl:";
     if (decl->declarer == KW_VAR) {
         result += "var";
@@ -134,25 +207,26 @@ std::any AstPrinter::visit_var_decl(Decl::Var* decl) {
         result += " " + decl->type_annotation->to_string();
     }
     if (decl->initializer != nullptr) {
-        result += " " + std::any_cast<std::string>(decl->initializer->accept(this));
+        result += " " + decl->initializer->accept(this);
     }
     result += ")";
     return result;
 }
 
-std::any AstPrinter::visit_fun_decl(Decl::Fun* decl) {
+std::string AstPrinter::visit_fun_decl(Decl::Fun* decl) {
     std::string result = "(decl:fun ";
     result += decl->name.lexeme;
+    result += type_params_to_string(decl->type_params);
     result += " ";
     result += decl->type_annotation->to_string();
     result += " ";
     for (const auto& param : decl->parameters) {
-        result += std::any_cast<std::string>(param->accept(this));
+        result += param->accept(this);
         result += " ";
     }
     result += "{ ";
     for (const auto& stmt : decl->body) {
-        result += std::any_cast<std::string>(stmt->accept(this));
+        result += stmt->accept(this);
         result += " ";
     }
     result += "})";
@@ -167,7 +241,7 @@ std::any AstPrinter::visit_fun_decl(Decl::Fun* decl) {
     */
 }
 
-std::any AstPrinter::visit_extern_fun_decl(Decl::ExternFun* decl) {
+std::string AstPrinter::visit_extern_fun_decl(Decl::ExternFun* decl) {
     std::string result = "(decl:extern_fun ";
     result += decl->name.lexeme;
     result += " ";
@@ -184,12 +258,13 @@ std::any AstPrinter::visit_extern_fun_decl(Decl::ExternFun* decl) {
     */
 }
 
-std::any AstPrinter::visit_struct_decl(Decl::Struct* decl) {
+std::string AstPrinter::visit_struct_decl(Decl::Struct* decl) {
     std::string result = "(decl:struct ";
     result += decl->name.lexeme;
+    result += type_params_to_string(decl->type_params);
     result += " { ";
     for (const auto& decl : decl->declarations) {
-        result += std::any_cast<std::string>(decl->accept(this));
+        result += decl->accept(this);
         result += " ";
     }
     result += "})";
@@ -205,40 +280,76 @@ std::any AstPrinter::visit_struct_decl(Decl::Struct* decl) {
     */
 }
 
-std::any AstPrinter::visit_assign_expr(Expr::Assign* expr) {
-    return parenthesize("=", {expr->left, expr->right});
+std::string AstPrinter::visit_enum_decl(Decl::Enum* decl) {
+    std::string result = "(decl:enum ";
+    result += decl->name.lexeme;
+    result += " { ";
+    for (const auto& variant : decl->variants) {
+        result += variant.name.lexeme;
+        if (!variant.payload_annotations.empty()) {
+            result += "(";
+            for (size_t i = 0; i < variant.payload_annotations.size(); i++) {
+                result += (i > 0 ? ", " : "") + variant.payload_annotations[i]->to_string();
+            }
+            result += ")";
+        }
+        result += " ";
+    }
+    result += "})";
+    return result;
+    /*
+    Example:
+    enum Shape {
+        Circle(f64)
+        Empty
+    }
+    ->
+    (decl:enum Shape { Circle(f64) Empty })
+    */
+}
+
+std::string AstPrinter::visit_assign_expr(Expr::Assign* expr) {
+    return parenthesize(expr->op.lexeme, {expr->left, expr->right});
 }
 
-std::any AstPrinter::visit_logical_expr(Expr::Logical* expr) {
+std::string AstPrinter::visit_logical_expr(Expr::Logical* expr) {
     return parenthesize(expr->op.lexeme, {expr->left, expr->right});
 }
 
-std::any AstPrinter::visit_binary_expr(Expr::Binary* expr) {
+std::string AstPrinter::visit_binary_expr(Expr::Binary* expr) {
     return parenthesize(expr->op.lexeme, {expr->left, expr->right});
 }
 
-std::any AstPrinter::visit_unary_expr(Expr::Unary* expr) {
+std::string AstPrinter::visit_unary_expr(Expr::Unary* expr) {
     return parenthesize(expr->op.lexeme, {expr->inner});
 }
 
-std::any AstPrinter::visit_dereference_expr(Expr::Dereference* expr) {
+std::string AstPrinter::visit_dereference_expr(Expr::Dereference* expr) {
     return parenthesize("*", {expr->inner});
 }
 
-std::any AstPrinter::visit_access_expr(Expr::Access* expr) {
+std::string AstPrinter::visit_access_expr(Expr::Access* expr) {
     std::string result = "(. ";
-    result += std::any_cast<std::string>(expr->left->accept(this));
+    result += expr->left->accept(this);
     result += " ";
     result += expr->ident.lexeme;
     result += ")";
     return result;
 }
 
-std::any AstPrinter::visit_index_expr(Expr::Index* expr) {
+std::string AstPrinter::visit_index_expr(Expr::Index* expr) {
     return parenthesize("[]", {expr->left, expr->right});
 }
 
-std::any AstPrinter::visit_call_expr(Expr::Call* expr) {
+std::string AstPrinter::visit_slice_expr(Expr::Slice* expr) {
+    std::string result = "([..] " + expr->left->accept(this);
+    // Missing bounds are printed as `_`
+    result += " " + (expr->start != nullptr ? expr->start->accept(this) : "_");
+    result += " " + (expr->end != nullptr ? expr->end->accept(this) : "_");
+    return result + ")";
+}
+
+std::string AstPrinter::visit_call_expr(Expr::Call* expr) {
     std::vector<std::shared_ptr<Expr>> args;
     args.push_back(expr->callee);
     for (const auto& arg : expr->arguments) {
@@ -247,28 +358,28 @@ std::any AstPrinter::visit_call_expr(Expr::Call* expr) {
     return parenthesize("call", args);
 }
 
-std::any AstPrinter::visit_cast_expr(Expr::Cast* expr) {
+std::string AstPrinter::visit_cast_expr(Expr::Cast* expr) {
     std::string result = "(as ";
-    result += std::any_cast<std::string>(expr->expression->accept(this));
+    result += expr->expression->accept(this);
     result += " ";
     result += expr->annotation->to_string();
     result += ")";
     return result;
 }
 
-std::any AstPrinter::visit_grouping_expr(Expr::Grouping* expr) {
+std::string AstPrinter::visit_grouping_expr(Expr::Grouping* expr) {
     return parenthesize("group", {expr->expression});
 }
 
-std::any AstPrinter::visit_identifier_expr(Expr::Identifier* expr) {
+std::string AstPrinter::visit_identifier_expr(Expr::Identifier* expr) {
     return expr->to_string();
 }
 
-// std::any AstPrinter::visit_type_ident_expr(Expr::TypeIdent* expr) {
+// std::string AstPrinter::visit_type_ident_expr(Expr::TypeIdent* expr) {
 //     return expr->to_string();
 // }
 
-std::any AstPrinter::visit_literal_expr(Expr::Literal* expr) {
+std::string AstPrinter::visit_literal_expr(Expr::Literal* expr) {
     if (expr->token.literal.has_value()) {
         return any_to_string(expr->token.literal);
     } else {
@@ -276,7 +387,7 @@ std::any AstPrinter::visit_literal_expr(Expr::Literal* expr) {
     }
 }
 
-std::any AstPrinter::visit_array_expr(Expr::Array* expr) {
+std::string AstPrinter::visit_array_expr(Expr::Array* expr) {
     std::vector<std::shared_ptr<Expr>> elements;
     for (const auto& element : expr->elements) {
         elements.push_back(element);
@@ -284,16 +395,16 @@ std::any AstPrinter::visit_array_expr(Expr::Array* expr) {
     return parenthesize("array", elements);
 }
 
-std::any AstPrinter::visit_array_gen_expr(Expr::ArrayGen* expr) {
+std::string AstPrinter::visit_array_gen_expr(Expr::ArrayGen* expr) {
     std::string result = "(array_gen ";
-    result += std::any_cast<std::string>(expr->generator->accept(this));
+    result += expr->generator->accept(this);
     result += " ";
     result += std::to_string(expr->size);
     result += ")";
     return result;
 }
 
-std::any AstPrinter::visit_tuple_expr(Expr::Tuple* expr) {
+std::string AstPrinter::visit_tuple_expr(Expr::Tuple* expr) {
     std::vector<std::shared_ptr<Expr>> elements;
     for (const auto& element : expr->elements) {
         elements.push_back(element);
@@ -301,7 +412,7 @@ std::any AstPrinter::visit_tuple_expr(Expr::Tuple* expr) {
     return parenthesize("tuple", elements);
 }
 
-std::any AstPrinter::visit_object_expr(Expr::Object* expr) {
+std::string AstPrinter::visit_object_expr(Expr::Object* expr) {
     std::string result = "(object ";
     result += expr->struct_annotation->to_string();
     result += " {";
@@ -309,7 +420,7 @@ std::any AstPrinter::visit_object_expr(Expr::Object* expr) {
     for (const auto& field : expr->fields) {
         result += field.first;
         result += ": ";
-        result += std::any_cast<std::string>(field.second->accept(this));
+        result += field.second->accept(this);
         if (i != expr->fields.size() - 1) {
             result += ", ";
         }
@@ -318,3 +429,15 @@ std::any AstPrinter::visit_object_expr(Expr::Object* expr) {
     result += "})";
     return result;
 }
+
+std::string AstPrinter::visit_alloc_expr(Expr::Alloc* expr) {
+    std::string result = "(alloc " + expr->annotation->to_string();
+    if (expr->count != nullptr) {
+        result += " " + expr->count->accept(this);
+    }
+    return result + ")";
+}
+
+std::string AstPrinter::visit_dealloc_expr(Expr::Dealloc* expr) {
+    return parenthesize("dealloc", {expr->expression});
+}
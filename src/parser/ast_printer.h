@@ -8,7 +8,7 @@
 #include <string>
 #include <vector>
 
-class AstPrinter : public Expr::Visitor, public Stmt::Visitor, public Decl::Visitor {
+class AstPrinter : public Expr::Visitor<std::string>, public Stmt::Visitor<std::string>, public Decl::Visitor<std::string> {
 public:
     /**
      * @brief Prints a string representation of an expression.
@@ -36,6 +36,24 @@ public:
      */
     std::string parenthesize(const std::string& name, const std::vector<std::shared_ptr<Expr>>& exprs);
 
+    /**
+     * @brief Creates a string representation of the type parameters of a generic declaration.
+     * E.g. "<T, U>", or "" if there are none.
+     *
+     * @param type_params The type parameters.
+     * @return std::string The string representation of the type parameters.
+     */
+    std::string type_params_to_string(const std::vector<Token>& type_params);
+
+    /**
+     * @brief Creates a string representation of the hints of a loop, each followed by a space.
+     * E.g. "@vectorize(4) @parallel "
+     *
+     * @param hints The loop hints to print.
+     * @return std::string The string representation of the hints; empty if there are none.
+     */
+    std::string print_hints(const LoopHints& hints);
+
     /**
      * @brief Converts a double value to a string with a specified precision using a stringstream object.
      *
@@ -61,73 +79,89 @@ public:
      * @brief Visits a block statement and returns a string representation of it.
      *
      * @param stmt The block statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_block_stmt(Stmt::Block* stmt) override;
+    std::string visit_block_stmt(Stmt::Block* stmt) override;
 
     /**
      * @brief Visits a conditional statement and returns a string representation of it.
      *
      * @param stmt The conditional statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_conditional_stmt(Stmt::Conditional* stmt) override;
+    std::string visit_conditional_stmt(Stmt::Conditional* stmt) override;
 
     /**
      * @brief Visits a loop statement and returns a string representation of it.
      *
      * @param stmt The loop statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
+     */
+    std::string visit_loop_stmt(Stmt::Loop* stmt) override;
+
+    /**
+     * @brief Visits a for statement and returns a string representation of it.
+     *
+     * @param stmt The for statement to visit.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_loop_stmt(Stmt::Loop* stmt) override;
+    std::string visit_for_stmt(Stmt::For* stmt) override;
+
+    /**
+     * @brief Visits a match statement and returns a string representation of it.
+     *
+     * @param stmt The match statement to visit.
+     * @return std::string The string representation of the statement.
+     */
+    std::string visit_match_stmt(Stmt::Match* stmt) override;
 
     /**
      * @brief Visits a return statement and returns a string representation of it.
      *
      * @param stmt The return statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_return_stmt(Stmt::Return* stmt) override;
+    std::string visit_return_stmt(Stmt::Return* stmt) override;
 
     /**
      * @brief Visits a break statement and returns a string representation of it.
      *
      * @param stmt The break statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_break_stmt(Stmt::Break* stmt) override;
+    std::string visit_break_stmt(Stmt::Break* stmt) override;
 
     /**
      * @brief Visits a continue statement and returns a string representation of it.
      *
      * @param stmt The continue statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_continue_stmt(Stmt::Continue* stmt) override;
+    std::string visit_continue_stmt(Stmt::Continue* stmt) override;
 
     /**
      * @brief Visits a declaration statement and returns a string representation of it.
      *
      * @param stmt The declaration statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_declaration_stmt(Stmt::Declaration* stmt) override;
+    std::string visit_declaration_stmt(Stmt::Declaration* stmt) override;
 
     /**
      * @brief Visits an end of file statement and returns a string representation of it.
      *
      * @param stmt The end of file statement to visit.
-     * @return std::any An any object containing the string representation of the statement.
+     * @return std::string The string representation of the statement.
      */
-    std::any visit_eof_stmt(Stmt::EndOfFile* stmt) override;
+    std::string visit_eof_stmt(Stmt::EndOfFile* stmt) override;
 
     /**
      * @brief Visits a get expression and returns a string representation of it.
      *
      * @param expr The get expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_expression_stmt(Stmt::Expression* stmt) override;
+    std::string visit_expression_stmt(Stmt::Expression* stmt) override;
 
     // MARK: Declarations
 
@@ -135,33 +169,41 @@ public:
      * @brief Visits a variable declaration and returns a string representation of it.
      *
      * @param decl The variable declaration to visit.
-     * @return std::any An any object containing the string representation of the declaration.
+     * @return std::string The string representation of the declaration.
      */
-    std::any visit_var_decl(Decl::Var* decl) override;
+    std::string visit_var_decl(Decl::Var* decl) override;
 
     /**
      * @brief Visits a function declaration and returns a string representation of it.
      *
      * @param decl The function declaration to visit.
-     * @return std::any An any object containing the string representation of the declaration.
+     * @return std::string The string representation of the declaration.
      */
-    std::any visit_fun_decl(Decl::Fun* decl) override;
+    std::string visit_fun_decl(Decl::Fun* decl) override;
 
     /**
      * @brief Visits an external function declaration and returns a string representation of it.
      *
      * @param decl The external function declaration to visit.
-     * @return std::any An any object containing the string representation of the declaration.
+     * @return std::string The string representation of the declaration.
      */
-    std::any visit_extern_fun_decl(Decl::ExternFun* decl) override;
+    std::string visit_extern_fun_decl(Decl::ExternFun* decl) override;
 
     /**
      * @brief Visits a struct declaration and returns a string representation of it.
      *
      * @param decl The struct declaration to visit.
-     * @return std::any An any object containing the string representation of the declaration.
+     * @return std::string The string representation of the declaration.
+     */
+    std::string visit_struct_decl(Decl::Struct* decl) override;
+
+    /**
+     * @brief Visits an enum declaration and returns a string representation of it.
+     *
+     * @param decl The enum declaration to visit.
+     * @return std::string The string representation of the declaration.
      */
-    std::any visit_struct_decl(Decl::Struct* decl) override;
+    std::string visit_enum_decl(Decl::Enum* decl) override;
 
     // MARK: Expressions
 
@@ -169,129 +211,154 @@ public:
      * @brief Visits an assign expression and returns a string representation of it.
      *
      * @param expr The assign expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_assign_expr(Expr::Assign* expr) override;
+    std::string visit_assign_expr(Expr::Assign* expr) override;
 
     /**
      * @brief Visits a logical expression and returns a string representation of it.
      *
      * @param expr The logical expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_logical_expr(Expr::Logical* expr) override;
+    std::string visit_logical_expr(Expr::Logical* expr) override;
 
     /**
      * @brief Visits a binary expression and returns a string representation of it.
      *
      * @param expr The binary expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_binary_expr(Expr::Binary* expr) override;
+    std::string visit_binary_expr(Expr::Binary* expr) override;
 
     /**
      * @brief Visits a unary expression and returns a string representation of it.
      *
      * @param expr The unary expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_unary_expr(Expr::Unary* expr) override;
+    std::string visit_unary_expr(Expr::Unary* expr) override;
 
     /**
      * @brief Visits a dereference expression and returns a string representation of it.
      *
      * @param expr The dereference expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_dereference_expr(Expr::Dereference* expr) override;
+    std::string visit_dereference_expr(Expr::Dereference* expr) override;
 
     /**
      * @brief Visits an access expression and returns a string representation of it.
      *
      * @param expr The access expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_access_expr(Expr::Access* expr) override;
+    std::string visit_access_expr(Expr::Access* expr) override;
 
     /**
      * @brief Visits an index expression and returns a string representation of it.
      *
      * @param expr The index expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
+     */
+    std::string visit_index_expr(Expr::Index* expr) override;
+
+    /**
+     * @brief Visits a slice expression and returns a string representation of it.
+     * Missing bounds are printed as `_`.
+     *
+     * @param expr The slice expression to visit.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_index_expr(Expr::Index* expr) override;
+    std::string visit_slice_expr(Expr::Slice* expr) override;
 
     /**
      * @brief Visits a call expression and returns a string representation of it.
      *
      * @param expr The call expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_call_expr(Expr::Call* expr) override;
+    std::string visit_call_expr(Expr::Call* expr) override;
 
     /**
      * @brief Visits a cast expression and returns a string representation of it.
      *
      * @param expr The cast expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_cast_expr(Expr::Cast* expr) override;
+    std::string visit_cast_expr(Expr::Cast* expr) override;
 
     /**
      * @brief Visits a grouping expression and returns a string representation of it.
      *
      * @param expr The grouping expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_grouping_expr(Expr::Grouping* expr) override;
+    std::string visit_grouping_expr(Expr::Grouping* expr) override;
 
     /**
      * @brief Visits a variable expression and returns a string representation of it.
      *
      * @param expr The variable expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_identifier_expr(Expr::Identifier* expr) override;
+    std::string visit_identifier_expr(Expr::Identifier* expr) override;
 
     /**
      * @brief Visits a literal expression and returns a string representation of it.
      *
      * @param expr The literal expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_literal_expr(Expr::Literal* expr) override;
+    std::string visit_literal_expr(Expr::Literal* expr) override;
 
     /**
      * @brief Visits an array expression and returns a string representation of it.
      *
      * @param expr The array expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_array_expr(Expr::Array* expr) override;
+    std::string visit_array_expr(Expr::Array* expr) override;
 
     /**
      * @brief Visit an array generator expression and return a string representation of it.
      *
      * @param expr The array generator expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_array_gen_expr(Expr::ArrayGen* expr) override;
+    std::string visit_array_gen_expr(Expr::ArrayGen* expr) override;
 
     /**
      * @brief Visits a tuple expression and returns a string representation of it.
      *
      * @param expr The tuple expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_tuple_expr(Expr::Tuple* expr) override;
+    std::string visit_tuple_expr(Expr::Tuple* expr) override;
 
     /**
      * @brief Visits an object expression and returns a string representation of it.
      *
      * @param expr The object expression to visit.
-     * @return std::any An any object containing the string representation of the expression.
+     * @return std::string The string representation of the expression.
+     */
+    std::string visit_object_expr(Expr::Object* expr) override;
+
+    /**
+     * @brief Visits an alloc expression and returns a string representation of it.
+     *
+     * @param expr The alloc expression to visit.
+     * @return std::string The string representation of the expression.
+     */
+    std::string visit_alloc_expr(Expr::Alloc* expr) override;
+
+    /**
+     * @brief Visits a dealloc expression and returns a string representation of it.
+     *
+     * @param expr The dealloc expression to visit.
+     * @return std::string The string representation of the expression.
      */
-    std::any visit_object_expr(Expr::Object* expr) override;
+    std::string visit_dealloc_expr(Expr::Dealloc* expr) override;
 };
 
 #endif // AST_PRINTER_H
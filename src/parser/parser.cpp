@@ -71,12 +71,14 @@ void Parser::synchronize() {
 
         switch (peek().tok_type) {
         case KW_STRUCT:
+        case KW_ENUM:
         case KW_FUN:
         case KW_VAR:
         case KW_FOR:
         case KW_IF:
         case KW_WHILE:
         case KW_LOOP:
+        case KW_MATCH:
         case KW_RETURN:
             return;
         default:
@@ -91,7 +93,7 @@ void Parser::synchronize() {
 
 std::shared_ptr<Stmt> Parser::statement() {
     try {
-        if (check({KW_VAR, KW_CONST, KW_FUN, KW_EXTERN, KW_STRUCT})) {
+        if (check({KW_VAR, KW_CONST, KW_FUN, KW_EXTERN, KW_STRUCT, KW_ENUM})) {
             return declaration_statement();
         }
         if (match({KW_IF})) {
@@ -104,6 +106,15 @@ std::shared_ptr<Stmt> Parser::statement() {
         if (match({KW_WHILE})) {
             return while_statement();
         }
+        if (match({KW_FOR})) {
+            return for_statement();
+        }
+        if (match({TOK_AT})) {
+            return hinted_loop_statement();
+        }
+        if (match({KW_MATCH})) {
+            return match_statement();
+        }
         if (match({KW_BREAK})) {
             return std::make_shared<Stmt::Break>(previous());
         }
@@ -146,6 +157,8 @@ std::shared_ptr<Stmt> Parser::declaration_statement() {
         }
     } else if (match({KW_STRUCT})) {
         decl = struct_decl();
+    } else if (match({KW_ENUM})) {
+        decl = enum_decl();
     } else {
         ErrorLogger::inst().log_error(peek().location, E_NOT_A_DECLARATION, "Expected a declaration.");
         throw ParserException();
@@ -227,6 +240,145 @@ std::shared_ptr<Stmt> Parser::while_statement() {
     return std::make_shared<Stmt::Loop>(keyword, condition, body);
 }
 
+std::shared_ptr<Stmt> Parser::for_statement() {
+    Token& keyword = previous();
+    Token name = consume(TOK_IDENT, E_NO_IDENT_IN_FOR, "Expected loop variable after 'for'.");
+    consume(KW_IN, E_NO_IN_IN_FOR, "Expected 'in' after loop variable.");
+    std::shared_ptr<Expr> start = expression();
+    std::shared_ptr<Expr> end = nullptr;
+    if (match({TOK_DOT_DOT})) {
+        end = expression();
+    }
+    std::vector<std::shared_ptr<Stmt>> body;
+
+    if (match({TOK_LEFT_BRACE})) {
+        // Parse multiple statements
+        while (match({TOK_NEWLINE}))
+            ; // Skip over newlines
+        while (!check({TOK_RIGHT_BRACE}) && !is_at_end()) {
+            body.push_back(statement());
+            while (match({TOK_NEWLINE}))
+                ; // Skip over newlines
+        }
+        consume(TOK_RIGHT_BRACE, E_UNMATCHED_BRACE_IN_FOR_STMT, "Expected '}' after for body.");
+
+    } else {
+        while (match({TOK_NEWLINE}))
+            ; // Skip over newlines
+        // Parse a single statement
+        body.push_back(statement());
+    }
+
+    // The loop variable is a constant; its type is inferred by the local checker.
+    auto variable = std::make_shared<Decl::Var>(KW_CONST, name, std::make_shared<Annotation::Segmented>("auto"), nullptr);
+    return std::make_shared<Stmt::For>(keyword, variable, start, end, body);
+}
+
+std::shared_ptr<Stmt> Parser::match_statement() {
+    Token& keyword = previous();
+    std::shared_ptr<Expr> value = expression();
+    std::vector<Stmt::Match::Arm> arms;
+
+    consume(TOK_LEFT_BRACE, E_NO_LBRACE_IN_MATCH, "Expected '{' after match value.");
+    while (match({TOK_NEWLINE}))
+        ; // Skip over newlines
+    while (!check({TOK_RIGHT_BRACE}) && !is_at_end()) {
+        Stmt::Match::Arm arm;
+        // The pattern is a variant, optionally with the path of its enum, or `_`
+        do {
+            arm.pattern.push_back(consume(TOK_IDENT, E_INVALID_MATCH_PATTERN, "Expected variant name or '_' in match arm."));
+        } while (match({TOK_COLON_COLON}));
+        bool is_wildcard = arm.pattern.size() == 1 && arm.pattern[0].lexeme == "_";
+
+        if (check({TOK_LEFT_PAREN})) {
+            if (is_wildcard) {
+                ErrorLogger::inst().log_error(peek().location, E_INVALID_MATCH_PATTERN, "A '_' arm has no payload to bind.");
+                throw ParserException();
+            }
+            grouping_tokens.push(TOK_RIGHT_PAREN);
+            advance();
+            arm.has_bindings = true;
+            if (!check({TOK_RIGHT_PAREN})) {
+                do {
+                    Token name = consume(TOK_IDENT, E_NOT_AN_IDENTIFIER, "Expected binding name in match arm.");
+                    // The bindings are constants; their types are those of the payload fields.
+                    arm.bindings.push_back(std::make_shared<Decl::Var>(KW_CONST, name, std::make_shared<Annotation::Segmented>("auto"), nullptr));
+                } while (match({TOK_COMMA}) && !check({TOK_RIGHT_PAREN}));
+            }
+            consume(TOK_RIGHT_PAREN, E_UNMATCHED_PAREN_IN_ARGS, "Expected ')' after match bindings.");
+        }
+        consume(TOK_DOUBLE_ARROW, E_NO_ARROW_IN_MATCH_ARM, "Expected '=>' after match pattern.");
+
+        if (match({TOK_LEFT_BRACE})) {
+            // Parse multiple statements
+            while (match({TOK_NEWLINE}))
+                ; // Skip over newlines
+            while (!check({TOK_RIGHT_BRACE}) && !is_at_end()) {
+                arm.body.push_back(statement());
+                while (match({TOK_NEWLINE}))
+                    ; // Skip over newlines
+            }
+            consume(TOK_RIGHT_BRACE, E_UNMATCHED_BRACE_IN_MATCH_STMT, "Expected '}' after match arm body.");
+        } else {
+            while (match({TOK_NEWLINE}))
+                ; // Skip over newlines
+            // Parse a single statement
+            arm.body.push_back(statement());
+        }
+        arms.push_back(arm);
+
+        while (match({TOK_NEWLINE, TOK_COMMA}))
+            ; // Skip over newlines or commas
+    }
+    consume(TOK_RIGHT_BRACE, E_UNMATCHED_BRACE_IN_MATCH_STMT, "Expected '}' after match arms.");
+
+    return std::make_shared<Stmt::Match>(keyword, value, arms);
+}
+
+std::shared_ptr<Stmt> Parser::hinted_loop_statement() {
+    LoopHints hints;
+    do {
+        Token name = consume(TOK_IDENT, E_INVALID_LOOP_HINT, "Expected hint name after '@'.");
+        // The argument is optional for every hint
+        int argument = -1;
+        if (match({TOK_LEFT_PAREN})) {
+            grouping_tokens.push(TOK_RIGHT_PAREN);
+            consume(TOK_INT, E_INVALID_LOOP_HINT, "Expected integer literal as loop hint argument.");
+            argument = std::any_cast<int>(previous().literal);
+            consume(TOK_RIGHT_PAREN, E_INVALID_LOOP_HINT, "Expected ')' after loop hint argument.");
+        }
+
+        if (name.lexeme == "vectorize" && argument != 0) {
+            hints.vectorize = true;
+            hints.vectorize_width = argument > 0 ? argument : 0;
+        } else if (name.lexeme == "unroll" && argument != 0) {
+            hints.unroll = true;
+            hints.unroll_count = argument > 0 ? argument : 0;
+        } else if (name.lexeme == "parallel" && argument == -1) {
+            hints.parallel = true;
+        } else {
+            ErrorLogger::inst().log_error(name.location, E_INVALID_LOOP_HINT, "Unknown loop hint or invalid argument.");
+            throw ParserException();
+        }
+
+        while (match({TOK_NEWLINE}))
+            ; // Skip over newlines
+    } while (match({TOK_AT}));
+
+    if (match({KW_WHILE})) {
+        auto loop = std::static_pointer_cast<Stmt::Loop>(while_statement());
+        loop->hints = hints;
+        return loop;
+    }
+    if (match({KW_FOR})) {
+        auto loop = std::static_pointer_cast<Stmt::For>(for_statement());
+        loop->hints = hints;
+        return loop;
+    }
+    ErrorLogger::inst().log_error(peek().location, E_LOOP_HINT_WITHOUT_LOOP, "Expected a loop after loop hints.");
+    throw ParserException();
+}
+
 std::shared_ptr<Stmt> Parser::expression_statement() {
     std::shared_ptr<Expr> expr = expression();
     if (!check({TOK_EOF}) && !match({TOK_NEWLINE, TOK_SEMICOLON})) {
@@ -275,8 +427,11 @@ std::shared_ptr<Decl> Parser::var_decl() {
 std::shared_ptr<Decl> Parser::fun_decl() {
     // First, grab the declarer
     TokenType declarer = previous().tok_type;
+    unsigned start = current - 1;
     // Next, grab the identifier
     Token name = consume(TOK_IDENT, E_UNNAMED_FUN, "Expected identifier in function declaration.");
+    // A generic function has type parameters after its name
+    std::vector<Token> type_params = type_parameters();
 
     // Start building the type annotation
     auto type_annotation = std::make_shared<Annotation::Function>(
@@ -337,7 +492,13 @@ std::shared_ptr<Decl> Parser::fun_decl() {
             ; // Skip over newlines
     }
     consume(TOK_RIGHT_BRACE, E_UNMATCHED_BRACE_IN_FUN_DECL, "Expected '}' after function body.");
-    return std::make_shared<Decl::Fun>(declarer, name, parameters, return_var, type_annotation, body);
+    auto fun = std::make_shared<Decl::Fun>(declarer, name, parameters, return_var, type_annotation, body);
+    // A generic function is parsed again for each instance
+    if (!type_params.empty()) {
+        fun->type_params = std::move(type_params);
+        fun->tokens.assign(tokens.begin() + start, tokens.begin() + current);
+    }
+    return fun;
 }
 
 std::shared_ptr<Decl> Parser::extern_fun_decl(bool is_variadic) {
@@ -387,8 +548,11 @@ std::shared_ptr<Decl> Parser::extern_fun_decl(bool is_variadic) {
 std::shared_ptr<Decl> Parser::struct_decl() {
     // Should be KW_STRUCT
     TokenType declarer = previous().tok_type;
+    unsigned start = current - 1;
     // Get the struct name
     Token name = consume(TOK_IDENT, E_UNNAMED_STRUCT, "Expected identifier in struct declaration.");
+    // A generic struct has type parameters after its name
+    std::vector<Token> type_params = type_parameters();
 
     std::vector<std::shared_ptr<Decl>> declarations;
 
@@ -414,7 +578,65 @@ std::shared_ptr<Decl> Parser::struct_decl() {
     }
     consume(TOK_RIGHT_BRACE, E_UNMATCHED_BRACE_IN_STRUCT_DECL, "Expected '}' after struct body.");
 
-    return std::make_shared<Decl::Struct>(declarer, name, declarations);
+    auto struct_ = std::make_shared<Decl::Struct>(declarer, name, declarations);
+    // A generic struct is parsed again for each instance
+    if (!type_params.empty()) {
+        struct_->type_params = std::move(type_params);
+        struct_->tokens.assign(tokens.begin() + start, tokens.begin() + current);
+    }
+    return struct_;
+}
+
+std::shared_ptr<Decl> Parser::enum_decl() {
+    // Should be KW_ENUM
+    TokenType declarer = previous().tok_type;
+    // Get the enum name
+    Token name = consume(TOK_IDENT, E_NO_IDENT_IN_ENUM, "Expected identifier in enum declaration.");
+
+    std::vector<Decl::Enum::Variant> variants;
+
+    consume(TOK_LEFT_BRACE, E_NO_LBRACE_IN_ENUM, "Expected '{' before enum body.");
+    while (match({TOK_NEWLINE}))
+        ; // Skip over newlines
+    while (!check({TOK_RIGHT_BRACE}) && !is_at_end()) {
+        Token variant_name = consume(TOK_IDENT, E_NOT_AN_IDENTIFIER, "Expected variant name in enum declaration.");
+        // A variant with a payload lists the types of its fields
+        std::vector<std::shared_ptr<Annotation>> payload_annotations;
+        if (check({TOK_LEFT_PAREN})) {
+            grouping_tokens.push(TOK_RIGHT_PAREN);
+            advance();
+            do {
+                payload_annotations.push_back(annotation());
+            } while (match({TOK_COMMA}) && !check({TOK_RIGHT_PAREN}));
+            consume(TOK_RIGHT_PAREN, E_UNMATCHED_PAREN_IN_ARGS, "Expected ')' after variant payload.");
+        }
+        variants.push_back({variant_name, payload_annotations, {}});
+
+        // Variants are separated by commas or newlines
+        if (!match({TOK_COMMA, TOK_NEWLINE}) && !check({TOK_RIGHT_BRACE})) {
+            ErrorLogger::inst().log_error(peek().location, E_UNMATCHED_BRACE_IN_ENUM, "Expected ',', newline or '}' after enum variant.");
+            throw ParserException();
+        }
+        while (match({TOK_NEWLINE}))
+            ; // Skip over newlines
+    }
+    consume(TOK_RIGHT_BRACE, E_UNMATCHED_BRACE_IN_ENUM, "Expected '}' after enum body.");
+
+    return std::make_shared<Decl::Enum>(declarer, name, variants);
+}
+
+std::vector<Token> Parser::type_parameters() {
+    std::vector<Token> type_params;
+    if (!check({TOK_LT})) {
+        return type_params;
+    }
+    grouping_tokens.push(TOK_GT);
+    advance();
+    do {
+        type_params.push_back(consume(TOK_IDENT, E_MISSING_IDENT_IN_TYPE_PARAMS, "Expected identifier in type parameters."));
+    } while (match({TOK_COMMA}) && !check({TOK_GT}));
+    consume(TOK_GT, E_UNMATCHED_ANGLE_IN_TYPE_PARAMS, "Expected '>' after type parameters.");
+    return type_params;
 }
 
 // MARK: Expressions
@@ -429,7 +651,7 @@ std::shared_ptr<Expr> Parser::assign_expr() {
     // Note: This isn't an interpreter. We can save l-value checking for
     // the type checker.
     // 5 = 10 is syntactically valid, but semantically invalid.
-    if (match({TOK_EQ})) {
+    if (match({TOK_EQ, TOK_AMP_AMP_EQ, TOK_BAR_BAR_EQ})) {
         Token op = previous();
         std::shared_ptr<Expr> right = or_expr();
         expr = std::make_shared<Expr::Assign>(expr, op, right);
@@ -441,7 +663,7 @@ std::shared_ptr<Expr> Parser::assign_expr() {
 std::shared_ptr<Expr> Parser::or_expr() {
     std::shared_ptr<Expr> expr = and_expr();
 
-    while (match({KW_OR})) {
+    while (match({KW_OR, TOK_BAR_BAR})) {
         Token op = previous();
         std::shared_ptr<Expr> right = and_expr();
         expr = std::make_shared<Expr::Logical>(expr, op, right);
@@ -452,7 +674,7 @@ std::shared_ptr<Expr> Parser::or_expr() {
 std::shared_ptr<Expr> Parser::and_expr() {
     std::shared_ptr<Expr> expr = equality_expr();
 
-    while (match({KW_AND})) {
+    while (match({KW_AND, TOK_AMP_AMP})) {
         Token op = previous();
         std::shared_ptr<Expr> right = equality_expr();
         expr = std::make_shared<Expr::Logical>(expr, op, right);
@@ -472,16 +694,74 @@ std::shared_ptr<Expr> Parser::equality_expr() {
 }
 
 std::shared_ptr<Expr> Parser::comparison_expr() {
-    std::shared_ptr<Expr> expr = term_expr();
+    std::shared_ptr<Expr> expr = bit_or_expr();
 
     while (match({TOK_LT, TOK_LE, TOK_GT, TOK_GE})) {
         Token op = previous();
+        std::shared_ptr<Expr> right = bit_or_expr();
+        expr = std::make_shared<Expr::Binary>(expr, op, right);
+    }
+    return expr;
+}
+
+std::shared_ptr<Expr> Parser::bit_or_expr() {
+    std::shared_ptr<Expr> expr = bit_xor_expr();
+
+    while (match({TOK_BAR})) {
+        Token op = previous();
+        std::shared_ptr<Expr> right = bit_xor_expr();
+        expr = std::make_shared<Expr::Binary>(expr, op, right);
+    }
+    return expr;
+}
+
+std::shared_ptr<Expr> Parser::bit_xor_expr() {
+    std::shared_ptr<Expr> expr = bit_and_expr();
+
+    while (match({TOK_TILDE})) {
+        Token op = previous();
+        std::shared_ptr<Expr> right = bit_and_expr();
+        expr = std::make_shared<Expr::Binary>(expr, op, right);
+    }
+    return expr;
+}
+
+std::shared_ptr<Expr> Parser::bit_and_expr() {
+    std::shared_ptr<Expr> expr = shift_expr();
+
+    while (match({TOK_AMP})) {
+        Token op = previous();
+        std::shared_ptr<Expr> right = shift_expr();
+        expr = std::make_shared<Expr::Binary>(expr, op, right);
+    }
+    return expr;
+}
+
+std::shared_ptr<Expr> Parser::shift_expr() {
+    std::shared_ptr<Expr> expr = term_expr();
+
+    while (check_shift()) {
+        Token first = advance();
+        advance();
+        Location location = first.location;
+        location.length = 2;
+        bool is_left = first.tok_type == TOK_LT;
+        Token op(is_left ? TOK_LT_LT : TOK_GT_GT, is_left ? "<<" : ">>", std::any(), location);
         std::shared_ptr<Expr> right = term_expr();
         expr = std::make_shared<Expr::Binary>(expr, op, right);
     }
     return expr;
 }
 
+bool Parser::check_shift() {
+    if (!check({TOK_LT, TOK_GT}) || current + 1 >= tokens.size()) {
+        return false;
+    }
+    const Location& first = peek().location;
+    const Location& second = tokens[current + 1]->location;
+    return tokens[current + 1]->tok_type == peek().tok_type && second.line == first.line && second.column == first.column + 1;
+}
+
 std::shared_ptr<Expr> Parser::term_expr() {
     std::shared_ptr<Expr> expr = factor_expr();
 
@@ -516,7 +796,7 @@ std::shared_ptr<Expr> Parser::power_expr() {
 }
 
 std::shared_ptr<Expr> Parser::unary_expr() {
-    if (match({TOK_BANG, TOK_MINUS, TOK_AMP})) {
+    if (match({TOK_BANG, TOK_MINUS, TOK_AMP, TOK_TILDE})) {
         Token op = previous();
         std::shared_ptr<Expr> right = unary_expr();
         return std::make_shared<Expr::Unary>(op, right);
@@ -526,6 +806,24 @@ std::shared_ptr<Expr> Parser::unary_expr() {
         std::shared_ptr<Expr> right = unary_expr();
         return std::make_shared<Expr::Dereference>(op, right);
     }
+    if (match({KW_ALLOC})) {
+        Token keyword = previous();
+        // `alloc [t; n]` allocates `n` elements; the count may be any expression, so this is not an array annotation
+        if (match({TOK_LEFT_SQUARE})) {
+            grouping_tokens.push(TOK_RIGHT_SQUARE);
+            std::shared_ptr<Annotation> inner = annotation();
+            consume(TOK_SEMICOLON, E_NO_SEMICOLON_IN_ARRAY_TYPE, "Expected ';' after the element type of an allocation.");
+            std::shared_ptr<Expr> count = expression();
+            consume(TOK_RIGHT_SQUARE, E_UNMATCHED_LEFT_SQUARE, "Expected ']' after the number of elements.");
+            return std::make_shared<Expr::Alloc>(keyword, inner, count);
+        }
+        return std::make_shared<Expr::Alloc>(keyword, annotation(), nullptr);
+    }
+    if (match({KW_DEALLOC})) {
+        Token keyword = previous();
+        std::shared_ptr<Expr> right = unary_expr();
+        return std::make_shared<Expr::Dealloc>(keyword, right);
+    }
     return call_expr();
 }
 
@@ -604,7 +902,21 @@ std::shared_ptr<Expr> Parser::access_index_expr() {
             grouping_tokens.push(TOK_RIGHT_SQUARE);
             while (match({TOK_NEWLINE}))
                 ; // Skip over newlines
-            std::shared_ptr<Expr> right = expression();
+            // A slice has a `..` between its bounds, either of which may be left out
+            std::shared_ptr<Expr> start = nullptr;
+            if (!check({TOK_DOT_DOT})) {
+                start = expression();
+            }
+            if (match({TOK_DOT_DOT})) {
+                std::shared_ptr<Expr> end = nullptr;
+                if (!check({TOK_RIGHT_SQUARE})) {
+                    end = expression();
+                }
+                consume(TOK_RIGHT_SQUARE, E_UNMATCHED_LEFT_SQUARE, "Expected ']' after slice.");
+                expr = std::make_shared<Expr::Slice>(expr, op, start, end);
+                continue;
+            }
+            std::shared_ptr<Expr> right = start;
             consume(TOK_RIGHT_SQUARE, E_UNMATCHED_LEFT_SQUARE, "Expected ']' after expression.");
 
             // If expr is an LValue, then we can use the LIndex expression
@@ -656,10 +968,23 @@ std::shared_ptr<Expr> Parser::primary_expr() {
     }
     if (match({TOK_IDENT})) {
         std::shared_ptr<Expr::Identifier> expr = std::make_shared<Expr::Identifier>(previous());
+        std::vector<std::vector<std::shared_ptr<Annotation>>> type_args(1);
 
         while (match({TOK_COLON_COLON})) {
+            // A generic is given its type arguments after a `::`, e.g. `max::<i32>`, since `max<i32>` would be a comparison
+            if (check({TOK_LT}) && type_args.back().empty()) {
+                type_args.back() = type_arguments();
+                continue;
+            }
             Token name = consume(TOK_IDENT, E_NOT_AN_IDENTIFIER, "Expected identifier after '::'.");
             expr->tokens.push_back(name);
+            type_args.emplace_back();
+        }
+        for (auto& token_args : type_args) {
+            if (!token_args.empty()) {
+                expr->type_args = type_args;
+                break;
+            }
         }
         return expr;
     }
@@ -789,31 +1114,27 @@ std::shared_ptr<Annotation> Parser::annotation() {
 
 std::shared_ptr<Annotation> Parser::segmented_annotation() {
 
-    std::shared_ptr<Annotation> type_annotation = std::make_shared<Annotation::Segmented>(std::vector<std::shared_ptr<Annotation::Segmented::Class>>());
+    std::shared_ptr<Annotation> type_annotation = nullptr;
 
-    auto seg_type_annotation = std::dynamic_pointer_cast<Annotation::Segmented>(type_annotation);
+    auto seg_type_annotation = std::make_shared<Annotation::Segmented>(std::vector<std::shared_ptr<Annotation::Segmented::Class>>());
 
     do {
         Token name = consume(TOK_IDENT, E_MISSING_IDENT_IN_TYPE, "Expected identifier in type annotation.");
+        // `vec<t, n>` is a vector type rather than a class; its second argument is a number of lanes.
+        if (name.lexeme == "vec" && seg_type_annotation->classes.empty() && check({TOK_LT})) {
+            type_annotation = vector_annotation();
+            break;
+        }
         auto temp = std::make_shared<Annotation::Segmented::Class>(name.lexeme, std::vector<std::shared_ptr<Annotation>>());
         if (check({TOK_LT})) {
-            grouping_tokens.push(TOK_GT);
-            advance();
-            if (!check({TOK_GT})) {
-                temp->type_args.push_back(annotation());
-                while (match({TOK_COMMA})) {
-                    if (check({TOK_GT})) {
-                        break;
-                    }
-                    temp->type_args.push_back(annotation());
-                }
-            }
-            consume(TOK_GT, E_UNMATCHED_ANGLE_IN_TYPE, "Expected '>' after type arguments.");
+            temp->type_args = type_arguments();
         }
         seg_type_annotation->classes.push_back(temp);
     } while (match({TOK_COLON_COLON}));
 
-    resolve_annotation(seg_type_annotation);
+    if (type_annotation == nullptr) {
+        type_annotation = resolve_annotation(seg_type_annotation);
+    }
 
     while (check({TOK_STAR})) {
         if (match({TOK_STAR})) {
@@ -824,6 +1145,23 @@ std::shared_ptr<Annotation> Parser::segmented_annotation() {
     return type_annotation;
 }
 
+std::vector<std::shared_ptr<Annotation>> Parser::type_arguments() {
+    std::vector<std::shared_ptr<Annotation>> type_args;
+    grouping_tokens.push(TOK_GT);
+    advance();
+    if (!check({TOK_GT})) {
+        type_args.push_back(annotation());
+        while (match({TOK_COMMA})) {
+            if (check({TOK_GT})) {
+                break;
+            }
+            type_args.push_back(annotation());
+        }
+    }
+    consume(TOK_GT, E_UNMATCHED_ANGLE_IN_TYPE, "Expected '>' after type arguments.");
+    return type_args;
+}
+
 std::shared_ptr<Annotation::Function> Parser::function_annotation() {
     std::vector<std::pair<TokenType, std::shared_ptr<Annotation>>> params;
     std::shared_ptr<Annotation> ret;
@@ -900,6 +1238,11 @@ std::shared_ptr<Annotation::Array> Parser::array_annotation() {
     std::shared_ptr<Annotation> inner = annotation();
     int size = -1;
 
+    // `[t]` is a slice, the same as `[t; *]`
+    if (match({TOK_RIGHT_SQUARE})) {
+        return std::make_shared<Annotation::Array>(inner, size);
+    }
+
     consume(TOK_SEMICOLON, E_NO_SEMICOLON_IN_ARRAY_TYPE, "Expected ';' after array type.");
 
     if (match({TOK_STAR})) {
@@ -916,8 +1259,29 @@ std::shared_ptr<Annotation::Array> Parser::array_annotation() {
     return std::make_shared<Annotation::Array>(inner, size);
 }
 
-void Parser::resolve_annotation(std::shared_ptr<Annotation::Segmented>& /*annotation*/) {
-    // Right now, we don't need to do anything here.
+std::shared_ptr<Annotation::Vector> Parser::vector_annotation() {
+    grouping_tokens.push(TOK_GT);
+    advance();
+    std::shared_ptr<Annotation> inner = annotation();
+
+    consume(TOK_COMMA, E_MISSING_SIZE_IN_VECTOR_TYPE, "Expected ',' and the number of lanes after vector element type.");
+    Token& size = consume(TOK_INT, E_MISSING_SIZE_IN_VECTOR_TYPE, "Expected integer number of lanes in vector type.");
+    int lanes = std::any_cast<int>(size.literal);
+
+    consume(TOK_GT, E_UNMATCHED_ANGLE_IN_TYPE, "Expected '>' after vector type.");
+
+    return std::make_shared<Annotation::Vector>(inner, lanes);
+}
+
+std::shared_ptr<Annotation> Parser::resolve_annotation(const std::shared_ptr<Annotation::Segmented>& annotation) {
+    // In an instance of a generic declaration, a type parameter stands for its type argument
+    if (annotation->classes.size() == 1 && annotation->classes[0]->type_args.empty()) {
+        auto iter = substitutions.find(annotation->classes[0]->name);
+        if (iter != substitutions.end()) {
+            return iter->second;
+        }
+    }
+    return annotation;
 }
 
 std::vector<std::shared_ptr<Stmt>> Parser::parse(const std::vector<std::shared_ptr<Token>>& tokens) {
@@ -959,3 +1323,31 @@ std::vector<std::shared_ptr<Stmt>> Parser::parse() {
 
     return statements;
 }
+
+std::shared_ptr<Decl> Parser::parse_instance(
+    const std::vector<std::shared_ptr<Token>>& decl_tokens,
+    const std::unordered_map<std::string, std::shared_ptr<Annotation>>& type_args,
+    const std::string& name
+) {
+    tokens = decl_tokens;
+    // The instance ends where the generic declaration does
+    tokens.push_back(std::make_shared<Token>(TOK_EOF, "", std::any(), decl_tokens.back()->location));
+    current = 0;
+    grouping_tokens = std::stack<TokenType>();
+    substitutions = type_args;
+
+    auto stmt = std::dynamic_pointer_cast<Stmt::Declaration>(statement());
+    substitutions.clear();
+    if (stmt == nullptr) {
+        return nullptr;
+    }
+    // The instance has its own name and no type parameters
+    if (auto struct_ = std::dynamic_pointer_cast<Decl::Struct>(stmt->declaration)) {
+        Token instance_name(struct_->name.tok_type, name, struct_->name.literal, struct_->name.location);
+        return std::make_shared<Decl::Struct>(struct_->declarer, instance_name, struct_->declarations);
+    } else if (auto fun = std::dynamic_pointer_cast<Decl::Fun>(stmt->declaration)) {
+        Token instance_name(fun->name.tok_type, name, fun->name.literal, fun->name.location);
+        return std::make_shared<Decl::Fun>(fun->declarer, instance_name, fun->parameters, fun->return_var, fun->type_annotation, fun->body);
+    }
+    return nullptr;
+}
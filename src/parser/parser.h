@@ -10,6 +10,8 @@
 #include <exception>
 #include <memory>
 #include <stack>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -29,6 +31,8 @@ class Parser {
     unsigned current = 0;
     // A stack to keep track of grouping tokens. If the stack is empty, newlines are significant.
     std::stack<TokenType> grouping_tokens;
+    // The annotations substituted for type parameters while parsing an instance of a generic declaration.
+    std::unordered_map<std::string, std::shared_ptr<Annotation>> substitutions;
 
     /**
      * @brief Returns the current token.
@@ -128,6 +132,39 @@ class Parser {
      */
     std::shared_ptr<Stmt> while_statement();
 
+    /**
+     * @brief Parses a for statement.
+     * A for statement begins with the `for` keyword followed by the loop variable, the `in` keyword,
+     * either a range `start..end` or an array expression, and a statement or statements.
+     *
+     * @return std::shared_ptr<Stmt> A pointer to the parsed for statement.
+     * @throw ParserException If an error occurs while parsing the statement. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Stmt> for_statement();
+
+    /**
+     * @brief Parses a match statement.
+     * A match statement begins with the `match` keyword followed by an expression and a set of braces containing arms.
+     * Each arm is a variant name, optionally with the path of its enum and a parenthesized list of bindings for its payload,
+     * or `_`, followed by `=>` and a statement or statements.
+     * E.g. "match shape { Shape::Circle(r) => { ... } _ => { ... } }".
+     *
+     * @return std::shared_ptr<Stmt> A pointer to the parsed match statement.
+     * @throw ParserException If an error occurs while parsing the statement. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Stmt> match_statement();
+
+    /**
+     * @brief Parses a loop preceded by loop hints.
+     * Each hint begins with `@` followed by its name and an optional integer argument in parentheses.
+     * The known hints are `@vectorize(width)`, `@unroll(count)`, and `@parallel`.
+     * E.g. "@vectorize(4) @unroll for i in 0..n { ... }".
+     *
+     * @return std::shared_ptr<Stmt> A pointer to the parsed loop statement, with its hints set.
+     * @throw ParserException If an error occurs while parsing the hints. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Stmt> hinted_loop_statement();
+
     /**
      * @brief Parses an expression statement, i.e. an expression by itself.
      * Expression statements are expressions followed by either a semicolon or a newline.
@@ -156,6 +193,15 @@ class Parser {
      */
     std::shared_ptr<Decl> var_decl();
 
+    /**
+     * @brief Parses the type parameters of a generic declaration, if there are any.
+     * Type parameters are a list of identifiers between angle brackets, e.g. "<T, U>".
+     *
+     * @return std::vector<Token> The type parameters. Empty if the declaration is not generic.
+     * @throw ParserException If an error occurs while parsing the type parameters. Will be caught by the statement() function.
+     */
+    std::vector<Token> type_parameters();
+
     /**
      * @brief Parses a function declaration.
      * Function declarations begin with "fun" followed by an identifier, a list of parameters, and a set of braces containing statements.
@@ -186,6 +232,16 @@ class Parser {
      */
     std::shared_ptr<Decl> struct_decl();
 
+    /**
+     * @brief Parses an enum declaration.
+     * Enum declarations begin with "enum" followed by an identifier and a set of braces containing variants separated by commas or newlines.
+     * A variant may carry a payload, given as a parenthesized list of type annotations, e.g. `Rect(f64, f64)`.
+     *
+     * @return std::shared_ptr<Decl> A pointer to the parsed enum declaration.
+     * @throw ParserException If an error occurs while parsing the declaration. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Decl> enum_decl();
+
     // MARK: Expressions
 
     /**
@@ -207,7 +263,7 @@ class Parser {
 
     /**
      * @brief Parses a logical OR expression.
-     * Logical OR expressions are expressions separated by the "or" keyword.
+     * Logical OR expressions are expressions separated by the "or" keyword or "||".
      *
      * @return std::shared_ptr<Expr> A pointer to the parsed logical OR expression.
      * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
@@ -216,7 +272,7 @@ class Parser {
 
     /**
      * @brief Parses a logical AND expression.
-     * Logical AND expressions are expressions separated by the "and" keyword.
+     * Logical AND expressions are expressions separated by the "and" keyword or "&&".
      *
      * @return std::shared_ptr<Expr> A pointer to the parsed logical AND expression.
      * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
@@ -241,6 +297,53 @@ class Parser {
      */
     std::shared_ptr<Expr> comparison_expr();
 
+    /**
+     * @brief Parses a bitwise OR expression.
+     * Bitwise OR expressions are expressions separated by the "|" operator.
+     *
+     * @return std::shared_ptr<Expr> A pointer to the parsed bitwise OR expression.
+     * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Expr> bit_or_expr();
+
+    /**
+     * @brief Parses a bitwise XOR expression.
+     * Bitwise XOR expressions are expressions separated by the "~" operator, since "^" is exponentiation.
+     *
+     * @return std::shared_ptr<Expr> A pointer to the parsed bitwise XOR expression.
+     * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Expr> bit_xor_expr();
+
+    /**
+     * @brief Parses a bitwise AND expression.
+     * Bitwise AND expressions are expressions separated by the "&" operator.
+     * The bitwise operators bind tighter than comparisons, so `a & mask == 0` compares the result of the `&`.
+     *
+     * @return std::shared_ptr<Expr> A pointer to the parsed bitwise AND expression.
+     * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Expr> bit_and_expr();
+
+    /**
+     * @brief Parses a shift expression.
+     * Shift expressions are expressions separated by the "<<" or ">>" operators.
+     *
+     * @return std::shared_ptr<Expr> A pointer to the parsed shift expression.
+     * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
+     */
+    std::shared_ptr<Expr> shift_expr();
+
+    /**
+     * @brief Checks if the current token and the next one form a shift operator.
+     * The scanner never joins two '<' or two '>', since ">>" also closes nested type arguments, e.g. in `Box<Box<i32>>`.
+     * Two of them form a shift operator here if nothing separates them.
+     *
+     * @return true If the next two tokens are "<<" or ">>".
+     * @return false Otherwise.
+     */
+    bool check_shift();
+
     /**
      * @brief Parses a term expression.
      * Term expressions are expressions separated by the "+" or "-" operators.
@@ -270,7 +373,8 @@ class Parser {
 
     /**
      * @brief Parses a unary expression.
-     * Unary expressions are expressions preceded by the "-" or "!" operators.
+     * Unary expressions are expressions preceded by the "-", "!" or "~" operators.
+     * Heap allocations, `alloc t` or `alloc [t; n]`, and deallocations, `dealloc p`, are parsed at the same level.
      *
      * @return std::shared_ptr<Expr> A pointer to the parsed unary expression.
      * @throw ParserException If an error occurs while parsing the expression. Will be caught by the statement() function.
@@ -358,6 +462,15 @@ class Parser {
      */
     std::shared_ptr<Annotation> segmented_annotation();
 
+    /**
+     * @brief Parses a list of type arguments between angle brackets, e.g. "<i32, bool>".
+     * The current token must be the "<".
+     *
+     * @return std::vector<std::shared_ptr<Annotation>> The type arguments.
+     * @throw ParserException If an error occurs while parsing the type arguments. Will be caught by the statement() function.
+     */
+    std::vector<std::shared_ptr<Annotation>> type_arguments();
+
     /**
      * @brief Parses a function type annotation.
      * Function type annotations must begin with the keyword "fun" followed by a list of paramter types, "=>", and a return type.
@@ -393,12 +506,24 @@ class Parser {
     std::shared_ptr<Annotation::Array> array_annotation();
 
     /**
-     * @brief Resolves a segmented annotation to its fully qualified name.
-     * Useful if a using declaration is present.
+     * @brief Parses a vector type annotation.
+     * Vector type annotations are "vec" followed by an element type and a literal number of lanes in angle brackets.
+     * The current token must be the "<" after "vec".
+     * E.g. "vec<f64, 4>".
      *
-     * @param annotation A reference segmented annotation to resolve. Will be modified in place.
+     * @return std::shared_ptr<Annotation::Vector> The parsed vector type annotation.
+     * @throw ParserException If an error occurs while parsing the annotation. Will be caught by the statement() function.
      */
-    void resolve_annotation(std::shared_ptr<Annotation::Segmented>& annotation);
+    std::shared_ptr<Annotation::Vector> vector_annotation();
+
+    /**
+     * @brief Resolves a segmented annotation to the annotation it stands for.
+     * While parsing an instance of a generic declaration, a type parameter stands for its type argument.
+     *
+     * @param annotation The segmented annotation to resolve.
+     * @return std::shared_ptr<Annotation> The annotation to use in its place.
+     */
+    std::shared_ptr<Annotation> resolve_annotation(const std::shared_ptr<Annotation::Segmented>& annotation);
 
 public:
     // MARK: Interface
@@ -435,6 +560,21 @@ public:
      * @deprecated Use the parse(const std::vector<std::shared_ptr<Token>>& tokens) function instead.
      */
     std::vector<std::shared_ptr<Stmt>> parse();
+
+    /**
+     * @brief Parses an instance of a generic struct or function from the tokens of the generic declaration.
+     * The instance has no type parameters; the annotations of its type arguments are substituted for them instead.
+     *
+     * @param decl_tokens The tokens of the generic declaration, as recorded in its `tokens` member.
+     * @param type_args The annotations of the type arguments, by type parameter name.
+     * @param name The name of the instance.
+     * @return std::shared_ptr<Decl> The instance. nullptr if it could not be parsed.
+     */
+    std::shared_ptr<Decl> parse_instance(
+        const std::vector<std::shared_ptr<Token>>& decl_tokens,
+        const std::unordered_map<std::string, std::shared_ptr<Annotation>>& type_args,
+        const std::string& name
+    );
 };
 
 #endif // PARSER_H
@@ -17,6 +17,7 @@ std::unordered_map<std::string, TokenType> Scanner::keywords = {
     {"continue", KW_CONTINUE},
     {"return", KW_RETURN},
     {"yield", KW_YIELD},
+    {"match", KW_MATCH},
     {"var", KW_VAR},
     {"const", KW_CONST},
     {"fun", KW_FUN},
@@ -216,6 +217,9 @@ void Scanner::scan_token() {
     case ';':
         add_token(TOK_SEMICOLON);
         break;
+    case '@':
+        add_token(TOK_AT);
+        break;
     case '&':
         if (match('&')) {
             add_token(match('=') ? TOK_AMP_AMP_EQ : TOK_AMP_AMP);
@@ -237,6 +241,9 @@ void Scanner::scan_token() {
     case '!':
         add_token(match('=') ? TOK_BANG_EQ : TOK_BANG);
         break;
+    case '~':
+        add_token(TOK_TILDE);
+        break;
     case '=':
         if (match('=')) {
             add_token(TOK_EQ_EQ);
@@ -459,7 +466,8 @@ void Scanner::numeric_literal() {
     }
 
     // Read the number
-    while (is_digit(peek(), base) || peek() == '_' || peek() == '.') {
+    // A '.' followed by another '.' starts a range, e.g. "0..10", and is not part of the number.
+    while (is_digit(peek(), base) || peek() == '_' || (peek() == '.' && peek_next() != '.')) {
         if (peek() == '_') {
             advance();
         } else if (peek() == '.') {
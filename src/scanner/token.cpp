@@ -89,6 +89,8 @@ std::string token_type_to_string(TokenType type) {
         return "TOK_BANG";
     case TOK_BANG_EQ:
         return "TOK_BANG_EQ";
+    case TOK_TILDE:
+        return "TOK_TILDE";
     case TOK_EQ:
         return "TOK_EQ";
     case TOK_EQ_EQ:
@@ -101,6 +103,10 @@ std::string token_type_to_string(TokenType type) {
         return "TOK_LT";
     case TOK_LE:
         return "TOK_LE";
+    case TOK_LT_LT:
+        return "TOK_LT_LT";
+    case TOK_GT_GT:
+        return "TOK_GT_GT";
     case TOK_DOT:
         return "TOK_DOT";
     case TOK_DOT_DOT:
@@ -117,6 +123,9 @@ std::string token_type_to_string(TokenType type) {
     case TOK_DOUBLE_ARROW:
         return "TOK_DOUBLE_ARROW";
 
+    case TOK_AT:
+        return "TOK_AT";
+
     case TOK_IDENT:
         return "TOK_IDENT";
     case TOK_CHAR:
@@ -162,6 +171,8 @@ std::string token_type_to_string(TokenType type) {
         return "KW_RETURN";
     case KW_YIELD:
         return "KW_YIELD";
+    case KW_MATCH:
+        return "KW_MATCH";
 
     case KW_VAR:
         return "KW_VAR";
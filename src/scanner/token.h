@@ -1,6 +1,7 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include "../utility/symbol.h"
 #include <any>
 #include <memory>
 #include <string>
@@ -60,12 +61,15 @@ enum TokenType {
     TOK_BAR_BAR_EQ,
     TOK_BANG,
     TOK_BANG_EQ,
+    TOK_TILDE,
     TOK_EQ,
     TOK_EQ_EQ,
     TOK_GT,
     TOK_GE,
     TOK_LT,
     TOK_LE,
+    TOK_LT_LT, // Made by the parser from two adjacent '<'
+    TOK_GT_GT, // Made by the parser from two adjacent '>', which also close nested type arguments
     TOK_DOT,
     TOK_DOT_DOT,
     TOK_TRIPLE_DOT,
@@ -75,6 +79,8 @@ enum TokenType {
     TOK_ARROW,
     TOK_DOUBLE_ARROW,
 
+    TOK_AT, // Annotations only
+
     // Literals
 
     TOK_IDENT,
@@ -102,6 +108,7 @@ enum TokenType {
     KW_CONTINUE,
     KW_RETURN,
     KW_YIELD,
+    KW_MATCH,
 
     KW_VAR,
     KW_CONST,
@@ -190,6 +197,8 @@ public:
     const std::any literal;
     // The location of the token in the source code.
     const Location location;
+    // The interned lexeme of an identifier, so that looking it up never goes through the symbol table; empty for other tokens.
+    const Symbol symbol;
 
     /**
      * @brief Construct a new Token object
@@ -198,6 +207,7 @@ public:
      * @param lexeme The string representing the lexeme of the token from the source code.
      * @param literal The literal value of the token, if it has one.
      * @param location The location of the token in the source code, including the line number, column number, and length.
+     * An identifier is interned here, as it is scanned.
      */
     Token(
         TokenType tok_type,
@@ -205,7 +215,7 @@ public:
         const std::any& literal,
         Location location
     )
-        : tok_type(tok_type), lexeme(lexeme), literal(literal), location(location) {}
+        : tok_type(tok_type), lexeme(lexeme), literal(literal), location(location), symbol(tok_type == TOK_IDENT ? Symbol::intern(lexeme) : Symbol()) {}
 
     /**
      * @brief A string representation of the token specifically for printing and debugging.
@@ -3,6 +3,20 @@
 
 ErrorCode Type::are_compatible(std::shared_ptr<Type>& a, std::shared_ptr<Type>& b) {
 
+    /*
+    Slices are arrays of unknown size. For a := b:
+    - If `a` is a slice, then `b` may be an array of any size with the same element type.
+    - If `b` is a slice, then `a` must also be a slice; we can't suddenly "remember" the size of an array.
+    */
+    if (a->kind() == Type::Kind::SLICE && b->kind() == Type::Kind::ARRAY) {
+        auto a_slice = std::dynamic_pointer_cast<Type::Slice>(a);
+        auto b_array = std::dynamic_pointer_cast<Type::Array>(b);
+        return a_slice->inner_type->to_string() == b_array->inner_type->to_string() ? (ErrorCode)0 : E_INCOMPATIBLE_TYPES;
+    }
+    if (a->kind() == Type::Kind::ARRAY && b->kind() == Type::Kind::SLICE) {
+        return E_ARRAY_SIZE_UNKNOWN;
+    }
+
     if (a->kind() == b->kind()) {
 
         /*
@@ -4,10 +4,13 @@
 #include "../logger/error_code.h"
 #include "../scanner/token.h"
 #include "llvm/IR/Type.h"
-#include <any>
 #include <memory>
 #include <string>
 
+namespace llvm {
+class Value;
+}
+
 /**
  * @brief A base class representing a type.
  * Types are used to represent the kind of data that can be stored in a variable.
@@ -33,6 +36,10 @@ public:
         POINTER,
         // A tuple type.
         TUPLE,
+        // A slice type; a view of a run of elements in memory.
+        SLICE,
+        // A vector type; a fixed number of lanes operated on at once.
+        VECTOR,
         // A blank type; used for type inference.
         BLANK
     };
@@ -45,6 +52,8 @@ public:
     class Array;
     class Pointer;
     class Tuple;
+    class Slice;
+    class Vector;
     class Blank;
 
     virtual ~Type() = default;
@@ -71,7 +80,7 @@ public:
      * @param context The LLVM context; can be obtained from the Environment singleton.
      * @return llvm::Type* The LLVM type representation of the type.
      */
-    virtual llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const = 0;
+    virtual llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const = 0;
 
     /**
      * @brief Determines if two types are compatible.
@@ -81,7 +90,7 @@ public:
      * @param b A shared ptr reference to the second type. Should not be nullptr.
      * @return 0 If the types are compatible.
      * E_INDETERMINATE_ARRAY_TYPE If the types are incompatible because `a` and `b` are arrays of blank types.
-     * E_ARRAY_SIZE_UNKNOWN If the types are incompatible because `a` is a sized array and `b` has an unknown size.
+     * E_ARRAY_SIZE_UNKNOWN If the types are incompatible because `a` is a sized array and `b` is a slice.
      * E_SIZED_ARRAY_WITHOUT_INITIALIZER If the types are incompatible because `a` is a sized array and `b` is a blank type.
      * E_INCOMPATIBLE_TYPES If the types are incompatible for any other reason.
      */
@@ -89,7 +98,7 @@ public:
 
     /**
      * @brief Checks if the type is a primitive integer type.
-     * One of these: `::i8`, `::i16`, `::i32`, `::i64`, `::char`.
+     * One of these: `::i8`, `::i16`, `::i32`, `::i64`, `::char`, or an unsigned integer type.
      * Uses the unique type name to determine if the type is an integer.
      *
      * @return true If the type is a primitive integer type.
@@ -97,7 +106,24 @@ public:
      */
     bool is_int() {
         if (
-            to_string() == "::i8" || to_string() == "::i16" || to_string() == "::i32" || to_string() == "::i64" || to_string() == "::char"
+            to_string() == "::i8" || to_string() == "::i16" || to_string() == "::i32" || to_string() == "::i64" || to_string() == "::char" || is_unsigned()
+        ) {
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks if the type is a primitive unsigned integer type.
+     * One of these: `::u8`, `::u16`, `::u32`, `::u64`.
+     * Unsigned integers divide, compare, widen and convert to floats without a sign; the other integers have one.
+     *
+     * @return true If the type is a primitive unsigned integer type.
+     * @return false Otherwise.
+     */
+    bool is_unsigned() {
+        if (
+            to_string() == "::u8" || to_string() == "::u16" || to_string() == "::u32" || to_string() == "::u64"
         ) {
             return true;
         }
@@ -131,8 +157,80 @@ public:
     bool is_numeric() {
         return is_int() || is_float();
     }
+
+protected:
+    /**
+     * @brief A memo for the LLVM lowering of a type.
+     * Composite types lower by walking all of their element types, so the result is remembered for the context it was created in.
+     * The context is only held weakly; a memo created for a context that has since been destroyed is never returned.
+     *
+     */
+    class LoweringCache {
+        // The context the cached type belongs to.
+        std::weak_ptr<llvm::LLVMContext> context;
+        // The cached type, or nullptr if nothing is cached yet.
+        llvm::Type* type = nullptr;
+
+    public:
+        /**
+         * @brief Gets the cached type if it was lowered in the given context.
+         *
+         * @param context The LLVM context the caller is lowering in.
+         * @return llvm::Type* The cached type, or nullptr if there is no cached type for this context.
+         */
+        llvm::Type* get(const std::shared_ptr<llvm::LLVMContext>& context) const {
+            // Compare control blocks instead of locking; the weak pointer keeps the block alive, so it cannot be reused by another context.
+            if (type == nullptr || this->context.owner_before(context) || context.owner_before(this->context)) {
+                return nullptr;
+            }
+            return type;
+        }
+
+        /**
+         * @brief Caches a lowered type for the given context.
+         *
+         * @param context The LLVM context the type was lowered in.
+         * @param type The lowered type.
+         * @return llvm::Type* The lowered type, for convenience.
+         */
+        llvm::Type* set(const std::shared_ptr<llvm::LLVMContext>& context, llvm::Type* type) {
+            this->context = context;
+            this->type = type;
+            return type;
+        }
+    };
 };
 
+/**
+ * @brief Expands `X(R)` once for every return type a visitor may have.
+ * Each AST node implements one accept overload per return type, so visitors get statically typed results without any casting.
+ * The types are: `void` for the global checker, `std::shared_ptr<Type>` for the local checker,
+ * `llvm::Value*` for the code generator, and `std::string` for the AST printer.
+ * A visitor with a new return type only needs that type added here.
+ *
+ */
+#define VISITOR_RETURN_TYPES(X) \
+    X(void)                     \
+    X(std::shared_ptr<Type>)    \
+    X(llvm::Value*)             \
+    X(std::string)
+
+#define DECLARE_ACCEPT(R) virtual R accept(Visitor<R>* visitor) = 0;
+#define OVERRIDE_ACCEPT(R) \
+    R accept(Visitor<R>* visitor) override { return dispatch(visitor); }
+
+/**
+ * @brief Implements every accept overload of an AST node by calling the given visit function of the visitor.
+ * Use inside the public section of a concrete node class, e.g. `IMPLEMENT_ACCEPT(visit_block_stmt)`.
+ *
+ */
+#define IMPLEMENT_ACCEPT(VISIT_FUNCTION)        \
+    template <typename V>                       \
+    auto dispatch(V* visitor) {                 \
+        return visitor->VISIT_FUNCTION(this);   \
+    }                                           \
+    VISITOR_RETURN_TYPES(OVERRIDE_ACCEPT)
+
 /**
  * @brief An abstract base class for all statements in the AST.
  * Includes statements for expressions and declarations.
@@ -147,6 +245,8 @@ public:
     class Block;
     class Conditional;
     class Loop;
+    class For;
+    class Match;
     class Return;
     class Break;
     class Continue;
@@ -160,37 +260,41 @@ public:
     /**
      * @brief A visitor class for statements.
      *
+     * @tparam R The type returned by every visit function. Must be one of VISITOR_RETURN_TYPES.
      */
+    template <typename R>
     class Visitor {
     public:
-        virtual std::any visit_declaration_stmt(Declaration* stmt) = 0;
-        virtual std::any visit_expression_stmt(Expression* stmt) = 0;
-        virtual std::any visit_block_stmt(Block* stmt) = 0;
-        virtual std::any visit_conditional_stmt(Conditional* stmt) = 0;
-        virtual std::any visit_loop_stmt(Loop* stmt) = 0;
-        virtual std::any visit_return_stmt(Return* stmt) = 0;
-        virtual std::any visit_break_stmt(Break* stmt) = 0;
-        virtual std::any visit_continue_stmt(Continue* stmt) = 0;
-        virtual std::any visit_eof_stmt(EndOfFile* stmt) = 0;
+        virtual ~Visitor() = default;
+        virtual R visit_declaration_stmt(Declaration* stmt) = 0;
+        virtual R visit_expression_stmt(Expression* stmt) = 0;
+        virtual R visit_block_stmt(Block* stmt) = 0;
+        virtual R visit_conditional_stmt(Conditional* stmt) = 0;
+        virtual R visit_loop_stmt(Loop* stmt) = 0;
+        virtual R visit_for_stmt(For* stmt) = 0;
+        virtual R visit_match_stmt(Match* stmt) = 0;
+        virtual R visit_return_stmt(Return* stmt) = 0;
+        virtual R visit_break_stmt(Break* stmt) = 0;
+        virtual R visit_continue_stmt(Continue* stmt) = 0;
+        virtual R visit_eof_stmt(EndOfFile* stmt) = 0;
     };
 
     /**
      * @brief Accepts a visitor class. Information may be passed upward in the return value.
-     * CAUTION: Improper casting of the std::any value can result in obscure runtime errors.
+     * There is one overload per visitor return type; see VISITOR_RETURN_TYPES.
+     * In the local checker, statements return a Type if the statement contains a return statement, and nullptr otherwise.
+     * In the code generator, statements return nullptr.
      *
      * @param visitor The visitor class to accept.
-     * @return std::any The return value from the visitor class.
-     * Statements usually return the empty std::any value unless the statement contains a return statement.
-     * If the visitor is a type checker, the return value will be a Type.
-     * If the visitor is a code generator, usually nullptr.
+     * @return R The return value from the visitor class.
      */
-    virtual std::any accept(Visitor* visitor) = 0;
+    VISITOR_RETURN_TYPES(DECLARE_ACCEPT)
 };
 
 /**
  * @brief An abstract base class for all declarations in the AST.
  * A declaration is a statement that introduces a new name into the program.
- * Structs are used to create Struct Nodes in the namespace tree.
+ * Structs and enums are used to create Struct Nodes in the namespace tree.
  * Other declaration types are VarDeclarable, meaning they can be declared as variables in the Environment.
  * If a declaration is VarDeclarable, it may store its resolved Type in addition to its Annotation.
  *
@@ -203,6 +307,7 @@ public:
     class Fun;
     class ExternFun;
     class Struct;
+    class Enum;
 
     virtual ~Decl() {}
 
@@ -212,25 +317,28 @@ public:
     /**
      * @brief A visitor class for declarations.
      *
+     * @tparam R The type returned by every visit function. Must be one of VISITOR_RETURN_TYPES.
      */
+    template <typename R>
     class Visitor {
     public:
-        virtual std::any visit_var_decl(Var* decl) = 0;
-        virtual std::any visit_fun_decl(Fun* decl) = 0;
-        virtual std::any visit_extern_fun_decl(ExternFun* decl) = 0;
-        virtual std::any visit_struct_decl(Struct* decl) = 0;
+        virtual ~Visitor() = default;
+        virtual R visit_var_decl(Var* decl) = 0;
+        virtual R visit_fun_decl(Fun* decl) = 0;
+        virtual R visit_extern_fun_decl(ExternFun* decl) = 0;
+        virtual R visit_struct_decl(Struct* decl) = 0;
+        virtual R visit_enum_decl(Enum* decl) = 0;
     };
 
     /**
      * @brief Accepts a visitor class. Information may be passed upward in the return value.
-     * CAUTION: Improper casting of the std::any value can result in obscure runtime errors.
+     * There is one overload per visitor return type; see VISITOR_RETURN_TYPES.
+     * In the local checker and the code generator, visiting a declaration yields nullptr.
      *
      * @param visitor The visitor class to accept.
-     * @return std::any The return value from the visitor class.
-     * In the type checkers, visiting a declaration usually yields the empty std::any value.
-     * In the code generator, visiting a declaration usually yields nullptr.
+     * @return R The return value from the visitor class.
      */
-    virtual std::any accept(Visitor* visitor) = 0;
+    VISITOR_RETURN_TYPES(DECLARE_ACCEPT)
 };
 
 /**
@@ -252,6 +360,7 @@ public:
     class Dereference;
     class Access;
     class Index;
+    class Slice;
     class Call;
     class Cast;
     class Grouping;
@@ -261,6 +370,8 @@ public:
     class ArrayGen;
     class Tuple;
     class Object;
+    class Alloc;
+    class Dealloc;
 
     class LAccess;
     class LIndex;
@@ -276,37 +387,43 @@ public:
     /**
      * @brief A visitor class for expressions.
      *
+     * @tparam R The type returned by every visit function. Must be one of VISITOR_RETURN_TYPES.
      */
+    template <typename R>
     class Visitor {
     public:
-        virtual std::any visit_assign_expr(Assign* expr) = 0;
-        virtual std::any visit_logical_expr(Logical* expr) = 0;
-        virtual std::any visit_binary_expr(Binary* expr) = 0;
-        virtual std::any visit_unary_expr(Unary* expr) = 0;
-        virtual std::any visit_dereference_expr(Dereference* expr) = 0;
-        virtual std::any visit_access_expr(Access* expr) = 0;
-        virtual std::any visit_index_expr(Index* expr) = 0;
-        virtual std::any visit_call_expr(Call* expr) = 0;
-        virtual std::any visit_cast_expr(Cast* expr) = 0;
-        virtual std::any visit_grouping_expr(Grouping* expr) = 0;
-        virtual std::any visit_identifier_expr(Identifier* expr) = 0;
-        virtual std::any visit_literal_expr(Literal* expr) = 0;
-        virtual std::any visit_array_expr(Array* expr) = 0;
-        virtual std::any visit_array_gen_expr(ArrayGen* expr) = 0;
-        virtual std::any visit_tuple_expr(Tuple* expr) = 0;
-        virtual std::any visit_object_expr(Object* expr) = 0;
+        virtual ~Visitor() = default;
+        virtual R visit_assign_expr(Assign* expr) = 0;
+        virtual R visit_logical_expr(Logical* expr) = 0;
+        virtual R visit_binary_expr(Binary* expr) = 0;
+        virtual R visit_unary_expr(Unary* expr) = 0;
+        virtual R visit_dereference_expr(Dereference* expr) = 0;
+        virtual R visit_access_expr(Access* expr) = 0;
+        virtual R visit_index_expr(Index* expr) = 0;
+        virtual R visit_slice_expr(Slice* expr) = 0;
+        virtual R visit_call_expr(Call* expr) = 0;
+        virtual R visit_cast_expr(Cast* expr) = 0;
+        virtual R visit_grouping_expr(Grouping* expr) = 0;
+        virtual R visit_identifier_expr(Identifier* expr) = 0;
+        virtual R visit_literal_expr(Literal* expr) = 0;
+        virtual R visit_array_expr(Array* expr) = 0;
+        virtual R visit_array_gen_expr(ArrayGen* expr) = 0;
+        virtual R visit_tuple_expr(Tuple* expr) = 0;
+        virtual R visit_object_expr(Object* expr) = 0;
+        virtual R visit_alloc_expr(Alloc* expr) = 0;
+        virtual R visit_dealloc_expr(Dealloc* expr) = 0;
     };
 
     /**
      * @brief Accepts a visitor class. Information may be passed upward in the return value.
-     * CAUTION: Improper casting of the std::any value can result in obscure runtime errors.
+     * There is one overload per visitor return type; see VISITOR_RETURN_TYPES.
+     * In the local checker, visiting an expression will yield a Type.
+     * In the code generator, visiting an expression will yield an LLVM Value.
      *
      * @param visitor The visitor class to accept.
-     * @return std::any The return value from the visitor class.
-     * In the type checkers, visiting an expression will yield a Type.
-     * In the code generator, visiting an expression will yield an LLVM Value.
+     * @return R The return value from the visitor class.
      */
-    virtual std::any accept(Visitor* visitor) = 0;
+    VISITOR_RETURN_TYPES(DECLARE_ACCEPT)
 };
 
 /**
@@ -327,11 +444,10 @@ public:
     class StructScope;
     class LocalScope;
     class Variable;
+    class Generic;
 
     virtual ~Node() = default;
 
-    // The number of local scopes created. Used for generating unique names.
-    static int local_scope_count;
     // A unique name for this node. Used for type comparison and LLVM IR generation.
     std::string unique_name;
     // The parent scope of this node. This is never a variable since variables do not have children.
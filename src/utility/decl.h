@@ -7,7 +7,6 @@
 #include "../scanner/token.h"
 #include "expr.h"
 #include "stmt.h"
-#include <any>
 #include <memory>
 #include <vector>
 
@@ -39,6 +38,9 @@ public:
     std::shared_ptr<Type> type = nullptr;
     // Whether the variable is an instance member of a struct.
     bool is_instance_member = false;
+    // The variable node created for this declaration. nullptr until the declaration has been declared in the Environment.
+    // Later passes use it to reach the variable (and its LLVM allocation) without repeating the scope lookup.
+    std::shared_ptr<Node::Variable> variable = nullptr;
 };
 
 class Expr;
@@ -57,9 +59,7 @@ public:
 
     Var(TokenType declarer, Token name, std::shared_ptr<Annotation> type_annotation, std::shared_ptr<Expr> initializer) : VarDeclarable(declarer, name, type_annotation), initializer(initializer) {}
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_var_decl(this);
-    }
+    IMPLEMENT_ACCEPT(visit_var_decl)
 
     // The initializer expression. Note: if the variable is explicitly initialized to nil, this will still point to an expression that represents nil.
     std::shared_ptr<Expr> initializer;
@@ -81,9 +81,7 @@ public:
         std::vector<std::shared_ptr<Stmt>> body
     ) : VarDeclarable(declarer, name, type_annotation), parameters(parameters), return_var(return_var), body(body) {}
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_fun_decl(this);
-    }
+    IMPLEMENT_ACCEPT(visit_fun_decl)
 
     // The parameters of the function.
     std::vector<std::shared_ptr<Decl::Var>> parameters;
@@ -91,6 +89,12 @@ public:
     std::shared_ptr<Decl::Var> return_var;
     // The body of the function.
     std::vector<std::shared_ptr<Stmt>> body;
+    // The type parameters of a generic function. E.g. `fun max<T>(a: T, b: T): T` has the type parameter `T`.
+    std::vector<Token> type_params;
+    // The tokens of a generic function, from `fun` to its closing brace. Each instance is parsed from them again.
+    std::vector<std::shared_ptr<Token>> tokens;
+    // The instances of a generic function, in the order they were created. Set by the global checker.
+    std::vector<std::shared_ptr<Decl::Fun>> instances;
 };
 
 /**
@@ -108,9 +112,7 @@ public:
         location = name.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_extern_fun_decl(this);
-    }
+    IMPLEMENT_ACCEPT(visit_extern_fun_decl)
 };
 
 /**
@@ -126,9 +128,7 @@ public:
         location = name.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_struct_decl(this);
-    }
+    IMPLEMENT_ACCEPT(visit_struct_decl)
 
     // The token type that signifies the declaration type.
     TokenType declarer;
@@ -138,6 +138,102 @@ public:
     std::vector<std::shared_ptr<Decl>> declarations;
     // The type corresponding to the struct. Also contains a reference to the Node::StructScope.
     std::shared_ptr<Type> struct_type = nullptr;
+    // The type parameters of a generic struct. E.g. `struct Box<T>` has the type parameter `T`.
+    std::vector<Token> type_params;
+    // The tokens of a generic struct, from `struct` to its closing brace. Each instance is parsed from them again.
+    std::vector<std::shared_ptr<Token>> tokens;
+    // The instances of a generic struct, in the order they were created. Set by the global checker.
+    std::vector<std::shared_ptr<Decl::Struct>> instances;
+};
+
+/**
+ * @brief A class representing an enum declaration, whose variants may carry a payload.
+ * E.g. enum Shape { Circle(f64), Rect(f64, f64), Empty }
+ * Note: The layout of an enum is decided by the global checker, from the payloads of its variants.
+ *
+ */
+class Decl::Enum : public Decl {
+public:
+    /**
+     * @brief A variant of an enum, with the types of its payload fields, if it has any.
+     *
+     */
+    struct Variant {
+        // The name of the variant.
+        Token name;
+        // The annotations of the payload fields.
+        std::vector<std::shared_ptr<Annotation>> payload_annotations;
+        // The types of the payload fields. Set by the global checker.
+        std::vector<std::shared_ptr<Type>> payload;
+    };
+
+    /**
+     * @brief How the values of an enum are represented.
+     *
+     */
+    enum class Layout {
+        // No variant has a payload; a value is the integer index of its variant.
+        TAG,
+        // A value is an integer tag followed by storage that fits the payload of any variant.
+        TAGGED_UNION,
+        // A single variant has a payload, which is one bool or tag-only enum; the other variants are the integers its payload never takes.
+        NICHE,
+    };
+
+    Enum(TokenType declarer, Token name, std::vector<Variant> variants)
+        : declarer(declarer), name(name), variants(variants) {
+        location = name.location;
+    }
+
+    IMPLEMENT_ACCEPT(visit_enum_decl)
+
+    /**
+     * @brief Finds the index of the variant with a name.
+     *
+     * @param variant_name The name of the variant.
+     * @return int The index of the variant, or -1 if there is none.
+     */
+    int find_variant(const std::string& variant_name) const {
+        for (size_t i = 0; i < variants.size(); i++) {
+            if (variants[i].name.lexeme == variant_name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief The number of integers a value of a scalar enum (TAG or NICHE) may be.
+     * For a TAGGED_UNION, the number of integers its tag may be.
+     *
+     * @return unsigned The number of values.
+     */
+    unsigned value_count() const {
+        return layout == Layout::NICHE ? niche_start + static_cast<unsigned>(variants.size()) : static_cast<unsigned>(variants.size());
+    }
+
+    /**
+     * @brief The width of the integer that holds a value of a scalar enum, or the tag of a TAGGED_UNION.
+     *
+     * @return unsigned 8, 16 or 32.
+     */
+    unsigned tag_bits() const {
+        unsigned count = value_count();
+        return count <= (1u << 8) ? 8 : count <= (1u << 16) ? 16 : 32;
+    }
+
+    // The token type that signifies the declaration type.
+    TokenType declarer;
+    // The name of the enum.
+    Token name;
+    // The variants of the enum, in declaration order.
+    std::vector<Variant> variants;
+    // How the values of the enum are represented. Set by the global checker.
+    Layout layout = Layout::TAG;
+    // With the NICHE layout, the number of values the payload may take; unit variant i is the value niche_start + i.
+    unsigned niche_start = 0;
+    // The type corresponding to the enum. Also contains a reference to the Node::StructScope.
+    std::shared_ptr<Type> enum_type = nullptr;
 };
 
 #endif // DECL_H
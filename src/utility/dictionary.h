@@ -1,25 +1,49 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
-#include <algorithm>
-#include <iterator>
-#include <unordered_map>
+#include "flat_table.h"
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
-#include <vector>
+
+/**
+ * @brief The type used to look up keys of type K without constructing a K.
+ * Strings are looked up through std::string_view, so lookups never copy the key.
+ *
+ * @tparam K The key type.
+ */
+template <typename K>
+struct DictionaryKey {
+    using view = const K&;
+};
+
+template <>
+struct DictionaryKey<std::string> {
+    using view = std::string_view;
+};
 
 /**
  * @brief A dictionary class that maps keys to values.
- * The dictionary is implemented using an unordered map and a vector of keys.
- * Unlike std::map, this class preserves the order of insertion.
+ * Entries are stored once, contiguously, in insertion order, in a FlatTable; unlike std::map, this class preserves the order of insertion.
+ * Small dictionaries (e.g. structs with a few fields) are searched linearly.
  *
  * @tparam K The key type. Must be hashable.
  * @tparam V The value type.
- * @tparam Hash The hash function for the keys. Defaults to std::hash<K>.
+ * @tparam Hash The hash function for the keys. Must accept the key view type. Defaults to std::hash of the key view.
  */
-template <typename K, typename V, typename Hash = std::hash<K>>
+template <typename K, typename V, typename Hash = std::hash<std::remove_cv_t<std::remove_reference_t<typename DictionaryKey<K>::view>>>>
 class Dictionary {
-    std::unordered_map<K, unsigned, Hash> map;
-    std::vector<std::pair<K, V>> keys;
+public:
+    using key_view = typename DictionaryKey<K>::view;
+    using iterator = typename FlatTable<K, V, Hash>::iterator;
+    using const_iterator = typename FlatTable<K, V, Hash>::const_iterator;
+
+private:
+    // The entries of the dictionary, in insertion order.
+    FlatTable<K, V, Hash> table;
 
 public:
     Dictionary() = default;
@@ -28,19 +52,18 @@ public:
 
     /**
      * @brief Insert a key-value pair into the dictionary.
-     * If the key does not exist, it is also added to the end of the keys vector.
+     * If the key does not exist, it is added to the end of the dictionary.
      * If the key already exists, the value is updated.
      *
      * @param key The key.
      * @param value The value.
      */
     void insert(K key, V value) {
-        auto it = map.find(key);
-        if (it == map.end()) {
-            map[key] = keys.size();
-            keys.push_back({key, value});
+        long index = table.index_of(key);
+        if (index == -1) {
+            table.append(std::move(key), std::move(value));
         } else {
-            keys.at(it->second).second = value;
+            table.entry_at(index).second = std::move(value);
         }
     }
 
@@ -51,15 +74,12 @@ public:
      * @param key The key.
      * @return V& A reference to the value.
      */
-    V& operator[](K key) {
-        auto it = map.find(key);
-        if (it == map.end()) {
-            map[key] = keys.size();
-            keys.push_back({key, V()});
-            return keys.back().second;
-        } else {
-            return keys.at(it->second).second;
+    V& operator[](key_view key) {
+        long index = table.index_of(key);
+        if (index == -1) {
+            return table.append(K(key), V());
         }
+        return table.entry_at(index).second;
     }
 
     /**
@@ -67,9 +87,10 @@ public:
      *
      * @param key The key.
      * @return const V& A const reference to the value.
+     * @throw std::out_of_range If the key is not in the dictionary.
      */
-    const V& operator[](K key) const {
-        return keys.at(map.at(key)).second;
+    const V& operator[](key_view key) const {
+        return at(key);
     }
 
     /**
@@ -79,8 +100,12 @@ public:
      * @return V& A reference to the value.
      * @throw std::out_of_range If the key is not in the dictionary.
      */
-    V& at(K key) {
-        return keys.at(map.at(key)).second;
+    V& at(key_view key) {
+        long index = table.index_of(key);
+        if (index == -1) {
+            throw std::out_of_range("Dictionary::at");
+        }
+        return table.entry_at(index).second;
     }
 
     /**
@@ -90,8 +115,12 @@ public:
      * @return const V& A const reference to the value.
      * @throw std::out_of_range If the key is not in the dictionary.
      */
-    const V& at(K key) const {
-        return keys.at(map.at(key)).second;
+    const V& at(key_view key) const {
+        long index = table.index_of(key);
+        if (index == -1) {
+            throw std::out_of_range("Dictionary::at");
+        }
+        return table.entry_at(index).second;
     }
 
     /**
@@ -101,13 +130,8 @@ public:
      * @param key The key.
      * @return int The index of the key. -1 if the key is not in the dictionary.
      */
-    int get_index(K key) {
-        auto it = map.find(key);
-        if (it == map.end()) {
-            return -1;
-        } else {
-            return (int)(it->second);
-        }
+    int get_index(key_view key) const {
+        return (int)table.index_of(key);
     }
 
     /**
@@ -118,7 +142,7 @@ public:
      * @throw std::out_of_range If the index is out of bounds.
      */
     std::pair<K, V>& get_pair_at(size_t index) {
-        return keys.at(index);
+        return table.entry_at(index);
     }
 
     /**
@@ -128,8 +152,8 @@ public:
      * @return true If the key is in the dictionary.
      * @return false If the key is not in the dictionary.
      */
-    bool contains(K key) const {
-        return map.find(key) != map.end();
+    bool contains(key_view key) const {
+        return table.index_of(key) != -1;
     }
 
     /**
@@ -138,7 +162,7 @@ public:
      * @return size_t The number of keys in the dictionary.
      */
     size_t size() const {
-        return map.size();
+        return table.size();
     }
 
     /**
@@ -146,40 +170,31 @@ public:
      *
      */
     void clear() {
-        map.clear();
-        keys.clear();
+        table.clear();
     }
 
-    typename std::vector<std::pair<K, V>>::iterator begin() {
-        return keys.begin();
+    iterator begin() {
+        return table.begin();
     }
 
-    typename std::vector<std::pair<K, V>>::iterator end() {
-        return keys.end();
+    iterator end() {
+        return table.end();
     }
 
-    typename std::vector<std::pair<K, V>>::const_iterator begin() const {
-        return keys.begin();
+    const_iterator begin() const {
+        return table.begin();
     }
 
-    typename std::vector<std::pair<K, V>>::const_iterator end() const {
-        return keys.end();
+    const_iterator end() const {
+        return table.end();
     }
 
-    typename std::vector<std::pair<K, V>>::iterator find(K key) {
-        auto iter = map.find(key);
-        if (iter == map.end()) {
-            return keys.end();
-        }
-        return keys.begin() + iter->second;
+    iterator find(key_view key) {
+        return table.find(key);
     }
 
-    typename std::vector<std::pair<K, V>>::const_iterator find(K key) const {
-        auto iter = map.find(key);
-        if (iter == map.end()) {
-            return keys.end();
-        }
-        return keys.begin() + iter->second;
+    const_iterator find(key_view key) const {
+        return table.find(key);
     }
 };
 
@@ -10,7 +10,7 @@ TokenType Expr::Dereference::get_lvalue_declarer() {
 
 llvm::Value* Expr::Dereference::get_llvm_allocation(CodeGenerator* code_generator) {
     // If this is a dereferenced pointer...
-    auto value = std::any_cast<llvm::Value*>(inner->accept(code_generator));
+    auto value = inner->accept(code_generator);
     // Then the pointer is the llvm allocation.
     return value;
 }
@@ -21,6 +21,10 @@ TokenType Expr::LAccess::get_lvalue_declarer() {
     if (left_lvalue->get_lvalue_declarer() == KW_CONST) {
         return KW_CONST;
     }
+    // The length of an array or slice cannot be assigned.
+    if (member_index == -1 && static_member == nullptr) {
+        return KW_CONST;
+    }
     // If the left side is not const, then the declarer is the declarer of the right side.
     auto l_struct_type = std::dynamic_pointer_cast<Type::Named>(left->type);
     auto member_name = ident.lexeme;
@@ -45,12 +49,9 @@ llvm::Value* Expr::LAccess::get_llvm_allocation(CodeGenerator* code_generator) {
     // // We use GEP to calculate the address of the member
     // return gep;
 
-    auto struct_alloca = std::any_cast<llvm::Value*>(left->accept(code_generator));
+    auto struct_alloca = left->accept(code_generator);
     auto struct_type = std::dynamic_pointer_cast<Type::Struct>(left->type);
 
-    auto member_name = ident.lexeme;
-    auto member_index = struct_type->struct_scope->instance_members.get_index(member_name);
-
     auto context = Environment::inst().get_llvm_context();
 
     // Create a GEP instruction to get the member
@@ -63,6 +64,11 @@ llvm::Value* Expr::LAccess::get_llvm_allocation(CodeGenerator* code_generator) {
 }
 
 TokenType Expr::LIndex::get_lvalue_declarer() {
+    // The elements of a slice are const if the slice was declared const, like the object behind a pointer.
+    auto slice_type = std::dynamic_pointer_cast<Type::Slice>(left->type);
+    if (slice_type != nullptr) {
+        return slice_type->declarer;
+    }
     // An access expression is const if the left side is const.
     return left_lvalue->get_lvalue_declarer();
 }
@@ -71,7 +77,7 @@ llvm::Value* Expr::LIndex::get_llvm_allocation(CodeGenerator* code_generator) {
     auto tuple_type = std::dynamic_pointer_cast<Type::Tuple>(left->type);
     if (tuple_type != nullptr) {
         // Get the tuple alloca
-        auto tuple_alloca = std::any_cast<llvm::Value*>(left->accept(code_generator));
+        auto tuple_alloca = left->accept(code_generator);
         // Get the index
         auto literal_right = std::dynamic_pointer_cast<Expr::Literal>(right);
         // This should never be nullptr
@@ -90,9 +96,10 @@ llvm::Value* Expr::LIndex::get_llvm_allocation(CodeGenerator* code_generator) {
     auto array_type = std::dynamic_pointer_cast<Type::Array>(left->type);
     if (array_type != nullptr) {
         // Get the array alloca
-        auto array_alloca = std::any_cast<llvm::Value*>(left->accept(code_generator));
+        auto array_alloca = left->accept(code_generator);
         // Get the index
-        auto index_value = std::any_cast<llvm::Value*>(right->accept(code_generator));
+        auto index_value = code_generator->generate_index(right.get());
+        code_generator->check_bounds(this, index_value, code_generator->builder->getInt64(array_type->size));
 
         auto context = Environment::inst().get_llvm_context();
         // Create a GEP instruction to get the member
@@ -104,15 +111,25 @@ llvm::Value* Expr::LIndex::get_llvm_allocation(CodeGenerator* code_generator) {
         return val;
         // It's pretty much like visiting an index expression, but we don't add the load instruction
     }
+    auto slice_type = std::dynamic_pointer_cast<Type::Slice>(left->type);
+    if (slice_type != nullptr) {
+        auto slice = left->accept(code_generator);
+        auto index_value = code_generator->generate_index(right.get());
+        code_generator->check_bounds(this, index_value, code_generator->builder->CreateExtractValue(slice, 1));
+        return code_generator->get_slice_element(slice, slice_type, index_value);
+    }
     return nullptr;
 }
 
 TokenType Expr::Identifier::get_lvalue_declarer() {
-    auto var_node = Environment::inst().get_variable(tokens);
-    return var_node->decl->declarer;
+    // The identifier has already been resolved by the local checker.
+    if (variant >= 0) {
+        // Enum variants are values, not storage
+        return KW_CONST;
+    }
+    return variable->decl->declarer;
 }
 
 llvm::Value* Expr::Identifier::get_llvm_allocation(CodeGenerator* /* code_generator */) {
-    auto var_node = Environment::inst().get_variable(tokens);
-    return var_node->llvm_allocation;
+    return variable->llvm_allocation;
 }
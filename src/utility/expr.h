@@ -8,7 +8,6 @@
 #include "../utility/dictionary.h"
 #include "type.h"
 #include "llvm/IR/Value.h"
-#include <any>
 #include <map>
 #include <memory>
 #include <vector>
@@ -59,9 +58,7 @@ public:
         location = op.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_assign_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_assign_expr)
 
     // TODO: All lvalues inherit Expr::LValue. Consider changinge the type of `left`.
     // Note that doing so would mean lvalue errors are caught in the parser, not the type checker.
@@ -86,9 +83,7 @@ public:
         location = op.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_logical_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_logical_expr)
 
     // The expression on the left side.
     std::shared_ptr<Expr> left;
@@ -110,9 +105,7 @@ public:
         location = op.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_binary_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_binary_expr)
 
     // The expression on the left side.
     std::shared_ptr<Expr> left;
@@ -132,9 +125,7 @@ public:
         location = op.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_unary_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_unary_expr)
 
     // The token representing the operator.
     Token op;
@@ -154,9 +145,7 @@ public:
         location = op.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_dereference_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_dereference_expr)
 
     // The token representing the operator.
     Token op;
@@ -182,9 +171,7 @@ public:
         location = op.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_access_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_access_expr)
 
     // The expression on the left side.
     std::shared_ptr<Expr> left;
@@ -192,6 +179,12 @@ public:
     Token op;
     // The ident token on the right side.
     Token ident;
+    // The index of the instance member being accessed, or -1 if the member is static.
+    // Set by the local checker.
+    int member_index = -1;
+    // The static member being accessed, or nullptr if the member is an instance member.
+    // Set by the local checker.
+    std::shared_ptr<Node::Variable> static_member = nullptr;
 };
 
 /**
@@ -207,9 +200,7 @@ public:
         : Access(left, op, ident), left_lvalue(left) {
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_access_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_access_expr)
 
     // A copy of the left side, casted to an lvalue for convenience.
     std::shared_ptr<Expr::LValue> left_lvalue;
@@ -231,9 +222,7 @@ public:
         location = bracket.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_index_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_index_expr)
 
     // The expression on the left side.
     std::shared_ptr<Expr> left;
@@ -241,6 +230,8 @@ public:
     Token bracket;
     // The expression on the right side.
     std::shared_ptr<Expr> right;
+    // Whether the local checker proved that the index is in range; such an index is never bounds checked.
+    bool in_bounds = false;
 };
 
 /**
@@ -256,9 +247,7 @@ public:
         : Index(left, bracket, right), left_lvalue(left) {
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_index_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_index_expr)
 
     // A copy of the left side, casted to an lvalue for convenience.
     std::shared_ptr<Expr::LValue> left_lvalue;
@@ -267,6 +256,31 @@ public:
     llvm::Value* get_llvm_allocation(CodeGenerator* code_generator) override;
 };
 
+/**
+ * @brief A class representing a slice expression.
+ * A slice expression creates a slice that views the elements of an array, slice, or pointer from `start` up to, but not including, `end`.
+ * E.g. `a[1..n]`, `a[..n]`, `a[1..]`, or `a[..]`
+ *
+ */
+class Expr::Slice : public Expr {
+public:
+    Slice(std::shared_ptr<Expr> left, Token bracket, std::shared_ptr<Expr> start, std::shared_ptr<Expr> end)
+        : left(left), bracket(bracket), start(start), end(end) {
+        location = bracket.location;
+    }
+
+    IMPLEMENT_ACCEPT(visit_slice_expr)
+
+    // The expression being sliced.
+    std::shared_ptr<Expr> left;
+    // The token representing the opening bracket.
+    Token bracket;
+    // The index of the first element, or nullptr to start at the first element.
+    std::shared_ptr<Expr> start;
+    // The index after the last element, or nullptr to end after the last element.
+    std::shared_ptr<Expr> end;
+};
+
 /**
  * @brief A class representing a call expression.
  * Usually, this means a function call, indicated by parentheses.
@@ -275,14 +289,50 @@ public:
  */
 class Expr::Call : public Expr {
 public:
+    /**
+     * @brief The operations built into the language that are called like functions, e.g. `vec::sum(v)` or `bits::count_ones(x)`.
+     * Their names are only builtins where no variable of the same name was declared.
+     *
+     */
+    enum class Builtin {
+        // Not a builtin; a call to a function.
+        NONE,
+        // `vec::load(values, start, mask)`: loads the lanes of an array or slice that the mask enables; the others are zero.
+        VEC_LOAD,
+        // `vec::store(values, start, v)` or `vec::store(values, start, v, mask)`: stores the lanes, or the ones the mask enables.
+        VEC_STORE,
+        // `vec::shuffle(a, [lanes])` or `vec::shuffle(a, b, [lanes])`: picks lanes of `a`, then `b`, by literal index.
+        VEC_SHUFFLE,
+        // `vec::select(mask, a, b)`: picks each lane from `a` where the mask is true, and from `b` otherwise.
+        VEC_SELECT,
+        // `vec::sum(v)`: adds up the lanes.
+        VEC_SUM,
+        // `vec::product(v)`: multiplies the lanes.
+        VEC_PRODUCT,
+        // `vec::min(v)`: the smallest lane.
+        VEC_MIN,
+        // `vec::max(v)`: the largest lane.
+        VEC_MAX,
+        // `vec::all(mask)`: whether every lane is true.
+        VEC_ALL,
+        // `vec::any(mask)`: whether any lane is true.
+        VEC_ANY,
+        // `bits::count_ones(x)`: the number of bits that are set.
+        BITS_COUNT_ONES,
+        // `bits::leading_zeros(x)`: the number of clear bits above the highest set one; the width of `x` if it is 0.
+        BITS_LEADING_ZEROS,
+        // `bits::trailing_zeros(x)`: the number of clear bits below the lowest set one; the width of `x` if it is 0.
+        BITS_TRAILING_ZEROS,
+        // `bits::swap_bytes(x)`: the bytes in the opposite order, e.g. to convert between little and big endian.
+        BITS_SWAP_BYTES,
+    };
+
     Call(std::shared_ptr<Expr> callee, Token paren, std::vector<std::shared_ptr<Expr>>& arguments)
         : callee(callee), paren(paren), arguments(arguments) {
         location = paren.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_call_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_call_expr)
 
     // The expression being called.
     std::shared_ptr<Expr> callee;
@@ -290,6 +340,11 @@ public:
     Token paren;
     // The arguments to the call.
     std::vector<std::shared_ptr<Expr>> arguments;
+    // The builtin the callee names, found by the local checker; the callee itself is then never visited again.
+    Builtin builtin = Builtin::NONE;
+    // The index of the enum variant the callee names, which the call constructs with its arguments as the payload; -1 if it names none.
+    // Set by the local checker; the enum is the type of the call.
+    int variant = -1;
 };
 
 /**
@@ -304,9 +359,7 @@ public:
         location = as_kw.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_cast_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_cast_expr)
 
     // The expression to cast.
     std::shared_ptr<Expr> expression;
@@ -327,9 +380,7 @@ public:
         location = expression->location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_grouping_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_grouping_expr)
 
     // The expression inside the grouping.
     std::shared_ptr<Expr> expression;
@@ -350,12 +401,17 @@ public:
         location = token.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_identifier_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_identifier_expr)
 
     // The tokens representing the identifier. The most general identifier is at the front. The most specific is at the back.
     std::vector<Token> tokens;
+    // The type arguments given to the tokens that name generics, e.g. `max::<i32>`. Either empty or one list per token.
+    std::vector<std::vector<std::shared_ptr<Annotation>>> type_args;
+    // The variable the identifier resolves to. Set by the local checker.
+    std::shared_ptr<Node::Variable> variable = nullptr;
+    // The index of the enum variant without a payload the identifier names instead of a variable; -1 if it names none.
+    // Set by the local checker; the enum is the type of the identifier.
+    int variant = -1;
 
     /**
      * @brief Converts the identifier to a string.
@@ -364,8 +420,16 @@ public:
      */
     std::string to_string() {
         std::string str = "";
-        for (auto& token : tokens) {
-            str += token.lexeme + "::";
+        for (size_t i = 0; i < tokens.size(); i++) {
+            str += tokens[i].lexeme + "::";
+            if (i < type_args.size() && !type_args[i].empty()) {
+                str += "<";
+                for (size_t j = 0; j < type_args[i].size(); j++) {
+                    str += type_args[i][j]->to_string();
+                    str += j < type_args[i].size() - 1 ? ", " : "";
+                }
+                str += ">::";
+            }
         }
         return str.substr(0, str.size() - 2);
     }
@@ -385,9 +449,7 @@ public:
         location = token.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_literal_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_literal_expr)
 
     // The token representing the literal value.
     Token token;
@@ -404,9 +466,7 @@ public:
         location = bracket.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_array_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_array_expr)
     // The token representing the opening bracket.
     Token bracket;
 
@@ -425,9 +485,7 @@ public:
         location = bracket.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_array_gen_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_array_gen_expr)
 
     // The token representing the opening bracket.
     Token bracket;
@@ -452,9 +510,7 @@ public:
         location = paren.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_tuple_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_tuple_expr)
 
     // The elements of the tuple.
     std::vector<std::shared_ptr<Expr>> elements;
@@ -475,9 +531,7 @@ public:
         location = colon.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_object_expr(this);
-    }
+    IMPLEMENT_ACCEPT(visit_object_expr)
 
     // The token representing the colon.
     Token colon;
@@ -487,4 +541,48 @@ public:
     Dictionary<std::string, std::shared_ptr<Expr>> fields;
 };
 
+/**
+ * @brief A class representing a heap allocation.
+ * `alloc t` allocates one zeroed `t` and yields a `t*`; `alloc [t; n]` allocates `n` zeroed elements and yields a `[t]`.
+ * The memory comes from the Niter runtime allocator and must be returned with `dealloc`.
+ * `t` may not hold aggregates inside it, which would need storage of their own; it may hold pointers to them.
+ *
+ */
+class Expr::Alloc : public Expr {
+public:
+    Alloc(Token keyword, std::shared_ptr<Annotation> annotation, std::shared_ptr<Expr> count)
+        : keyword(keyword), annotation(annotation), count(count) {
+        location = keyword.location;
+    }
+
+    IMPLEMENT_ACCEPT(visit_alloc_expr)
+
+    // The token representing the `alloc` keyword.
+    Token keyword;
+    // The annotation of the type to allocate; the element type if there is a count.
+    std::shared_ptr<Annotation> annotation;
+    // The number of elements to allocate, or nullptr to allocate a single value.
+    std::shared_ptr<Expr> count;
+};
+
+/**
+ * @brief A class representing a heap deallocation.
+ * `dealloc p` returns memory from `alloc` to the runtime allocator; `p` is a pointer or a slice, exactly as `alloc` returned it.
+ *
+ */
+class Expr::Dealloc : public Expr {
+public:
+    Dealloc(Token keyword, std::shared_ptr<Expr> expression)
+        : keyword(keyword), expression(expression) {
+        location = keyword.location;
+    }
+
+    IMPLEMENT_ACCEPT(visit_dealloc_expr)
+
+    // The token representing the `dealloc` keyword.
+    Token keyword;
+    // The pointer or slice to deallocate.
+    std::shared_ptr<Expr> expression;
+};
+
 #endif // EXPR_H
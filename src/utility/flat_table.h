@@ -0,0 +1,150 @@
+#ifndef FLAT_TABLE_H
+#define FLAT_TABLE_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A flat table of key-value pairs, the storage behind ScopeTable and Dictionary.
+ * Entries are stored once, contiguously, in insertion order.
+ * Small tables are searched linearly; larger tables add an open-addressing index over the entries.
+ * Lookups never modify the table, so a finished table may be read from several threads at once.
+ *
+ * @tparam K The key type.
+ * @tparam V The value type.
+ * @tparam Hash The hash function. It is called with whatever type lookups use, which must compare equal to K.
+ */
+template <typename K, typename V, typename Hash>
+class FlatTable {
+public:
+    using iterator = typename std::vector<std::pair<K, V>>::iterator;
+    using const_iterator = typename std::vector<std::pair<K, V>>::const_iterator;
+
+private:
+    // The entries of the table, in insertion order.
+    std::vector<std::pair<K, V>> entries;
+    // Open-addressing index into `entries`; each slot holds an entry index plus one, or 0 if empty.
+    // Only built once the table outgrows a linear scan.
+    std::vector<uint32_t> slots;
+
+    // The number of entries that are searched linearly before the index is built.
+    static constexpr size_t LINEAR_LIMIT = 8;
+
+    template <typename L>
+    size_t slot_of(const L& key) const {
+        return Hash{}(key) & (slots.size() - 1);
+    }
+
+    void index_entry(uint32_t entry_index) {
+        size_t slot = slot_of(entries[entry_index].first);
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & (slots.size() - 1);
+        }
+        slots[slot] = entry_index + 1;
+    }
+
+    void rebuild_index() {
+        // The index is kept at most half full; sizes stay powers of two so probing can mask.
+        size_t capacity = LINEAR_LIMIT * 4;
+        while (capacity < entries.size() * 2) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, 0);
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            index_entry(i);
+        }
+    }
+
+public:
+    /**
+     * @brief Find the index of a key.
+     *
+     * @tparam L The type the key is looked up as, e.g. std::string_view for std::string keys.
+     * @param key The key.
+     * @return long The index of the entry, or -1 if the key is not in the table.
+     */
+    template <typename L>
+    long index_of(const L& key) const {
+        if (slots.empty()) {
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (entries[i].first == key) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+        for (size_t slot = slot_of(key); slots[slot] != 0; slot = (slot + 1) & (slots.size() - 1)) {
+            if (entries[slots[slot] - 1].first == key) {
+                return slots[slot] - 1;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Add an entry to the end of the table. The key must not be in the table yet.
+     *
+     * @param key The key.
+     * @param value The value.
+     * @return V& A reference to the value in the table.
+     */
+    V& append(K key, V value) {
+        entries.emplace_back(std::move(key), std::move(value));
+        if (!slots.empty() && entries.size() * 2 <= slots.size()) {
+            index_entry(entries.size() - 1);
+        } else if (entries.size() > LINEAR_LIMIT) {
+            rebuild_index();
+        }
+        return entries.back().second;
+    }
+
+    /**
+     * @brief Get the entry at an index.
+     *
+     * @param index The index.
+     * @return std::pair<K, V>& The entry.
+     * @throw std::out_of_range If the index is out of bounds.
+     */
+    std::pair<K, V>& entry_at(size_t index) {
+        return entries.at(index);
+    }
+
+    const std::pair<K, V>& entry_at(size_t index) const {
+        return entries.at(index);
+    }
+
+    /**
+     * @brief Find the entry for a key.
+     *
+     * @param key The key.
+     * @return iterator An iterator to the entry, or end() if the key is not in the table.
+     */
+    template <typename L>
+    iterator find(const L& key) {
+        long index = index_of(key);
+        return index == -1 ? entries.end() : entries.begin() + index;
+    }
+
+    template <typename L>
+    const_iterator find(const L& key) const {
+        long index = index_of(key);
+        return index == -1 ? entries.end() : entries.begin() + index;
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    void clear() {
+        entries.clear();
+        slots.clear();
+    }
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+};
+
+#endif // FLAT_TABLE_H
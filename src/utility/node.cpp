@@ -1,56 +1,64 @@
 #include "node.h"
 
-#include "../checker/environment.h"
+#include "decl.h"
 
-int Node::local_scope_count = 0;
-
-std::shared_ptr<Node> Node::Scope::upward_lookup(const std::string& name) {
-    if (children.find(name) != children.end()) {
-        return children[name];
-    } else if (auto parent_sptr = parent.lock()) {
-        // If parent is not null...
-        return parent_sptr->upward_lookup(name);
-    } else {
+std::shared_ptr<Node> Node::Scope::upward_lookup(Symbol name) {
+    if (name.empty()) {
         return nullptr;
     }
+    for (Scope* scope = this; scope != nullptr; scope = scope->parent_scope) {
+        auto iter = scope->children.find(name);
+        if (iter != scope->children.end()) {
+            return iter->second;
+        }
+    }
+    return nullptr;
 }
 
-std::shared_ptr<Node> Node::Scope::downward_lookup(const std::vector<std::string>& path) {
+std::shared_ptr<Node> Node::Scope::downward_lookup(const std::vector<Symbol>& path) {
     if (path.empty()) {
         return nullptr;
     }
 
-    bool found = true;
-    Scope* current = this;
     // E.g. if the identifier is A::B::c, attempt to enter scope A, then B, then find c.
-    // Iterate through all but the last element in the path. E.g. for A::B::c, iterate through A and B.
-    for (unsigned i = 0; i < path.size() - 1; i++) {
-        // See if 'A' exists in the current scope.
-        if (current->children.find(path[i]) == current->children.end()) {
-            found = false;
-            break;
+    // If that fails, try again from the parent scope.
+    for (Scope* start = this; start != nullptr; start = start->parent_scope) {
+        Scope* current = start;
+        // Iterate through all but the last element in the path. E.g. for A::B::c, iterate through A and B.
+        for (size_t i = 0; current != nullptr && i < path.size() - 1; i++) {
+            auto iter = current->children.find(path[i]);
+            // If 'A' does not exist or turns out not to be a scope, then the path is invalid from here.
+            current = iter != current->children.end() ? dynamic_cast<Scope*>(iter->second.get()) : nullptr;
         }
-        // If 'A' exists, enter the scope.
-        current = dynamic_cast<Scope*>(current->children[path[i]].get());
-        // If 'A' turns out not to be a scope, then the path is invalid.
         if (current == nullptr) {
-            found = false;
-            break;
+            continue;
+        }
+        // If we found 'A::B::c', return it.
+        auto iter = current->children.find(path.back());
+        if (iter != current->children.end()) {
+            return iter->second;
         }
-        // Else, continue and start looking for 'B'.
     }
-    // If we didn't find 'A' or 'B', or 'A::B' does not contain 'c', then try again from the parent scope.
-    if (!found || current->children.find(path.back()) == current->children.end()) {
-        auto parent_sptr = parent.lock();
-        return parent_sptr != nullptr ? parent_sptr->downward_lookup(path) : nullptr;
+    return nullptr;
+}
+
+std::shared_ptr<Node> Node::Scope::downward_lookup(const std::vector<std::string>& path) {
+    std::vector<Symbol> symbols;
+    symbols.reserve(path.size());
+    for (auto& name : path) {
+        auto symbol = Symbol::find(name);
+        // A name that was never interned is not in any scope.
+        if (symbol.empty()) {
+            return nullptr;
+        }
+        symbols.push_back(symbol);
     }
-    // If we found 'A::B::c', return it.
-    return current->children[path.back()];
+    return downward_lookup(symbols);
 }
 
-Node::StructScope::StructScope(const Location& location, std::shared_ptr<Scope> parent, const std::string& name, llvm::Type* llvm_type) {
+Node::StructScope::StructScope(const Location& location, std::shared_ptr<Scope> parent, const std::string& name, llvm::LLVMContext& context, llvm::Type* llvm_type) {
     this->location = location;
-    this->parent = parent;
+    set_parent(parent);
     unique_name = parent->unique_name + "::" + name;
     // The struct type will be provided for primitive types.
     ir_type = llvm_type;
@@ -60,7 +68,7 @@ Node::StructScope::StructScope(const Location& location, std::shared_ptr<Scope>
         auto llvm_safe_name = unique_name;
         std::replace(llvm_safe_name.begin(), llvm_safe_name.end(), ':', '_');
 
-        ir_type = llvm::StructType::create(*Environment::inst().get_llvm_context(), llvm_safe_name);
+        ir_type = llvm::StructType::create(context, llvm_safe_name);
     }
 }
 
@@ -72,3 +80,13 @@ Node::Variable::Variable(
     this->parent = parent;
     unique_name = parent->unique_name + "::" + declaration->name.lexeme;
 }
+
+Node::Generic::Generic(
+    std::shared_ptr<Scope> parent,
+    Decl* declaration,
+    const Token& name
+) : decl(declaration) {
+    this->location = name.location;
+    this->parent = parent;
+    unique_name = parent->unique_name + "::" + name.lexeme;
+}
@@ -5,6 +5,8 @@
 
 #include "../scanner/token.h"
 #include "../utility/dictionary.h"
+#include "../utility/scope_table.h"
+#include "../utility/symbol.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Type.h"
 #include <algorithm>
@@ -22,8 +24,12 @@ class Node::Scope : public virtual Node {
 public:
     virtual ~Scope() = default;
 
-    // The children of this scope. The key is the name of the child.
-    std::unordered_map<std::string, std::shared_ptr<Node>> children;
+    // The children of this scope. The key is the interned name of the child.
+    ScopeTable<std::shared_ptr<Node>> children;
+
+    // A non-owning copy of `parent`, used to walk up the tree without locking the weak pointer.
+    // A scope never outlives its parent while it is being searched: the tree owns its scopes, and local scopes are stacked.
+    Scope* parent_scope = nullptr;
 
     /**
      * @brief Perform an upward lookup for a node with the given name.
@@ -33,7 +39,18 @@ public:
      * @param name The name of the node to look for.
      * @return std::shared_ptr<Node> A shared pointer to the node if it is found, or nullptr if it is not found.
      */
-    std::shared_ptr<Node> upward_lookup(const std::string& name);
+    std::shared_ptr<Node> upward_lookup(Symbol name);
+
+    /**
+     * @brief Perform an upward lookup for a node with the given name.
+     * The name is not interned; a name that was never interned cannot be found.
+     *
+     * @param name The name of the node to look for.
+     * @return std::shared_ptr<Node> A shared pointer to the node if it is found, or nullptr if it is not found.
+     */
+    std::shared_ptr<Node> upward_lookup(std::string_view name) {
+        return upward_lookup(Symbol::find(name));
+    }
 
     /**
      * @brief Perform a downward lookup for a node with the given path.
@@ -44,7 +61,27 @@ public:
      * E.g. for A::B::c, the path is {"A", "B", "c"}.
      * @return std::shared_ptr<Node> A shared pointer to the node if it is found, or nullptr if it is not found.
      */
+    std::shared_ptr<Node> downward_lookup(const std::vector<Symbol>& path);
+
+    /**
+     * @brief Perform a downward lookup for a node with the given path of names.
+     * The names are not interned; a path containing a name that was never interned cannot be found.
+     *
+     * @param path The path to the node to look for.
+     * @return std::shared_ptr<Node> A shared pointer to the node if it is found, or nullptr if it is not found.
+     */
     std::shared_ptr<Node> downward_lookup(const std::vector<std::string>& path);
+
+protected:
+    /**
+     * @brief Sets the parent of this scope.
+     *
+     * @param parent The parent scope.
+     */
+    void set_parent(std::shared_ptr<Scope> parent) {
+        this->parent = parent;
+        parent_scope = parent.get();
+    }
 };
 
 /**
@@ -80,7 +117,7 @@ class Node::NamespaceScope : public Node::Scope, public Node::Locatable {
 public:
     NamespaceScope(const Location& location, std::shared_ptr<Scope> parent, const std::string& name) {
         this->location = location;
-        this->parent = parent;
+        set_parent(parent);
         unique_name = parent->unique_name + "::" + name;
     }
 };
@@ -101,8 +138,19 @@ public:
 
     llvm::Type* ir_type = nullptr;
     bool is_primitive = false;
+    // The declaration of the enum the scope represents, or nullptr if it is a struct
+    Decl::Enum* enum_decl = nullptr;
 
-    StructScope(const Location& location, std::shared_ptr<Scope> parent, const std::string& name, llvm::Type* llvm_type = nullptr);
+    /**
+     * @brief Creates a struct scope.
+     *
+     * @param location The location of the struct declaration.
+     * @param parent The parent scope.
+     * @param name The name of the struct.
+     * @param context The LLVM context of the compilation; used to create the struct type.
+     * @param llvm_type The LLVM type of the struct. Provided for primitive types; if nullptr, a new named struct type is created.
+     */
+    StructScope(const Location& location, std::shared_ptr<Scope> parent, const std::string& name, llvm::LLVMContext& context, llvm::Type* llvm_type = nullptr);
 };
 
 /**
@@ -116,9 +164,15 @@ public:
  */
 class Node::LocalScope : public Node::Scope {
 public:
-    LocalScope(std::shared_ptr<Scope> parent) {
-        this->parent = parent;
-        unique_name = parent->unique_name + "::" + std::to_string(local_scope_count++);
+    /**
+     * @brief Creates a local scope.
+     *
+     * @param parent The parent scope.
+     * @param id A number unique among the local scopes of the compilation. Used for generating unique names.
+     */
+    LocalScope(std::shared_ptr<Scope> parent, int id) {
+        set_parent(parent);
+        unique_name = parent->unique_name + "::" + std::to_string(id);
     }
 };
 
@@ -143,4 +197,24 @@ public:
     );
 };
 
+/**
+ * @brief A node that represents a generic struct or function.
+ * The generic declaration is never checked itself. It is instantiated for each list of type arguments it is used with,
+ * and each instance is declared next to it under its instance name, e.g. `Box<::i32>` next to `Box`.
+ *
+ */
+class Node::Generic : public Node::Locatable {
+public:
+    // The generic declaration; a Decl::Struct or a Decl::Fun with type parameters.
+    Decl* decl;
+    // The instances created so far, by instance name. nullptr for type arguments that could not be instantiated.
+    std::unordered_map<std::string, std::shared_ptr<Decl>> instances;
+
+    Generic(
+        std::shared_ptr<Scope> parent,
+        Decl* declaration,
+        const Token& name
+    );
+};
+
 #endif // NODE_H
@@ -0,0 +1,119 @@
+#ifndef SCOPE_TABLE_H
+#define SCOPE_TABLE_H
+
+#include "flat_table.h"
+#include "symbol.h"
+#include <stdexcept>
+#include <string_view>
+
+/**
+ * @brief A flat table mapping symbols to the nodes of a scope.
+ * Entries are stored contiguously in insertion order, in a FlatTable.
+ * Most scopes only hold a handful of names, so they are searched linearly;
+ * lookups never modify the table, so a finished table may be read from several threads at once.
+ *
+ * @tparam V The value type.
+ */
+template <typename V>
+class ScopeTable {
+    struct SymbolHash {
+        size_t operator()(Symbol key) const {
+            // Multiplicative hashing scatters the dense symbol ids over the index.
+            return key.get_id() * 0x9E3779B9u;
+        }
+    };
+
+    FlatTable<Symbol, V, SymbolHash> table;
+
+    long index_of(Symbol key) const {
+        return key.empty() ? -1 : table.index_of(key);
+    }
+
+public:
+    using iterator = typename FlatTable<Symbol, V, SymbolHash>::iterator;
+    using const_iterator = typename FlatTable<Symbol, V, SymbolHash>::const_iterator;
+
+    /**
+     * @brief Find the entry for a symbol.
+     *
+     * @param key The symbol.
+     * @return iterator An iterator to the entry, or end() if the symbol is not in the table.
+     */
+    iterator find(Symbol key) {
+        return key.empty() ? table.end() : table.find(key);
+    }
+
+    const_iterator find(Symbol key) const {
+        return key.empty() ? table.end() : table.find(key);
+    }
+
+    /**
+     * @brief Find the entry for a name.
+     * The name is not interned; a name that was never interned cannot be in the table.
+     *
+     * @param name The name.
+     * @return iterator An iterator to the entry, or end() if the name is not in the table.
+     */
+    iterator find(std::string_view name) {
+        return find(Symbol::find(name));
+    }
+
+    const_iterator find(std::string_view name) const {
+        return find(Symbol::find(name));
+    }
+
+    /**
+     * @brief Access the value associated with a symbol, inserting a default value if it does not exist.
+     *
+     * @param key The symbol.
+     * @return V& A reference to the value.
+     */
+    V& operator[](Symbol key) {
+        long index = index_of(key);
+        if (index != -1) {
+            return table.entry_at(index).second;
+        }
+        return table.append(key, V());
+    }
+
+    /**
+     * @brief Access the value associated with a name, interning the name and inserting a default value if it does not exist.
+     *
+     * @param name The name.
+     * @return V& A reference to the value.
+     */
+    V& operator[](std::string_view name) {
+        return (*this)[Symbol::intern(name)];
+    }
+
+    /**
+     * @brief Access the value associated with a name.
+     *
+     * @param name The name.
+     * @return V& A reference to the value.
+     * @throw std::out_of_range If the name is not in the table.
+     */
+    V& at(std::string_view name) {
+        long index = index_of(Symbol::find(name));
+        if (index == -1) {
+            throw std::out_of_range("ScopeTable::at");
+        }
+        return table.entry_at(index).second;
+    }
+
+    /**
+     * @brief Gets the number of entries in the table.
+     *
+     * @return size_t The number of entries.
+     */
+    size_t size() const {
+        return table.size();
+    }
+
+    iterator begin() { return table.begin(); }
+    iterator end() { return table.end(); }
+    const_iterator begin() const { return table.begin(); }
+    const_iterator end() const { return table.end(); }
+};
+
+#endif // SCOPE_TABLE_H
@@ -6,7 +6,6 @@
 #include "../scanner/token.h"
 #include "decl.h"
 #include "expr.h"
-#include <any>
 #include <memory>
 
 /**
@@ -20,9 +19,7 @@ public:
         location = declaration->location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_declaration_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_declaration_stmt)
 
     // The declaration in the statement
     std::shared_ptr<Decl> declaration;
@@ -39,9 +36,7 @@ public:
         location = expression->location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_expression_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_expression_stmt)
 
     // The expression in the statement
     std::shared_ptr<Expr> expression;
@@ -59,9 +54,7 @@ public:
         location = condition->location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_conditional_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_conditional_stmt)
 
     // The keyword that signifies the conditional statement.
     Token keyword;
@@ -73,6 +66,24 @@ public:
     std::vector<std::shared_ptr<Stmt>> else_branch;
 };
 
+/**
+ * @brief Optimization hints for a loop, written as annotations before it.
+ * E.g. `@vectorize(4) @unroll(2) while i < n { ... }`.
+ *
+ */
+struct LoopHints {
+    // `@vectorize` or `@vectorize(width)`: vectorize the loop.
+    bool vectorize = false;
+    // The vectorization width; 0 lets the optimizer choose, 1 disables vectorization.
+    unsigned vectorize_width = 0;
+    // `@unroll` or `@unroll(count)`: unroll the loop.
+    bool unroll = false;
+    // The unroll count; 0 lets the optimizer choose, 1 disables unrolling.
+    unsigned unroll_count = 0;
+    // `@parallel`: no iteration reads or writes memory that another iteration writes, so iterations may run in any order.
+    bool parallel = false;
+};
+
 /**
  * @brief A class representing a loop statement.
  * Loop statements contain an expression for the condition and a list of statements for the loop body.
@@ -85,9 +96,7 @@ public:
         location = condition->location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_loop_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_loop_stmt)
 
     // The keyword that signifies the loop statement.
     Token keyword;
@@ -95,6 +104,77 @@ public:
     std::shared_ptr<Expr> condition;
     // The statements in the loop body
     std::vector<std::shared_ptr<Stmt>> body;
+    // The optimization hints from the annotations before the loop
+    LoopHints hints;
+};
+
+/**
+ * @brief A class representing a for statement.
+ * For statements declare a constant loop variable that takes every value of an integer range or every element of a sized array.
+ * E.g. `for i in 0..n { ... }` or `for x in values { ... }`.
+ *
+ */
+class Stmt::For : public Stmt {
+public:
+    For(Token keyword, std::shared_ptr<Decl::Var> variable, std::shared_ptr<Expr> start, std::shared_ptr<Expr> end, std::vector<std::shared_ptr<Stmt>> body)
+        : keyword(keyword), variable(variable), start(start), end(end), body(body) {
+        location = keyword.location;
+    }
+
+    IMPLEMENT_ACCEPT(visit_for_stmt)
+
+    // The keyword that signifies the for statement.
+    Token keyword;
+    // The loop variable. It has no initializer; its type is inferred from the range or array.
+    std::shared_ptr<Decl::Var> variable;
+    // The start of the range (inclusive), or the array to iterate over if `end` is nullptr
+    std::shared_ptr<Expr> start;
+    // The end of the range (exclusive), or nullptr if the loop iterates over an array
+    std::shared_ptr<Expr> end;
+    // The statements in the loop body
+    std::vector<std::shared_ptr<Stmt>> body;
+    // The optimization hints from the annotations before the loop
+    LoopHints hints;
+};
+
+/**
+ * @brief A class representing a match statement.
+ * Match statements run the arm whose pattern names the variant of an enum value, binding its payload to constants.
+ * E.g. `match shape { Circle(r) => { ... } Rect(w, h) => { ... } _ => { ... } }`.
+ *
+ */
+class Stmt::Match : public Stmt {
+public:
+    /**
+     * @brief An arm of a match statement.
+     *
+     */
+    struct Arm {
+        // The path of the variant the arm matches, e.g. `Shape::Circle` or `Circle`. A single `_` matches any other variant.
+        std::vector<Token> pattern;
+        // The constants the payload fields are bound to, in order. A binding named `_` ignores its field.
+        std::vector<std::shared_ptr<Decl::Var>> bindings;
+        // Whether the pattern was followed by a parenthesized list of bindings.
+        bool has_bindings = false;
+        // The statements run when the arm matches.
+        std::vector<std::shared_ptr<Stmt>> body;
+        // The index of the variant the arm matches, or -1 for the wildcard. Set by the local checker.
+        int variant = -1;
+    };
+
+    Match(Token keyword, std::shared_ptr<Expr> value, std::vector<Arm> arms)
+        : keyword(keyword), value(value), arms(arms) {
+        location = keyword.location;
+    }
+
+    IMPLEMENT_ACCEPT(visit_match_stmt)
+
+    // The keyword that signifies the match statement.
+    Token keyword;
+    // The enum value to match
+    std::shared_ptr<Expr> value;
+    // The arms, in source order
+    std::vector<Arm> arms;
 };
 
 /**
@@ -108,9 +188,7 @@ public:
         location = keyword.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_return_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_return_stmt)
 
     // The keyword that signifies the return statement.
     Token keyword;
@@ -131,9 +209,7 @@ public:
         location = keyword.location;
     }
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_break_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_break_stmt)
 
     // The keyword that signifies the break statement.
     Token keyword;
@@ -149,9 +225,7 @@ class Stmt::EndOfFile : public Stmt {
 public:
     EndOfFile() {}
 
-    std::any accept(Visitor* visitor) override {
-        return visitor->visit_eof_stmt(this);
-    }
+    IMPLEMENT_ACCEPT(visit_eof_stmt)
 };
 
 #endif // STMT_H
@@ -0,0 +1,63 @@
+#include "symbol.h"
+
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace {
+
+/**
+ * @brief The process-wide storage behind Symbol.
+ * Names live in a deque so that references handed out by Symbol::str stay valid as the table grows.
+ *
+ */
+struct SymbolTable {
+    std::shared_mutex mutex;
+    // Index 0 holds the name of the empty symbol.
+    std::deque<std::string> names = {""};
+    // Keys view into `names`.
+    std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+SymbolTable& symbol_table() {
+    static SymbolTable table;
+    return table;
+}
+
+} // namespace
+
+Symbol Symbol::intern(std::string_view name) {
+    auto& table = symbol_table();
+    {
+        std::shared_lock lock(table.mutex);
+        auto iter = table.ids.find(name);
+        if (iter != table.ids.end()) {
+            return Symbol(iter->second);
+        }
+    }
+
+    std::unique_lock lock(table.mutex);
+    // Another thread may have interned the name between the two locks.
+    auto iter = table.ids.find(name);
+    if (iter != table.ids.end()) {
+        return Symbol(iter->second);
+    }
+    uint32_t id = table.names.size();
+    table.names.emplace_back(name);
+    table.ids.emplace(table.names.back(), id);
+    return Symbol(id);
+}
+
+Symbol Symbol::find(std::string_view name) {
+    auto& table = symbol_table();
+    std::shared_lock lock(table.mutex);
+    auto iter = table.ids.find(name);
+    return iter != table.ids.end() ? Symbol(iter->second) : Symbol();
+}
+
+const std::string& Symbol::str() const {
+    auto& table = symbol_table();
+    std::shared_lock lock(table.mutex);
+    return table.names[id];
+}
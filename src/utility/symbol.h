@@ -0,0 +1,79 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief An interned identifier.
+ * Every distinct name is stored exactly once in a process-wide table and is referred to by a small integer id.
+ * Comparing and hashing symbols is therefore a single integer operation, which is what scope lookups need.
+ * The table is append-only and safe to use from multiple threads.
+ *
+ */
+class Symbol {
+    // The id of the symbol; 0 is reserved for the empty symbol.
+    uint32_t id = 0;
+
+    explicit Symbol(uint32_t id) : id(id) {}
+
+public:
+    /**
+     * @brief Creates the empty symbol, which is distinct from every interned name.
+     *
+     */
+    Symbol() = default;
+
+    /**
+     * @brief Interns a name, adding it to the symbol table if it has not been seen before.
+     *
+     * @param name The name to intern.
+     * @return Symbol The symbol for the name.
+     */
+    static Symbol intern(std::string_view name);
+
+    /**
+     * @brief Finds the symbol for a name without interning it.
+     * A name that was never interned cannot be stored in any scope, so lookups can fail early with the empty symbol.
+     *
+     * @param name The name to look for.
+     * @return Symbol The symbol for the name, or the empty symbol if the name has never been interned.
+     */
+    static Symbol find(std::string_view name);
+
+    /**
+     * @brief Gets the name of the symbol.
+     *
+     * @return const std::string& The interned name. Empty for the empty symbol.
+     */
+    const std::string& str() const;
+
+    /**
+     * @brief Checks if this is the empty symbol.
+     *
+     * @return true If the symbol does not refer to any name.
+     * @return false Otherwise.
+     */
+    bool empty() const { return id == 0; }
+
+    /**
+     * @brief Gets the id of the symbol. Ids are dense and start at 1.
+     *
+     * @return uint32_t The id.
+     */
+    uint32_t get_id() const { return id; }
+
+    bool operator==(const Symbol& other) const { return id == other.id; }
+    bool operator!=(const Symbol& other) const { return id != other.id; }
+};
+
+template <>
+struct std::hash<Symbol> {
+    size_t operator()(const Symbol& symbol) const {
+        return symbol.get_id();
+    }
+};
+
+#endif // SYMBOL_H
@@ -33,7 +33,7 @@ public:
      * @param context The llvm context.
      * @return llvm::Type* The actual llvm type of the aggregate type.
      */
-    virtual llvm::Type* to_llvm_aggregate_type(std::shared_ptr<llvm::LLVMContext> context) const = 0;
+    virtual llvm::Type* to_llvm_aggregate_type(const std::shared_ptr<llvm::LLVMContext>& context) const = 0;
 };
 
 /**
@@ -51,7 +51,7 @@ public:
     Type::Kind kind() const override { return Type::Kind::STRUCT; }
     std::string to_string() const override { return struct_scope->unique_name; }
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
         return struct_scope->ir_type;
     }
 
@@ -71,11 +71,11 @@ public:
 
     Struct(std::shared_ptr<Node::StructScope> struct_scope) : Named(struct_scope) {}
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
         return llvm::PointerType::getUnqual(struct_scope->ir_type);
     }
 
-    llvm::Type* to_llvm_aggregate_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_aggregate_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
         return struct_scope->ir_type;
     }
 };
@@ -96,6 +96,12 @@ public:
     // Whether the function is variadic. Currently only allowed for external functions.
     bool is_variadic = false;
 
+private:
+    // The memoized LLVM function type.
+    mutable LoweringCache lowering;
+
+public:
+
     virtual ~Function() = default;
     Type::Kind kind() const override { return Type::Kind::FUNCTION; }
     std::string to_string() const override {
@@ -114,20 +120,29 @@ public:
         return str;
     }
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
+        if (auto cached = lowering.get(context)) {
+            return cached;
+        }
+
         std::vector<llvm::Type*> param_types;
-        for (auto& param : params) {
-            param_types.push_back(param.second->to_llvm_type(context));
+        param_types.reserve(params.size() + 1);
+
+        // An aggregate is returned through a pointer to storage provided by the caller, passed as the first parameter.
+        if (std::dynamic_pointer_cast<Aggregate>(return_type)) {
+            param_types.push_back(llvm::PointerType::getUnqual(*context));
+            for (auto& param : params) {
+                param_types.push_back(param.second->to_llvm_type(context));
+            }
+            return lowering.set(context, llvm::FunctionType::get(llvm::Type::getVoidTy(*context), param_types, is_variadic));
         }
 
-        // If the function's return type is aggregate, return the actual type.
-        auto aggregate_return_type = std::dynamic_pointer_cast<Aggregate>(return_type);
-        if (aggregate_return_type) {
-            return llvm::FunctionType::get(aggregate_return_type->to_llvm_aggregate_type(context), param_types, is_variadic);
+        for (auto& param : params) {
+            param_types.push_back(param.second->to_llvm_type(context));
         }
 
         auto fun_type = llvm::FunctionType::get(return_type->to_llvm_type(context), param_types, is_variadic);
-        return fun_type;
+        return lowering.set(context, fun_type);
     }
 
     Function(
@@ -150,6 +165,12 @@ public:
     // The size of the array. -1 if the size is not known.
     int size = -1;
 
+private:
+    // The memoized LLVM array type.
+    mutable LoweringCache lowering;
+
+public:
+
     virtual ~Array() = default;
     Type::Kind kind() const override { return Type::Kind::ARRAY; }
     std::string to_string() const override {
@@ -157,12 +178,15 @@ public:
         return "[" + inner_type->to_string() + "; " + size_string + "]";
     }
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
         return llvm::PointerType::getUnqual(to_llvm_aggregate_type(context));
     }
 
-    llvm::Type* to_llvm_aggregate_type(std::shared_ptr<llvm::LLVMContext> context) const override {
-        return llvm::ArrayType::get(inner_type->to_llvm_type(context), size);
+    llvm::Type* to_llvm_aggregate_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
+        if (auto cached = lowering.get(context)) {
+            return cached;
+        }
+        return lowering.set(context, llvm::ArrayType::get(inner_type->to_llvm_type(context), size));
     }
 
     Array(std::shared_ptr<Type> inner_type, int size) : inner_type(inner_type), size(size) {}
@@ -185,13 +209,66 @@ public:
     Type::Kind kind() const override { return Type::Kind::POINTER; }
     std::string to_string() const override { return inner_type->to_string() + "*"; }
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
         return llvm::PointerType::get(inner_type->to_llvm_type(context), 0);
     }
 
     Pointer(std::shared_ptr<Type> inner_type) : inner_type(inner_type) {}
 };
 
+/**
+ * @brief A class representing a slice type, written `[t]` or `[t; *]`.
+ * A slice is a view of a run of elements stored elsewhere: a pointer to the first element and the number of elements.
+ * Unlike arrays, slices are not aggregates; they are passed around by value, and copying a slice never copies the elements.
+ * Sized arrays convert implicitly to slices of the whole array.
+ *
+ */
+class Type::Slice : public Type {
+public:
+    // The declarer of the slice type. Use to determine if the elements can be mutated through this slice. Default is KW_VAR.
+    TokenType declarer = KW_VAR;
+
+    // The element type of the slice.
+    std::shared_ptr<Type> inner_type = nullptr;
+
+    virtual ~Slice() = default;
+    Type::Kind kind() const override { return Type::Kind::SLICE; }
+    std::string to_string() const override { return "[" + inner_type->to_string() + "]"; }
+
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
+        // `{T*, i64}`; literal structs are uniqued by LLVM, so there is nothing to cache.
+        return llvm::StructType::get(*context, {llvm::PointerType::get(inner_type->to_llvm_type(context), 0), llvm::Type::getInt64Ty(*context)});
+    }
+
+    Slice(std::shared_ptr<Type> inner_type) : inner_type(inner_type) {}
+};
+
+/**
+ * @brief A class representing a vector type, written `vec<t, n>`.
+ * A vector has `n` lanes of a numeric or bool element type, lowered to an LLVM `<n x t>` vector.
+ * Unlike arrays, vectors are not aggregates; they are passed around by value in SIMD registers,
+ * and arithmetic and comparisons apply to every lane at once.
+ *
+ */
+class Type::Vector : public Type {
+public:
+    // The element type of the lanes.
+    std::shared_ptr<Type> inner_type = nullptr;
+    // The number of lanes.
+    int size = 0;
+
+    virtual ~Vector() = default;
+    Type::Kind kind() const override { return Type::Kind::VECTOR; }
+    std::string to_string() const override { return "vec<" + inner_type->to_string() + ", " + std::to_string(size) + ">"; }
+
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
+        // Vector types are uniqued by LLVM, so there is nothing to cache.
+        return llvm::FixedVectorType::get(inner_type->to_llvm_type(context), size);
+    }
+
+    Vector(std::shared_ptr<Type> inner_type, int size) : inner_type(inner_type), size(size) {}
+};
+
 /**
  * @brief A class representing a tuple type.
  * Tuple types have multiple element types.
@@ -202,6 +279,12 @@ public:
     // A list of element types in the tuple.
     std::vector<std::shared_ptr<Type>> element_types;
 
+private:
+    // The memoized LLVM struct type.
+    mutable LoweringCache lowering;
+
+public:
+
     virtual ~Tuple() = default;
     Type::Kind kind() const override { return Type::Kind::TUPLE; }
     std::string to_string() const override {
@@ -213,16 +296,21 @@ public:
         return str;
     }
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
         return llvm::PointerType::getUnqual(to_llvm_aggregate_type(context));
     }
 
-    llvm::Type* to_llvm_aggregate_type(std::shared_ptr<llvm::LLVMContext> context) const override {
+    llvm::Type* to_llvm_aggregate_type(const std::shared_ptr<llvm::LLVMContext>& context) const override {
+        if (auto cached = lowering.get(context)) {
+            return cached;
+        }
+
         std::vector<llvm::Type*> elem_llvm_types;
+        elem_llvm_types.reserve(element_types.size());
         for (auto& elem : element_types) {
             elem_llvm_types.push_back(elem->to_llvm_type(context));
         }
-        return llvm::StructType::get(*context, elem_llvm_types);
+        return lowering.set(context, llvm::StructType::get(*context, elem_llvm_types));
     }
 
     Tuple(std::vector<std::shared_ptr<Type>>& elements) : element_types(elements) {}
@@ -240,7 +328,7 @@ public:
     Type::Kind kind() const override { return Type::Kind::BLANK; }
     std::string to_string() const override { return ""; }
 
-    llvm::Type* to_llvm_type(std::shared_ptr<llvm::LLVMContext> context) const override { return nullptr; }
+    llvm::Type* to_llvm_type(const std::shared_ptr<llvm::LLVMContext>& context) const override { return nullptr; }
 
     Blank() {}
 };
@@ -374,3 +374,69 @@ TEST_CASE("Checker break outside loop", "[checker]") {
 
     cleanup();
 }
+
+TEST_CASE("Checker for stmt", "[checker]") {
+
+    std::string source_code = R"(
+            fun main(): i32 {
+                var total: i32 = 0
+                const n: i32 = 10
+                for i in 0..n {
+                    total = total + i
+                }
+                var values: [i32; 3] = [1, 2, 3]
+                for value in values {
+                    if value > 1 {
+                        break
+                    }
+                }
+                return 0
+            }
+        )";
+
+    setup(source_code, "test_files/for_stmt.nit", true);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 0);
+
+    cleanup();
+}
+
+TEST_CASE("Checker for stmt non-iterable", "[checker]") {
+
+    std::string source_code = R"(
+            fun main(): i32 {
+                for x in 0.0..1.0 {
+                }
+                return 0
+            }
+        )";
+
+    setup(source_code, "test_files/for_stmt_non_iterable.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 1);
+    CHECK(logger.get_errors().at(0) == E_FOR_OVER_NON_ITERABLE);
+
+    cleanup();
+}
+
+TEST_CASE("Checker for stmt assign to variable", "[checker]") {
+
+    std::string source_code = R"(
+            fun main(): i32 {
+                for i in 0..10 {
+                    i = 5
+                }
+                return 0
+            }
+        )";
+
+    setup(source_code, "test_files/for_stmt_assign.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 1);
+    CHECK(logger.get_errors().at(0) == E_ASSIGN_TO_CONST);
+
+    cleanup();
+}
@@ -591,6 +591,48 @@ fun main(): i32 {
     cleanup();
 }
 
+TEST_CASE("Local checker many locals", "[checker]") {
+    std::string source_code = R"(
+var g: i32 = 0
+fun main(): i32 {
+    var a0 = 0; var a1 = 1; var a2 = 2; var a3 = 3; var a4 = 4; var a5 = 5
+    var a6 = 6; var a7 = 7; var a8 = 8; var a9 = 9; var a10 = 10; var a11 = 11
+    if a0 == 0 {
+        var a3: f64 = 3.0
+        var b: f64 = a3 * 2.0
+    }
+    return a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11 + g
+}
+)";
+
+    setup(source_code, "test_files/many_locals.nit", true);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+
+    REQUIRE(logger.get_errors().size() == 0);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker undeclared variable in large scope", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    var a0 = 0; var a1 = 1; var a2 = 2; var a3 = 3; var a4 = 4; var a5 = 5
+    var a6 = 6; var a7 = 7; var a8 = 8; var a9 = 9; var a10 = 10; var a11 = 11
+    return a12
+}
+)";
+
+    setup(source_code, "test_files/undeclared_variable_large_scope.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_UNKNOWN_VAR);
+
+    cleanup();
+}
+
 TEST_CASE("Local checker invalid cast", "[checker]") {
     std::string source_code = R"(
 fun main(): i32 {
@@ -648,3 +690,122 @@ fun main(): i32 {
 
     cleanup();
 }
+
+TEST_CASE("Local checker parallel bodies", "[checker]") {
+    // Every body declares the same local names; each contains errors that must be reported in source order.
+    std::string source_code = R"(
+var g: i32 = 1;
+fun a(): i32 {
+    var x: i32 = 1;
+    var x: i32 = 2;
+    return x;
+}
+struct S {
+    var m: i32
+    fun b(): bool {
+        var x: bool = 1;
+        return x;
+    }
+}
+var h: bool = 1;
+fun c(): i32 {
+    var x: i32 = g;
+    return true;
+}
+fun d(): i32 {
+    var x: i32 = g;
+    return x;
+}
+)";
+
+    auto check = [&](unsigned worker_count) {
+        auto source_code_ptr = std::make_shared<std::string>(source_code);
+        auto file_name_ptr = std::make_shared<std::string>("test_files/parallel_bodies.nit");
+        ErrorLogger::inst().set_printing_enabled(false);
+
+        Scanner scanner;
+        scanner.scan_file(file_name_ptr, source_code_ptr);
+        Parser parser;
+        std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+        GlobalChecker global_checker;
+        global_checker.type_check(stmts);
+        LocalChecker local_checker;
+        local_checker.set_worker_count(worker_count);
+        local_checker.type_check(stmts);
+
+        auto errors = ErrorLogger::inst().get_errors();
+        cleanup();
+        return errors;
+    };
+
+    auto serial_errors = check(1);
+    REQUIRE(serial_errors.size() == 4);
+    CHECK(serial_errors.at(0) == E_LOCAL_ALREADY_DECLARED);
+    CHECK(serial_errors.at(1) == E_INCOMPATIBLE_TYPES);
+    CHECK(serial_errors.at(2) == E_INCOMPATIBLE_TYPES);
+    CHECK(serial_errors.at(3) == E_RETURN_INCOMPATIBLE);
+
+    for (unsigned worker_count : {0u, 2u, 4u}) {
+        CHECK(check(worker_count) == serial_errors);
+    }
+}
+
+TEST_CASE("Local checker parallel bodies share no types", "[checker]") {
+    // Bodies that make a global's pointer const or leave out a field with a default must not affect each other.
+    std::string source_code = R"(
+var n: i32 = 0
+var g: i32* = &n
+struct P {
+    var x: i32 = 1 + 2
+    var y: i32
+}
+fun a(): i32 {
+    const q = g
+    const p = :P {y: 1}
+    return p.x
+}
+fun b(): i32 {
+    *g = 3
+    const p = :P {y: 2}
+    return p.x + p.y
+}
+fun c(): i32 {
+    const p = :P {y: true}
+    return p.x
+}
+fun d(): i32 {
+    const p = :P {y: 4}
+    return p.x
+}
+)";
+
+    auto check = [&](unsigned worker_count) {
+        auto source_code_ptr = std::make_shared<std::string>(source_code);
+        auto file_name_ptr = std::make_shared<std::string>("test_files/parallel_bodies_share_no_types.nit");
+        ErrorLogger::inst().set_printing_enabled(false);
+
+        Scanner scanner;
+        scanner.scan_file(file_name_ptr, source_code_ptr);
+        Parser parser;
+        std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+        GlobalChecker global_checker;
+        global_checker.type_check(stmts);
+        LocalChecker local_checker;
+        local_checker.set_worker_count(worker_count);
+        local_checker.type_check(stmts);
+
+        auto errors = ErrorLogger::inst().get_errors();
+        cleanup();
+        return errors;
+    };
+
+    auto serial_errors = check(1);
+    REQUIRE(serial_errors.size() == 1);
+    CHECK(serial_errors.at(0) == E_INCOMPATIBLE_TYPES);
+
+    for (unsigned worker_count : {0u, 2u, 4u}) {
+        for (int run = 0; run < 8; run++) {
+            CHECK(check(worker_count) == serial_errors);
+        }
+    }
+}
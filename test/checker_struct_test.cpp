@@ -354,6 +354,140 @@ fun main(): i32 {
     cleanup();
 }
 
+TEST_CASE("Local checker const array as mutable slice", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const arr = [1, 2, 3]
+    const view: [i32] = arr
+    var tail: [i32] = view[1..]
+    return 0
+}
+)";
+    setup(source_code, "test_files/const_array_mutable_slice.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INVALID_PTR_DECLARER);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker const copy of mutable slice", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    var arr = [1, 2, 3, 4]
+    var s: [i32] = arr
+    const t = s
+    s[0] = 1
+    return t[0]
+}
+)";
+    setup(source_code, "test_files/const_copy_of_mutable_slice.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    CHECK(logger.get_errors().size() == 0);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker slice of temporary", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const view = [1, 2, 3][1..]
+    return 0
+}
+)";
+    setup(source_code, "test_files/slice_of_temporary.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INVALID_SLICE);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker dealloc const", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const numbers = [1, 2, 3]
+    const view: [i32] = numbers
+    dealloc view
+    return 0
+}
+)";
+    setup(source_code, "test_files/dealloc_const.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INVALID_DEALLOC);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker alloc count", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    var numbers = alloc [i32; 2.5]
+    return 0
+}
+)";
+    setup(source_code, "test_files/alloc_count.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INVALID_ALLOC);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker alloc nested aggregates", "[checker]") {
+    std::string source_code = R"(
+struct Inner {
+    var a: i32
+}
+struct Outer {
+    var inner: Inner
+}
+struct Linked {
+    var inner: Inner*
+    var count: i32
+}
+enum Shape { Dot, Box((i32, i32)) }
+fun one(): i32 {
+    var outer = alloc Outer
+    return 0
+}
+fun many(): i32 {
+    var outers = alloc [Outer; 4]
+    return 0
+}
+fun grids(): i32 {
+    var grids = alloc [[[i32; 2]; 2]; 4]
+    return 0
+}
+fun shape(): i32 {
+    var shape = alloc Shape
+    return 0
+}
+fun linked(): i32 {
+    var linked = alloc Linked
+    var pairs = alloc [(i32, i32); 4]
+    var rows = alloc [[i32; 2]; 4]
+    return 0
+}
+)";
+    setup(source_code, "test_files/alloc_nested_aggregates.nit", false);
+
+    // Inner aggregates live in storage of their own, which the allocation would not include; pointers to them are fine.
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 4);
+    for (auto error : logger.get_errors()) {
+        CHECK(error == E_INVALID_ALLOC);
+    }
+
+    cleanup();
+}
+
 TEST_CASE("Local checker sized array without initializer", "[checker]") {
     std::string source_code = R"(
 fun main(): i32 {
@@ -481,3 +615,230 @@ fun main(): i32 {
 
     cleanup();
 }
+
+TEST_CASE("Local checker generic struct", "[checker]") {
+    std::string source_code = R"(
+struct Box<T> {
+    var value: T
+
+    fun get(this: Box<T>*): T {
+        return this->value
+    }
+}
+
+fun main(): i32 {
+    var a: Box<i32> = :Box<i32> {value: 1}
+    var b: Box<f64> = :Box<f64> {value: 1.0}
+    return a.get()
+}
+)";
+    setup(source_code, "test_files/generic_struct.nit", true);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 0);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker generic instances are distinct", "[checker]") {
+    std::string source_code = R"(
+struct Box<T> {
+    var value: T
+}
+
+fun main(): i32 {
+    var a: Box<i32> = :Box<f64> {value: 1.0}
+    return 0
+}
+)";
+    setup(source_code, "test_files/generic_instances_distinct.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INCOMPATIBLE_TYPES);
+
+    cleanup();
+}
+
+TEST_CASE("Global checker wrong type arg count", "[checker]") {
+    std::string source_code = R"(
+fun max<T>(a: T, b: T): T {
+    if a > b {
+        return a
+    }
+    return b
+}
+
+fun main(): i32 {
+    return max::<i32, i32>(1, 2)
+}
+)";
+    setup(source_code, "test_files/wrong_type_arg_count.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_WRONG_TYPE_ARG_COUNT);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker vectors", "[checker]") {
+    std::string source_code = R"(
+fun dot(xs: [f64], ys: [f64]): f64 {
+    const all = true as vec<bool, 4>
+    const products = vec::load(xs, 0, all) * vec::load(ys, 0, all)
+    return vec::sum(products)
+}
+
+fun main(): i32 {
+    var a = [1, 2, 3, 4] as vec<i32, 4>
+    const b = 2 as vec<i32, 4>
+    const bigger = a > b
+    a = vec::select(bigger, a - b, -a)
+    a[0] = vec::max(vec::shuffle(a, b, [0, 7, 1, 6]))
+    var out = [0, 0, 0, 0, 0]
+    vec::store(out, 1, a, !bigger)
+    if vec::any(bigger && a == b) {
+        return a[0]
+    }
+    return (a as [i32; 4])[3]
+}
+)";
+    setup(source_code, "test_files/vectors.nit", true);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 0);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker lane out of range", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const v = 1 as vec<i32, 4>
+    return v[4]
+}
+)";
+    setup(source_code, "test_files/lane_out_of_range.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_LANE_OUT_OF_RANGE);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker invalid shuffle", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const v = 1 as vec<i32, 4>
+    var i = 0
+    const w = vec::shuffle(v, [i, 1, 2, 3])
+    return w[0]
+}
+)";
+    setup(source_code, "test_files/invalid_shuffle.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INVALID_SHUFFLE);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker vector mixed with scalar", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const v = 1 as vec<i32, 4>
+    const w = v + 1
+    return w[0]
+}
+)";
+    setup(source_code, "test_files/vector_mixed_with_scalar.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INCOMPATIBLE_TYPES);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker signed and unsigned", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const a = 1 as u8
+    const b = 1 as i8
+    return (a + b) as i32
+}
+)";
+    setup(source_code, "test_files/signed_and_unsigned.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INCOMPATIBLE_TYPES);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker bitwise on floats", "[checker]") {
+    std::string source_code = R"(
+fun main(): i32 {
+    const x = 1.0 << 2
+    return 0
+}
+)";
+    setup(source_code, "test_files/bitwise_on_floats.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_INCOMPATIBLE_TYPES);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker non-exhaustive match", "[checker]") {
+    std::string source_code = R"(
+enum Shape {
+    Circle(f64)
+    Rect(f64, f64)
+    Empty
+}
+
+fun area(s: Shape): f64 {
+    match s {
+        Circle(r) => return r * r
+        Empty => return 0.0
+    }
+    return 1.0
+}
+)";
+    setup(source_code, "test_files/non_exhaustive_match.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_NON_EXHAUSTIVE_MATCH);
+
+    cleanup();
+}
+
+TEST_CASE("Local checker unknown variant", "[checker]") {
+    std::string source_code = R"(
+enum Color { Red, Green, Blue }
+
+fun code(c: Color): i32 {
+    match c {
+        Red => return 1
+        Purple => return 2
+        _ => return 3
+    }
+    return 0
+}
+)";
+    setup(source_code, "test_files/unknown_variant.nit", false);
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_UNKNOWN_VARIANT);
+
+    cleanup();
+}
@@ -114,6 +114,22 @@ TEST_CASE("Parser array type with size", "[parser]") {
     CHECK(printer.print(stmts.at(1)) == "(stmt:eof)");
 }
 
+TEST_CASE("Parser slice type", "[parser]") {
+    std::string source_code = "var x: [i32]; var y: [[i32; 2]];";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/slice_type_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser(scanner.get_tokens());
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse();
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 3);
+    CHECK(printer.print(stmts.at(0)) == "(decl:var x [i32; *])");
+    CHECK(printer.print(stmts.at(1)) == "(decl:var y [[i32; 2]; *])");
+    CHECK(printer.print(stmts.at(2)) == "(stmt:eof)");
+}
+
 TEST_CASE("Parser tuple type", "[parser]") {
     std::string source_code = "var x: (i32, i32); var y: ();";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/tuple_type_test.nit");
@@ -654,6 +670,125 @@ TEST_CASE("Logger no declarer after extern", "[logger]") {
     logger.reset();
 }
 
+TEST_CASE("Parser generic decls", "[parser]") {
+    std::string source_code = R"(
+struct Box<T> {
+    var value: T
+}
+fun max<T>(a: T, b: T): T {
+    return max::<T>(a, b)
+}
+)";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/generic_decls_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser;
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 3);
+    CHECK(printer.print(stmts.at(0)) == "(decl:struct Box<T> { (decl:var value T) })");
+    CHECK(printer.print(stmts.at(1)) == "(decl:fun max<T> fun(T, T) => T (decl:const a T) (decl:const b T) { (stmt:return (call max::<T> a b)) })");
+    CHECK(printer.print(stmts.at(2)) == "(stmt:eof)");
+}
+
+TEST_CASE("Parser vector types", "[parser]") {
+    std::string source_code = R"(
+var v: vec<f64, 4> = 1.0 as vec<f64, 4>
+var m: vec<bool, 8>
+)";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/vector_types_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser;
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 3);
+    CHECK(printer.print(stmts.at(0)) == "(decl:var v vec<f64, 4> (as 1.0000 vec<f64, 4>))");
+    CHECK(printer.print(stmts.at(1)) == "(decl:var m vec<bool, 8>)");
+}
+
+TEST_CASE("Parser enum decls", "[parser]") {
+    std::string source_code = R"(
+enum Color { Red, Green, Blue }
+enum Shape {
+    Circle(f64)
+    Rect(f64, f64)
+    Empty
+}
+)";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/enum_decls_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser;
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 3);
+    CHECK(printer.print(stmts.at(0)) == "(decl:enum Color { Red Green Blue })");
+    CHECK(printer.print(stmts.at(1)) == "(decl:enum Shape { Circle(f64) Rect(f64, f64) Empty })");
+}
+
+TEST_CASE("Parser match stmts", "[parser]") {
+    std::string source_code = R"(
+match shape {
+    Shape::Rect(w, _) => w
+    Empty => {}
+    _ => return
+}
+)";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/match_stmts_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser;
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 2);
+    CHECK(printer.print(stmts.at(0)) == "(stmt:match shape { Shape::Rect(w, _) => { w } Empty => { } _ => { (stmt:return) } })");
+}
+
+TEST_CASE("Logger missing size in vector type", "[logger]") {
+    std::string source_code = "var v: vec<i32>";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/missing_size_in_vector_type_test.nit");
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    logger.set_printing_enabled(false);
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser;
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_MISSING_SIZE_IN_VECTOR_TYPE);
+
+    logger.reset();
+}
+
+TEST_CASE("Logger unmatched angle in type params", "[logger]") {
+    std::string source_code = "struct Box<T { var value: T }";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/unmatched_angle_in_type_params_test.nit");
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    logger.set_printing_enabled(false);
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+    Parser parser;
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse(scanner.get_tokens());
+
+    REQUIRE(logger.get_errors().size() >= 1);
+    CHECK(logger.get_errors().at(0) == E_UNMATCHED_ANGLE_IN_TYPE_PARAMS);
+
+    logger.reset();
+}
+
 TEST_CASE("Logger no lbrace in struct", "[logger]") {
     std::string source_code = "struct Foo var x: i32; }";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/no_lbrace_in_struct_test.nit");
@@ -246,6 +246,44 @@ TEST_CASE("Parser chained access exprs", "[parser]") {
     CHECK(printer.print(stmts.at(3)) == "(stmt:eof)");
 }
 
+TEST_CASE("Parser slice exprs", "[parser]") {
+    std::string source_code = "foo[1..n]; foo[..n]; foo[i + 1..]; foo[..][0];";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/slice_exprs_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+
+    Parser parser(scanner.get_tokens());
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse();
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 5);
+    CHECK(printer.print(stmts.at(0)) == "([..] foo 1 n)");
+    CHECK(printer.print(stmts.at(1)) == "([..] foo _ n)");
+    CHECK(printer.print(stmts.at(2)) == "([..] foo (+ i 1) _)");
+    CHECK(printer.print(stmts.at(3)) == "([] ([..] foo _ _) 0)");
+    CHECK(printer.print(stmts.at(4)) == "(stmt:eof)");
+}
+
+TEST_CASE("Parser alloc exprs", "[parser]") {
+    std::string source_code = "alloc i32; alloc [Foo; n + 1]; dealloc p; dealloc *q;";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/alloc_exprs_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+
+    Parser parser(scanner.get_tokens());
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse();
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 5);
+    CHECK(printer.print(stmts.at(0)) == "(alloc i32)");
+    CHECK(printer.print(stmts.at(1)) == "(alloc Foo (+ n 1))");
+    CHECK(printer.print(stmts.at(2)) == "(dealloc p)");
+    CHECK(printer.print(stmts.at(3)) == "(dealloc (* q))");
+    CHECK(printer.print(stmts.at(4)) == "(stmt:eof)");
+}
+
 TEST_CASE("Parser chained access with grouping", "[parser]") {
     std::string source_code = "foo[foo[1]];";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/chained_access_with_grouping_test.nit");
@@ -378,6 +416,25 @@ TEST_CASE("Parser comparison order of operations", "[parser]") {
     CHECK(printer.print(stmts.at(3)) == "(stmt:eof)");
 }
 
+TEST_CASE("Parser bitwise order of operations", "[parser]") {
+    std::string source_code = "a | b ~ c & d; a & 1 << 2 + 3 == 0; a >> 1 > b; ~a & b;";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/bitwise_order_of_operations_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+
+    Parser parser(scanner.get_tokens());
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse();
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 5);
+    CHECK(printer.print(stmts.at(0)) == "(| a (~ b (& c d)))");
+    CHECK(printer.print(stmts.at(1)) == "(== (& a (<< 1 (+ 2 3))) 0)");
+    CHECK(printer.print(stmts.at(2)) == "(> (>> a 1) b)");
+    CHECK(printer.print(stmts.at(3)) == "(& (~ a) b)");
+    CHECK(printer.print(stmts.at(4)) == "(stmt:eof)");
+}
+
 TEST_CASE("Parser logical exprs", "[parser]") {
     std::string source_code = "true and false; true or false;";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/logical_exprs_test.nit");
@@ -412,6 +469,24 @@ TEST_CASE("Parser logical order of operations", "[parser]") {
     CHECK(printer.print(stmts.at(2)) == "(stmt:eof)");
 }
 
+TEST_CASE("Parser symbolic logical exprs", "[parser]") {
+    std::string source_code = "a && b || c; a &&= b; a ||= b || c;";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/symbolic_logical_exprs_test.nit");
+
+    Scanner scanner;
+    scanner.scan_file(file_name, std::make_shared<std::string>(source_code));
+
+    Parser parser(scanner.get_tokens());
+    std::vector<std::shared_ptr<Stmt>> stmts = parser.parse();
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 4);
+    CHECK(printer.print(stmts.at(0)) == "(|| (&& a b) c)");
+    CHECK(printer.print(stmts.at(1)) == "(&&= a b)");
+    CHECK(printer.print(stmts.at(2)) == "(||= a (|| b c))");
+    CHECK(printer.print(stmts.at(3)) == "(stmt:eof)");
+}
+
 TEST_CASE("Parser assign exprs", "[parser]") {
     std::string source_code = "x = 5; 1 = 2;";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/assign_exprs_test.nit");
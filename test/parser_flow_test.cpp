@@ -334,6 +334,59 @@ TEST_CASE("Parser break stmt", "[parser]") {
     cleanup();
 }
 
+TEST_CASE("Parser for stmt", "[parser]") {
+    std::string source_code = R"(
+for i in 0..n { x = x + i }
+for value in values
+    x = value
+)";
+
+    auto stmts = run_parser(source_code, "test_files/for_stmt.nit");
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 3);
+    CHECK(printer.print(stmts[0]) == "(stmt:for i in 0..n { (= x (+ x i)) })");
+    CHECK(printer.print(stmts[1]) == "(stmt:for value in values { (= x value) })");
+    CHECK(printer.print(stmts[2]) == "(stmt:eof)");
+
+    cleanup();
+}
+
+TEST_CASE("Parser loop hints", "[parser]") {
+    std::string source_code = R"(
+@vectorize(4) @unroll
+while true { x = 1 }
+@parallel
+@unroll(2)
+while false x = 2
+@vectorize for i in 0..8 { x = i }
+)";
+
+    auto stmts = run_parser(source_code, "test_files/loop_hints.nit");
+
+    AstPrinter printer;
+    REQUIRE(stmts.size() == 4);
+    CHECK(printer.print(stmts[0]) == "(stmt:while @vectorize(4) @unroll(0) true { (= x 1) })");
+    CHECK(printer.print(stmts[1]) == "(stmt:while @unroll(2) @parallel false { (= x 2) })");
+    CHECK(printer.print(stmts[2]) == "(stmt:for @vectorize(0) i in 0..8 { (= x i) })");
+    CHECK(printer.print(stmts[3]) == "(stmt:eof)");
+
+    cleanup();
+}
+
+TEST_CASE("Logger loop hints", "[logger]") {
+    std::string source_code = "@parallel(2) while true { x = 1 }\n@unroll x = 1\n";
+
+    auto stmts = run_parser(source_code, "test_files/loop_hints_invalid.nit");
+
+    ErrorLogger& logger = ErrorLogger::inst();
+    REQUIRE(logger.get_errors().size() == 2);
+    CHECK(logger.get_errors()[0] == E_INVALID_LOOP_HINT);
+    CHECK(logger.get_errors()[1] == E_LOOP_HINT_WITHOUT_LOOP);
+
+    cleanup();
+}
+
 TEST_CASE("Logger while stmt unmatched brace", "[logger]") {
     std::string source_code = "while true { x = 1; \n";
 
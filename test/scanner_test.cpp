@@ -222,6 +222,26 @@ TEST_CASE("Scanner operators 2", "[scanner]") {
     CHECK(tokens.at(23)->tok_type == TOK_EOF);
 }
 
+TEST_CASE("Scanner tilde", "[scanner]") {
+    std::string source_code = "~x ~~y ~=";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/tilde_test.nit");
+    std::shared_ptr<std::string> source = std::make_shared<std::string>(source_code);
+
+    Scanner scanner;
+    scanner.scan_file(file_name, source);
+    auto tokens = scanner.get_tokens();
+
+    REQUIRE(tokens.size() == 8);
+    CHECK(tokens.at(0)->tok_type == TOK_TILDE);
+    CHECK(tokens.at(1)->tok_type == TOK_IDENT);
+    CHECK(tokens.at(2)->tok_type == TOK_TILDE);
+    CHECK(tokens.at(3)->tok_type == TOK_TILDE);
+    CHECK(tokens.at(4)->tok_type == TOK_IDENT);
+    CHECK(tokens.at(5)->tok_type == TOK_TILDE);
+    CHECK(tokens.at(6)->tok_type == TOK_EQ);
+    CHECK(tokens.at(7)->tok_type == TOK_EOF);
+}
+
 TEST_CASE("Scanner bool and nil", "[scanner]") {
     std::string source_code = "true false nil";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/bool_nil_test.nit");
@@ -276,6 +296,27 @@ TEST_CASE("Scanner integers", "[scanner]") {
     CHECK(tokens.at(7)->tok_type == TOK_EOF);
 }
 
+TEST_CASE("Scanner integer ranges", "[scanner]") {
+    std::string source_code = "0..10 1...2";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/integer_ranges_test.nit");
+    std::shared_ptr<std::string> source = std::make_shared<std::string>(source_code);
+
+    Scanner scanner;
+    scanner.scan_file(file_name, source);
+    auto tokens = scanner.get_tokens();
+
+    REQUIRE(tokens.size() == 7);
+    CHECK(tokens.at(0)->tok_type == TOK_INT);
+    CHECK(std::any_cast<int>(tokens.at(0)->literal) == 0);
+    CHECK(tokens.at(1)->tok_type == TOK_DOT_DOT);
+    CHECK(tokens.at(2)->tok_type == TOK_INT);
+    CHECK(std::any_cast<int>(tokens.at(2)->literal) == 10);
+    CHECK(tokens.at(3)->tok_type == TOK_INT);
+    CHECK(tokens.at(4)->tok_type == TOK_TRIPLE_DOT);
+    CHECK(tokens.at(5)->tok_type == TOK_INT);
+    CHECK(tokens.at(6)->tok_type == TOK_EOF);
+}
+
 TEST_CASE("Scanner floating point numbers", "[scanner]") {
     std::string source_code = "5.0 5. 0.5 .5 5e5 5e+5 5e-5 5.0e5 5.0e+5 5.0e-5 5E5";
     std::shared_ptr file_name = std::make_shared<std::string>("test_files/floating_point_test.nit");
@@ -536,6 +577,25 @@ TEST_CASE("Escaping newlines", "[scanner]") {
     CHECK(tokens.at(4)->tok_type == TOK_EOF);
 }
 
+TEST_CASE("Scanner interned identifiers", "[scanner]") {
+    std::string source_code = "var count = count + 1";
+    std::shared_ptr file_name = std::make_shared<std::string>("test_files/interned_identifiers_test.nit");
+    std::shared_ptr<std::string> source = std::make_shared<std::string>(source_code);
+
+    Scanner scanner;
+    scanner.scan_file(file_name, source);
+    auto tokens = scanner.get_tokens();
+
+    // Identifiers carry their symbol, so lookups need not search the symbol table; other tokens carry none.
+    REQUIRE(tokens.size() == 7);
+    CHECK(tokens.at(0)->symbol.empty());
+    CHECK(!tokens.at(1)->symbol.empty());
+    CHECK(tokens.at(1)->symbol == Symbol::find("count"));
+    CHECK(tokens.at(3)->symbol == tokens.at(1)->symbol);
+    CHECK(tokens.at(4)->symbol.empty());
+    CHECK(tokens.at(5)->symbol.empty());
+}
+
 // MARK: Error tests
 
 TEST_CASE("Logger no LF after backslash", "[logger]") {